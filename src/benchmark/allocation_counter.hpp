@@ -0,0 +1,44 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <stdint.h>
+
+// Counts the heap allocations of the whole program through operator new, so the benchmarks can
+// check that the steady state of a frame doesn't allocate. Replaces the global operator new and
+// delete, so it must only be included in one translation unit.
+static std::atomic<int64_t> allocation_count{0};
+
+// Number of operator new calls so far, by any thread.
+static int64_t allocations() { return allocation_count.load(std::memory_order_relaxed); }
+
+void* operator new(std::size_t size) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+  if (auto* data = std::malloc(size > 0 ? size : 1)) {
+    return data;
+  }
+
+  throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+  allocation_count.fetch_add(1, std::memory_order_relaxed);
+
+  // aligned_alloc() needs a size that is a non-zero multiple of the alignment
+  const auto align = size_t(alignment);
+  const auto rounded = std::max(size_t(1), (size + align - 1) / align) * align;
+
+  if (auto* data = std::aligned_alloc(align, rounded)) {
+    return data;
+  }
+
+  throw std::bad_alloc();
+}
+
+void operator delete(void* data) noexcept { std::free(data); }
+void operator delete(void* data, std::size_t) noexcept { std::free(data); }
+void operator delete(void* data, std::align_val_t) noexcept { std::free(data); }
+void operator delete(void* data, std::size_t, std::align_val_t) noexcept { std::free(data); }
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "common.hpp"
+#include "benchmark/bilinear_exact.hpp"
+#include "interpolate/filters.hpp"
+#include "interpolate/kernels.hpp"
+
+class FilterMultiThread : public cv::ParallelLoopBody
+{
+public:
+  FilterMultiThread(const interpolate::BGRImage& input_image, const cv::Mat2f& coords,
+                    const interpolate::BGRImage& output_image, interpolate::Filter filter,
+                    interpolate::Isa isa)
+      : input_image_(input_image),
+        coords_(coords),
+        output_image_(output_image),
+        row_function_(filter == interpolate::Filter::bicubic
+                          ? interpolate::kernels_for(isa).bicubic_row
+                          : interpolate::kernels_for(isa).lanczos3_row) {
+    check_output_size(output_image, coords.size());
+  }
+
+  virtual void operator()(const cv::Range& range) const override {
+    for (auto y = range.start; y < range.end; y++) {
+      const auto* px_coords_row = coords_.ptr<cv::Vec2f>(y);
+
+      row_function_(input_image_, reinterpret_cast<const interpolate::InputCoords*>(px_coords_row),
+                    output_image_.row(y), output_image_.cols);
+    }
+  }
+
+private:
+  const interpolate::BGRImage input_image_;
+  const cv::Mat2f coords_;
+  const interpolate::BGRImage output_image_;
+  decltype(interpolate::Kernels::bicubic_row) row_function_;
+};
+
+// Interpolates into a caller provided output image, without allocating.
+void filter_multi_thread(const BenchmarkInput& input, interpolate::Filter filter,
+                         interpolate::Isa isa, const interpolate::BGRImage& output_image) {
+  auto parallel_executor =
+      FilterMultiThread(input.source_image, input.coords, output_image, filter, isa);
+
+  parallel_for(cv::Range(0, output_image.rows), parallel_executor);
+}
+
+cv::Mat3b filter_multi_thread(const BenchmarkInput& input, interpolate::Filter filter,
+                              interpolate::Isa isa) {
+  auto output_image = cv::Mat3b(input.output_size);
+  filter_multi_thread(input, filter, isa, bgr_image(output_image));
+
+  return output_image;
+}
+
+static void BM_filter_multi_thread(benchmark::State& state, const BenchmarkInput& input,
+                                   interpolate::Filter filter, interpolate::Isa isa) {
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    filter_multi_thread(input, filter, isa);
+  }
+
+  perf_counters.stop();
+}
+
+// cv::remap with INTER_CUBIC, what the bicubic kernels replace.
+static void BM_opencv_remap_cubic(benchmark::State& state, const BenchmarkInput& input) {
+  auto map = opencv_map(input.coords);
+
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    auto output_image = cv::Mat3b();
+    cv::remap(input.source_image_mat, output_image, map, cv::noArray(), cv::INTER_CUBIC);
+  }
+
+  perf_counters.stop();
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <vector>
+
+#include "common.hpp"
+#include "interpolate/async_remap.hpp"
+#include "interpolate/remap.hpp"
+
+using StreamClock = std::chrono::steady_clock;
+
+static double seconds_between(StreamClock::time_point start, StreamClock::time_point end) {
+  return std::chrono::duration<double>(end - start).count();
+}
+
+// Report the frames per second of a stream of frames over `elapsed` seconds, and the 50th and
+// 99th percentile latencies from a frame being ready to its output being complete.
+static void set_stream_counters(benchmark::State& state, std::vector<double>& latencies,
+                                double elapsed) {
+  if (latencies.empty() || elapsed <= 0.0) {
+    return;
+  }
+
+  std::sort(latencies.begin(), latencies.end());
+
+  auto percentile_ms = [&](double percentile) {
+    auto index = size_t(percentile * double(latencies.size() - 1) + 0.5);
+    return latencies[index] * 1000.0;
+  };
+
+  state.counters["frames_per_second"] = double(latencies.size()) / elapsed;
+  state.counters["p50_latency_ms"] = percentile_ms(0.50);
+  state.counters["p99_latency_ms"] = percentile_ms(0.99);
+}
+
+// Interpolates with the async API, waiting for the future.
+cv::Mat3b bilinear_async(const BenchmarkInput& input, interpolate::AsyncRemap& async_remap) {
+  auto output_image = cv::Mat3b(input.output_size);
+  async_remap.submit(input.source_image, coords_map(input.coords), bgr_image(output_image)).get();
+
+  return output_image;
+}
+
+template <typename Transform>
+cv::Mat3b bilinear_async(const BenchmarkInput& input, const Transform& transform,
+                         interpolate::AsyncRemap& async_remap) {
+  auto output_image = cv::Mat3b(input.output_size);
+  async_remap.submit(input.source_image, transform, bgr_image(output_image)).get();
+
+  return output_image;
+}
+
+// A stream of frames submitted back to back with up to `in_flight` of them in flight, as a
+// pipeline that hands each frame off and goes back to decoding. Each frame's latency is from its
+// submission, including any wait for a free slot, to its completion callback.
+static void BM_bilinear_async_stream(benchmark::State& state, const BenchmarkInput& input,
+                                     int in_flight) {
+  auto options = interpolate::AsyncRemap::Options();
+  options.pool = &thread_pool(false);
+  options.max_in_flight = in_flight;
+
+  auto async_remap = interpolate::AsyncRemap(options);
+  state.SetLabel(interpolate::isa_name(interpolate::active_isa()));
+
+  // An output per frame in flight. Frames complete in order, so a frame's output is free again by
+  // the time submit() lets another `in_flight` frames in.
+  auto output_images = std::vector<cv::Mat3b>();
+  for (auto i = 0; i < in_flight; i++) {
+    output_images.push_back(cv::Mat3b(input.output_size));
+  }
+
+  const auto map = coords_map(input.coords);
+  auto latencies_mutex = std::mutex();
+  auto latencies = std::vector<double>();
+  auto last_completion = StreamClock::now();
+  auto frame = size_t(0);
+
+  auto perf_counters = PerfCounters(state);
+  const auto start = StreamClock::now();
+
+  for (auto _ : state) {
+    const auto submitted = StreamClock::now();
+    auto output_view = bgr_image(output_images[frame++ % output_images.size()]);
+
+    async_remap.submit(input.source_image, map, output_view, [&, submitted] {
+      auto now = StreamClock::now();
+      auto lock = std::lock_guard<std::mutex>(latencies_mutex);
+      latencies.push_back(seconds_between(submitted, now));
+      last_completion = std::max(last_completion, now);
+    });
+  }
+
+  async_remap.wait_idle();
+  perf_counters.stop();
+
+  set_stream_counters(state, latencies, seconds_between(start, last_completion));
+  set_throughput_counters(state,
+                          coordinate_map_traffic(input.coords, input.source_image_mat.size()));
+}
+
+// The same stream with the blocking interpolate::remap(), one frame at a time.
+static void BM_bilinear_sync_stream(benchmark::State& state, const BenchmarkInput& input) {
+  state.SetLabel(interpolate::isa_name(interpolate::active_isa()));
+
+  auto output_image = cv::Mat3b(input.output_size);
+  auto output_view = bgr_image(output_image);
+  const auto map = coords_map(input.coords);
+  auto latencies = std::vector<double>();
+
+  auto perf_counters = PerfCounters(state);
+  const auto start = StreamClock::now();
+
+  for (auto _ : state) {
+    const auto submitted = StreamClock::now();
+    interpolate::remap(input.source_image, map, output_view);
+    latencies.push_back(seconds_between(submitted, StreamClock::now()));
+  }
+
+  const auto end = StreamClock::now();
+  perf_counters.stop();
+
+  set_stream_counters(state, latencies, seconds_between(start, end));
+  set_throughput_counters(state,
+                          coordinate_map_traffic(input.coords, input.source_image_mat.size()));
+}
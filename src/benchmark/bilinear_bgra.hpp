@@ -0,0 +1,62 @@
+#pragma once
+
+#include "common.hpp"
+#include "interpolate/kernels.hpp"
+#include "interpolate/remap.hpp"
+
+// Interpolates the 32bpp copy of the source image on one thread.
+cv::Mat4b bilinear_bgra_single_thread(const BenchmarkInput& input, interpolate::Isa isa) {
+  auto output_image = cv::Mat4b(input.output_size);
+  auto output = bgra_image(output_image);
+
+  const auto& kernels = interpolate::kernels_for(isa);
+
+  for (auto y = 0; y < output.rows; y++) {
+    const auto* px_coords_row = input.coords.ptr<cv::Vec2f>(y);
+
+    kernels.bilinear_bgra_row(input.source_image_bgra,
+                              reinterpret_cast<const interpolate::InputCoords*>(px_coords_row),
+                              output.row(y), output.cols);
+  }
+
+  return output_image;
+}
+
+// Interpolates the 32bpp copy of the source image with the library's remap.
+cv::Mat4b bilinear_bgra_multi_thread(const BenchmarkInput& input, interpolate::Isa isa) {
+  auto output_image = cv::Mat4b(input.output_size);
+  interpolate::remap(input.source_image_bgra, coords_map(input.coords), bgra_image(output_image),
+                     isa, thread_pool(false));
+
+  return output_image;
+}
+
+// The B, G and R channels of a 32bpp image, to compare with the 24bpp kernels.
+cv::Mat3b bgr_channels(const cv::Mat4b& image) {
+  auto bgr = cv::Mat3b();
+  cv::cvtColor(image, bgr, cv::COLOR_BGRA2BGR);
+
+  return bgr;
+}
+
+// Allocates the output image every frame, like BM_bilinear_single_thread() and
+// BM_bilinear_multi_thread(), so the difference from them is the 32bpp loads, arithmetic and
+// stores. The byte rates count 4 bytes per source and output pixel.
+static void BM_bilinear_bgra(benchmark::State& state, const BenchmarkInput& input,
+                             interpolate::Isa isa, bool multi_thread) {
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    if (multi_thread) {
+      bilinear_bgra_multi_thread(input, isa);
+    } else {
+      bilinear_bgra_single_thread(input, isa);
+    }
+  }
+
+  perf_counters.stop();
+
+  set_throughput_counters(state, coordinate_map_traffic(input.coords,
+                                                        input.source_image_mat.size(),
+                                                        sizeof(interpolate::BGRAPixel)));
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cmath>
+
+#include "common.hpp"
+#include "interpolate/remap.hpp"
+
+// Name used for a border type in the benchmark and validation output.
+std::string border_name(interpolate::BorderType type) {
+  switch (type) {
+    case interpolate::BorderType::constant:
+      return "constant";
+    case interpolate::BorderType::replicate:
+      return "replicate";
+    case interpolate::BorderType::reflect:
+      return "reflect";
+  }
+
+  return "";
+}
+
+// The border constant pixels are sampled as.
+static constexpr interpolate::BGRPixel BORDER_VALUE = {255, 0, 128};
+
+interpolate::Border border_of(interpolate::BorderType type) {
+  return {type, BORDER_VALUE};
+}
+
+// Warps the source image with a map that may sample outside it, through the border.
+cv::Mat3b bilinear_border_multi_thread(const BenchmarkInput& input, const cv::Mat2f& coords,
+                                       const interpolate::Border& border, interpolate::Isa isa) {
+  auto output_image = cv::Mat3b(coords.size());
+  interpolate::remap(input.source_image, coords_map(coords), bgr_image(output_image), border, isa,
+                     thread_pool(false));
+
+  return output_image;
+}
+
+// A map offset into the source image padded by `padding` pixels on every side, enough to hold
+// every coordinate of the original map.
+struct PaddedMap {
+  int padding;
+  cv::Mat2f coords;
+};
+
+PaddedMap padded_map(const cv::Mat2f& coords, cv::Size2i input_size) {
+  auto padding = 0.0f;
+
+  for (auto y = 0; y < coords.rows; y++) {
+    for (auto x = 0; x < coords.cols; x++) {
+      const auto& c = coords(y, x);
+      padding = std::max({padding, -c[0], -c[1], c[0] - float(input_size.height - 1),
+                          c[1] - float(input_size.width - 1)});
+    }
+  }
+
+  auto padded = PaddedMap{int(std::ceil(padding)) + 1, cv::Mat2f(coords.size())};
+
+  for (auto y = 0; y < coords.rows; y++) {
+    for (auto x = 0; x < coords.cols; x++) {
+      const auto& c = coords(y, x);
+      padded.coords(y, x) = {c[0] + float(padded.padding), c[1] + float(padded.padding)};
+    }
+  }
+
+  return padded;
+}
+
+// What a pipeline without border modes does each frame: pad the source image with
+// cv::copyMakeBorder(), then warp the padded image with the offset map.
+cv::Mat3b bilinear_padded_multi_thread(const BenchmarkInput& input, const PaddedMap& map,
+                                       const interpolate::Border& border, interpolate::Isa isa) {
+  int opencv_border = cv::BORDER_CONSTANT;
+
+  if (border.type == interpolate::BorderType::replicate) {
+    opencv_border = cv::BORDER_REPLICATE;
+  } else if (border.type == interpolate::BorderType::reflect) {
+    opencv_border = cv::BORDER_REFLECT;
+  }
+
+  auto padded_source = cv::Mat3b();
+  cv::copyMakeBorder(input.source_image_mat, padded_source, map.padding, map.padding, map.padding,
+                     map.padding, opencv_border,
+                     cv::Scalar(border.value.b, border.value.g, border.value.r));
+
+  auto output_image = cv::Mat3b(map.coords.size());
+  interpolate::remap(bgr_image(padded_source), coords_map(map.coords), bgr_image(output_image),
+                     isa, thread_pool(false));
+
+  return output_image;
+}
+
+// Allocates the output image every frame, like BM_bilinear_multi_thread().
+static void BM_bilinear_border_multi_thread(benchmark::State& state, const BenchmarkInput& input,
+                                            const cv::Mat2f& coords,
+                                            interpolate::BorderType type, interpolate::Isa isa) {
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    bilinear_border_multi_thread(input, coords, border_of(type), isa);
+  }
+
+  perf_counters.stop();
+}
+
+static void BM_bilinear_padded_multi_thread(benchmark::State& state, const BenchmarkInput& input,
+                                            const PaddedMap& map, interpolate::BorderType type,
+                                            interpolate::Isa isa) {
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    bilinear_padded_multi_thread(input, map, border_of(type), isa);
+  }
+
+  perf_counters.stop();
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cmath>
+
+#include "common.hpp"
+#include "interpolate/kernels.hpp"
+
+// Formats of the coordinate map read by the kernels.
+enum class MapFormat { fixed_point, half_float };
+
+class CompactMapMultiThread : public cv::ParallelLoopBody
+{
+public:
+  CompactMapMultiThread(const BenchmarkInput& input, const interpolate::BGRImage& output_image,
+                        MapFormat format, interpolate::Isa isa)
+      : input_(input),
+        output_image_(output_image),
+        format_(format),
+        kernels_(interpolate::kernels_for(isa)) {
+    check_output_size(output_image, input.output_size);
+  }
+
+  virtual void operator()(const cv::Range& range) const override {
+    for (auto y = range.start; y < range.end; y++) {
+      auto* output_pixels_row = output_image_.row(y);
+
+      if (format_ == MapFormat::fixed_point) {
+        const auto* coords_row = reinterpret_cast<const interpolate::FixedPointCoords*>(
+            input_.fixed_point_coords.ptr<cv::Vec2s>(y));
+
+        kernels_.bilinear_fixed_point_row(input_.source_image, coords_row,
+                                          input_.fixed_point_fractions.ptr<uint16_t>(y),
+                                          output_pixels_row, output_image_.cols);
+      } else {
+        const auto* offsets_row = reinterpret_cast<const interpolate::HalfFloatOffsets*>(
+            input_.half_float_offsets.ptr<cv::Vec2w>(y));
+
+        kernels_.bilinear_half_float_row(input_.source_image, offsets_row, 0, y,
+                                         output_pixels_row, output_image_.cols);
+      }
+    }
+  }
+
+private:
+  const BenchmarkInput& input_;
+  const interpolate::BGRImage output_image_;
+  const MapFormat format_;
+  const interpolate::Kernels& kernels_;
+};
+
+// Interpolates into a caller provided output image, without allocating.
+void bilinear_compact_map_multi_thread(const BenchmarkInput& input, MapFormat format,
+                                       interpolate::Isa isa,
+                                       const interpolate::BGRImage& output_image) {
+  auto parallel_executor = CompactMapMultiThread(input, output_image, format, isa);
+
+  parallel_for(cv::Range(0, output_image.rows), parallel_executor);
+}
+
+cv::Mat3b bilinear_compact_map_multi_thread(const BenchmarkInput& input, MapFormat format,
+                                            interpolate::Isa isa) {
+  auto output_image = cv::Mat3b(input.output_size);
+  bilinear_compact_map_multi_thread(input, format, isa, bgr_image(output_image));
+
+  return output_image;
+}
+
+// The coordinates the half float offsets of an input decode to, as a float map.
+cv::Mat2f half_float_coordinates(const BenchmarkInput& input) {
+  auto coords = cv::Mat2f(input.half_float_offsets.size());
+
+  for (auto y = 0; y < coords.rows; y++) {
+    for (auto x = 0; x < coords.cols; x++) {
+      const auto& offset = input.half_float_offsets(y, x);
+      coords(y, x) = {float(y) + interpolate::half_to_float(offset[0]),
+                      float(x) + interpolate::half_to_float(offset[1])};
+    }
+  }
+
+  return coords;
+}
+
+// Largest difference between the coordinates of the input's float map and what its half float
+// offsets decode to.
+float half_float_error(const BenchmarkInput& input) {
+  auto decoded = half_float_coordinates(input);
+  auto max_error = 0.0f;
+
+  for (auto y = 0; y < decoded.rows; y++) {
+    for (auto x = 0; x < decoded.cols; x++) {
+      const auto& c = decoded(y, x);
+      const auto& expected = input.coords(y, x);
+      max_error = std::max({max_error, std::abs(c[0] - expected[0]),
+                            std::abs(c[1] - expected[1])});
+    }
+  }
+
+  return max_error;
+}
+
+static void BM_bilinear_compact_map_multi_thread(benchmark::State& state,
+                                                 const BenchmarkInput& input, MapFormat format,
+                                                 interpolate::Isa isa) {
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    bilinear_compact_map_multi_thread(input, format, isa);
+  }
+
+  perf_counters.stop();
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <type_traits>
+
+#include "common.hpp"
+#include "interpolate/kernels.hpp"
+#include "interpolate/remap.hpp"
+
+// Image of 3 `Channel`s per pixel, uint16_t or float.
+template <typename Channel>
+using DeepMat = cv::Mat_<cv::Vec<Channel, 3>>;
+
+// View of an image for the 16 bit or float kernels. Doesn't own the pixels.
+static interpolate::BGR16Image deep_image(const cv::Mat3w& mat) { return bgr16_image(mat); }
+static interpolate::BGRFloatImage deep_image(const cv::Mat3f& mat) { return bgr_float_image(mat); }
+
+// The copy of the source image with `Channel`s.
+template <typename Channel>
+const auto& deep_source(const BenchmarkInput& input) {
+  if constexpr (std::is_same_v<Channel, float>) {
+    return input.source_image_float;
+  } else {
+    return input.source_image_16;
+  }
+}
+
+// Interpolates the 16 bit or float copy of the source image on one thread.
+template <typename Channel>
+DeepMat<Channel> bilinear_deep_single_thread(const BenchmarkInput& input, interpolate::Isa isa) {
+  auto output_image = DeepMat<Channel>(input.output_size);
+  auto output = deep_image(output_image);
+
+  const auto& kernels = interpolate::kernels_for(isa);
+  const auto bilinear_row = [&] {
+    if constexpr (std::is_same_v<Channel, float>) {
+      return kernels.bilinear_bgr_float_row;
+    } else {
+      return kernels.bilinear_bgr16_row;
+    }
+  }();
+
+  for (auto y = 0; y < output.rows; y++) {
+    const auto* px_coords_row = input.coords.ptr<cv::Vec2f>(y);
+
+    bilinear_row(deep_source<Channel>(input),
+                 reinterpret_cast<const interpolate::InputCoords*>(px_coords_row), output.row(y),
+                 output.cols);
+  }
+
+  return output_image;
+}
+
+// Interpolates the 16 bit or float copy of the source image with the library's remap.
+template <typename Channel>
+DeepMat<Channel> bilinear_deep_multi_thread(const BenchmarkInput& input, interpolate::Isa isa) {
+  auto output_image = DeepMat<Channel>(input.output_size);
+  interpolate::remap(deep_source<Channel>(input), coords_map(input.coords),
+                     deep_image(output_image), isa, thread_pool(false));
+
+  return output_image;
+}
+
+// A 16 bit or float image scaled back to 8 bits, to compare with the 8 bit kernels.
+template <typename Channel>
+cv::Mat3b bgr_from_deep(const DeepMat<Channel>& image) {
+  auto bgr = cv::Mat3b();
+  image.convertTo(bgr, CV_8U, std::is_same_v<Channel, float> ? 255.0 : 1.0 / 257.0);
+
+  return bgr;
+}
+
+// Allocates the output image every frame, like BM_bilinear_single_thread() and
+// BM_bilinear_multi_thread(). The byte rates count 6 or 12 bytes per source and output pixel,
+// to compare the bandwidth of each depth.
+template <typename Channel>
+static void BM_bilinear_deep(benchmark::State& state, const BenchmarkInput& input,
+                             interpolate::Isa isa, bool multi_thread) {
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    if (multi_thread) {
+      bilinear_deep_multi_thread<Channel>(input, isa);
+    } else {
+      bilinear_deep_single_thread<Channel>(input, isa);
+    }
+  }
+
+  perf_counters.stop();
+
+  set_throughput_counters(state, coordinate_map_traffic(
+                                     input.coords, input.source_image_mat.size(),
+                                     sizeof(interpolate::BasicBGRPixel<Channel>)));
+}
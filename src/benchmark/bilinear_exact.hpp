@@ -0,0 +1,95 @@
+#pragma once
+
+#include "common.hpp"
+#include "interpolate/kernels.hpp"
+
+class ExactMultiThread : public cv::ParallelLoopBody
+{
+public:
+  ExactMultiThread(const interpolate::BGRImage& input_image, const cv::Mat2f& coords,
+                   const interpolate::BGRImage& output_image, interpolate::Isa isa)
+      : input_image_(input_image),
+        coords_(coords),
+        output_image_(output_image),
+        kernels_(interpolate::kernels_for(isa)) {
+    check_output_size(output_image, coords.size());
+  }
+
+  virtual void operator()(const cv::Range& range) const override {
+    for (auto y = range.start; y < range.end; y++) {
+      const auto* px_coords_row = coords_.ptr<cv::Vec2f>(y);
+
+      kernels_.bilinear_exact_row(input_image_,
+                                  reinterpret_cast<const interpolate::InputCoords*>(px_coords_row),
+                                  output_image_.row(y), output_image_.cols);
+    }
+  }
+
+private:
+  const interpolate::BGRImage input_image_;
+  const cv::Mat2f coords_;
+  const interpolate::BGRImage output_image_;
+  const interpolate::Kernels& kernels_;
+};
+
+// Interpolates into a caller provided output image, without allocating.
+void bilinear_exact_multi_thread(const BenchmarkInput& input, interpolate::Isa isa,
+                                 const interpolate::BGRImage& output_image) {
+  auto parallel_executor = ExactMultiThread(input.source_image, input.coords, output_image, isa);
+
+  parallel_for(cv::Range(0, output_image.rows), parallel_executor);
+}
+
+cv::Mat3b bilinear_exact_multi_thread(const BenchmarkInput& input, interpolate::Isa isa) {
+  auto output_image = cv::Mat3b(input.output_size);
+  bilinear_exact_multi_thread(input, isa, bgr_image(output_image));
+
+  return output_image;
+}
+
+// The sampling coordinates as an OpenCV map, which holds x y pairs rather than y x.
+cv::Mat2f opencv_map(const cv::Mat2f& coords) {
+  auto map = cv::Mat2f(coords.size());
+
+  for (auto y = 0; y < coords.rows; y++) {
+    for (auto x = 0; x < coords.cols; x++) {
+      map(y, x) = {coords(y, x)[1], coords(y, x)[0]};
+    }
+  }
+
+  return map;
+}
+
+// cv::remap with INTER_LINEAR, the reference for the exact mode.
+cv::Mat3b opencv_remap(const BenchmarkInput& input, const cv::Mat2f& map) {
+  auto output_image = cv::Mat3b();
+  cv::remap(input.source_image_mat, output_image, map, cv::noArray(), cv::INTER_LINEAR);
+
+  return output_image;
+}
+
+static void BM_bilinear_exact_multi_thread(benchmark::State& state, const BenchmarkInput& input,
+                                           interpolate::Isa isa) {
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    bilinear_exact_multi_thread(input, isa);
+  }
+
+  perf_counters.stop();
+}
+
+static void BM_opencv_remap(benchmark::State& state, const BenchmarkInput& input) {
+  auto map = opencv_map(input.coords);
+
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    opencv_remap(input, map);
+  }
+
+  perf_counters.stop();
+
+  set_throughput_counters(state,
+                          coordinate_map_traffic(input.coords, input.source_image_mat.size()));
+}
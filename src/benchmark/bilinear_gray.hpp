@@ -0,0 +1,60 @@
+#pragma once
+
+#include "common.hpp"
+#include "interpolate/kernels.hpp"
+#include "interpolate/remap.hpp"
+
+// Interpolates the grayscale copy of the source image on one thread.
+cv::Mat1b bilinear_gray_single_thread(const BenchmarkInput& input, interpolate::Isa isa) {
+  auto output_image = cv::Mat1b(input.output_size);
+  auto output = gray_image(output_image);
+
+  const auto& kernels = interpolate::kernels_for(isa);
+
+  for (auto y = 0; y < output.rows; y++) {
+    const auto* px_coords_row = input.coords.ptr<cv::Vec2f>(y);
+
+    kernels.bilinear_gray_row(input.source_image_gray,
+                              reinterpret_cast<const interpolate::InputCoords*>(px_coords_row),
+                              output.row(y), output.cols);
+  }
+
+  return output_image;
+}
+
+// Interpolates the grayscale copy of the source image with the library's remap.
+cv::Mat1b bilinear_gray_multi_thread(const BenchmarkInput& input, interpolate::Isa isa) {
+  auto output_image = cv::Mat1b(input.output_size);
+  interpolate::remap(input.source_image_gray, coords_map(input.coords), gray_image(output_image),
+                     isa, thread_pool(false));
+
+  return output_image;
+}
+
+// A grayscale image with its value in all three channels, to compare with the 24bpp kernels.
+cv::Mat3b bgr_from_gray(const cv::Mat1b& image) {
+  auto bgr = cv::Mat3b();
+  cv::cvtColor(image, bgr, cv::COLOR_GRAY2BGR);
+
+  return bgr;
+}
+
+// Allocates the output image every frame, like BM_bilinear_single_thread() and
+// BM_bilinear_multi_thread(). The byte rates count 1 byte per source and output pixel.
+static void BM_bilinear_gray(benchmark::State& state, const BenchmarkInput& input,
+                             interpolate::Isa isa, bool multi_thread) {
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    if (multi_thread) {
+      bilinear_gray_multi_thread(input, isa);
+    } else {
+      bilinear_gray_single_thread(input, isa);
+    }
+  }
+
+  perf_counters.stop();
+
+  set_throughput_counters(state, coordinate_map_traffic(input.coords,
+                                                        input.source_image_mat.size(), 1));
+}
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <map>
+#include <memory>
+
+#include "common.hpp"
+#include "benchmark/bilinear_multi_thread.hpp"
+
+// Thread pool with `threads` threads including the caller, 0 for all hardware threads. Pools are
+// created on first use and kept, so every benchmark with the same thread count shares one.
+static interpolate::ThreadPool& sized_thread_pool(int threads) {
+  if (threads <= 0) {
+    return thread_pool(false);
+  }
+
+  static auto pools = std::map<int, std::unique_ptr<interpolate::ThreadPool>>();
+  auto& pool = pools[threads];
+
+  if (!pool) {
+    auto options = interpolate::ThreadPool::Options();
+    options.threads = threads;
+    pool = std::make_unique<interpolate::ThreadPool>(options);
+  }
+
+  return *pool;
+}
+
+// Input for one point of the benchmark matrix: the source image scaled to `source_percent` of
+// its size, and coordinates for a 16:9 output `output_width` pixels wide, rotated by `angle`
+// degrees about the centre and stepping `scale` source pixels per output pixel.
+BenchmarkInput matrix_input(const BenchmarkInput& input, int source_percent, int output_width,
+                            float angle, float scale) {
+  auto matrix_input = BenchmarkInput();
+
+  if (source_percent == 100) {
+    matrix_input.source_image_mat = input.source_image_mat;
+  } else {
+    auto source_size = cv::Size2i(input.source_image_mat.cols * source_percent / 100,
+                                  input.source_image_mat.rows * source_percent / 100);
+    cv::resize(input.source_image_mat, matrix_input.source_image_mat, source_size, 0, 0,
+               cv::INTER_AREA);
+  }
+
+  matrix_input.source_image = bgr_image(matrix_input.source_image_mat);
+  matrix_input.output_size = cv::Size2i(output_width, output_width * 9 / 16);
+  matrix_input.coords = rotated_sampling_coordinates(
+      matrix_input.output_size, matrix_input.source_image_mat.size(), angle, scale);
+
+  return matrix_input;
+}
+
+// Arguments: source image size in percent, output width, rotation angle in degrees, source
+// pixels per output pixel in percent, threads (0 for all hardware threads). Kernel only, with
+// the dispatched instruction set.
+static void BM_bilinear_matrix(benchmark::State& state, const BenchmarkInput& input) {
+  auto threads = int(state.range(4));
+  auto& pool = sized_thread_pool(threads);
+
+  auto isa = interpolate::active_isa();
+  state.SetLabel(std::string(interpolate::isa_name(isa)) + " " + std::to_string(pool.threads()) +
+                 " threads");
+
+  const auto frame_input = matrix_input(input, int(state.range(0)), int(state.range(1)),
+                                        float(state.range(2)), state.range(3) / 100.0f);
+
+  auto output_image = cv::Mat3b(frame_input.output_size);
+  auto output_view = bgr_image(output_image);
+  auto parallel_executor =
+      InterpolateMultiThread(frame_input.source_image, frame_input.coords, output_view, isa);
+
+  auto perf_counters = PerfCounters(state, pool);
+
+  for (auto _ : state) {
+    pool.parallel_for(output_view.rows, 0,
+                      [&](int begin, int end) { parallel_executor(cv::Range(begin, end)); });
+  }
+
+  perf_counters.stop();
+
+  set_throughput_counters(
+      state,
+      coordinate_map_traffic(frame_input.coords, frame_input.source_image_mat.size()));
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "common.hpp"
+#include "interpolate/image_pyramid.hpp"
+
+// Interpolates into a caller provided output image, without allocating. The pyramid is only
+// rebuilt when the source image changes.
+void bilinear_mipmap_multi_thread(const BenchmarkInput& input, interpolate::ImagePyramid& pyramid,
+                                  interpolate::MipmapFilter filter, interpolate::Isa isa,
+                                  const interpolate::BGRImage& output_image) {
+  pyramid.update(input.source_image, isa);
+
+  interpolate::remap(pyramid, coords_map(input.coords), output_image, filter, isa,
+                     thread_pool(false));
+}
+
+cv::Mat3b bilinear_mipmap_multi_thread(const BenchmarkInput& input,
+                                       interpolate::ImagePyramid& pyramid,
+                                       interpolate::MipmapFilter filter, interpolate::Isa isa) {
+  auto output_image = cv::Mat3b(input.output_size);
+  bilinear_mipmap_multi_thread(input, pyramid, filter, isa, bgr_image(output_image));
+
+  return output_image;
+}
+
+// Kernel only. The pyramid is built in the first frame and reused, as for a source image that
+// doesn't change between frames, unless `rebuild` is set.
+static void BM_bilinear_mipmap_multi_thread(benchmark::State& state, const BenchmarkInput& input,
+                                            interpolate::MipmapFilter filter, interpolate::Isa isa,
+                                            bool rebuild = false) {
+  auto pyramid = interpolate::ImagePyramid();
+  auto output_image = cv::Mat3b(input.output_size);
+  auto output_view = bgr_image(output_image);
+
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    if (rebuild) {
+      pyramid.invalidate();
+    }
+
+    bilinear_mipmap_multi_thread(input, pyramid, filter, isa, output_view);
+  }
+
+  perf_counters.stop();
+
+  state.counters["builds"] = pyramid.builds();
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "common.hpp"
+#include "benchmark/allocation_counter.hpp"
+#include "interpolate/buffer_pool.hpp"
+#include "interpolate/kernels.hpp"
+#include "interpolate/remap.hpp"
+#include "interpolate/streaming.hpp"
+
+class InterpolateMultiThread : public cv::ParallelLoopBody
+{
+public:
+  InterpolateMultiThread(const interpolate::BGRImage& input_image, const cv::Mat2f& coords,
+                         const interpolate::BGRImage& output_image, interpolate::Isa isa,
+                         interpolate::Store store = interpolate::Store::cached)
+      : input_image_(input_image),
+        coords_(coords),
+        output_image_(output_image),
+        kernels_(interpolate::kernels_for(isa)),
+        store_(store) {
+    check_output_size(output_image, coords.size());
+  }
+
+  virtual void operator()(const cv::Range& range) const override {
+    auto streaming = store_ == interpolate::Store::streaming;
+    auto bilinear_row = streaming ? kernels_.bilinear_streaming_row : kernels_.bilinear_row;
+
+    for (auto y = range.start; y < range.end; y++) {
+      const auto* px_coords_row = coords_.ptr<cv::Vec2f>(y);
+
+      bilinear_row(input_image_, reinterpret_cast<const interpolate::InputCoords*>(px_coords_row),
+                   output_image_.row(y), output_image_.cols);
+    }
+
+    // Once per chunk, so the output is complete when parallel_for returns
+    if (streaming) {
+      interpolate::streaming_store_fence();
+    }
+  }
+
+private:
+  const interpolate::BGRImage input_image_;
+  const cv::Mat2f coords_;
+  const interpolate::BGRImage output_image_;
+  const interpolate::Kernels& kernels_;
+  const interpolate::Store store_;
+};
+
+// Interpolates into a caller provided output image, without allocating.
+void bilinear_multi_thread(const BenchmarkInput& input, interpolate::Isa isa,
+                           const interpolate::BGRImage& output_image,
+                           Executor executor = Executor::thread_pool,
+                           interpolate::Store store = interpolate::Store::cached) {
+  auto parallel_executor =
+      InterpolateMultiThread(input.source_image, input.coords, output_image, isa, store);
+
+  parallel_for(cv::Range(0, output_image.rows), parallel_executor, executor);
+}
+
+cv::Mat3b bilinear_multi_thread(const BenchmarkInput& input, interpolate::Isa isa,
+                                Executor executor = Executor::thread_pool,
+                                interpolate::Store store = interpolate::Store::cached) {
+  auto output_image = cv::Mat3b(input.output_size);
+  bilinear_multi_thread(input, isa, bgr_image(output_image), executor, store);
+
+  return output_image;
+}
+
+// Allocates the output image every frame.
+static void BM_bilinear_multi_thread(benchmark::State& state, const BenchmarkInput& input,
+                                     interpolate::Isa isa) {
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    bilinear_multi_thread(input, isa);
+  }
+
+  perf_counters.stop();
+
+  set_throughput_counters(state,
+                          coordinate_map_traffic(input.coords, input.source_image_mat.size()));
+}
+
+// Uses whichever instruction set the runtime dispatcher selected.
+static void BM_bilinear_dispatched_multi_thread(benchmark::State& state,
+                                                const BenchmarkInput& input,
+                                                Executor executor = Executor::thread_pool) {
+  auto isa = interpolate::active_isa();
+  state.SetLabel(interpolate::isa_name(isa));
+
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    bilinear_multi_thread(input, isa, executor);
+  }
+
+  perf_counters.stop();
+}
+
+// Kernel only: writes every frame into the same caller owned output image.
+static void BM_bilinear_dispatched_multi_thread_preallocated(benchmark::State& state,
+                                                             const BenchmarkInput& input) {
+  auto isa = interpolate::active_isa();
+  state.SetLabel(interpolate::isa_name(isa));
+
+  auto output_image = cv::Mat3b(input.output_size);
+  auto output_view = bgr_image(output_image);
+
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    bilinear_multi_thread(input, isa, output_view);
+  }
+
+  perf_counters.stop();
+}
+
+// Kernel only through interpolate::remap(), the library entry point, with the dispatched
+// instruction set and the library's thread pool.
+static void BM_core_remap(benchmark::State& state, const BenchmarkInput& input) {
+  state.SetLabel(interpolate::isa_name(interpolate::active_isa()));
+
+  auto output_image = cv::Mat3b(input.output_size);
+  auto output_view = bgr_image(output_image);
+  auto map = coords_map(input.coords);
+
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    interpolate::remap(input.source_image, map, output_view);
+  }
+
+  perf_counters.stop();
+
+  set_throughput_counters(state,
+                          coordinate_map_traffic(input.coords, input.source_image_mat.size()));
+}
+
+// Interpolates a frame into an image from a buffer pool on the thread pool, and releases it.
+// Only the first frame allocates: the buffer, then never again.
+void bilinear_buffer_pool_frame(const BenchmarkInput& input, interpolate::Isa isa,
+                                interpolate::ImageBufferPool& pool) {
+  auto buffer = pool.acquire(input.output_size.height, input.output_size.width);
+  bilinear_multi_thread(input, isa, buffer.image());
+}
+
+// Output images from a buffer pool, released after each frame. "allocated" counts the pool's
+// buffers, and "allocations" the heap allocations of anything else in the frames after the first.
+static void BM_bilinear_dispatched_multi_thread_buffer_pool(benchmark::State& state,
+                                                            const BenchmarkInput& input) {
+  auto isa = interpolate::active_isa();
+  state.SetLabel(interpolate::isa_name(isa));
+
+  auto pool = interpolate::ImageBufferPool();
+  bilinear_buffer_pool_frame(input, isa, pool);
+
+  auto perf_counters = PerfCounters(state);
+  auto allocations_start = allocations();
+
+  for (auto _ : state) {
+    bilinear_buffer_pool_frame(input, isa, pool);
+  }
+
+  auto frame_allocations = allocations() - allocations_start;
+  perf_counters.stop();
+
+  state.counters["allocated"] = pool.allocated();
+  state.counters["allocations"] = double(frame_allocations);
+}
+
+// Kernel only, with regular or streaming stores. Use an output much larger than the cache to see
+// the difference.
+static void BM_bilinear_store_multi_thread(benchmark::State& state, const BenchmarkInput& input,
+                                           interpolate::Isa isa, interpolate::Store store) {
+  auto output_image = cv::Mat3b(input.output_size);
+  auto output_view = bgr_image(output_image);
+
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    bilinear_multi_thread(input, isa, output_view, Executor::thread_pool, store);
+  }
+
+  perf_counters.stop();
+}
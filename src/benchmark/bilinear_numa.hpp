@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+
+#include "common.hpp"
+#include "interpolate/numa.hpp"
+
+// Interpolates with the NUMA aware remap, into its own output image.
+cv::Mat3b bilinear_numa(const BenchmarkInput& input, interpolate::Isa isa,
+                        const interpolate::NumaRemap::Options& options) {
+  auto remap = interpolate::NumaRemap(coords_map(input.coords), input.source_image.rows,
+                                      input.source_image.cols, isa, options);
+  remap.remap(input.source_image);
+
+  return mat_view(remap.output()).clone();
+}
+
+// Kernel only, with the dispatched instruction set. Reports the throughput of each node as
+// node<N>_items_per_second, in output pixels per second of the node's own wall time, and its
+// threads as node<N>_threads. Scaling is near linear when the per node throughputs are close to
+// each other and to the single node throughput per thread.
+static void BM_bilinear_numa(benchmark::State& state, const BenchmarkInput& input,
+                             bool replicate_source) {
+  auto isa = interpolate::active_isa();
+
+  auto options = interpolate::NumaRemap::Options();
+  options.replicate_source = replicate_source;
+
+  auto remap = interpolate::NumaRemap(coords_map(input.coords), input.source_image.rows,
+                                      input.source_image.cols, isa, options);
+  state.SetLabel(std::string(interpolate::isa_name(isa)) + " " + std::to_string(remap.nodes()) +
+                 " nodes");
+
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    remap.remap(input.source_image);
+  }
+
+  perf_counters.stop();
+
+  for (auto index = 0; index < remap.nodes(); index++) {
+    auto name = "node" + std::to_string(remap.node(index).node);
+    auto pixels = double(remap.node_rows(index)) * double(input.output_size.width);
+
+    if (remap.node_seconds(index) > 0.0) {
+      state.counters[name + "_items_per_second"] =
+          pixels * double(state.iterations()) / remap.node_seconds(index);
+    }
+
+    state.counters[name + "_threads"] = remap.node_threads(index);
+  }
+
+  set_throughput_counters(state,
+                          coordinate_map_traffic(input.coords, input.source_image_mat.size()));
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "common.hpp"
+#include "interpolate/kernels.hpp"
+#include "interpolate/remap_plan.hpp"
+
+interpolate::RemapPlan build_remap_plan(const BenchmarkInput& input) {
+  return interpolate::RemapPlan(
+      input.source_image, reinterpret_cast<const interpolate::InputCoords*>(input.coords.ptr(0)),
+      input.coords.rows, input.coords.cols, input.coords.step / sizeof(interpolate::InputCoords));
+}
+
+class RemapPlanMultiThread : public cv::ParallelLoopBody
+{
+public:
+  RemapPlanMultiThread(const interpolate::BGRImage& input_image,
+                       const interpolate::RemapPlan& plan,
+                       const interpolate::BGRImage& output_image, interpolate::Isa isa)
+      : input_image_(input_image),
+        plan_(plan),
+        output_image_(output_image),
+        kernels_(interpolate::kernels_for(isa)) {
+    if (!plan.compatible(input_image) || plan.rows() != output_image.rows ||
+        plan.cols() != output_image.cols) {
+      throw std::runtime_error("remap plan doesn't match the input and output images");
+    }
+  }
+
+  virtual void operator()(const cv::Range& range) const override {
+    for (auto y = range.start; y < range.end; y++) {
+      auto* output_pixels_row = output_image_.row(y);
+
+      kernels_.bilinear_plan_row(input_image_, plan_.offsets(y), plan_.weights(y),
+                                 output_pixels_row, output_image_.cols);
+    }
+  }
+
+private:
+  const interpolate::BGRImage input_image_;
+  const interpolate::RemapPlan& plan_;
+  const interpolate::BGRImage output_image_;
+  const interpolate::Kernels& kernels_;
+};
+
+// Interpolates into a caller provided output image, without allocating.
+void bilinear_remap_plan_multi_thread(const BenchmarkInput& input,
+                                      const interpolate::RemapPlan& plan, interpolate::Isa isa,
+                                      const interpolate::BGRImage& output_image) {
+  auto parallel_executor = RemapPlanMultiThread(input.source_image, plan, output_image, isa);
+
+  parallel_for(cv::Range(0, output_image.rows), parallel_executor);
+}
+
+cv::Mat3b bilinear_remap_plan_multi_thread(const BenchmarkInput& input,
+                                           const interpolate::RemapPlan& plan,
+                                           interpolate::Isa isa) {
+  auto output_image = cv::Mat3b(input.output_size);
+  bilinear_remap_plan_multi_thread(input, plan, isa, bgr_image(output_image));
+
+  return output_image;
+}
+
+// The plan is built once, as for a video with a fixed map. Compare with the "multi thread"
+// benchmarks, which work from the coordinate map every frame.
+static void BM_bilinear_remap_plan_multi_thread(benchmark::State& state,
+                                                const BenchmarkInput& input,
+                                                interpolate::Isa isa) {
+  const auto plan = build_remap_plan(input);
+
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    bilinear_remap_plan_multi_thread(input, plan, isa);
+  }
+
+  perf_counters.stop();
+}
+
+// One off cost of building a plan, to work out how many frames it takes to pay for itself.
+static void BM_bilinear_remap_plan_build(benchmark::State& state, const BenchmarkInput& input) {
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(build_remap_plan(input));
+  }
+
+  perf_counters.stop();
+}
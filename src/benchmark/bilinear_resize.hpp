@@ -0,0 +1,158 @@
+#pragma once
+
+#include "common.hpp"
+#include "benchmark/bilinear_multi_thread.hpp"
+#include "interpolate/resize_plan.hpp"
+
+// Common resize scale factors: the whole source image down 2x and 1.5x, and the centre quarter of
+// it up 2x, so each output is at most the size of the source image.
+enum class ResizeScale { down_2x, down_1_5x, up_2x };
+
+static const char* resize_scale_name(ResizeScale scale) {
+  switch (scale) {
+    case ResizeScale::down_2x:
+      return "2x down";
+    case ResizeScale::down_1_5x:
+      return "1.5x down";
+    case ResizeScale::up_2x:
+      return "2x up";
+  }
+
+  return "";
+}
+
+interpolate::ResizePlan build_resize_plan(const BenchmarkInput& input, ResizeScale scale) {
+  const auto rows = input.source_image.rows;
+  const auto cols = input.source_image.cols;
+
+  switch (scale) {
+    case ResizeScale::down_2x:
+      return interpolate::ResizePlan(rows, cols, rows / 2, cols / 2);
+    case ResizeScale::down_1_5x:
+      return interpolate::ResizePlan(rows, cols, rows * 2 / 3, cols * 2 / 3);
+    case ResizeScale::up_2x:
+      break;
+  }
+
+  const auto crop = interpolate::Rect{cols / 4, rows / 4, cols / 2, rows / 2};
+  return interpolate::ResizePlan(rows, cols, crop, crop.height * 2, crop.width * 2);
+}
+
+// The sampling coordinates of a resize as a coordinate map, with the output size, for the
+// generic kernels.
+BenchmarkInput resize_map_input(const BenchmarkInput& input, const interpolate::ResizePlan& plan) {
+  auto map_input = input;
+  map_input.output_size = cv::Size2i(plan.cols(), plan.rows());
+  map_input.coords = cv::Mat2f(map_input.output_size);
+
+  const auto& crop = plan.crop();
+
+  for (auto y = 0; y < plan.rows(); y++) {
+    auto source_y = std::min(std::max(plan.source_y(y), 0.0f), float(crop.height - 1));
+
+    for (auto x = 0; x < plan.cols(); x++) {
+      auto source_x = std::min(std::max(plan.source_x(x), 0.0f), float(crop.width - 1));
+      map_input.coords(y, x) = {float(crop.y) + source_y, float(crop.x) + source_x};
+    }
+  }
+
+  return map_input;
+}
+
+class ResizeMultiThread : public cv::ParallelLoopBody
+{
+public:
+  ResizeMultiThread(const interpolate::BGRImage& input_image, const interpolate::ResizePlan& plan,
+                    const interpolate::BGRImage& output_image, interpolate::Isa isa)
+      : input_image_(input_image), plan_(plan), output_image_(output_image), isa_(isa) {
+    if (!plan.compatible(input_image) || plan.rows() != output_image.rows ||
+        plan.cols() != output_image.cols) {
+      throw std::runtime_error("resize plan doesn't match the input and output images");
+    }
+  }
+
+  virtual void operator()(const cv::Range& range) const override {
+    plan_.resize_rows(input_image_, output_image_, range.start, range.end, isa_);
+  }
+
+private:
+  const interpolate::BGRImage input_image_;
+  const interpolate::ResizePlan& plan_;
+  const interpolate::BGRImage output_image_;
+  const interpolate::Isa isa_;
+};
+
+// Interpolates into a caller provided output image, without allocating.
+void bilinear_resize_multi_thread(const BenchmarkInput& input, const interpolate::ResizePlan& plan,
+                                  interpolate::Isa isa,
+                                  const interpolate::BGRImage& output_image) {
+  auto parallel_executor = ResizeMultiThread(input.source_image, plan, output_image, isa);
+
+  parallel_for(cv::Range(0, output_image.rows), parallel_executor);
+}
+
+cv::Mat3b bilinear_resize_multi_thread(const BenchmarkInput& input,
+                                       const interpolate::ResizePlan& plan, interpolate::Isa isa) {
+  auto output_image = cv::Mat3b(plan.rows(), plan.cols());
+  bilinear_resize_multi_thread(input, plan, isa, bgr_image(output_image));
+
+  return output_image;
+}
+
+// cv::resize with INTER_LINEAR, of the same crop and to the same size as a plan.
+cv::Mat3b opencv_resize(const BenchmarkInput& input, const interpolate::ResizePlan& plan) {
+  const auto& crop = plan.crop();
+
+  auto output_image = cv::Mat3b();
+  cv::resize(input.source_image_mat(cv::Rect(crop.x, crop.y, crop.width, crop.height)),
+             output_image, cv::Size2i(plan.cols(), plan.rows()), 0, 0, cv::INTER_LINEAR);
+
+  return output_image;
+}
+
+// Kernel only, into a preallocated output. The plan is tiny and built once, as for a stream of
+// frames of the same size.
+static void BM_bilinear_resize_multi_thread(benchmark::State& state, const BenchmarkInput& input,
+                                            ResizeScale scale, interpolate::Isa isa) {
+  const auto plan = build_resize_plan(input, scale);
+  auto output_image = cv::Mat3b(plan.rows(), plan.cols());
+  auto output_view = bgr_image(output_image);
+
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    bilinear_resize_multi_thread(input, plan, isa, output_view);
+  }
+
+  perf_counters.stop();
+}
+
+// The same resize with the generic kernels and a coordinate map, into a preallocated output.
+static void BM_bilinear_resize_map_multi_thread(benchmark::State& state,
+                                                const BenchmarkInput& input, ResizeScale scale,
+                                                interpolate::Isa isa) {
+  const auto map_input = resize_map_input(input, build_resize_plan(input, scale));
+  auto output_image = cv::Mat3b(map_input.output_size);
+  auto output_view = bgr_image(output_image);
+
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    bilinear_multi_thread(map_input, isa, output_view);
+  }
+
+  perf_counters.stop();
+}
+
+static void BM_opencv_resize(benchmark::State& state, const BenchmarkInput& input,
+                             ResizeScale scale) {
+  const auto plan = build_resize_plan(input, scale);
+
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    opencv_resize(input, plan);
+  }
+
+  perf_counters.stop();
+}
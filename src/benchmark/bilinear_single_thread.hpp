@@ -0,0 +1,41 @@
+#pragma once
+
+#include "common.hpp"
+#include "interpolate/kernels.hpp"
+
+// Interpolates into a caller provided output image.
+void bilinear_single_thread(const BenchmarkInput& input, interpolate::Isa isa,
+                            const interpolate::BGRImage& output_image) {
+  check_output_size(output_image, input.output_size);
+
+  const auto& kernels = interpolate::kernels_for(isa);
+
+  for (auto y = 0; y < output_image.rows; y++) {
+    const auto* px_coords_row = input.coords.ptr<cv::Vec2f>(y);
+
+    kernels.bilinear_row(input.source_image,
+                         reinterpret_cast<const interpolate::InputCoords*>(px_coords_row),
+                         output_image.row(y), output_image.cols);
+  }
+}
+
+cv::Mat3b bilinear_single_thread(const BenchmarkInput& input, interpolate::Isa isa) {
+  auto output_image = cv::Mat3b(input.output_size);
+  bilinear_single_thread(input, isa, bgr_image(output_image));
+
+  return output_image;
+}
+
+static void BM_bilinear_single_thread(benchmark::State& state, const BenchmarkInput& input,
+                                      interpolate::Isa isa) {
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    bilinear_single_thread(input, isa);
+  }
+
+  perf_counters.stop();
+
+  set_throughput_counters(state,
+                          coordinate_map_traffic(input.coords, input.source_image_mat.size()));
+}
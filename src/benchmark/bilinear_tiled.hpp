@@ -0,0 +1,50 @@
+#pragma once
+
+#include "common.hpp"
+#include "interpolate/remap.hpp"
+
+// Interpolates the output in 2D tiles instead of whole rows, see the tiled interpolate::remap().
+void bilinear_tiled_multi_thread(const BenchmarkInput& input, const cv::Mat2f& coords,
+                                 interpolate::TileSize tile_size, interpolate::Isa isa,
+                                 const interpolate::BGRImage& output_image) {
+  interpolate::remap(input.source_image, coords_map(coords), output_image, tile_size, isa,
+                     thread_pool(false));
+}
+
+cv::Mat3b bilinear_tiled_multi_thread(const BenchmarkInput& input, const cv::Mat2f& coords,
+                                      interpolate::TileSize tile_size, interpolate::Isa isa) {
+  auto output_image = cv::Mat3b(coords.size());
+  bilinear_tiled_multi_thread(input, coords, tile_size, isa, bgr_image(output_image));
+
+  return output_image;
+}
+
+// Arguments: tile width, tile height, rotation angle in degrees, downscale factor in percent.
+// A tile width of 0 means the full output width, so {0, 1} is the row by row traversal.
+static void BM_bilinear_tiled_multi_thread(benchmark::State& state, const BenchmarkInput& input) {
+  auto tile_size = interpolate::TileSize{int(state.range(0)), int(state.range(1))};
+  auto angle = float(state.range(2));
+  auto scale = state.range(3) / 100.0f;
+
+  if (tile_size.width == 0) {
+    tile_size.width = input.output_size.width;
+  }
+
+  auto isa = interpolate::active_isa();
+  state.SetLabel(interpolate::isa_name(isa));
+
+  auto coords = rotated_sampling_coordinates(input.output_size, input.source_image_mat.size(),
+                                             angle, scale);
+
+  // Kernel only, so the allocation doesn't hide differences between tile sizes
+  auto output_image = cv::Mat3b(coords.size());
+  auto output_view = bgr_image(output_image);
+
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    bilinear_tiled_multi_thread(input, coords, tile_size, isa, output_view);
+  }
+
+  perf_counters.stop();
+}
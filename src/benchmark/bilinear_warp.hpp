@@ -0,0 +1,173 @@
+#pragma once
+
+#include <cmath>
+
+#include "common.hpp"
+#include "interpolate/kernels.hpp"
+
+// Warps the source image with a transform. The sampling coordinates are generated in the
+// kernels, so no coordinate map is read.
+template <typename Transform>
+class WarpMultiThread : public cv::ParallelLoopBody
+{
+public:
+  WarpMultiThread(const interpolate::BGRImage& input_image, const Transform& transform,
+                  const interpolate::BGRImage& output_image, interpolate::Isa isa)
+      : input_image_(input_image),
+        transform_(transform),
+        output_image_(output_image),
+        kernels_(interpolate::kernels_for(isa)) {}
+
+  virtual void operator()(const cv::Range& range) const override {
+    for (auto y = range.start; y < range.end; y++) {
+      auto* output_pixels_row = output_image_.row(y);
+
+      if constexpr (std::is_same_v<Transform, interpolate::AffineTransform>) {
+        kernels_.bilinear_affine_row(input_image_, transform_, 0, y, output_pixels_row,
+                                     output_image_.cols);
+      } else {
+        kernels_.bilinear_perspective_row(input_image_, transform_, 0, y, output_pixels_row,
+                                          output_image_.cols);
+      }
+    }
+  }
+
+private:
+  const interpolate::BGRImage input_image_;
+  const Transform transform_;
+  const interpolate::BGRImage output_image_;
+  const interpolate::Kernels& kernels_;
+};
+
+// Warps into a caller provided output image, without allocating.
+template <typename Transform>
+void bilinear_warp_multi_thread(const BenchmarkInput& input, const Transform& transform,
+                                interpolate::Isa isa, const interpolate::BGRImage& output_image) {
+  auto parallel_executor =
+      WarpMultiThread<Transform>(input.source_image, transform, output_image, isa);
+
+  parallel_for(cv::Range(0, output_image.rows), parallel_executor);
+}
+
+template <typename Transform>
+cv::Mat3b bilinear_warp_multi_thread(const BenchmarkInput& input, const Transform& transform,
+                                     interpolate::Isa isa) {
+  auto output_image = cv::Mat3b(input.output_size);
+  bilinear_warp_multi_thread(input, transform, isa, bgr_image(output_image));
+
+  return output_image;
+}
+
+// Source coordinates of output pixel (x, y) under a transform, in double precision.
+cv::Vec2f transform_point(const interpolate::AffineTransform& transform, int x, int y) {
+  const auto& m = transform.m;
+
+  return {float(double(m[1][0]) * x + double(m[1][1]) * y + m[1][2]),
+          float(double(m[0][0]) * x + double(m[0][1]) * y + m[0][2])};
+}
+
+cv::Vec2f transform_point(const interpolate::PerspectiveTransform& transform, int x, int y) {
+  const auto& m = transform.m;
+  const auto w = double(m[2][0]) * x + double(m[2][1]) * y + m[2][2];
+
+  return {float((double(m[1][0]) * x + double(m[1][1]) * y + m[1][2]) / w),
+          float((double(m[0][0]) * x + double(m[0][1]) * y + m[0][2]) / w)};
+}
+
+// The coordinates a transform generates for every output pixel as a map, clamped to the source
+// image as the warp kernels clamp them unless `clamp` is false. With the map kernels, the map
+// gives the gold standard of a warp.
+template <typename Transform>
+cv::Mat2f transform_coordinates(const Transform& transform, cv::Size2i output_size,
+                                cv::Size2i input_size, bool clamp = true) {
+  auto coords = cv::Mat2f(output_size);
+  auto max_x = float(input_size.width - 1);
+  auto max_y = float(input_size.height - 1);
+
+  for (auto y = 0; y < output_size.height; y++) {
+    for (auto x = 0; x < output_size.width; x++) {
+      auto point = transform_point(transform, x, y);
+
+      if (clamp) {
+        point = {std::clamp(point[0], 0.0f, max_y), std::clamp(point[1], 0.0f, max_x)};
+      }
+
+      coords(y, x) = point;
+    }
+  }
+
+  return coords;
+}
+
+// The input with its map replaced by the coordinates of a transform.
+template <typename Transform>
+BenchmarkInput transform_map_input(const BenchmarkInput& input, const Transform& transform) {
+  auto map_input = input;
+  map_input.coords =
+      transform_coordinates(transform, input.output_size, input.source_image_mat.size());
+
+  return map_input;
+}
+
+// Largest difference between the coordinates of the affine transform from sampling_transform()
+// and the map from sampling_coordinates() it replaces. Only output pixels whose coordinates
+// warpAffine() interpolated from inside the grid of the map are compared: the rest are blended
+// with its zero border, and the first pixel is overwritten.
+float sampling_transform_error(const BenchmarkInput& input) {
+  auto input_size = input.source_image_mat.size();
+  auto coords = transform_coordinates(input.affine_transform, input.output_size, input_size,
+                                      false);
+
+  // The grid of the map before warpAffine() covers these coordinates
+  auto max_x = float(input.output_size.width - 1) * input_size.width / input.output_size.width;
+  auto max_y =
+      float(input.output_size.height - 1) * input_size.height / input.output_size.height;
+  auto max_error = 0.0f;
+
+  for (auto y = 0; y < coords.rows; y++) {
+    for (auto x = 0; x < coords.cols; x++) {
+      const auto& c = coords(y, x);
+
+      if ((x == 0 && y == 0) || c[0] < 0.0f || c[1] < 0.0f || c[0] > max_y || c[1] > max_x) {
+        continue;
+      }
+
+      const auto& expected = input.coords(y, x);
+      max_error = std::max({max_error, std::abs(c[0] - expected[0]),
+                            std::abs(c[1] - expected[1])});
+    }
+  }
+
+  return max_error;
+}
+
+cv::Mat3b bilinear_affine_multi_thread(const BenchmarkInput& input, interpolate::Isa isa) {
+  return bilinear_warp_multi_thread(input, input.affine_transform, isa);
+}
+
+cv::Mat3b bilinear_perspective_multi_thread(const BenchmarkInput& input, interpolate::Isa isa) {
+  return bilinear_warp_multi_thread(input, input.perspective_transform, isa);
+}
+
+static void BM_bilinear_affine_multi_thread(benchmark::State& state, const BenchmarkInput& input,
+                                            interpolate::Isa isa) {
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    bilinear_affine_multi_thread(input, isa);
+  }
+
+  perf_counters.stop();
+}
+
+static void BM_bilinear_perspective_multi_thread(benchmark::State& state,
+                                                 const BenchmarkInput& input,
+                                                 interpolate::Isa isa) {
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    bilinear_perspective_multi_thread(input, isa);
+  }
+
+  perf_counters.stop();
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "common.hpp"
+#include "interpolate/remap.hpp"
+#include "interpolate/yuv.hpp"
+
+// Which copy of the source frame a YUV warp reads.
+enum class YuvSource { nv12, i420 };
+
+// Warps the NV12 or I420 copy of the source image plane by plane into an NV12 frame, in a
+// nv12_mat().
+cv::Mat1b bilinear_nv12_multi_thread(const BenchmarkInput& input,
+                                     const interpolate::LumaCoords& coords, interpolate::Isa isa,
+                                     YuvSource source = YuvSource::nv12) {
+  auto output_image = nv12_mat(input.output_size);
+  auto output = nv12_image(output_image, input.output_size);
+
+  if (source == YuvSource::nv12) {
+    interpolate::remap(input.source_image_nv12, coords, output, isa, thread_pool(false));
+  } else {
+    interpolate::remap(input.source_image_i420, coords, output, isa, thread_pool(false));
+  }
+
+  return output_image;
+}
+
+cv::Mat1b bilinear_nv12_multi_thread(const BenchmarkInput& input, interpolate::Isa isa,
+                                     YuvSource source = YuvSource::nv12) {
+  return bilinear_nv12_multi_thread(input, coords_map(input.coords), isa, source);
+}
+
+// As above, with the conversion to BGR fused into the warp.
+cv::Mat3b bilinear_nv12_to_bgr_multi_thread(const BenchmarkInput& input, interpolate::Isa isa,
+                                            YuvSource source = YuvSource::nv12) {
+  auto output_image = cv::Mat3b(input.output_size);
+  auto output = bgr_image(output_image);
+
+  if (source == YuvSource::nv12) {
+    interpolate::remap(input.source_image_nv12, coords_map(input.coords), output, isa,
+                       thread_pool(false));
+  } else {
+    interpolate::remap(input.source_image_i420, coords_map(input.coords), output, isa,
+                       thread_pool(false));
+  }
+
+  return output_image;
+}
+
+// What a pipeline without the YUV warp does each frame: convert the whole NV12 source frame to
+// BGR with cv::cvtColor(), then warp it with the 24bpp kernels.
+cv::Mat3b bilinear_convert_then_warp(const BenchmarkInput& input, interpolate::Isa isa) {
+  auto source_bgr = cv::Mat3b();
+  cv::cvtColor(input.source_image_nv12_mat, source_bgr, cv::COLOR_YUV2BGR_NV12);
+
+  auto output_image = cv::Mat3b(input.output_size);
+  interpolate::remap(bgr_image(source_bgr), coords_map(input.coords), bgr_image(output_image),
+                     isa, thread_pool(false));
+
+  return output_image;
+}
+
+// An NV12 frame of `size` converted to BGR with the library's conversion.
+cv::Mat3b bgr_from_nv12(const cv::Mat1b& nv12, cv::Size2i size) {
+  auto bgr = cv::Mat3b(size);
+  interpolate::convert(nv12_image(nv12, size), bgr_image(bgr));
+
+  return bgr;
+}
+
+// How a YUV benchmark warps a frame.
+enum class YuvWarp { nv12, nv12_to_bgr, convert_then_warp };
+
+// Allocates the output image every frame, like BM_bilinear_multi_thread(). The byte rates count
+// 1.5 bytes per NV12 source and output pixel, and 3 per BGR output pixel.
+static void BM_bilinear_yuv(benchmark::State& state, const BenchmarkInput& input,
+                            interpolate::Isa isa, YuvWarp warp) {
+  auto perf_counters = PerfCounters(state);
+
+  for (auto _ : state) {
+    switch (warp) {
+      case YuvWarp::nv12:
+        bilinear_nv12_multi_thread(input, isa);
+        break;
+      case YuvWarp::nv12_to_bgr:
+        bilinear_nv12_to_bgr_multi_thread(input, isa);
+        break;
+      case YuvWarp::convert_then_warp:
+        bilinear_convert_then_warp(input, isa);
+        break;
+    }
+  }
+
+  perf_counters.stop();
+
+  auto traffic = coordinate_map_traffic(input.coords, input.source_image_mat.size(), 1);
+  traffic.source_bytes = traffic.source_bytes * 3 / 2;
+  traffic.output_bytes = (warp == YuvWarp::nv12) ? traffic.output_bytes * 3 / 2
+                                                  : traffic.output_bytes * 3;
+
+  set_throughput_counters(state, traffic);
+}
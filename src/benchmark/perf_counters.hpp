@@ -0,0 +1,338 @@
+#pragma once
+
+#include <algorithm>
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "benchmark/benchmark.h"
+#include "interpolate/thread_pool.hpp"
+
+// Whether the benchmarks read hardware performance counters, set by --perf_counters.
+static bool& perf_counters_enabled() {
+  static auto enabled = false;
+  return enabled;
+}
+
+// Hardware performance counters while a benchmark runs, with perf_event_open. Construct it right
+// before the benchmark loop and call stop() right after it.
+//
+// Reports the counts per frame as user counters: cycles, instructions, l1d_misses, llc_misses,
+// dtlb_misses and ipc. These are summed over the threads of the process that exist at
+// construction, so they include OpenCV's threads and the library's workers, and the time idle
+// workers spin waiting for the next frame. set_throughput_counters() adds cycles_per_pixel and
+// bytes_per_cycle.
+//
+// Each thread of `pool` (the benchmarks' pool by default) also counts its own cycles and
+// instructions, opened on the thread itself and only enabled while it works on a parallel_for(),
+// so idle spinning is left out. They are reported as worker_cycles_max, worker_cycles_min,
+// worker_instructions_max and worker_instructions_min, the busiest and least busy threads, to
+// show how evenly a frame is spread. Threads of other pools, eg the pinned pool, are only in the
+// totals. Thread 0 is counted on the thread that creates the PerfCounters, the caller of
+// parallel_for(), so with AsyncRemap, whose dispatch thread calls it, its counts are misplaced.
+//
+// Events the CPU or kernel doesn't support are left out. Does nothing unless
+// perf_counters_enabled(), or on other platforms than Linux.
+class PerfCounters : public interpolate::ThreadPool::JobObserver
+{
+public:
+  explicit PerfCounters(benchmark::State& state,
+                        interpolate::ThreadPool& pool = interpolate::default_thread_pool())
+      : state_(state), pool_(pool) {
+#ifdef __linux__
+    if (perf_counters_enabled()) {
+      open();
+      open_workers();
+      control(PERF_EVENT_IOC_RESET);
+      control(PERF_EVENT_IOC_ENABLE);
+    }
+#endif
+  }
+
+  ~PerfCounters() { close_all(); }
+
+  PerfCounters(const PerfCounters&) = delete;
+  PerfCounters& operator=(const PerfCounters&) = delete;
+
+  // Stop counting and set the user counters.
+  void stop() {
+#ifdef __linux__
+    if (events_.empty() && workers_.empty()) {
+      return;
+    }
+
+    control(PERF_EVENT_IOC_DISABLE);
+
+    if (observing_) {
+      pool_.set_job_observer(nullptr);
+      observing_ = false;
+    }
+
+    for (const auto& event : events_) {
+      auto count = read_count(event);
+
+      if (count >= 0.0) {
+        state_.counters[event.name] =
+            benchmark::Counter(count, benchmark::Counter::kAvgIterations);
+      }
+    }
+
+    set_worker_counters();
+
+    auto cycles = state_.counters.find("cycles");
+    auto instructions = state_.counters.find("instructions");
+
+    if (cycles != state_.counters.end() && instructions != state_.counters.end() &&
+        cycles->second.value > 0.0) {
+      state_.counters["ipc"] = instructions->second.value / cycles->second.value;
+    }
+
+    close_all();
+#endif
+  }
+
+  void job_started(int thread) override {
+#ifdef __linux__
+    worker_control(thread, PERF_EVENT_IOC_ENABLE);
+#endif
+  }
+
+  void job_finished(int thread) override {
+#ifdef __linux__
+    worker_control(thread, PERF_EVENT_IOC_DISABLE);
+#endif
+  }
+
+private:
+#ifdef __linux__
+  // Cycles and instructions of a thread of the pool, as a group so one ioctl controls both
+  struct WorkerEvents {
+    int cycles = -1;
+    int instructions = -1;
+  };
+
+  struct Event {
+    const char* name;
+    uint32_t type;
+    uint64_t config;
+    std::vector<int> fds;    // one per thread
+  };
+
+  static constexpr uint64_t cache_miss(uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  }
+
+  // Threads of this process
+  static std::vector<int> threads() {
+    auto tids = std::vector<int>();
+    auto* dir = opendir("/proc/self/task");
+
+    if (dir == nullptr) {
+      return tids;
+    }
+
+    while (auto* entry = readdir(dir)) {
+      if (entry->d_name[0] != '.') {
+        tids.push_back(std::stoi(entry->d_name));
+      }
+    }
+
+    closedir(dir);
+    return tids;
+  }
+
+  // Counter of an event on thread `tid`, or the calling thread for 0, in the group of
+  // `group_fd` unless it's -1.
+  static int open_event(uint32_t type, uint64_t config, int tid, int group_fd = -1) {
+    auto attr = perf_event_attr();
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return int(syscall(SYS_perf_event_open, &attr, tid, -1, group_fd, 0));
+  }
+
+  // Open the counters of each thread of the pool on the thread itself, and start observing its
+  // jobs to enable them.
+  void open_workers() {
+    workers_.assign(pool_.threads(), WorkerEvents());
+
+    pool_.for_each_thread([&](int thread) {
+      auto& worker = workers_[thread];
+      worker.cycles = open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, 0);
+
+      if (worker.cycles >= 0) {
+        worker.instructions =
+            open_event(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, 0, worker.cycles);
+      }
+    });
+
+    pool_.set_job_observer(this);
+    observing_ = true;
+  }
+
+  void worker_control(int thread, unsigned long request) {
+    if (workers_[thread].cycles >= 0) {
+      ioctl(workers_[thread].cycles, request, PERF_IOC_FLAG_GROUP);
+    }
+  }
+
+  // Busiest and least busy threads of the pool
+  void set_worker_counters() {
+    auto counts = std::vector<double>();
+    const auto set_spread = [&](const char* max_name, const char* min_name) {
+      if (!counts.empty()) {
+        state_.counters[max_name] = benchmark::Counter(
+            *std::max_element(counts.begin(), counts.end()), benchmark::Counter::kAvgIterations);
+        state_.counters[min_name] = benchmark::Counter(
+            *std::min_element(counts.begin(), counts.end()), benchmark::Counter::kAvgIterations);
+      }
+    };
+
+    for (const auto& worker : workers_) {
+      auto count = read_count(worker.cycles);
+
+      if (count >= 0.0) {
+        counts.push_back(count);
+      }
+    }
+
+    set_spread("worker_cycles_max", "worker_cycles_min");
+    counts.clear();
+
+    for (const auto& worker : workers_) {
+      auto count = read_count(worker.instructions);
+
+      if (count >= 0.0) {
+        counts.push_back(count);
+      }
+    }
+
+    set_spread("worker_instructions_max", "worker_instructions_min");
+  }
+
+  void open() {
+    auto all_events = std::vector<Event>{
+        {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, {}},
+        {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, {}},
+        {"l1d_misses", PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_L1D), {}},
+        {"llc_misses", PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_LL), {}},
+        {"dtlb_misses", PERF_TYPE_HW_CACHE, cache_miss(PERF_COUNT_HW_CACHE_DTLB), {}},
+    };
+
+    const auto tids = threads();
+
+    for (auto& event : all_events) {
+      for (auto tid : tids) {
+        auto fd = open_event(event.type, event.config, tid);
+
+        // Threads can exit between listing and opening, but an event that fails for the first
+        // thread isn't supported at all
+        if (fd >= 0) {
+          event.fds.push_back(fd);
+        } else if (event.fds.empty()) {
+          break;
+        }
+      }
+
+      if (!event.fds.empty()) {
+        events_.push_back(std::move(event));
+      }
+    }
+
+    if (events_.empty()) {
+      static auto warned = false;
+
+      if (!warned) {
+        fprintf(stderr, "perf_event_open failed, no hardware performance counters\n");
+        warned = true;
+      }
+    }
+  }
+
+  void control(unsigned long request) {
+    for (const auto& event : events_) {
+      for (auto fd : event.fds) {
+        ioctl(fd, request, 0);
+      }
+    }
+  }
+
+  // Count of a counter, scaled up for the time the kernel multiplexed it off the PMU, or -1 if it
+  // never ran.
+  static double read_count(int fd) {
+    uint64_t values[3];    // value, time enabled, time running
+
+    if (fd < 0 || read(fd, values, sizeof(values)) != ssize_t(sizeof(values)) || values[2] == 0) {
+      return -1.0;
+    }
+
+    return double(values[0]) * double(values[1]) / double(values[2]);
+  }
+
+  // Sum of an event over the threads, or -1 if it never ran.
+  static double read_count(const Event& event) {
+    auto total = 0.0;
+    auto ran = false;
+
+    for (auto fd : event.fds) {
+      auto count = read_count(fd);
+
+      if (count >= 0.0) {
+        total += count;
+        ran = true;
+      }
+    }
+
+    return ran ? total : -1.0;
+  }
+#endif
+
+  void close_all() {
+#ifdef __linux__
+    if (observing_) {
+      pool_.set_job_observer(nullptr);
+      observing_ = false;
+    }
+
+    for (auto& event : events_) {
+      for (auto fd : event.fds) {
+        close(fd);
+      }
+    }
+
+    for (const auto& worker : workers_) {
+      for (auto fd : {worker.instructions, worker.cycles}) {
+        if (fd >= 0) {
+          close(fd);
+        }
+      }
+    }
+
+    events_.clear();
+    workers_.clear();
+#endif
+  }
+
+  benchmark::State& state_;
+  interpolate::ThreadPool& pool_;
+
+#ifdef __linux__
+  std::vector<Event> events_;
+  std::vector<WorkerEvents> workers_;
+  bool observing_ = false;
+#endif
+};
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 
 #include <opencv2/core.hpp>
@@ -7,29 +9,191 @@
 #include <opencv2/highgui/highgui.hpp>
 
 #include "benchmark/benchmark.h"
+#include "benchmark/perf_counters.hpp"
 
+#include "interpolate/compact_maps.hpp"
+#include "interpolate/thread_pool.hpp"
 #include "interpolate/types.hpp"
+#include "interpolate/yuv.hpp"
 
 struct BenchmarkInput {
   cv::Mat3b source_image_mat;
   interpolate::BGRImage source_image;
   cv::Mat2f coords;
   cv::Size2i output_size;
+
+  // The source image as 32bpp BGRA, for the 32bpp kernels.
+  cv::Mat4b source_image_bgra_mat;
+  interpolate::BGRAImage source_image_bgra;
+
+  // The source image as 8 bit grayscale, for the single channel kernels.
+  cv::Mat1b source_image_gray_mat;
+  interpolate::GrayImage source_image_gray;
+
+  // The source image with 16 bit channels, scaled to 0-65535, and float channels, scaled to 0-1.
+  cv::Mat3w source_image_16_mat;
+  interpolate::BGR16Image source_image_16;
+  cv::Mat3f source_image_float_mat;
+  interpolate::BGRFloatImage source_image_float;
+
+  // The source image as an I420 frame from cv::cvtColor(), and the same frame as NV12, for the
+  // YUV warps.
+  cv::Mat1b source_image_i420_mat;
+  interpolate::I420Image source_image_i420;
+  cv::Mat1b source_image_nv12_mat;
+  interpolate::NV12Image source_image_nv12;
+
+  // Coordinates that sample outside the source image too, for the border modes.
+  cv::Mat2f outside_coords;
+
+  // Transforms for the warp modes, which generate the coordinates in the kernels.
+  interpolate::AffineTransform affine_transform;
+  interpolate::PerspectiveTransform perspective_transform;
+
+  // coords converted to the compact map formats.
+  cv::Mat2s fixed_point_coords;
+  cv::Mat1w fixed_point_fractions;
+  cv::Mat2w half_float_offsets;
 };
 
-static cv::Mat2f sampling_coordinates(cv::Size2i output_size, cv::Size2i input_size) {
-  auto coords = cv::Mat2f(output_size);
+// View of a cv::Mat3b for the kernels, as an input or output image. Doesn't own the pixels.
+static interpolate::BGRImage bgr_image(const cv::Mat3b& mat) {
+  return interpolate::BGRImage(mat.rows, mat.cols, int(mat.step),
+                               reinterpret_cast<interpolate::BGRPixel*>(mat.data));
+}
 
-  for (auto y = 0; y < output_size.height; y++) {
-    for (auto x = 0; x < output_size.width; x++) {
-      auto x_sample = (float(x) / float(output_size.width)) * input_size.width;
-      auto y_sample = float(y) / float(output_size.height) * input_size.height;
+// View of a cv::Mat4b for the 32bpp kernels. Doesn't own the pixels.
+static interpolate::BGRAImage bgra_image(const cv::Mat4b& mat) {
+  return interpolate::BGRAImage(mat.rows, mat.cols, int(mat.step),
+                                reinterpret_cast<interpolate::BGRAPixel*>(mat.data));
+}
 
-      coords(y, x) = {y_sample, x_sample};
+// View of a cv::Mat1b for the single channel kernels. Doesn't own the pixels.
+static interpolate::GrayImage gray_image(const cv::Mat1b& mat) {
+  return interpolate::GrayImage(mat.rows, mat.cols, int(mat.step), mat.data);
+}
+
+// Views of a cv::Mat3w and a cv::Mat3f for the 16 bit and float kernels. Don't own the pixels.
+static interpolate::BGR16Image bgr16_image(const cv::Mat3w& mat) {
+  return interpolate::BGR16Image(mat.rows, mat.cols, int(mat.step),
+                                 reinterpret_cast<interpolate::BGR16Pixel*>(mat.data));
+}
+
+static interpolate::BGRFloatImage bgr_float_image(const cv::Mat3f& mat) {
+  return interpolate::BGRFloatImage(mat.rows, mat.cols, int(mat.step),
+                                    reinterpret_cast<interpolate::BGRFloatPixel*>(mat.data));
+}
+
+// Size of the chroma planes of a 4:2:0 frame of `size`.
+static cv::Size2i chroma_plane_size(cv::Size2i size) {
+  return cv::Size2i((size.width + 1) / 2, (size.height + 1) / 2);
+}
+
+// Views of the planes of an I420 frame of `size` in a continuous cv::Mat1b, as written by
+// cv::cvtColor(): the luma plane, then the U plane and the V plane. Don't own the pixels.
+static interpolate::I420Image i420_image(const cv::Mat1b& mat, cv::Size2i size) {
+  auto chroma = chroma_plane_size(size);
+  auto* luma = mat.data;
+  auto* u = luma + size.area();
+  auto* v = u + chroma.area();
+
+  return {interpolate::GrayImage(size.height, size.width, size.width, luma),
+          interpolate::GrayImage(chroma.height, chroma.width, chroma.width, u),
+          interpolate::GrayImage(chroma.height, chroma.width, chroma.width, v)};
+}
+
+// A cv::Mat1b for an NV12 frame of `size`: the luma rows, then the interleaved chroma rows, with
+// the same step. For even sizes, the layout cv::cvtColor() reads. Zeroed, so the padding byte of
+// the luma rows of odd widths compares equal.
+static cv::Mat1b nv12_mat(cv::Size2i size) {
+  auto chroma = chroma_plane_size(size);
+
+  return cv::Mat1b(cv::Size2i(chroma.width * 2, size.height + chroma.height), uint8_t(0));
+}
+
+// Views of the planes of an NV12 frame of `size` in a nv12_mat(). Don't own the pixels.
+static interpolate::NV12Image nv12_image(const cv::Mat1b& mat, cv::Size2i size) {
+  auto chroma = chroma_plane_size(size);
+  auto* luma = mat.data;
+  auto* uv = reinterpret_cast<interpolate::UVPixel*>(luma + size.height * mat.step);
+
+  return {interpolate::GrayImage(size.height, size.width, int(mat.step), luma),
+          interpolate::UVImage(chroma.height, chroma.width, int(mat.step), uv)};
+}
+
+// NV12 copy of an I420 frame of `size`, with the U and V planes interleaved.
+static cv::Mat1b nv12_from_i420(const cv::Mat1b& i420, cv::Size2i size) {
+  auto nv12 = nv12_mat(size);
+  auto planes = i420_image(i420, size);
+  auto frame = nv12_image(nv12, size);
+
+  for (auto y = 0; y < frame.y.rows; y++) {
+    memcpy(frame.y.row(y), planes.y.ptr(y, 0), size.width);
+  }
+
+  for (auto y = 0; y < frame.uv.rows; y++) {
+    for (auto x = 0; x < frame.uv.cols; x++) {
+      frame.uv.row(y)[x] = {*planes.u.ptr(y, x), *planes.v.ptr(y, x)};
     }
   }
 
-  // Rotate a bit
+  return nv12;
+}
+
+// cv::Mat3b view of an image, eg to compare a buffer pool image. Doesn't own the pixels.
+static cv::Mat3b mat_view(const interpolate::BGRImage& image) {
+  return cv::Mat3b(image.rows, image.cols, reinterpret_cast<cv::Vec3b*>(image.data), image.step);
+}
+
+// View of a coordinate map for the kernels. Doesn't own the coordinates.
+static interpolate::CoordsMap coords_map(const cv::Mat2f& coords) {
+  return interpolate::CoordsMap(coords.rows, coords.cols, int(coords.step),
+                                reinterpret_cast<const interpolate::InputCoords*>(coords.data));
+}
+
+// Throws if a caller provided output image is not the size of the coordinate map.
+template <typename Pixel>
+static void check_output_size(const interpolate::Image<Pixel>& output_image, cv::Size2i size) {
+  if (output_image.rows != size.height || output_image.cols != size.width) {
+    throw std::runtime_error("output image must be the same size as the output frame");
+  }
+}
+
+// How the multi thread benchmarks spread rows over threads.
+enum class Executor { thread_pool, pinned_thread_pool, opencv };
+
+static interpolate::ThreadPool& thread_pool(bool pinned) {
+  if (pinned) {
+    static auto pinned_pool = [] {
+      auto options = interpolate::ThreadPool::Options();
+      options.pin_threads = true;
+      return interpolate::ThreadPool(options);
+    }();
+
+    return pinned_pool;
+  }
+
+  // The library's pool, so the benchmarks and interpolate::remap() don't compete with two sets of
+  // spinning workers
+  return interpolate::default_thread_pool();
+}
+
+// Replacement for cv::parallel_for_ using our own thread pool by default.
+static void parallel_for(const cv::Range& range, const cv::ParallelLoopBody& body,
+                         Executor executor = Executor::thread_pool) {
+  if (executor == Executor::opencv) {
+    cv::parallel_for_(range, body);
+    return;
+  }
+
+  thread_pool(executor == Executor::pinned_thread_pool)
+      .parallel_for(range.end - range.start, 0, [&](int begin, int end) {
+        body(cv::Range(range.start + begin, range.start + end));
+      });
+}
+
+// Rotate a bit
+static cv::Mat1f rotation_warp(cv::Size2i output_size) {
   auto angle = 3.14f / 10.0f;
   auto warp = cv::Mat1f(2, 3);
   warp(0, 0) = cos(angle);
@@ -39,7 +203,22 @@ static cv::Mat2f sampling_coordinates(cv::Size2i output_size, cv::Size2i input_s
   warp(1, 1) = cos(angle);
   warp(1, 2) = -output_size.height / 2.0f;
 
-  cv::warpAffine(coords, coords, warp, coords.size());
+  return warp;
+}
+
+static cv::Mat2f sampling_coordinates(cv::Size2i output_size, cv::Size2i input_size) {
+  auto coords = cv::Mat2f(output_size);
+
+  for (auto y = 0; y < output_size.height; y++) {
+    for (auto x = 0; x < output_size.width; x++) {
+      auto x_sample = (float(x) / float(output_size.width)) * input_size.width;
+      auto y_sample = float(y) / float(output_size.height) * input_size.height;
+
+      coords(y, x) = {y_sample, x_sample};
+    }
+  }
+
+  cv::warpAffine(coords, coords, rotation_warp(output_size), coords.size());
 
   // This sampling coordinate will be clamped when fetching the pixel data for the next row, which
   // is out of bounds.
@@ -48,7 +227,214 @@ static cv::Mat2f sampling_coordinates(cv::Size2i output_size, cv::Size2i input_s
   return coords;
 }
 
-bool mats_equivalent(const cv::Mat3b& a, const cv::Mat3b& b) {
+// Sampling coordinates rotated by `angle` degrees about the centre of the image and scaled down by
+// `scale`, for measuring how the access pattern in the source image affects performance.
+// Coordinates are clamped to the input image, unless `clamp` is false.
+static cv::Mat2f rotated_sampling_coordinates(cv::Size2i output_size, cv::Size2i input_size,
+                                              float angle, float scale, bool clamp = true) {
+  auto coords = cv::Mat2f(output_size);
+
+  auto radians = angle * 3.14159265f / 180.0f;
+  auto cos_scaled = cos(radians) * scale;
+  auto sin_scaled = sin(radians) * scale;
+
+  auto max_x = float(input_size.width - 1);
+  auto max_y = float(input_size.height - 1);
+
+  for (auto y = 0; y < output_size.height; y++) {
+    for (auto x = 0; x < output_size.width; x++) {
+      auto dx = x - output_size.width / 2.0f;
+      auto dy = y - output_size.height / 2.0f;
+
+      auto x_sample = input_size.width / 2.0f + cos_scaled * dx - sin_scaled * dy;
+      auto y_sample = input_size.height / 2.0f + sin_scaled * dx + cos_scaled * dy;
+
+      if (clamp) {
+        coords(y, x) = {std::clamp(y_sample, 0.0f, max_y), std::clamp(x_sample, 0.0f, max_x)};
+      } else {
+        coords(y, x) = {y_sample, x_sample};
+      }
+    }
+  }
+
+  return coords;
+}
+
+// Sampling coordinates of the whole input image and a margin around it of an eighth of its size
+// on each side, rotated a little, for the border modes.
+static cv::Mat2f outside_sampling_coordinates(cv::Size2i output_size, cv::Size2i input_size) {
+  auto scale = std::max(float(input_size.width) / float(output_size.width),
+                        float(input_size.height) / float(output_size.height));
+
+  return rotated_sampling_coordinates(output_size, input_size, 10.0f, 1.25f * scale, false);
+}
+
+// Sampling coordinates that undo barrel distortion, like the map from
+// cv::initUndistortRectifyMap() for a wide angle lens: the source pixel of each output pixel is
+// pulled towards the centre of the image, by `max_offset` pixels at the corners.
+static cv::Mat2f undistortion_coordinates(cv::Size2i size, float max_offset) {
+  auto coords = cv::Mat2f(size);
+
+  auto centre_x = (size.width - 1) / 2.0f;
+  auto centre_y = (size.height - 1) / 2.0f;
+  auto radius = std::sqrt(centre_x * centre_x + centre_y * centre_y);
+
+  for (auto y = 0; y < size.height; y++) {
+    for (auto x = 0; x < size.width; x++) {
+      auto dx = x - centre_x;
+      auto dy = y - centre_y;
+
+      // Offset grows with the cube of the distance from the centre
+      auto r = std::sqrt(dx * dx + dy * dy) / radius;
+      auto scale = 1.0f - max_offset / radius * r * r;
+
+      coords(y, x) = {centre_y + dy * scale, centre_x + dx * scale};
+    }
+  }
+
+  return coords;
+}
+
+// The same scale and rotation as sampling_coordinates() as an affine transform. warpAffine maps
+// each output pixel through the inverse of the rotation, then the scale maps it to the input.
+static interpolate::AffineTransform sampling_transform(cv::Size2i output_size,
+                                                       cv::Size2i input_size) {
+  auto warp = rotation_warp(output_size);
+
+  // Invert the rotation
+  auto det = warp(0, 0) * warp(1, 1) - warp(0, 1) * warp(1, 0);
+  auto a = warp(1, 1) / det;
+  auto b = -warp(0, 1) / det;
+  auto c = -warp(1, 0) / det;
+  auto d = warp(0, 0) / det;
+  auto tx = -(a * warp(0, 2) + b * warp(1, 2));
+  auto ty = -(c * warp(0, 2) + d * warp(1, 2));
+
+  auto scale_x = float(input_size.width) / float(output_size.width);
+  auto scale_y = float(input_size.height) / float(output_size.height);
+
+  auto transform = interpolate::AffineTransform();
+  transform.m[0][0] = a * scale_x;
+  transform.m[0][1] = b * scale_x;
+  transform.m[0][2] = tx * scale_x;
+  transform.m[1][0] = c * scale_y;
+  transform.m[1][1] = d * scale_y;
+  transform.m[1][2] = ty * scale_y;
+
+  return transform;
+}
+
+// sampling_transform() with a slight tilt.
+static interpolate::PerspectiveTransform sampling_perspective_transform(cv::Size2i output_size,
+                                                                        cv::Size2i input_size) {
+  auto affine = sampling_transform(output_size, input_size);
+
+  auto transform = interpolate::PerspectiveTransform();
+  for (auto row = 0; row < 2; row++) {
+    for (auto col = 0; col < 3; col++) {
+      transform.m[row][col] = affine.m[row][col];
+    }
+  }
+
+  transform.m[2][0] = 0.0001f;
+  transform.m[2][1] = -0.0002f;
+  transform.m[2][2] = 1.0f;
+
+  return transform;
+}
+
+// Convert input.coords to the compact map formats.
+static void convert_compact_maps(BenchmarkInput& input) {
+  input.fixed_point_coords = cv::Mat2s(input.coords.size());
+  input.fixed_point_fractions = cv::Mat1w(input.coords.size());
+  input.half_float_offsets = cv::Mat2w(input.coords.size());
+
+  for (auto y = 0; y < input.coords.rows; y++) {
+    const auto* coords_row =
+        reinterpret_cast<const interpolate::InputCoords*>(input.coords.ptr<cv::Vec2f>(y));
+    auto* fixed_point_row = reinterpret_cast<interpolate::FixedPointCoords*>(
+        input.fixed_point_coords.ptr<cv::Vec2s>(y));
+    auto* half_float_row = reinterpret_cast<interpolate::HalfFloatOffsets*>(
+        input.half_float_offsets.ptr<cv::Vec2w>(y));
+
+    interpolate::convert_to_fixed_point(coords_row, fixed_point_row,
+                                        input.fixed_point_fractions.ptr<uint16_t>(y),
+                                        input.coords.cols);
+    interpolate::convert_to_half_float_offsets(coords_row, 0, y, half_float_row,
+                                               input.coords.cols);
+  }
+}
+
+// Bytes of the distinct source pixels a coordinate map samples: the 2x2 neighbourhood of each
+// coordinate, clamped to the image. The least source traffic a frame needs, whatever the order
+// the pixels are fetched in.
+static int64_t source_footprint_bytes(const cv::Mat2f& coords, cv::Size2i input_size,
+                                      int64_t pixel_bytes = sizeof(interpolate::BGRPixel)) {
+  auto sampled = cv::Mat1b(input_size, uint8_t(0));
+
+  for (auto y = 0; y < coords.rows; y++) {
+    for (auto x = 0; x < coords.cols; x++) {
+      auto sample_x = std::clamp(int(coords(y, x)[1]), 0, input_size.width - 1);
+      auto sample_y = std::clamp(int(coords(y, x)[0]), 0, input_size.height - 1);
+      auto right = std::min(sample_x + 1, input_size.width - 1);
+      auto below = std::min(sample_y + 1, input_size.height - 1);
+
+      sampled(sample_y, sample_x) = sampled(sample_y, right) = 1;
+      sampled(below, sample_x) = sampled(below, right) = 1;
+    }
+  }
+
+  return int64_t(cv::countNonZero(sampled)) * pixel_bytes;
+}
+
+// Memory traffic of one frame.
+struct FrameTraffic {
+  int64_t output_pixels;
+  int64_t source_bytes;
+  int64_t map_bytes;
+  int64_t output_bytes;
+};
+
+// Traffic of a frame interpolated from a float coordinate map, with source and output pixels of
+// `pixel_bytes`.
+static FrameTraffic coordinate_map_traffic(const cv::Mat2f& coords, cv::Size2i input_size,
+                                           int64_t pixel_bytes = sizeof(interpolate::BGRPixel)) {
+  auto output_pixels = int64_t(coords.rows) * coords.cols;
+
+  return {output_pixels, source_footprint_bytes(coords, input_size, pixel_bytes),
+          output_pixels * int64_t(sizeof(interpolate::InputCoords)), output_pixels * pixel_bytes};
+}
+
+// Report output pixels per second as items_per_second, and the total traffic as
+// bytes_per_second with a rate for each of the source, map and output, so runs with different
+// image sizes and machines can be compared directly. With hardware performance counters (see
+// PerfCounters) also report cycles_per_pixel and bytes_per_cycle, for a roofline view of whether
+// a kernel is compute or memory bound.
+static void set_throughput_counters(benchmark::State& state, const FrameTraffic& traffic) {
+  auto frames = int64_t(state.iterations());
+  auto frame_bytes = traffic.source_bytes + traffic.map_bytes + traffic.output_bytes;
+  state.SetItemsProcessed(frames * traffic.output_pixels);
+  state.SetBytesProcessed(frames * frame_bytes);
+
+  auto cycles = state.counters.find("cycles");
+
+  if (cycles != state.counters.end() && cycles->second.value > 0.0 && frames > 0) {
+    auto frame_cycles = cycles->second.value / double(frames);
+    state.counters["cycles_per_pixel"] = frame_cycles / double(traffic.output_pixels);
+    state.counters["bytes_per_cycle"] = double(frame_bytes) / frame_cycles;
+  }
+
+  auto rate = [](int64_t bytes) {
+    return benchmark::Counter(double(bytes), benchmark::Counter::kIsIterationInvariantRate,
+                              benchmark::Counter::kIs1024);
+  };
+
+  state.counters["source_bytes_per_second"] = rate(traffic.source_bytes);
+  state.counters["map_bytes_per_second"] = rate(traffic.map_bytes);
+  state.counters["output_bytes_per_second"] = rate(traffic.output_bytes);
+}
+
+bool mats_equivalent(const cv::Mat3b& a, const cv::Mat3b& b, int tolerance = 3) {
   if ((a.rows != b.rows) || (a.cols != b.cols)) {
     std::cout << "mats different size\n";
     return false;
@@ -63,9 +449,9 @@ bool mats_equivalent(const cv::Mat3b& a, const cv::Mat3b& b) {
       auto g_diff = std::abs(px1[1] - px2[1]);
       auto r_diff = std::abs(px1[2] - px2[2]);
 
-      // TODO: there are some very slight differences with the SIMD interpolations,
-      // probably due to rounding.
-      if (b_diff > 3 || g_diff > 3 || r_diff > 3) {
+      // The SIMD implementations truncate 8 bit weights that are rounded differently from the
+      // plain implementation, so they differ very slightly. The exact mode compares with 0.
+      if (b_diff > tolerance || g_diff > tolerance || r_diff > tolerance) {
         std::cout << "pixels not equal at " << x << "x" << y << "\n";
         std::cout << int32_t(px1[0]) << " " << int32_t(px1[1]) << " " << int32_t(px1[2]) << "\n";
         std::cout << int32_t(px2[0]) << " " << int32_t(px2[1]) << " " << int32_t(px2[2]) << "\n";
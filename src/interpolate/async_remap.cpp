@@ -0,0 +1,218 @@
+#include "interpolate/async_remap.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace interpolate
+{
+
+struct AsyncRemap::Job {
+  enum class Coords { map, affine, perspective };
+
+  Coords coords;
+  BGRImage source;
+  BGRImage output;
+  CoordsMap map;
+  AffineTransform affine;
+  PerspectiveTransform perspective;
+  const Kernels* kernels;
+  Callback on_complete;
+  int chunk_rows;
+
+  // Chunks of rows, numbered from first_chunk in the parallel_for() of its batch
+  int chunks;
+  int first_chunk = 0;
+};
+
+AsyncRemap::AsyncRemap(const Options& options)
+    : pool_(options.pool != nullptr ? *options.pool : default_thread_pool()),
+      max_in_flight_(std::max(1, options.max_in_flight)),
+      chunk_rows_(options.chunk_rows) {
+  batch_.reserve(max_in_flight_);
+  dispatcher_ = std::thread(&AsyncRemap::dispatch_main, this);
+}
+
+AsyncRemap::~AsyncRemap() {
+  wait_idle();
+
+  {
+    auto lock = std::lock_guard<std::mutex>(mutex_);
+    stopping_ = true;
+  }
+
+  work_available_.notify_all();
+  dispatcher_.join();
+}
+
+// The future overloads complete a promise from the callback.
+static AsyncRemap::Callback set_promise(std::future<void>& future) {
+  auto promise = std::make_shared<std::promise<void>>();
+  future = promise->get_future();
+
+  return [promise] { promise->set_value(); };
+}
+
+std::future<void> AsyncRemap::submit(const BGRImage& source, const CoordsMap& map,
+                                     const BGRImage& output) {
+  auto future = std::future<void>();
+  submit(source, map, output, set_promise(future));
+
+  return future;
+}
+
+std::future<void> AsyncRemap::submit(const BGRImage& source, const AffineTransform& transform,
+                                     const BGRImage& output) {
+  auto future = std::future<void>();
+  submit(source, transform, output, set_promise(future));
+
+  return future;
+}
+
+std::future<void> AsyncRemap::submit(const BGRImage& source,
+                                     const PerspectiveTransform& transform,
+                                     const BGRImage& output) {
+  auto future = std::future<void>();
+  submit(source, transform, output, set_promise(future));
+
+  return future;
+}
+
+void AsyncRemap::submit(const BGRImage& source, const CoordsMap& map, const BGRImage& output,
+                        Callback on_complete) {
+  if (output.rows != map.rows || output.cols != map.cols) {
+    throw std::runtime_error("output image must be the same size as the map");
+  }
+
+  auto job = std::make_shared<Job>();
+  job->coords = Job::Coords::map;
+  job->source = source;
+  job->output = output;
+  job->map = map;
+  job->on_complete = std::move(on_complete);
+  enqueue(std::move(job));
+}
+
+void AsyncRemap::submit(const BGRImage& source, const AffineTransform& transform,
+                        const BGRImage& output, Callback on_complete) {
+  auto job = std::make_shared<Job>();
+  job->coords = Job::Coords::affine;
+  job->source = source;
+  job->output = output;
+  job->affine = transform;
+  job->on_complete = std::move(on_complete);
+  enqueue(std::move(job));
+}
+
+void AsyncRemap::submit(const BGRImage& source, const PerspectiveTransform& transform,
+                        const BGRImage& output, Callback on_complete) {
+  auto job = std::make_shared<Job>();
+  job->coords = Job::Coords::perspective;
+  job->source = source;
+  job->output = output;
+  job->perspective = transform;
+  job->on_complete = std::move(on_complete);
+  enqueue(std::move(job));
+}
+
+void AsyncRemap::enqueue(std::shared_ptr<Job> job) {
+  const auto rows = job->output.rows;
+
+  job->kernels = &kernels();
+  job->chunk_rows = chunk_rows_ > 0 ? chunk_rows_ : std::max(1, rows / (threads() * 4));
+  job->chunks = rows > 0 ? (rows + job->chunk_rows - 1) / job->chunk_rows : 0;
+
+  {
+    auto lock = std::unique_lock<std::mutex>(mutex_);
+    job_completed_.wait(lock, [&] { return in_flight_ < max_in_flight_; });
+
+    in_flight_++;
+    pending_.push_back(std::move(job));
+  }
+
+  work_available_.notify_all();
+}
+
+void AsyncRemap::wait_idle() {
+  auto lock = std::unique_lock<std::mutex>(mutex_);
+  job_completed_.wait(lock, [&] { return in_flight_ == 0; });
+}
+
+void AsyncRemap::dispatch_main() {
+  for (;;) {
+    {
+      auto lock = std::unique_lock<std::mutex>(mutex_);
+      work_available_.wait(lock, [&] { return stopping_ || !pending_.empty(); });
+
+      if (pending_.empty()) {
+        return;
+      }
+
+      // Every job queued so far, at most max_in_flight_
+      while (!pending_.empty()) {
+        batch_.push_back(std::move(pending_.front()));
+        pending_.pop_front();
+      }
+    }
+
+    run_batch();
+  }
+}
+
+void AsyncRemap::run_batch() {
+  auto chunks = 0;
+
+  for (auto& job : batch_) {
+    job->first_chunk = chunks;
+    chunks += job->chunks;
+  }
+
+  pool_.parallel_for(chunks, 1, [&](int begin, int end) {
+    for (auto chunk = begin; chunk < end; chunk++) {
+      // The batch is a few jobs, so a linear search is enough
+      auto i = size_t(0);
+      while (chunk >= batch_[i]->first_chunk + batch_[i]->chunks) {
+        i++;
+      }
+
+      const auto& job = *batch_[i];
+      const auto row = (chunk - job.first_chunk) * job.chunk_rows;
+      run_rows(job, row, std::min(row + job.chunk_rows, job.output.rows));
+    }
+  });
+
+  // The whole batch is written, so complete its jobs in submission order
+  for (auto& job : batch_) {
+    job->on_complete();
+
+    {
+      auto lock = std::lock_guard<std::mutex>(mutex_);
+      in_flight_--;
+    }
+
+    job_completed_.notify_all();
+  }
+
+  batch_.clear();
+}
+
+void AsyncRemap::run_rows(const Job& job, int begin, int end) {
+  const auto& kernels = *job.kernels;
+  const auto cols = job.output.cols;
+
+  for (auto y = begin; y < end; y++) {
+    switch (job.coords) {
+      case Job::Coords::map:
+        kernels.bilinear_row(job.source, job.map.row(y), job.output.row(y), cols);
+        break;
+      case Job::Coords::affine:
+        kernels.bilinear_affine_row(job.source, job.affine, 0, y, job.output.row(y), cols);
+        break;
+      case Job::Coords::perspective:
+        kernels.bilinear_perspective_row(job.source, job.perspective, 0, y, job.output.row(y),
+                                         cols);
+        break;
+    }
+  }
+}
+
+}    // namespace interpolate
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "interpolate/kernels.hpp"
+#include "interpolate/thread_pool.hpp"
+
+namespace interpolate
+{
+
+// Non-blocking bilinear interpolation of whole frames. Each submit() enqueues a job (source
+// image, coordinate map or transform, output image) and returns straight away, with a future or
+// a callback for its completion, so the caller's threads keep decoding or sending frames while
+// the warp runs.
+//
+// The jobs run on the threads of a ThreadPool, driven by a dispatch thread of the AsyncRemap that
+// takes the place of the caller of parallel_for(). The jobs queued when the pool becomes free are
+// split into chunks of rows and interpolated together in one parallel_for(), so the tail of one
+// frame overlaps the start of the next instead of leaving threads idle. Jobs complete in
+// submission order.
+//
+// The images, and the map, are views: they must stay valid until the job completes.
+class AsyncRemap
+{
+public:
+  struct Options {
+    // Pool to interpolate on, or nullptr for default_thread_pool(). Sharing the pool of the
+    // synchronous remap() keeps to a thread per core: their parallel_for() calls take turns.
+    ThreadPool* pool = nullptr;
+
+    // Jobs submitted and not yet complete. submit() blocks while this many are in flight, which
+    // bounds the latency of a stream of frames faster than the workers.
+    int max_in_flight = 4;
+
+    // Rows per chunk. 0 picks a size giving each thread several chunks of a frame.
+    int chunk_rows = 0;
+  };
+
+  // Called on the dispatch thread once the whole output is written, after the callbacks of the
+  // jobs submitted before. Must not throw, submit() or wait_idle().
+  using Callback = std::function<void()>;
+
+  AsyncRemap() : AsyncRemap(Options()) {}
+  explicit AsyncRemap(const Options& options);
+
+  // Waits for the jobs in flight to complete.
+  ~AsyncRemap();
+
+  AsyncRemap(const AsyncRemap&) = delete;
+  AsyncRemap& operator=(const AsyncRemap&) = delete;
+
+  // Interpolate `output` from `source` with the active instruction set (see active_isa()), with
+  // the sampling coordinates in a map or generated from a transform. The output must be the size
+  // of the map, or a std::runtime_error is thrown.
+  std::future<void> submit(const BGRImage& source, const CoordsMap& map, const BGRImage& output);
+  std::future<void> submit(const BGRImage& source, const AffineTransform& transform,
+                           const BGRImage& output);
+  std::future<void> submit(const BGRImage& source, const PerspectiveTransform& transform,
+                           const BGRImage& output);
+
+  // As above, calling `on_complete` instead of returning a future.
+  void submit(const BGRImage& source, const CoordsMap& map, const BGRImage& output,
+              Callback on_complete);
+  void submit(const BGRImage& source, const AffineTransform& transform, const BGRImage& output,
+              Callback on_complete);
+  void submit(const BGRImage& source, const PerspectiveTransform& transform,
+              const BGRImage& output, Callback on_complete);
+
+  // Block until every job submitted so far has completed.
+  void wait_idle();
+
+  // Number of threads interpolating, the pool's workers and the dispatch thread.
+  int threads() const { return pool_.threads(); }
+
+private:
+  struct Job;
+
+  void enqueue(std::shared_ptr<Job> job);
+  void dispatch_main();
+  void run_batch();
+  static void run_rows(const Job& job, int begin, int end);
+
+  ThreadPool& pool_;
+  int max_in_flight_;
+  int chunk_rows_;
+
+  std::mutex mutex_;
+  std::condition_variable work_available_;
+  std::condition_variable job_completed_;
+
+  // Jobs not taken by the dispatch thread yet, oldest first
+  std::deque<std::shared_ptr<Job>> pending_;
+  int in_flight_ = 0;
+  bool stopping_ = false;
+
+  // The jobs of the current parallel_for(), only used by the dispatch thread
+  std::vector<std::shared_ptr<Job>> batch_;
+
+  std::thread dispatcher_;
+};
+
+}    // namespace interpolate
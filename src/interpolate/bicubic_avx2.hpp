@@ -0,0 +1,189 @@
+#pragma once
+
+#include <immintrin.h>
+#include <stddef.h>
+
+#include "interpolate/bicubic_plain.hpp"
+#include "interpolate/bilinear_avx2.hpp"
+
+namespace interpolate::bicubic::avx2
+{
+
+// As the sse4 implementation, with an output pixel in each 128 bit lane. A 16 byte load from the
+// first tap of a row holds the source pixels of two pairs of taps, which are shuffled to pairs of
+// 16 bit channels and multiplied and added with a pair of weights at a time.
+
+// Masks to shuffle the pairs of taps in the lower and upper 6 bytes of each lane to pairs of 16
+// bit channels.
+// Eg: (10 other bytes) rgb rgb  |  (10 other bytes) rgb rgb
+// Becomes: _ _ r r g g b b  |  _ _ r r g g b b
+#define MASK_SHUFFLE_TAPS_LOW_HALF -1, -1, -1, -1, -1, 5, -1, 2, -1, 4, -1, 1, -1, 3, -1, 0
+#define MASK_SHUFFLE_TAPS_HIGH_HALF -1, -1, -1, -1, -1, 11, -1, 8, -1, 10, -1, 7, -1, 9, -1, 6
+
+// Weights of 2 pixels, from the fractional parts of their coordinates in the lower 64 bits of
+// each lane: _ _ x y. Each dword of the results is the pair of 16 bit weights of two adjacent
+// taps, as laid out in the filter's table, broadcast to the lane. The weights are gathered from
+// the table.
+template <interpolate::Filter filter>
+static inline void tap_weights(__m256i fractions, __m256i weights_x[], __m256i weights_y[]) {
+  const auto* table = (const int*) filter_weights<filter>().w;
+
+  if constexpr (filter == Filter::bicubic) {
+    // One gather for both directions
+    // wy23 wy01 wx23 wx01
+    __m256i index = _mm256_shuffle_epi32(fractions, _MM_SHUFFLE(0, 0, 1, 1));
+    index = _mm256_add_epi32(_mm256_slli_epi32(index, 1), _mm256_set_epi32(1, 0, 1, 0, 1, 0, 1, 0));
+    const __m256i weights = _mm256_i32gather_epi32(table, index, 4);
+
+    weights_x[0] = _mm256_shuffle_epi32(weights, _MM_SHUFFLE(0, 0, 0, 0));
+    weights_x[1] = _mm256_shuffle_epi32(weights, _MM_SHUFFLE(1, 1, 1, 1));
+    weights_y[0] = _mm256_shuffle_epi32(weights, _MM_SHUFFLE(2, 2, 2, 2));
+    weights_y[1] = _mm256_shuffle_epi32(weights, _MM_SHUFFLE(3, 3, 3, 3));
+  } else {
+    // Rows of the table are 3 dwords
+    // _ w45 w23 w01
+    const __m256i offsets = _mm256_set_epi32(2, 2, 1, 0, 2, 2, 1, 0);
+
+    __m256i index_x = _mm256_shuffle_epi32(fractions, _MM_SHUFFLE(1, 1, 1, 1));
+    index_x = _mm256_add_epi32(_mm256_add_epi32(index_x, _mm256_slli_epi32(index_x, 1)), offsets);
+    const __m256i x = _mm256_i32gather_epi32(table, index_x, 4);
+
+    __m256i index_y = _mm256_shuffle_epi32(fractions, _MM_SHUFFLE(0, 0, 0, 0));
+    index_y = _mm256_add_epi32(_mm256_add_epi32(index_y, _mm256_slli_epi32(index_y, 1)), offsets);
+    const __m256i y = _mm256_i32gather_epi32(table, index_y, 4);
+
+    weights_x[0] = _mm256_shuffle_epi32(x, _MM_SHUFFLE(0, 0, 0, 0));
+    weights_x[1] = _mm256_shuffle_epi32(x, _MM_SHUFFLE(1, 1, 1, 1));
+    weights_x[2] = _mm256_shuffle_epi32(x, _MM_SHUFFLE(2, 2, 2, 2));
+    weights_y[0] = _mm256_shuffle_epi32(y, _MM_SHUFFLE(0, 0, 0, 0));
+    weights_y[1] = _mm256_shuffle_epi32(y, _MM_SHUFFLE(1, 1, 1, 1));
+    weights_y[2] = _mm256_shuffle_epi32(y, _MM_SHUFFLE(2, 2, 2, 2));
+  }
+}
+
+// 16 bytes from each of 2 source addresses, plus an offset, in the lower and upper lanes.
+static inline __m256i load_lanes(const uint8_t* const p[2], ptrdiff_t offset) {
+  const __m128i lower = _mm_loadu_si128((const __m128i*) (p[0] + offset));
+  const __m128i upper = _mm_loadu_si128((const __m128i*) (p[1] + offset));
+
+  return _mm256_inserti128_si256(_mm256_castsi128_si256(lower), upper, 1);
+}
+
+// Filter one row of taps of 2 pixels horizontally, `offset` bytes from their first taps.
+// Returns the sums rounded to 16 bit fixed point, in 32 bits: _ r g b  |  _ r g b
+template <interpolate::Filter filter>
+static inline __m256i filter_row(const uint8_t* const first_taps[2], ptrdiff_t offset,
+                                 const __m256i weights_x[]) {
+  const __m256i shuffle_low =
+      _mm256_set_epi8(MASK_SHUFFLE_TAPS_LOW_HALF, MASK_SHUFFLE_TAPS_LOW_HALF);
+  const __m256i shuffle_high =
+      _mm256_set_epi8(MASK_SHUFFLE_TAPS_HIGH_HALF, MASK_SHUFFLE_TAPS_HIGH_HALF);
+
+  const __m256i pixels = load_lanes(first_taps, offset);
+
+  __m256i sums = _mm256_madd_epi16(_mm256_shuffle_epi8(pixels, shuffle_low), weights_x[0]);
+  sums = _mm256_add_epi32(
+      sums, _mm256_madd_epi16(_mm256_shuffle_epi8(pixels, shuffle_high), weights_x[1]));
+
+  if constexpr (filter == Filter::lanczos3) {
+    const __m256i more_pixels = load_lanes(first_taps, offset + 12);
+    sums = _mm256_add_epi32(
+        sums, _mm256_madd_epi16(_mm256_shuffle_epi8(more_pixels, shuffle_low), weights_x[2]));
+  }
+
+  return _mm256_srai_epi32(_mm256_add_epi32(sums, _mm256_set1_epi32(128)), 8);
+}
+
+// Filter 2 output pixels from their first taps, the top left of their source pixels, and their
+// fractions (see tap_weights()). Returns an 8 bpc pixel in the lower 32 bits of each lane, the
+// format bilinear::avx2::write_output_pixels() takes.
+template <interpolate::Filter filter>
+static inline __m256i interpolate_two_pixels(const uint8_t* const first_taps[2], ptrdiff_t step,
+                                             __m256i fractions) {
+  constexpr auto taps = FILTER_TAPS<filter>;
+
+  __m256i weights_x[taps / 2], weights_y[taps / 2];
+  tap_weights<filter>(fractions, weights_x, weights_y);
+
+  __m256i sums = _mm256_setzero_si256();
+
+  for (auto j = 0; j < taps; j += 2) {
+    const __m256i upper = filter_row<filter>(first_taps, j * step, weights_x);
+    const __m256i lower = filter_row<filter>(first_taps, (j + 1) * step, weights_x);
+
+    // Pairs of rows as 16 bit ints, multiplied and added with their pair of weights
+    const __m256i rows = _mm256_blend_epi16(upper, _mm256_slli_epi32(lower, 16), 0xAA);
+    sums = _mm256_add_epi32(sums, _mm256_madd_epi16(rows, weights_y[j / 2]));
+  }
+
+  // Round to nearest, and convert from 32bpc => 16bpc => 8bpc, which clamps the overshoot
+  sums = _mm256_add_epi32(sums, _mm256_set1_epi32(1 << (2 * FILTER_WEIGHT_BITS - 9)));
+  sums = _mm256_srai_epi32(sums, 2 * FILTER_WEIGHT_BITS - 8);
+
+  sums = _mm256_packus_epi32(sums, _mm256_setzero_si256());
+  return _mm256_packus_epi16(sums, _mm256_setzero_si256());
+}
+
+// Filter 4 adjacent output pixels. If any of their taps aren't inside the image, the 4 pixels go
+// through the plain implementation.
+template <interpolate::Filter filter>
+static inline void interpolate(const interpolate::BGRImage& image,
+                               const interpolate::InputCoords input_coords[4],
+                               interpolate::BGRPixel output_pixels[4]) {
+  constexpr auto first_tap = FILTER_FIRST_TAP<filter>;
+
+  // Fixed point coordinates, rounded to nearest
+  // x4 y4 x3 y3  |  x2 y2 x1 y1
+  const __m256i fixed = _mm256_cvtps_epi32(
+      _mm256_mul_ps(_mm256_loadu_ps(&input_coords[0].y), _mm256_set1_ps(float(FIXED_POINT_SCALE))));
+  const __m256i ints = _mm256_srai_epi32(fixed, FIXED_POINT_BITS);
+
+  // Pixels whose taps and loads are all inside the image
+  const auto max_x = image.cols - FILTER_LOAD_PIXELS<filter> - first_tap;
+  const auto max_y = image.rows - FILTER_TAPS<filter> / 2 - 1;
+  const __m256i max = _mm256_set_epi32(max_x, max_y, max_x, max_y, max_x, max_y, max_x, max_y);
+  const __m256i outside = _mm256_or_si256(_mm256_cmpgt_epi32(_mm256_set1_epi32(-first_tap), ints),
+                                          _mm256_cmpgt_epi32(ints, max));
+
+  if (!_mm256_testz_si256(outside, outside)) [[unlikely]] {
+    plain::interpolate_row<filter>(image, input_coords, output_pixels, 4);
+    return;
+  }
+
+  alignas(32) int32_t yx[8];
+  _mm256_store_si256((__m256i*) yx, ints);
+
+  const uint8_t* first_taps[4];
+
+  for (auto i = 0; i < 4; i++) {
+    first_taps[i] = (const uint8_t*) image.ptr(yx[i * 2] + first_tap, yx[i * 2 + 1] + first_tap);
+  }
+
+  // Pixels 1 and 3 from the lower 64 bits of each lane, and 2 and 4 from the upper
+  const __m256i fractions = _mm256_and_si256(fixed, _mm256_set1_epi32(FIXED_POINT_MASK));
+  const uint8_t* const first_taps_13[2] = {first_taps[0], first_taps[2]};
+  const uint8_t* const first_taps_24[2] = {first_taps[1], first_taps[3]};
+
+  const __m256i pixels_13 = interpolate_two_pixels<filter>(first_taps_13, image.step, fractions);
+  const __m256i pixels_24 = interpolate_two_pixels<filter>(
+      first_taps_24, image.step, _mm256_shuffle_epi32(fractions, _MM_SHUFFLE(3, 2, 3, 2)));
+
+  bilinear::avx2::write_output_pixels(pixels_13, pixels_24, output_pixels);
+}
+
+// Interpolate a row of output pixels. Any count is supported. The last 1-3 pixels go through the
+// plain implementation.
+template <interpolate::Filter filter>
+static inline void interpolate_row(const interpolate::BGRImage& image,
+                                   const interpolate::InputCoords* input_coords,
+                                   interpolate::BGRPixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 4 <= count; x += 4) {
+    interpolate<filter>(image, input_coords + x, output_pixels + x);
+  }
+
+  plain::interpolate_row<filter>(image, input_coords + x, output_pixels + x, count - x);
+}
+
+}    // namespace interpolate::bicubic::avx2
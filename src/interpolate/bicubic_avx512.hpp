@@ -0,0 +1,214 @@
+#pragma once
+
+#include <immintrin.h>
+#include <stddef.h>
+
+#include "interpolate/bicubic_plain.hpp"
+#include "interpolate/bilinear_avx512.hpp"
+
+namespace interpolate::bicubic::avx512
+{
+
+// As the sse4 implementation, with an output pixel in each 128 bit lane. A 16 byte load from the
+// first tap of a row holds the source pixels of two pairs of taps, which are shuffled to pairs of
+// 16 bit channels and multiplied and added with a pair of weights at a time. With VNNI the
+// multiply-adds accumulate in one instruction.
+
+// Masks to shuffle the pairs of taps in the lower and upper 6 bytes of each lane to pairs of 16
+// bit channels.
+// Eg, a 128 bit lane with the following data:
+// (10 other bytes) rgb rgb
+// Becomes:
+// _ _ r r g g b b
+#define MASK_SHUFFLE_TAPS_LOW_SINGLE_LANE -1, -1, -1, -1, -1, 5, -1, 2, -1, 4, -1, 1, -1, 3, -1, 0
+#define MASK_SHUFFLE_TAPS_HIGH_SINGLE_LANE                                                         \
+  -1, -1, -1, -1, -1, 11, -1, 8, -1, 10, -1, 7, -1, 9, -1, 6
+
+// Multiply adjacent pairs of 16 bit ints and add them to the 32 bit sums.
+static inline __m512i multiply_add(__m512i sums, __m512i a, __m512i b) {
+#ifdef __AVX512VNNI__
+  return _mm512_dpwssd_epi32(sums, a, b);
+#else
+  return _mm512_add_epi32(sums, _mm512_madd_epi16(a, b));
+#endif
+}
+
+// Weights of 4 pixels, from the fractional parts of their coordinates in the lower 64 bits of
+// each lane: _ _ x y. Each dword of the results is the pair of 16 bit weights of two adjacent
+// taps, as laid out in the filter's table, broadcast to the lane. The weights are gathered from
+// the table.
+template <interpolate::Filter filter>
+static inline void tap_weights(__m512i fractions, __m512i weights_x[], __m512i weights_y[]) {
+  const auto* table = (const int*) filter_weights<filter>().w;
+
+  if constexpr (filter == Filter::bicubic) {
+    // One gather for both directions
+    // ... | wy23 wy01 wx23 wx01
+    __m512i index = _mm512_shuffle_epi32(fractions, _MM_PERM_AABB);
+    index = _mm512_add_epi32(_mm512_slli_epi32(index, 1), _mm512_set4_epi32(1, 0, 1, 0));
+    const __m512i weights = _mm512_i32gather_epi32(index, table, 4);
+
+    weights_x[0] = _mm512_shuffle_epi32(weights, _MM_PERM_AAAA);
+    weights_x[1] = _mm512_shuffle_epi32(weights, _MM_PERM_BBBB);
+    weights_y[0] = _mm512_shuffle_epi32(weights, _MM_PERM_CCCC);
+    weights_y[1] = _mm512_shuffle_epi32(weights, _MM_PERM_DDDD);
+  } else {
+    // Rows of the table are 3 dwords
+    // ... | _ w45 w23 w01
+    const __m512i offsets = _mm512_set4_epi32(2, 2, 1, 0);
+
+    __m512i index_x = _mm512_shuffle_epi32(fractions, _MM_PERM_BBBB);
+    index_x = _mm512_add_epi32(_mm512_add_epi32(index_x, _mm512_slli_epi32(index_x, 1)), offsets);
+    const __m512i x = _mm512_i32gather_epi32(index_x, table, 4);
+
+    __m512i index_y = _mm512_shuffle_epi32(fractions, _MM_PERM_AAAA);
+    index_y = _mm512_add_epi32(_mm512_add_epi32(index_y, _mm512_slli_epi32(index_y, 1)), offsets);
+    const __m512i y = _mm512_i32gather_epi32(index_y, table, 4);
+
+    weights_x[0] = _mm512_shuffle_epi32(x, _MM_PERM_AAAA);
+    weights_x[1] = _mm512_shuffle_epi32(x, _MM_PERM_BBBB);
+    weights_x[2] = _mm512_shuffle_epi32(x, _MM_PERM_CCCC);
+    weights_y[0] = _mm512_shuffle_epi32(y, _MM_PERM_AAAA);
+    weights_y[1] = _mm512_shuffle_epi32(y, _MM_PERM_BBBB);
+    weights_y[2] = _mm512_shuffle_epi32(y, _MM_PERM_CCCC);
+  }
+}
+
+// 16 bytes from each of 4 source addresses, plus an offset, in lanes 0-3.
+static inline __m512i load_lanes(const uint8_t* const p[4], ptrdiff_t offset) {
+  __m512i lanes = _mm512_castsi128_si512(_mm_loadu_si128((const __m128i*) (p[0] + offset)));
+  lanes = _mm512_inserti32x4(lanes, _mm_loadu_si128((const __m128i*) (p[1] + offset)), 1);
+  lanes = _mm512_inserti32x4(lanes, _mm_loadu_si128((const __m128i*) (p[2] + offset)), 2);
+  return _mm512_inserti32x4(lanes, _mm_loadu_si128((const __m128i*) (p[3] + offset)), 3);
+}
+
+// Filter one row of taps of 4 pixels horizontally, `offset` bytes from their first taps.
+// Returns the sums rounded to 16 bit fixed point, in 32 bits: ... | _ r g b
+template <interpolate::Filter filter>
+static inline __m512i filter_row(const uint8_t* const first_taps[4], ptrdiff_t offset,
+                                 const __m512i weights_x[]) {
+  const __m512i shuffle_low =
+      _mm512_set_epi8(MASK_SHUFFLE_TAPS_LOW_SINGLE_LANE, MASK_SHUFFLE_TAPS_LOW_SINGLE_LANE,
+                      MASK_SHUFFLE_TAPS_LOW_SINGLE_LANE, MASK_SHUFFLE_TAPS_LOW_SINGLE_LANE);
+  const __m512i shuffle_high =
+      _mm512_set_epi8(MASK_SHUFFLE_TAPS_HIGH_SINGLE_LANE, MASK_SHUFFLE_TAPS_HIGH_SINGLE_LANE,
+                      MASK_SHUFFLE_TAPS_HIGH_SINGLE_LANE, MASK_SHUFFLE_TAPS_HIGH_SINGLE_LANE);
+
+  const __m512i pixels = load_lanes(first_taps, offset);
+
+  __m512i sums = _mm512_madd_epi16(_mm512_shuffle_epi8(pixels, shuffle_low), weights_x[0]);
+  sums = multiply_add(sums, _mm512_shuffle_epi8(pixels, shuffle_high), weights_x[1]);
+
+  if constexpr (filter == Filter::lanczos3) {
+    const __m512i more_pixels = load_lanes(first_taps, offset + 12);
+    sums = multiply_add(sums, _mm512_shuffle_epi8(more_pixels, shuffle_low), weights_x[2]);
+  }
+
+  return _mm512_srai_epi32(_mm512_add_epi32(sums, _mm512_set1_epi32(128)), 8);
+}
+
+// Filter 4 output pixels from their first taps, the top left of their source pixels, and their
+// fractions (see tap_weights()). The result is in the format
+// bilinear::avx512::write_output_pixels() takes: an 8 bpc pixel in the lower 32 bits of each
+// lane, or with VBMI the 32 bpc pixel multiplied by 256.
+template <interpolate::Filter filter>
+static inline __m512i interpolate_four_pixels(const uint8_t* const first_taps[4], ptrdiff_t step,
+                                              __m512i fractions) {
+  constexpr auto taps = FILTER_TAPS<filter>;
+
+  __m512i weights_x[taps / 2], weights_y[taps / 2];
+  tap_weights<filter>(fractions, weights_x, weights_y);
+
+  __m512i sums = _mm512_setzero_si512();
+
+  for (auto j = 0; j < taps; j += 2) {
+    const __m512i upper = filter_row<filter>(first_taps, j * step, weights_x);
+    const __m512i lower = filter_row<filter>(first_taps, (j + 1) * step, weights_x);
+
+    // Pairs of rows as 16 bit ints, multiplied and added with their pair of weights
+    const __m512i rows = _mm512_mask_blend_epi16(0xAAAAAAAA, upper, _mm512_slli_epi32(lower, 16));
+    sums = multiply_add(sums, rows, weights_y[j / 2]);
+  }
+
+  // Round to nearest
+  sums = _mm512_add_epi32(sums, _mm512_set1_epi32(1 << (2 * FILTER_WEIGHT_BITS - 9)));
+  sums = _mm512_srai_epi32(sums, 2 * FILTER_WEIGHT_BITS - 8);
+
+#ifdef __AVX512VBMI__
+  // Clamp the overshoot, and scale to the sums write_output_pixels() divides by 256
+  sums = _mm512_min_epi32(_mm512_max_epi32(sums, _mm512_setzero_si512()), _mm512_set1_epi32(255));
+  return _mm512_slli_epi32(sums, 8);
+#else
+  // Convert from 32bpc => 16bpc => 8bpc, which clamps the overshoot
+  sums = _mm512_packus_epi32(sums, _mm512_setzero_si512());
+  return _mm512_packus_epi16(sums, _mm512_setzero_si512());
+#endif
+}
+
+// Filter 8 adjacent output pixels. If any of their taps aren't inside the image, the 8 pixels go
+// through the plain implementation.
+template <interpolate::Filter filter>
+static inline void interpolate(const interpolate::BGRImage& image,
+                               const interpolate::InputCoords input_coords[8],
+                               interpolate::BGRPixel output_pixels[8]) {
+  constexpr auto first_tap = FILTER_FIRST_TAP<filter>;
+
+  // Fixed point coordinates, rounded to nearest
+  // ... | x2 y2 x1 y1
+  const __m512i fixed = _mm512_cvtps_epi32(
+      _mm512_mul_ps(_mm512_loadu_ps(&input_coords[0].y), _mm512_set1_ps(float(FIXED_POINT_SCALE))));
+  const __m512i ints = _mm512_srai_epi32(fixed, FIXED_POINT_BITS);
+
+  // Pixels whose taps and loads are all inside the image
+  const __m512i max = _mm512_set4_epi32(image.cols - FILTER_LOAD_PIXELS<filter> - first_tap,
+                                        image.rows - FILTER_TAPS<filter> / 2 - 1,
+                                        image.cols - FILTER_LOAD_PIXELS<filter> - first_tap,
+                                        image.rows - FILTER_TAPS<filter> / 2 - 1);
+  const __mmask16 inside = _mm512_cmpge_epi32_mask(ints, _mm512_set1_epi32(-first_tap)) &
+                           _mm512_cmple_epi32_mask(ints, max);
+
+  if (inside != 0xFFFF) [[unlikely]] {
+    plain::interpolate_row<filter>(image, input_coords, output_pixels, 8);
+    return;
+  }
+
+  alignas(64) int32_t yx[16];
+  _mm512_store_si512(yx, ints);
+
+  const uint8_t* first_taps[8];
+
+  for (auto i = 0; i < 8; i++) {
+    first_taps[i] = (const uint8_t*) image.ptr(yx[i * 2] + first_tap, yx[i * 2 + 1] + first_tap);
+  }
+
+  // Pixels 1, 3, 5 and 7 from the lower 64 bits of each lane, and 2, 4, 6 and 8 from the upper
+  const __m512i fractions = _mm512_and_si512(fixed, _mm512_set1_epi32(FIXED_POINT_MASK));
+  const uint8_t* const first_taps_1357[4] = {first_taps[0], first_taps[2], first_taps[4],
+                                             first_taps[6]};
+  const uint8_t* const first_taps_2468[4] = {first_taps[1], first_taps[3], first_taps[5],
+                                             first_taps[7]};
+
+  const __m512i pixels_1357 =
+      interpolate_four_pixels<filter>(first_taps_1357, image.step, fractions);
+  const __m512i pixels_2468 = interpolate_four_pixels<filter>(
+      first_taps_2468, image.step, _mm512_shuffle_epi32(fractions, _MM_PERM_DCDC));
+
+  bilinear::avx512::write_output_pixels(pixels_1357, pixels_2468, output_pixels);
+}
+
+// Interpolate a row of output pixels. Any count is supported. The last 1-7 pixels go through the
+// plain implementation.
+template <interpolate::Filter filter>
+static inline void interpolate_row(const interpolate::BGRImage& image,
+                                   const interpolate::InputCoords* input_coords,
+                                   interpolate::BGRPixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 8 <= count; x += 8) {
+    interpolate<filter>(image, input_coords + x, output_pixels + x);
+  }
+
+  plain::interpolate_row<filter>(image, input_coords + x, output_pixels + x, count - x);
+}
+
+}    // namespace interpolate::bicubic::avx512
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <math.h>
+
+#include "interpolate/filters.hpp"
+#include "interpolate/types.hpp"
+
+namespace interpolate::bicubic::plain
+{
+
+// Interpolation with a separable filter of 4x4 (bicubic) or 6x6 (Lanczos-3) taps. Coordinates
+// are rounded to the nearest 1/32 of a pixel, as in the exact bilinear mode, and the weights
+// looked up from the filter's table. Taps outside the image repeat the edge pixels.
+//
+// Each row of taps is summed horizontally, rounded to FILTER_WEIGHT_BITS - 8 fractional bits,
+// then the rows are summed vertically and rounded to nearest. The SIMD implementations use the
+// same integer arithmetic, so every instruction set gives identical output.
+template <interpolate::Filter filter>
+static inline interpolate::BGRPixel interpolate(const interpolate::BGRImage& image,
+                                                const interpolate::InputCoords& input_coords) {
+  constexpr auto taps = FILTER_TAPS<filter>;
+  constexpr auto first_tap = FILTER_FIRST_TAP<filter>;
+
+  // Round to nearest, ties to even, like the SIMD float to int conversions
+  const auto x = int(lrintf(input_coords.x * FIXED_POINT_SCALE));
+  const auto y = int(lrintf(input_coords.y * FIXED_POINT_SCALE));
+
+  const auto* wx = filter_weights<filter>().w[x & FIXED_POINT_MASK];
+  const auto* wy = filter_weights<filter>().w[y & FIXED_POINT_MASK];
+
+  // Source columns of the taps, clamped to the image
+  int columns[taps];
+  for (auto k = 0; k < taps; k++) {
+    auto column = (x >> FIXED_POINT_BITS) + first_tap + k;
+    columns[k] = (column < 0) ? 0 : (column < image.cols) ? column : image.cols - 1;
+  }
+
+  int sums[3] = {};
+
+  for (auto j = 0; j < taps; j++) {
+    auto row = (y >> FIXED_POINT_BITS) + first_tap + j;
+    row = (row < 0) ? 0 : (row < image.rows) ? row : image.rows - 1;
+
+    int row_sums[3] = {};
+
+    for (auto k = 0; k < taps; k++) {
+      const auto& pixel = *image.ptr(row, columns[k]);
+      row_sums[0] += pixel.b * wx[k];
+      row_sums[1] += pixel.g * wx[k];
+      row_sums[2] += pixel.r * wx[k];
+    }
+
+    // Down to 16 bits for the vertical pass
+    for (auto c = 0; c < 3; c++) {
+      sums[c] += int16_t((row_sums[c] + 128) >> 8) * wy[j];
+    }
+  }
+
+  // Round to nearest, and clamp the overshoot of the negative lobes
+  uint8_t out[3];
+  for (auto c = 0; c < 3; c++) {
+    const auto value = (sums[c] + (1 << (2 * FILTER_WEIGHT_BITS - 9))) >>
+                       (2 * FILTER_WEIGHT_BITS - 8);
+    out[c] = uint8_t((value < 0) ? 0 : (value > 255) ? 255 : value);
+  }
+
+  return {out[0], out[1], out[2]};
+}
+
+// Interpolate a row of output pixels. Any count is supported.
+template <interpolate::Filter filter>
+static inline void interpolate_row(const interpolate::BGRImage& image,
+                                   const interpolate::InputCoords* input_coords,
+                                   interpolate::BGRPixel* output_pixels, int count) {
+  for (auto i = 0; i < count; i++) {
+    output_pixels[i] = interpolate<filter>(image, input_coords[i]);
+  }
+}
+
+}    // namespace interpolate::bicubic::plain
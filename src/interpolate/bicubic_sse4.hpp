@@ -0,0 +1,161 @@
+#pragma once
+
+#include <immintrin.h>
+#include <stddef.h>
+
+#include "interpolate/bicubic_plain.hpp"
+#include "interpolate/bilinear_sse4.hpp"
+
+namespace interpolate::bicubic::sse4
+{
+
+// Each output pixel is filtered in its own register. A 16 byte load from the first tap of a row
+// holds the source pixels of two pairs of taps, which are shuffled to pairs of 16 bit channels
+// and multiplied and added with a pair of weights at a time. 6 taps need a second load.
+
+// Weights of a pixel, from the fractional parts of its coordinates. Each dword of the results is
+// the pair of 16 bit weights of two adjacent taps, as laid out in the filter's table, broadcast
+// to the whole register.
+template <interpolate::Filter filter>
+static inline void tap_weights(int fraction_y, int fraction_x, __m128i weights_x[],
+                               __m128i weights_y[]) {
+  const auto& table = filter_weights<filter>();
+  const auto* row_x = table.w[fraction_x];
+  const auto* row_y = table.w[fraction_y];
+
+  if constexpr (filter == Filter::bicubic) {
+    // wy23 wy01 wx23 wx01
+    const __m128i weights =
+        _mm_unpacklo_epi64(_mm_loadl_epi64((const __m128i*) row_x),
+                           _mm_loadl_epi64((const __m128i*) row_y));
+
+    weights_x[0] = _mm_shuffle_epi32(weights, _MM_SHUFFLE(0, 0, 0, 0));
+    weights_x[1] = _mm_shuffle_epi32(weights, _MM_SHUFFLE(1, 1, 1, 1));
+    weights_y[0] = _mm_shuffle_epi32(weights, _MM_SHUFFLE(2, 2, 2, 2));
+    weights_y[1] = _mm_shuffle_epi32(weights, _MM_SHUFFLE(3, 3, 3, 3));
+  } else {
+    // _ w45 w23 w01. Rows of the table are 12 bytes.
+    const __m128i x = _mm_insert_epi32(_mm_loadl_epi64((const __m128i*) row_x),
+                                       ((const int32_t*) row_x)[2], 2);
+    const __m128i y = _mm_insert_epi32(_mm_loadl_epi64((const __m128i*) row_y),
+                                       ((const int32_t*) row_y)[2], 2);
+
+    weights_x[0] = _mm_shuffle_epi32(x, _MM_SHUFFLE(0, 0, 0, 0));
+    weights_x[1] = _mm_shuffle_epi32(x, _MM_SHUFFLE(1, 1, 1, 1));
+    weights_x[2] = _mm_shuffle_epi32(x, _MM_SHUFFLE(2, 2, 2, 2));
+    weights_y[0] = _mm_shuffle_epi32(y, _MM_SHUFFLE(0, 0, 0, 0));
+    weights_y[1] = _mm_shuffle_epi32(y, _MM_SHUFFLE(1, 1, 1, 1));
+    weights_y[2] = _mm_shuffle_epi32(y, _MM_SHUFFLE(2, 2, 2, 2));
+  }
+}
+
+// Filter one row of taps horizontally, from the row's first tap.
+// Returns the sums rounded to 16 bit fixed point, in 32 bits: _ r g b
+template <interpolate::Filter filter>
+static inline __m128i filter_row(const uint8_t* first_tap, const __m128i weights_x[]) {
+  // Pairs of taps in the lower and upper 6 bytes of a load, as pairs of 16 bit channels
+  // _ _ r r g g b b
+  const __m128i shuffle_low =
+      _mm_set_epi8(-1, -1, -1, -1, -1, 5, -1, 2, -1, 4, -1, 1, -1, 3, -1, 0);
+  const __m128i shuffle_high =
+      _mm_set_epi8(-1, -1, -1, -1, -1, 11, -1, 8, -1, 10, -1, 7, -1, 9, -1, 6);
+
+  const __m128i pixels = _mm_loadu_si128((const __m128i*) first_tap);
+
+  __m128i sums = _mm_madd_epi16(_mm_shuffle_epi8(pixels, shuffle_low), weights_x[0]);
+  sums = _mm_add_epi32(sums, _mm_madd_epi16(_mm_shuffle_epi8(pixels, shuffle_high), weights_x[1]));
+
+  if constexpr (filter == Filter::lanczos3) {
+    const __m128i more_pixels = _mm_loadu_si128((const __m128i*) (first_tap + 12));
+    sums = _mm_add_epi32(sums,
+                         _mm_madd_epi16(_mm_shuffle_epi8(more_pixels, shuffle_low), weights_x[2]));
+  }
+
+  return _mm_srai_epi32(_mm_add_epi32(sums, _mm_set1_epi32(128)), 8);
+}
+
+// Filter one output pixel from its first tap, the top left of its source pixels.
+// Returns the pixel in the lower 32 bits.
+template <interpolate::Filter filter>
+static inline __m128i interpolate_one_pixel(const uint8_t* first_tap, ptrdiff_t step,
+                                            int fraction_y, int fraction_x) {
+  constexpr auto taps = FILTER_TAPS<filter>;
+
+  __m128i weights_x[taps / 2], weights_y[taps / 2];
+  tap_weights<filter>(fraction_y, fraction_x, weights_x, weights_y);
+
+  __m128i sums = _mm_setzero_si128();
+
+  for (auto j = 0; j < taps; j += 2) {
+    const __m128i upper = filter_row<filter>(first_tap + j * step, weights_x);
+    const __m128i lower = filter_row<filter>(first_tap + (j + 1) * step, weights_x);
+
+    // Pairs of rows as 16 bit ints, multiplied and added with their pair of weights
+    const __m128i rows = _mm_blend_epi16(upper, _mm_slli_epi32(lower, 16), 0xAA);
+    sums = _mm_add_epi32(sums, _mm_madd_epi16(rows, weights_y[j / 2]));
+  }
+
+  // Round to nearest, and convert from 32bpc => 16bpc => 8bpc, which clamps the overshoot
+  sums = _mm_add_epi32(sums, _mm_set1_epi32(1 << (2 * FILTER_WEIGHT_BITS - 9)));
+  sums = _mm_srai_epi32(sums, 2 * FILTER_WEIGHT_BITS - 8);
+
+  sums = _mm_packus_epi32(sums, _mm_setzero_si128());
+  return _mm_packus_epi16(sums, _mm_setzero_si128());
+}
+
+// Filter 2 adjacent output pixels. Pixels whose taps aren't all inside the image go through the
+// plain implementation.
+template <interpolate::Filter filter>
+static inline void interpolate(const interpolate::BGRImage& image,
+                               const interpolate::InputCoords input_coords[2],
+                               interpolate::BGRPixel output_pixels[2], bool can_write_third_pixel) {
+  constexpr auto first_tap = FILTER_FIRST_TAP<filter>;
+
+  // Fixed point coordinates, rounded to nearest
+  // x2 y2 x1 y1
+  const __m128i fixed = _mm_cvtps_epi32(
+      _mm_mul_ps(_mm_loadu_ps(&input_coords[0].y), _mm_set1_ps(float(FIXED_POINT_SCALE))));
+  const __m128i ints = _mm_srai_epi32(fixed, FIXED_POINT_BITS);
+
+  // Pixels whose taps and loads are all inside the image
+  const __m128i max = _mm_set_epi32(image.cols - FILTER_LOAD_PIXELS<filter> - first_tap,
+                                    image.rows - FILTER_TAPS<filter> / 2 - 1,
+                                    image.cols - FILTER_LOAD_PIXELS<filter> - first_tap,
+                                    image.rows - FILTER_TAPS<filter> / 2 - 1);
+  const __m128i outside = _mm_or_si128(_mm_cmplt_epi32(ints, _mm_set1_epi32(-first_tap)),
+                                       _mm_cmpgt_epi32(ints, max));
+
+  if (!_mm_testz_si128(outside, outside)) [[unlikely]] {
+    plain::interpolate_row<filter>(image, input_coords, output_pixels, 2);
+    return;
+  }
+
+  alignas(16) int32_t yx[4];
+  alignas(16) int32_t fractions[4];
+  _mm_store_si128((__m128i*) yx, ints);
+  _mm_store_si128((__m128i*) fractions, _mm_and_si128(fixed, _mm_set1_epi32(FIXED_POINT_MASK)));
+
+  const auto* p1 = (const uint8_t*) image.ptr(yx[0] + first_tap, yx[1] + first_tap);
+  const auto* p2 = (const uint8_t*) image.ptr(yx[2] + first_tap, yx[3] + first_tap);
+
+  const __m128i pixel_1 = interpolate_one_pixel<filter>(p1, image.step, fractions[0], fractions[1]);
+  const __m128i pixel_2 = interpolate_one_pixel<filter>(p2, image.step, fractions[2], fractions[3]);
+
+  bilinear::sse4::write_output_pixels(pixel_1, pixel_2, output_pixels, can_write_third_pixel);
+}
+
+// Interpolate a row of output pixels. Any count is supported.
+template <interpolate::Filter filter>
+static inline void interpolate_row(const interpolate::BGRImage& image,
+                                   const interpolate::InputCoords* input_coords,
+                                   interpolate::BGRPixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 2 <= count; x += 2) {
+    interpolate<filter>(image, input_coords + x, output_pixels + x, x + 2 < count);
+  }
+
+  plain::interpolate_row<filter>(image, input_coords + x, output_pixels + x, count - x);
+}
+
+}    // namespace interpolate::bicubic::sse4
@@ -1,37 +1,27 @@
 #pragma once
 
+#include "interpolate/streaming.hpp"
+#include "interpolate/tail.hpp"
 #include "interpolate/types.hpp"
 #include <immintrin.h>
+#include <string.h>
 
 namespace interpolate::bilinear::avx2
 {
 
-static const __m256i WEIGHTS_Y_SHUFFLE =
-    _mm256_set_epi8(11, 10, 11, 10, 9, 8, 9, 8, 3, 2, 3, 2, 1, 0, 1, 0,
-                    // Repeated
-                    11, 10, 11, 10, 9, 8, 9, 8, 3, 2, 3, 2, 1, 0, 1, 0);
-
-// Calculate the weights for the 4 surrounding pixels of 4 independent xy pairs.
+// Calculate the weights for the 4 surrounding pixels of 4 independent xy pairs, from the
+// fractional parts of their coordinates as 16 bit ints in the range 0-256. Pixels 1 and 2 go in
+// the lower 64 bits of the lower lane, and pixels 3 and 4 in the lower 64 bits of the upper lane.
+// The upper 64 bits of each lane are ignored.
+// Eg: _ _ _ _ x4 y4 x3 y3  |  _ _ _ _ x2 y2 x1 y1
 // Returns weights as 16 bit ints.
 // Eg: w4 w3 w2 w1 (x4/y4)   w4 w3 w2 w1 (x3/y3)   |  w4 w3 w2 w1 (x2/y2)  w4 w3 w2 w1 (x1/y1)
-static inline __m256i calculate_weights(const float sample_coords[8]) {
-  const __m256 initial =
-      _mm256_castsi256_ps(_mm256_stream_load_si256((const __m256i*) sample_coords));
-
-  const __m256 floored = _mm256_floor_ps(initial);
-  const __m256 fractional = _mm256_sub_ps(initial, floored);
-
-  // Convert fractional parts to 32 bit ints in range 0-256
-  // x4 y4 x3 y3  |  x2 y2 x1 y1
-  __m256i lower = _mm256_cvtps_epi32(_mm256_mul_ps(fractional, _mm256_set1_ps(256.0f)));
-
-  // Convert to 16 bit ints
-  // 0 0 0 0 x4 y4 x3 y3  |  0 0 0 0 x2 y2 x1 y1
-  lower = _mm256_packs_epi32(lower, _mm256_set1_epi32(0));
-
+// Fractions with fewer than 8 bits give the exact products as weights, see EXACT_WEIGHT_BITS.
+template <int fraction_bits = 8>
+static inline __m256i combine_weights(__m256i lower) {
   // Get the 1-fractional from the 16 bit result
-  // 256 256 256 256 1-x4 1-y4 1-x3 1-y3  |  256 256 256 256 1-x2 1-y2 1-x1 1-y1
-  const __m256i upper = _mm256_sub_epi16(_mm256_set1_epi16(256), lower);
+  // _ _ _ _ 1-x4 1-y4 1-x3 1-y3  |  _ _ _ _ 1-x2 1-y2 1-x1 1-y1
+  const __m256i upper = _mm256_sub_epi16(_mm256_set1_epi16(1 << fraction_bits), lower);
 
   // ...y4 ...y3  |  ...y2  1-x1 x1  1-y1 y1
   const __m256i combined = _mm256_unpacklo_epi16(upper, lower);
@@ -41,55 +31,78 @@ static inline __m256i calculate_weights(const float sample_coords[8]) {
 
   // ...(1-y4)  ...(1-y3)  |  ...(1-y2)  y1 y1 (1-y1) (1-y1)
   // Shuffle 16 bit numbers as 8 bits because there is no _mm256_shuffle_epi16
-  const __m256i weights_y = _mm256_shuffle_epi8(combined, WEIGHTS_Y_SHUFFLE);
+  const __m256i weights_y_shuffle =
+      _mm256_set_epi8(11, 10, 11, 10, 9, 8, 9, 8, 3, 2, 3, 2, 1, 0, 1, 0,
+                      // Repeated
+                      11, 10, 11, 10, 9, 8, 9, 8, 3, 2, 3, 2, 1, 0, 1, 0);
+  const __m256i weights_y = _mm256_shuffle_epi8(combined, weights_y_shuffle);
 
-  // Multiply to get final per pixel weights. Divide by 256 to get back into correct range.
+  // Multiply to get final per pixel weights.
   // ...(x4/y4)  ... (x3/y3)  |  ... (x2/y2)  w4 w3 w2 w1 (x1/y1)
-  __m256i weights = _mm256_srli_epi16(_mm256_mullo_epi16(weights_x, weights_y), 8);
+  __m256i weights = _mm256_mullo_epi16(weights_x, weights_y);
 
-  // If both weights were 256, the result is 65536 which is all 0s in the lower 16 bits.
-  // Find the weights this happened to, and replace them with 256.
-  const __m256i weights_hi = _mm256_mulhi_epi16(weights_x, weights_y);
-  const __m256i weights_hi_mask = _mm256_cmpgt_epi16(weights_hi, _mm256_setzero_si256());
-  weights = _mm256_blendv_epi8(weights, _mm256_set1_epi16(256), weights_hi_mask);
+  if constexpr (fraction_bits == 8) {
+    // Divide by 256 to get back into correct range.
+    weights = _mm256_srli_epi16(weights, 8);
+
+    // If both weights were 256, the result is 65536 which is all 0s in the lower 16 bits.
+    // Find the weights this happened to, and replace them with 256.
+    const __m256i weights_hi = _mm256_mulhi_epi16(weights_x, weights_y);
+    const __m256i weights_hi_mask = _mm256_cmpgt_epi16(weights_hi, _mm256_setzero_si256());
+    weights = _mm256_blendv_epi8(weights, _mm256_set1_epi16(256), weights_hi_mask);
+  }
 
   return weights;
 }
 
-// Mask to shuffle the blue and green channels from packed 24bpp to 64bpp (16bpc) in each lane.
+// Calculate the weights for the 4 surrounding pixels of 4 independent xy pairs.
+// Returns weights as 16 bit ints, see combine_weights().
+static inline __m256i calculate_weights(__m256 initial) {
+  const __m256 floored = _mm256_floor_ps(initial);
+  const __m256 fractional = _mm256_sub_ps(initial, floored);
+
+  // Convert fractional parts to 32 bit ints in range 0-256
+  // x4 y4 x3 y3  |  x2 y2 x1 y1
+  __m256i lower = _mm256_cvtps_epi32(_mm256_mul_ps(fractional, _mm256_set1_ps(256.0f)));
+
+  // Convert to 16 bit ints
+  // 0 0 0 0 x4 y4 x3 y3  |  0 0 0 0 x2 y2 x1 y1
+  lower = _mm256_packs_epi32(lower, _mm256_set1_epi32(0));
+
+  return combine_weights(lower);
+}
+
+// Rows of coordinates can start anywhere when the output width is arbitrary, so the load is
+// unaligned.
+static inline __m256i calculate_weights(const float sample_coords[8]) {
+  return calculate_weights(_mm256_loadu_ps(sample_coords));
+}
+
+// Masks to shuffle the blue and green channels from packed 24bpp to 64bpp (16bpc) in each lane.
 // Upper and lower lanes of input should contain independent sets of 4 pixels.
 // Eg:
 // (12 other bits) rgb rgb (12 other bits) rgb rgb  |  (12 other bits) rgb rgb (12 other bits) rgb
 // rgb Becomes g g g g b b b b  |  g g g g b b b b
-static const __m128i MASK_SHUFFLE_BG_HALF = _mm_set_epi8(
-    // green
-    -1, 12, -1, 9, -1, 4, -1, 1,
-    // blue
-    -1, 11, -1, 8, -1, 3, -1, 0);
-
-static const __m256i MASK_SHUFFLE_BG = _mm256_set_m128i(MASK_SHUFFLE_BG_HALF, MASK_SHUFFLE_BG_HALF);
+//
+// These are macros rather than static vectors so no AVX2 instructions run during static
+// initialisation on CPUs without AVX2.
+#define MASK_SHUFFLE_BG_HALF                                                                       \
+  _mm_set_epi8(/* green */ -1, 12, -1, 9, -1, 4, -1, 1, /* blue */ -1, 11, -1, 8, -1, 3, -1, 0)
 
 // Do the same with the red channel. The upper half of each lane is not used.
-static const __m128i MASK_SHUFFLE_R0_HALF = _mm_set_epi8(
-    // unused
-    -1, -1, -1, -1, -1, -1, -1, -1,
-    // red
-    -1, 13, -1, 10, -1, 5, -1, 2);
-
-static const __m256i MASK_SHUFFLE_R0 = _mm256_set_m128i(MASK_SHUFFLE_R0_HALF, MASK_SHUFFLE_R0_HALF);
-
-static inline __m256i interpolate_two_pixels(const interpolate::BGRImage& image,
-                                             const interpolate::InputCoords input_coords[3],
-                                             __m256i weights) {
-  // Load pixel data
-  const auto* p0_0 = image.ptr(input_coords[0].y, input_coords[0].x);
-  const auto* p1_0 = image.ptr(input_coords[2].y, input_coords[2].x);
+#define MASK_SHUFFLE_R0_HALF                                                                       \
+  _mm_set_epi8(/* unused */ -1, -1, -1, -1, -1, -1, -1, -1, /* red */ -1, 13, -1, 10, -1, 5, -1, 2)
 
-  const __m256i pixels = _mm256_set_epi64x(*((int64_t*) image.ptr_below(p1_0)), *((int64_t*) p1_0),
-                                           *((int64_t*) image.ptr_below(p0_0)), *((int64_t*) p0_0));
+// Interpolate two pixels from their source pixel data. Each lane holds the top and bottom rows
+// of a pixel's source pixels in its lower and upper 64 bits. 8 bit weights truncate the weighted
+// sums, and EXACT_WEIGHT_BITS weights round them to nearest.
+template <int weight_bits = 8>
+static inline __m256i blend_two_pixels(__m256i pixels, __m256i weights) {
+  const __m256i mask_shuffle_bg = _mm256_set_m128i(MASK_SHUFFLE_BG_HALF, MASK_SHUFFLE_BG_HALF);
+  const __m256i mask_shuffle_r0 = _mm256_set_m128i(MASK_SHUFFLE_R0_HALF, MASK_SHUFFLE_R0_HALF);
 
-  const __m256i pixels_bg = _mm256_shuffle_epi8(pixels, MASK_SHUFFLE_BG);
-  const __m256i pixels_r0 = _mm256_shuffle_epi8(pixels, MASK_SHUFFLE_R0);
+  const __m256i pixels_bg = _mm256_shuffle_epi8(pixels, mask_shuffle_bg);
+  const __m256i pixels_r0 = _mm256_shuffle_epi8(pixels, mask_shuffle_r0);
 
   // Multiply with the pixel data and sum adjacent pairs to 32 bit ints
   // g g b b | g g b b
@@ -101,8 +114,13 @@ static inline __m256i interpolate_two_pixels(const interpolate::BGRImage& image,
   // _ r g b  |  _ r g b
   __m256i result = _mm256_hadd_epi32(result_bg, result_r0);
 
-  // Divide by 256 to get back into correct range.
-  result = _mm256_srli_epi32(result, 8);
+  // Divide by the sum of the weights to get back into correct range.
+  if constexpr (weight_bits == 8) {
+    result = _mm256_srli_epi32(result, 8);
+  } else {
+    result = _mm256_add_epi32(result, _mm256_set1_epi32(1 << (weight_bits - 1)));
+    result = _mm256_srli_epi32(result, weight_bits);
+  }
 
   // Convert from 32bpc => 16bpc => 8bpc
   result = _mm256_packus_epi32(result, _mm256_setzero_si256());
@@ -111,14 +129,26 @@ static inline __m256i interpolate_two_pixels(const interpolate::BGRImage& image,
   return result;
 }
 
+// Interpolate two pixels from the top left source pixel of each.
+template <int weight_bits = 8>
+static inline __m256i interpolate_two_pixels(const interpolate::BGRImage& image,
+                                             const interpolate::BGRPixel* p0_0,
+                                             const interpolate::BGRPixel* p1_0, __m256i weights) {
+  // Load pixel data
+  const __m256i pixels = _mm256_set_epi64x(*((int64_t*) image.ptr_below(p1_0)), *((int64_t*) p1_0),
+                                           *((int64_t*) image.ptr_below(p0_0)), *((int64_t*) p0_0));
+
+  return blend_two_pixels<weight_bits>(pixels, weights);
+}
+
 // Slightly faster than memcpy
 static inline void memcpy_12(uint8_t* dst, const uint8_t* src) {
   *((uint64_t*) dst) = *((uint64_t*) src);
   *((uint32_t*) (dst + 8)) = *((uint32_t*) (src + 8));
 }
 
-static inline void write_output_pixels(__m256i pixels_13, __m256i pixels_24,
-                                       interpolate::BGRPixel output_pixels[4]) {
+// Pack 4 interpolated pixels into packed 24bpp in the lower 12 bytes.
+static inline __m256i pack_output_pixels(__m256i pixels_13, __m256i pixels_24) {
   // Unpack to get adjacent pixel data in lower 64 bits of each lane
   // _ _ 4 3  |  _ _ 2 1
   __m256i combined = _mm256_unpacklo_epi32(pixels_13, pixels_24);
@@ -128,19 +158,79 @@ static inline void write_output_pixels(__m256i pixels_13, __m256i pixels_24,
   combined = _mm256_permute4x64_epi64(combined, _MM_SHUFFLE(3, 3, 2, 0));
 
   // Shuffle around to get packed 24bpp at the bottom of the lower lane
-  combined = _mm256_shuffle_epi8(combined,
-                                 _mm256_set_epi8(
-                                     // Top lane not used
-                                     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-                                     // Bottom lane - 32 unused bits at the top
-                                     -1, -1, -1, -1,
-                                     // Packed pixel data
-                                     14, 13, 12, 10, 9, 8, 6, 5, 4, 2, 1, 0));
+  return _mm256_shuffle_epi8(combined,
+                             _mm256_set_epi8(
+                                 // Top lane not used
+                                 -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                 // Bottom lane - 32 unused bits at the top
+                                 -1, -1, -1, -1,
+                                 // Packed pixel data
+                                 14, 13, 12, 10, 9, 8, 6, 5, 4, 2, 1, 0));
+}
 
+// Write `count` (1-4) output pixels from pack_output_pixels(). Writing fewer than 4 is for the
+// tail of a row.
+static inline void write_output_pixels(__m256i packed, interpolate::BGRPixel output_pixels[4],
+                                       int count = 4) {
   // Write out the lower 12 bytes
   alignas(32) uint8_t interpolated_pixels[32];
-  _mm256_store_si256((__m256i*) interpolated_pixels, combined);
-  memcpy_12((uint8_t*) output_pixels, interpolated_pixels);
+  _mm256_store_si256((__m256i*) interpolated_pixels, packed);
+
+  if (count == 4) [[likely]] {
+    memcpy_12((uint8_t*) output_pixels, interpolated_pixels);
+  } else {
+    memcpy(output_pixels, interpolated_pixels, count * sizeof(interpolate::BGRPixel));
+  }
+}
+
+// Write `count` (1-4) output pixels. Writing fewer than 4 is for the tail of a row.
+static inline void write_output_pixels(__m256i pixels_13, __m256i pixels_24,
+                                       interpolate::BGRPixel output_pixels[4], int count = 4) {
+  write_output_pixels(pack_output_pixels(pixels_13, pixels_24), output_pixels, count);
+}
+
+// Bilinear interpolation of 4 adjacent output pixels from the top left source pixel of each,
+// and weights from calculate_weights(). Returns them packed, see pack_output_pixels().
+template <int weight_bits = 8>
+static inline __m256i interpolate_packed(const interpolate::BGRImage& image,
+                                         const interpolate::BGRPixel* const source_pixels[4],
+                                         __m256i weights) {
+  // Prepare weights for pixels 1 and 3, and interpolate
+  const __m256i weights_13 = _mm256_unpacklo_epi64(weights, weights);
+  const __m256i pixels_13 =
+      interpolate_two_pixels<weight_bits>(image, source_pixels[0], source_pixels[2], weights_13);
+
+  // Same for pixels 2 and 4
+  const __m256i weights_24 = _mm256_unpackhi_epi64(weights, weights);
+  const __m256i pixels_24 =
+      interpolate_two_pixels<weight_bits>(image, source_pixels[1], source_pixels[3], weights_24);
+
+  return pack_output_pixels(pixels_13, pixels_24);
+}
+
+// Bilinear interpolation of 4 adjacent output pixels from the top left source pixel of each,
+// and weights from calculate_weights(). Only the first `count` output pixels are written.
+template <int weight_bits = 8>
+static inline void interpolate(const interpolate::BGRImage& image,
+                               const interpolate::BGRPixel* const source_pixels[4],
+                               __m256i weights, interpolate::BGRPixel output_pixels[4],
+                               int count = 4) {
+  write_output_pixels(interpolate_packed<weight_bits>(image, source_pixels, weights),
+                      output_pixels, count);
+}
+
+// Bilinear interpolation of 4 adjacent output pixels with the supplied coordinates and weights
+// from calculate_weights(). Only the first `count` output pixels are written.
+static inline void interpolate(const interpolate::BGRImage& image,
+                               const interpolate::InputCoords input_coords[4], __m256i weights,
+                               interpolate::BGRPixel output_pixels[4], int count = 4) {
+  const interpolate::BGRPixel* source_pixels[4];
+
+  for (auto i = 0; i < 4; i++) {
+    source_pixels[i] = image.ptr(input_coords[i].y, input_coords[i].x);
+  }
+
+  interpolate(image, source_pixels, weights, output_pixels, count);
 }
 
 // Bilinear interpolation of 4 adjacent output pixels with the supplied coordinates using AVX2.
@@ -150,15 +240,1535 @@ static inline void interpolate(const interpolate::BGRImage& image,
   // Calculate weights for 4 pixels
   const __m256i weights = calculate_weights(&input_coords[0].y);
 
-  // Prepare weights for pixels 1 and 3, and interpolate
+  interpolate(image, input_coords, weights, output_pixels);
+}
+
+//
+// Hardware gathers
+//
+
+// Byte offsets from the start of the image of the top left source pixel of 4 pixels, and of
+// the pixel below it, from y x coordinates as 32 bit ints. The last row of the image is its own
+// row below, as in BGRImage::ptr_below().
+static inline void source_offsets(const interpolate::BGRImage& image, __m256i coords,
+                                  __m128i& top, __m128i& bottom) {
+  // Moves the lower 32 bits of each pair to the lower lane
+  const __m256i pack_pairs = _mm256_set_epi32(7, 5, 3, 1, 6, 4, 2, 0);
+
+  // y * step + x * 3 in the lower 32 bits of each pair
+  __m256i offsets = _mm256_mullo_epi32(coords, _mm256_set1_epi64x((3ll << 32) | image.step));
+  offsets = _mm256_add_epi32(offsets, _mm256_srli_epi64(offsets, 32));
+  top = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(offsets, pack_pairs));
+
+  const __m128i ys = _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(coords, pack_pairs));
+  const __m128i has_row_below = _mm_cmpgt_epi32(_mm_set1_epi32(image.rows - 1), ys);
+  bottom = _mm_add_epi32(top, _mm_and_si128(has_row_below, _mm_set1_epi32(image.step)));
+}
+
+// Bilinear interpolation of 4 adjacent output pixels, fetching the top and bottom source pixels
+// of each with one gather per row. Offsets are in bytes from the start of the image. Returns
+// them packed, see pack_output_pixels().
+template <int weight_bits = 8>
+static inline __m256i interpolate_gathered_packed(const interpolate::BGRImage& image, __m128i top,
+                                                  __m128i bottom, __m256i weights) {
+  const auto* data = (const long long*) image.data;
+
+  // 4 3  |  2 1
+  const __m256i top_pixels = _mm256_i32gather_epi64(data, top, 1);
+  const __m256i bottom_pixels = _mm256_i32gather_epi64(data, bottom, 1);
+
+  const __m256i pixels_13 = _mm256_unpacklo_epi64(top_pixels, bottom_pixels);
   const __m256i weights_13 = _mm256_unpacklo_epi64(weights, weights);
-  const __m256i pixels_13 = interpolate_two_pixels(image, input_coords, weights_13);
 
-  // Same for pixels 2 and 4
+  const __m256i pixels_24 = _mm256_unpackhi_epi64(top_pixels, bottom_pixels);
   const __m256i weights_24 = _mm256_unpackhi_epi64(weights, weights);
-  const __m256i pixels_24 = interpolate_two_pixels(image, input_coords + 1, weights_24);
 
-  write_output_pixels(pixels_13, pixels_24, output_pixels);
+  return pack_output_pixels(blend_two_pixels<weight_bits>(pixels_13, weights_13),
+                            blend_two_pixels<weight_bits>(pixels_24, weights_24));
+}
+
+// As interpolate_gathered_packed(), writing only the first `count` output pixels.
+template <int weight_bits = 8>
+static inline void interpolate_gathered(const interpolate::BGRImage& image, __m128i top,
+                                        __m128i bottom, __m256i weights,
+                                        interpolate::BGRPixel output_pixels[4], int count = 4) {
+  write_output_pixels(interpolate_gathered_packed<weight_bits>(image, top, bottom, weights),
+                      output_pixels, count);
+}
+
+// Bilinear interpolation of 4 adjacent output pixels from their y x coordinates, with the
+// addresses calculated in registers and the source pixels fetched with gathers.
+static inline void interpolate_gathered(const interpolate::BGRImage& image, __m256 coords,
+                                        interpolate::BGRPixel output_pixels[4], int count = 4) {
+  // Coordinates are never negative, so truncating floors them
+  __m128i top, bottom;
+  source_offsets(image, _mm256_cvttps_epi32(coords), top, bottom);
+
+  interpolate_gathered(image, top, bottom, calculate_weights(coords), output_pixels, count);
+}
+
+// Interpolate a row of output pixels. Any count is supported. The last 1-3 pixels go through
+// the same SIMD path with padded coordinates.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_row(const interpolate::BGRImage& image,
+                                   const interpolate::InputCoords* input_coords,
+                                   interpolate::BGRPixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 4 <= count; x += 4) {
+    if constexpr (fetch == interpolate::Fetch::gather) {
+      interpolate_gathered(image, _mm256_loadu_ps(&input_coords[x].y), output_pixels + x);
+    } else {
+      interpolate(image, input_coords + x, output_pixels + x);
+    }
+  }
+
+  if (x < count) {
+    alignas(32) interpolate::InputCoords padded[4];
+    copy_tail<4>(input_coords + x, count - x, padded);
+
+    if constexpr (fetch == interpolate::Fetch::gather) {
+      interpolate_gathered(image, _mm256_load_ps(&padded[0].y), output_pixels + x, count - x);
+    } else {
+      interpolate(image, padded, calculate_weights(&padded[0].y), output_pixels + x, count - x);
+    }
+  }
+}
+
+//
+// Streaming stores
+//
+
+// Interpolate 4 output pixels from their coordinates, returning them packed, see
+// pack_output_pixels().
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline __m256i interpolate_step(const interpolate::BGRImage& image,
+                                       const interpolate::InputCoords input_coords[4]) {
+  if constexpr (fetch == interpolate::Fetch::gather) {
+    const __m256 coords = _mm256_loadu_ps(&input_coords[0].y);
+
+    __m128i top, bottom;
+    source_offsets(image, _mm256_cvttps_epi32(coords), top, bottom);
+
+    return interpolate_gathered_packed(image, top, bottom, calculate_weights(coords));
+  } else {
+    const interpolate::BGRPixel* source_pixels[4];
+
+    for (auto i = 0; i < 4; i++) {
+      source_pixels[i] = image.ptr(input_coords[i].y, input_coords[i].x);
+    }
+
+    return interpolate_packed(image, source_pixels, calculate_weights(&input_coords[0].y));
+  }
+}
+
+// Join two steps of packed pixels into 8 packed pixels in the lower 24 bytes.
+static inline __m256i join_steps(__m256i pixels_1234, __m256i pixels_5678) {
+  const __m256i both = _mm256_permute2x128_si256(pixels_1234, pixels_5678, 0x20);
+  return _mm256_permutevar8x32_epi32(both, _mm256_set_epi32(0, 0, 6, 5, 4, 2, 1, 0));
+}
+
+// Write 32 output pixels, 96 bytes, with non-temporal stores. Each of `packed` holds 8 pixels
+// from join_steps(). The output must be 32 byte aligned.
+static inline void stream_output_pixels(const __m256i packed[4],
+                                        interpolate::BGRPixel output_pixels[32]) {
+  auto* output = (__m256i*) output_pixels;
+
+  // Pixels 1-8 and the first 2 32 bit elements of 9-16
+  const __m256i line_0 = _mm256_blend_epi32(
+      packed[0], _mm256_permutevar8x32_epi32(packed[1], _mm256_set_epi32(1, 0, 0, 0, 0, 0, 0, 0)),
+      0xc0);
+  _mm256_stream_si256(output, line_0);
+
+  // The rest of 9-16 and the first 4 32 bit elements of 17-24
+  const __m256i line_1 = _mm256_blend_epi32(
+      _mm256_permutevar8x32_epi32(packed[1], _mm256_set_epi32(0, 0, 0, 0, 5, 4, 3, 2)),
+      _mm256_permutevar8x32_epi32(packed[2], _mm256_set_epi32(3, 2, 1, 0, 0, 0, 0, 0)), 0xf0);
+  _mm256_stream_si256(output + 1, line_1);
+
+  // The rest of 17-24 and 25-32
+  const __m256i line_2 = _mm256_blend_epi32(
+      _mm256_permutevar8x32_epi32(packed[2], _mm256_set_epi32(0, 0, 0, 0, 0, 0, 5, 4)),
+      _mm256_permutevar8x32_epi32(packed[3], _mm256_set_epi32(5, 4, 3, 2, 1, 0, 0, 0)), 0xfc);
+  _mm256_stream_si256(output + 2, line_2);
+}
+
+// As interpolate_row(), writing the output with non-temporal stores so it doesn't evict the
+// source pixels from the cache. The pixels before the first 32 byte boundary and after the last
+// whole step of 32 pixels use regular stores. Call streaming_store_fence() after the last row.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_streaming_row(const interpolate::BGRImage& image,
+                                             const interpolate::InputCoords* input_coords,
+                                             interpolate::BGRPixel* output_pixels, int count) {
+  auto x = interpolate::pixels_to_alignment<32>(output_pixels);
+  if (x > count) {
+    x = count;
+  }
+
+  interpolate_row<fetch>(image, input_coords, output_pixels, x);
+
+  for (; x + 32 <= count; x += 32) {
+    __m256i packed[4];
+
+    for (auto i = 0; i < 4; i++) {
+      const auto* step_coords = input_coords + x + i * 8;
+      packed[i] = join_steps(interpolate_step<fetch>(image, step_coords),
+                             interpolate_step<fetch>(image, step_coords + 4));
+    }
+
+    stream_output_pixels(packed, output_pixels + x);
+  }
+
+  interpolate_row<fetch>(image, input_coords + x, output_pixels + x, count - x);
+}
+
+//
+// Exact mode
+//
+
+// Interpolate 4 output pixels in the exact mode, see bilinear::plain::interpolate_exact(). Only
+// the first `count` output pixels are written.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_exact(const interpolate::BGRImage& image, __m256 coords,
+                                     interpolate::BGRPixel output_pixels[4], int count = 4) {
+  // Fixed point coordinates, rounded to nearest
+  // x4 y4 x3 y3  |  x2 y2 x1 y1
+  const __m256i fixed =
+      _mm256_cvtps_epi32(_mm256_mul_ps(coords, _mm256_set1_ps(float(FIXED_POINT_SCALE))));
+  const __m256i ints = _mm256_srai_epi32(fixed, FIXED_POINT_BITS);
+
+  // 0 0 0 0 x4 y4 x3 y3  |  0 0 0 0 x2 y2 x1 y1
+  const __m256i fractions = _mm256_packs_epi32(
+      _mm256_and_si256(fixed, _mm256_set1_epi32(FIXED_POINT_MASK)), _mm256_setzero_si256());
+  const __m256i weights = combine_weights<FIXED_POINT_BITS>(fractions);
+
+  if constexpr (fetch == interpolate::Fetch::gather) {
+    __m128i top, bottom;
+    source_offsets(image, ints, top, bottom);
+
+    interpolate_gathered<EXACT_WEIGHT_BITS>(image, top, bottom, weights, output_pixels, count);
+  } else {
+    alignas(32) int32_t yx[8];
+    _mm256_store_si256((__m256i*) yx, ints);
+
+    const interpolate::BGRPixel* source_pixels[4];
+
+    for (auto i = 0; i < 4; i++) {
+      source_pixels[i] = image.ptr(yx[i * 2], yx[i * 2 + 1]);
+    }
+
+    interpolate<EXACT_WEIGHT_BITS>(image, source_pixels, weights, output_pixels, count);
+  }
+}
+
+// Interpolate a row of output pixels in the exact mode. Any count is supported.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_exact_row(const interpolate::BGRImage& image,
+                                         const interpolate::InputCoords* input_coords,
+                                         interpolate::BGRPixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 4 <= count; x += 4) {
+    interpolate_exact<fetch>(image, _mm256_loadu_ps(&input_coords[x].y), output_pixels + x);
+  }
+
+  if (x < count) {
+    alignas(32) interpolate::InputCoords padded[4];
+    copy_tail<4>(input_coords + x, count - x, padded);
+
+    interpolate_exact<fetch>(image, _mm256_load_ps(&padded[0].y), output_pixels + x, count - x);
+  }
+}
+
+//
+// Warps
+//
+
+// Clamp the source coordinates of 4 pixels to the image, and interleave them as y x pairs.
+// Comparisons with NaN (eg from a perspective divide by 0) return the clamp bound.
+static inline __m256 clamp_and_interleave(const interpolate::BGRImage& image, __m128 xs,
+                                          __m128 ys) {
+  xs = _mm_min_ps(_mm_max_ps(xs, _mm_setzero_ps()), _mm_set1_ps(float(image.cols - 1)));
+  ys = _mm_min_ps(_mm_max_ps(ys, _mm_setzero_ps()), _mm_set1_ps(float(image.rows - 1)));
+
+  // y2 x2 y1 x1
+  const __m128 coords_12 = _mm_unpacklo_ps(ys, xs);
+  // y4 x4 y3 x3
+  const __m128 coords_34 = _mm_unpackhi_ps(ys, xs);
+
+  return _mm256_set_m128(coords_34, coords_12);
+}
+
+// Interpolate 4 output pixels from sampling coordinates generated in registers. Only the first
+// `count` output pixels are written.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_generated(const interpolate::BGRImage& image, __m256 coords,
+                                         interpolate::BGRPixel output_pixels[4], int count = 4) {
+  if constexpr (fetch == interpolate::Fetch::gather) {
+    interpolate_gathered(image, coords, output_pixels, count);
+    return;
+  }
+
+  // The weights come straight from the registers. The pixel addresses are calculated per
+  // pixel, so the coordinates also go through a small stack buffer that stays in L1.
+  alignas(32) interpolate::InputCoords input_coords[4];
+  _mm256_store_ps(&input_coords[0].y, coords);
+
+  interpolate(image, input_coords, calculate_weights(coords), output_pixels, count);
+}
+
+// Number of pixels to write in the step of a row starting at x.
+static inline int step_count(int x, int count) { return (count - x < 4) ? count - x : 4; }
+
+// Interpolate `count` pixels of output row y, starting at column x, with sampling coordinates
+// from an affine transform. Coordinates are clamped to the image. Any count is supported.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_affine_row(const interpolate::BGRImage& image,
+                                          const interpolate::AffineTransform& transform, int x,
+                                          int y, interpolate::BGRPixel* output_pixels,
+                                          int count) {
+  const auto& m = transform.m;
+  const __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+
+  // Column of each pixel. Coordinates are calculated from the column rather than accumulated,
+  // so rounding errors don't build up along the row.
+  __m128 columns = _mm_add_ps(lane, _mm_set1_ps(float(x)));
+  const __m128 columns_step = _mm_set1_ps(4.0f);
+
+  const __m128 m00 = _mm_set1_ps(m[0][0]);
+  const __m128 m10 = _mm_set1_ps(m[1][0]);
+  const __m128 row_xs = _mm_set1_ps(m[0][1] * y + m[0][2]);
+  const __m128 row_ys = _mm_set1_ps(m[1][1] * y + m[1][2]);
+
+  for (auto i = 0; i < count; i += 4) {
+    const __m128 xs = _mm_fmadd_ps(columns, m00, row_xs);
+    const __m128 ys = _mm_fmadd_ps(columns, m10, row_ys);
+
+    interpolate_generated<fetch>(image, clamp_and_interleave(image, xs, ys), output_pixels + i,
+                                 step_count(i, count));
+
+    columns = _mm_add_ps(columns, columns_step);
+  }
+}
+
+// As interpolate_affine_row(), with a perspective transform.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_perspective_row(const interpolate::BGRImage& image,
+                                               const interpolate::PerspectiveTransform& transform,
+                                               int x, int y, interpolate::BGRPixel* output_pixels,
+                                               int count) {
+  const auto& m = transform.m;
+  const __m128 lane = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+
+  __m128 columns = _mm_add_ps(lane, _mm_set1_ps(float(x)));
+  const __m128 columns_step = _mm_set1_ps(4.0f);
+
+  const __m128 m00 = _mm_set1_ps(m[0][0]);
+  const __m128 m10 = _mm_set1_ps(m[1][0]);
+  const __m128 m20 = _mm_set1_ps(m[2][0]);
+  const __m128 row_xs = _mm_set1_ps(m[0][1] * y + m[0][2]);
+  const __m128 row_ys = _mm_set1_ps(m[1][1] * y + m[1][2]);
+  const __m128 row_ws = _mm_set1_ps(m[2][1] * y + m[2][2]);
+
+  for (auto i = 0; i < count; i += 4) {
+    const __m128 ws = _mm_fmadd_ps(columns, m20, row_ws);
+    const __m128 xs = _mm_div_ps(_mm_fmadd_ps(columns, m00, row_xs), ws);
+    const __m128 ys = _mm_div_ps(_mm_fmadd_ps(columns, m10, row_ys), ws);
+
+    interpolate_generated<fetch>(image, clamp_and_interleave(image, xs, ys), output_pixels + i,
+                                 step_count(i, count));
+
+    columns = _mm_add_ps(columns, columns_step);
+  }
+}
+
+//
+// Compact maps
+//
+
+// Interpolate 4 output pixels from a fixed point map, rounded as the exact mode. Only the first
+// `count` output pixels are written.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_fixed_point(const interpolate::BGRImage& image,
+                                           const interpolate::FixedPointCoords coords[4],
+                                           const uint16_t fractions[4],
+                                           interpolate::BGRPixel output_pixels[4],
+                                           int count = 4) {
+  // (fy << 5) | fx for each pixel, as 32 bit ints
+  const __m128i packed = _mm_cvtepu16_epi32(_mm_loadl_epi64((const __m128i*) fractions));
+
+  // Split into 16 bit ints
+  // x4 y4 x3 y3 x2 y2 x1 y1
+  const __m128i ys = _mm_srli_epi32(packed, FIXED_POINT_BITS);
+  const __m128i xs = _mm_and_si128(packed, _mm_set1_epi32(FIXED_POINT_MASK));
+  const __m128i lower = _mm_or_si128(ys, _mm_slli_epi32(xs, 16));
+
+  // Pixels 1 and 2 in the lower lane, 3 and 4 in the upper lane
+  const __m256i weights = combine_weights<FIXED_POINT_BITS>(
+      _mm256_set_m128i(_mm_unpackhi_epi64(lower, lower), lower));
+
+  if constexpr (fetch == interpolate::Fetch::gather) {
+    __m128i top, bottom;
+    source_offsets(image, _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*) coords)), top,
+                   bottom);
+
+    interpolate_gathered<EXACT_WEIGHT_BITS>(image, top, bottom, weights, output_pixels, count);
+    return;
+  }
+
+  const interpolate::BGRPixel* source_pixels[4];
+
+  for (auto i = 0; i < 4; i++) {
+    source_pixels[i] = image.ptr(coords[i].y, coords[i].x);
+  }
+
+  interpolate<EXACT_WEIGHT_BITS>(image, source_pixels, weights, output_pixels, count);
+}
+
+// Interpolate a row of output pixels from a fixed point map. Any count is supported.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_fixed_point_row(const interpolate::BGRImage& image,
+                                               const interpolate::FixedPointCoords* coords,
+                                               const uint16_t* fractions,
+                                               interpolate::BGRPixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 4 <= count; x += 4) {
+    interpolate_fixed_point<fetch>(image, coords + x, fractions + x, output_pixels + x);
+  }
+
+  if (x < count) {
+    interpolate::FixedPointCoords padded_coords[4];
+    uint16_t padded_fractions[4];
+    copy_tail<4>(coords + x, count - x, padded_coords);
+    copy_tail<4>(fractions + x, count - x, padded_fractions);
+
+    interpolate_fixed_point<fetch>(image, padded_coords, padded_fractions, output_pixels + x,
+                                   count - x);
+  }
+}
+
+// Interpolate `count` pixels of output row y, starting at column x, from a half float offset
+// map. Coordinates are clamped to the image. Any count is supported.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_half_float_row(const interpolate::BGRImage& image,
+                                              const interpolate::HalfFloatOffsets* offsets, int x,
+                                              int y, interpolate::BGRPixel* output_pixels,
+                                              int count) {
+  // Output pixel positions as y x pairs
+  __m256 positions = _mm256_add_ps(_mm256_set_ps(3.0f, 0.0f, 2.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f),
+                                   _mm256_set_ps(x, y, x, y, x, y, x, y));
+  const __m256 positions_step = _mm256_set_ps(4.0f, 0.0f, 4.0f, 0.0f, 4.0f, 0.0f, 4.0f, 0.0f);
+
+  const float max_x = image.cols - 1;
+  const float max_y = image.rows - 1;
+  const __m256 max_coords = _mm256_set_ps(max_x, max_y, max_x, max_y, max_x, max_y, max_x, max_y);
+
+  for (auto i = 0; i < count; i += 4) {
+    const auto* step_offsets = offsets + i;
+    interpolate::HalfFloatOffsets padded[4];
+
+    // Don't read past the end of the row
+    if (count - i < 4) {
+      copy_tail<4>(step_offsets, count - i, padded);
+      step_offsets = padded;
+    }
+
+    const __m256 coords_offsets = _mm256_cvtph_ps(_mm_loadu_si128((const __m128i*) step_offsets));
+    __m256 coords = _mm256_add_ps(positions, coords_offsets);
+    coords = _mm256_min_ps(_mm256_max_ps(coords, _mm256_setzero_ps()), max_coords);
+
+    interpolate_generated<fetch>(image, coords, output_pixels + i, step_count(i, count));
+
+    positions = _mm256_add_ps(positions, positions_step);
+  }
+}
+
+//
+// Remap plans
+//
+
+// Interpolate 4 output pixels with offsets and weights from a RemapPlan. Only the first `count`
+// output pixels are written.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_planned(const interpolate::BGRImage& image,
+                                       const int32_t offsets[4],
+                                       const interpolate::BilinearWeights weights[4],
+                                       interpolate::BGRPixel output_pixels[4], int count = 4) {
+  if constexpr (fetch == interpolate::Fetch::gather) {
+    // Plans already moved pixels in the last row up a row, so every pixel has a row below
+    const __m128i top = _mm_loadu_si128((const __m128i*) offsets);
+    const __m128i bottom = _mm_add_epi32(top, _mm_set1_epi32(image.step));
+
+    interpolate_gathered(image, top, bottom, _mm256_loadu_si256((const __m256i*) weights),
+                         output_pixels, count);
+    return;
+  }
+
+  const auto* data = (const uint8_t*) image.data;
+  const auto step = image.step;
+
+  const auto* p1 = data + offsets[0];
+  const auto* p2 = data + offsets[1];
+  const auto* p3 = data + offsets[2];
+  const auto* p4 = data + offsets[3];
+
+  // The weights are already in register layout
+  const __m256i pixel_weights = _mm256_loadu_si256((const __m256i*) weights);
+
+  const __m256i pixels_13 = _mm256_set_epi64x(*((int64_t*) (p3 + step)), *((int64_t*) p3),
+                                              *((int64_t*) (p1 + step)), *((int64_t*) p1));
+  const __m256i weights_13 = _mm256_unpacklo_epi64(pixel_weights, pixel_weights);
+
+  const __m256i pixels_24 = _mm256_set_epi64x(*((int64_t*) (p4 + step)), *((int64_t*) p4),
+                                              *((int64_t*) (p2 + step)), *((int64_t*) p2));
+  const __m256i weights_24 = _mm256_unpackhi_epi64(pixel_weights, pixel_weights);
+
+  write_output_pixels(blend_two_pixels(pixels_13, weights_13),
+                      blend_two_pixels(pixels_24, weights_24), output_pixels, count);
+}
+
+// Interpolate a row of output pixels with the offsets and weights from a RemapPlan. Any count is
+// supported.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_plan_row(const interpolate::BGRImage& image,
+                                        const int32_t* offsets,
+                                        const interpolate::BilinearWeights* weights,
+                                        interpolate::BGRPixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 4 <= count; x += 4) {
+    interpolate_planned<fetch>(image, offsets + x, weights + x, output_pixels + x);
+  }
+
+  if (x < count) {
+    int32_t padded_offsets[4];
+    interpolate::BilinearWeights padded_weights[4];
+    copy_tail<4>(offsets + x, count - x, padded_offsets);
+    copy_tail<4>(weights + x, count - x, padded_weights);
+
+    interpolate_planned<fetch>(image, padded_offsets, padded_weights, output_pixels + x,
+                               count - x);
+  }
+}
+
+//
+// Image pyramids
+//
+
+// Load 8 source pixels of a row, pixels 1-4 in the lower 12 bytes of the lower lane and 5-8 in
+// the upper lane.
+static inline __m256i load_downsample_pixels(const uint8_t* pixels) {
+  const __m256i loaded =
+      _mm256_maskload_epi32((const int*) pixels, _mm256_set_epi32(0, 0, -1, -1, -1, -1, -1, -1));
+  return _mm256_permutevar8x32_epi32(loaded, _mm256_set_epi32(5, 5, 4, 3, 2, 2, 1, 0));
+}
+
+// Average the 2x2 blocks of 8 source pixels from two rows, from load_downsample_pixels(), into 4
+// output pixels packed as from pack_output_pixels().
+static inline __m256i downsample_pixels(__m256i top, __m256i bottom) {
+  // The first and second pixel of each block as 16 bit channels, in output order. The upper lane
+  // leaves the lower 2 channels empty, so the lanes can be joined with an OR after packing.
+  const __m256i first = _mm256_set_epi8(-1, 8, -1, 7, -1, 6, -1, 2, -1, 1, -1, 0, -1, -1, -1, -1,
+                                        -1, -1, -1, -1, -1, 8, -1, 7, -1, 6, -1, 2, -1, 1, -1, 0);
+  const __m256i second =
+      _mm256_set_epi8(-1, 11, -1, 10, -1, 9, -1, 5, -1, 4, -1, 3, -1, -1, -1, -1,    //
+                      -1, -1, -1, -1, -1, 11, -1, 10, -1, 9, -1, 5, -1, 4, -1, 3);
+
+  __m256i sums = _mm256_shuffle_epi8(top, first);
+  sums = _mm256_add_epi16(sums, _mm256_shuffle_epi8(top, second));
+  sums = _mm256_add_epi16(sums, _mm256_shuffle_epi8(bottom, first));
+  sums = _mm256_add_epi16(sums, _mm256_shuffle_epi8(bottom, second));
+  sums = _mm256_srli_epi16(_mm256_add_epi16(sums, _mm256_set1_epi16(2)), 2);
+
+  // Output pixels 1-2 in bytes 0-5 of the lower lane, and 3-4 in bytes 2-7 of the upper lane
+  const __m256i packed = _mm256_packus_epi16(sums, _mm256_setzero_si256());
+
+  // Join them in the lower 12 bytes. The 32 bit element 2 of each lane is 0.
+  const __m256i lower =
+      _mm256_permutevar8x32_epi32(packed, _mm256_set_epi32(2, 2, 2, 2, 2, 5, 1, 0));
+  const __m256i upper =
+      _mm256_permutevar8x32_epi32(packed, _mm256_set_epi32(2, 2, 2, 2, 2, 2, 4, 2));
+  return _mm256_or_si256(lower, upper);
+}
+
+// Row y of the image downscaled 2x, see bilinear::plain::downsample_row().
+static inline void downsample_row(const interpolate::BGRImage& image, int y,
+                                  interpolate::BGRPixel* output_pixels, int count) {
+  const auto* top = (const uint8_t*) image.ptr(2 * y, 0);
+  const auto* bottom = (const uint8_t*) image.ptr(2 * y + 1, 0);
+
+  auto x = 0;
+
+  for (; x + 4 <= count; x += 4) {
+    write_output_pixels(downsample_pixels(load_downsample_pixels(top + x * 6),
+                                          load_downsample_pixels(bottom + x * 6)),
+                        output_pixels + x);
+  }
+
+  if (x < count) {
+    // Copy the last source pixels, which are fewer than a step, into zero padded steps
+    alignas(32) uint8_t top_tail[24] = {};
+    alignas(32) uint8_t bottom_tail[24] = {};
+    memcpy(top_tail, top + x * 6, (count - x) * 6);
+    memcpy(bottom_tail, bottom + x * 6, (count - x) * 6);
+
+    write_output_pixels(downsample_pixels(load_downsample_pixels(top_tail),
+                                          load_downsample_pixels(bottom_tail)),
+                        output_pixels + x, count - x);
+  }
+}
+
+// Blend two rows of pixels, see bilinear::plain::blend_row().
+static inline void blend_row(const interpolate::BGRPixel* a, const interpolate::BGRPixel* b,
+                             int weight, interpolate::BGRPixel* output_pixels, int count) {
+  const auto* a_bytes = (const uint8_t*) a;
+  const auto* b_bytes = (const uint8_t*) b;
+  auto* output_bytes = (uint8_t*) output_pixels;
+
+  // The weighted sums are at most 255 * 256 + 128, which fits in unsigned 16 bits
+  const __m256i a_weight = _mm256_set1_epi16(256 - weight);
+  const __m256i b_weight = _mm256_set1_epi16(weight);
+  const __m256i half = _mm256_set1_epi16(128);
+  const __m256i zero = _mm256_setzero_si256();
+
+  auto i = 0;
+
+  for (; i + 32 <= count * 3; i += 32) {
+    const __m256i a_data = _mm256_loadu_si256((const __m256i*) (a_bytes + i));
+    const __m256i b_data = _mm256_loadu_si256((const __m256i*) (b_bytes + i));
+
+    // 16 bit channels, in the same order in each lane as the packus below puts them back
+    const __m256i b_lower = _mm256_unpacklo_epi8(b_data, zero);
+    const __m256i b_upper = _mm256_unpackhi_epi8(b_data, zero);
+
+    __m256i lower = _mm256_mullo_epi16(_mm256_unpacklo_epi8(a_data, zero), a_weight);
+    __m256i upper = _mm256_mullo_epi16(_mm256_unpackhi_epi8(a_data, zero), a_weight);
+    lower = _mm256_add_epi16(lower, _mm256_mullo_epi16(b_lower, b_weight));
+    upper = _mm256_add_epi16(upper, _mm256_mullo_epi16(b_upper, b_weight));
+    lower = _mm256_srli_epi16(_mm256_add_epi16(lower, half), 8);
+    upper = _mm256_srli_epi16(_mm256_add_epi16(upper, half), 8);
+
+    _mm256_storeu_si256((__m256i*) (output_bytes + i), _mm256_packus_epi16(lower, upper));
+  }
+
+  for (; i < count * 3; i++) {
+    output_bytes[i] = uint8_t((a_bytes[i] * (256 - weight) + b_bytes[i] * weight + 128) >> 8);
+  }
+}
+
+//
+// Resizes
+//
+
+// Interpolate 4 adjacent output pixels of a resize from one row of source pixels, see
+// bilinear::plain::resize_row(). Only the first `count` output pixels are written.
+static inline void resize(const uint8_t* row, const int32_t offsets[4],
+                          const interpolate::ResizeWeights weights[4],
+                          interpolate::BGRPixel output_pixels[4], int count = 4) {
+  // The left and right source pixels of 2 output pixels in each lane
+  // (pixel 4) _ _ rgb rgb (pixel 3) _ _ rgb rgb  |  (pixel 2) _ _ rgb rgb (pixel 1) _ _ rgb rgb
+  const __m256i pixels = _mm256_set_epi64x(
+      *((int64_t*) (row + offsets[3])), *((int64_t*) (row + offsets[2])),
+      *((int64_t*) (row + offsets[1])), *((int64_t*) (row + offsets[0])));
+
+  // Each channel of the left and right source pixels next to each other
+  // _ _ r r g g b b  |  _ _ r r g g b b
+  const __m256i mask_shuffle_13 =
+      _mm256_set_epi8(-1, -1, -1, -1, -1, 5, -1, 2, -1, 4, -1, 1, -1, 3, -1, 0,    //
+                      -1, -1, -1, -1, -1, 5, -1, 2, -1, 4, -1, 1, -1, 3, -1, 0);
+  const __m256i mask_shuffle_24 =
+      _mm256_set_epi8(-1, -1, -1, -1, -1, 13, -1, 10, -1, 12, -1, 9, -1, 11, -1, 8,    //
+                      -1, -1, -1, -1, -1, 13, -1, 10, -1, 12, -1, 9, -1, 11, -1, 8);
+
+  // The weights of pixels 1 and 3, and of 2 and 4, broadcast to their lanes
+  // w2 w1 w2 w1 w2 w1 w2 w1  |  w2 w1 w2 w1 w2 w1 w2 w1
+  const __m256i weights_4 = _mm256_castsi128_si256(_mm_loadu_si128((const __m128i*) weights));
+  const __m256i weights_13 =
+      _mm256_permutevar8x32_epi32(weights_4, _mm256_set_epi32(2, 2, 2, 2, 0, 0, 0, 0));
+  const __m256i weights_24 =
+      _mm256_permutevar8x32_epi32(weights_4, _mm256_set_epi32(3, 3, 3, 3, 1, 1, 1, 1));
+
+  // Multiply and add, round to nearest and divide by 256. 32 bpc.
+  // _ r g b  |  _ r g b
+  const __m256i half = _mm256_set1_epi32(128);
+  __m256i pixels_13 =
+      _mm256_madd_epi16(_mm256_shuffle_epi8(pixels, mask_shuffle_13), weights_13);
+  __m256i pixels_24 =
+      _mm256_madd_epi16(_mm256_shuffle_epi8(pixels, mask_shuffle_24), weights_24);
+  pixels_13 = _mm256_srli_epi32(_mm256_add_epi32(pixels_13, half), 8);
+  pixels_24 = _mm256_srli_epi32(_mm256_add_epi32(pixels_24, half), 8);
+
+  // Convert from 32bpc => 16bpc => 8bpc
+  pixels_13 = _mm256_packus_epi32(pixels_13, _mm256_setzero_si256());
+  pixels_13 = _mm256_packus_epi16(pixels_13, _mm256_setzero_si256());
+  pixels_24 = _mm256_packus_epi32(pixels_24, _mm256_setzero_si256());
+  pixels_24 = _mm256_packus_epi16(pixels_24, _mm256_setzero_si256());
+
+  write_output_pixels(pixels_13, pixels_24, output_pixels, count);
+}
+
+// Interpolate a row of output pixels of a resize, see bilinear::plain::resize_row(). Any count
+// is supported.
+static inline void resize_row(const interpolate::BGRPixel* row, const int32_t* offsets,
+                              const interpolate::ResizeWeights* weights,
+                              interpolate::BGRPixel* output_pixels, int count) {
+  const auto* data = (const uint8_t*) row;
+  auto x = 0;
+
+  for (; x + 4 <= count; x += 4) {
+    resize(data, offsets + x, weights + x, output_pixels + x);
+  }
+
+  if (x < count) {
+    int32_t padded_offsets[4];
+    interpolate::ResizeWeights padded_weights[4];
+    copy_tail<4>(offsets + x, count - x, padded_offsets);
+    copy_tail<4>(weights + x, count - x, padded_weights);
+
+    resize(data, padded_offsets, padded_weights, output_pixels + x, count - x);
+  }
+}
+
+//
+// 32bpp
+//
+
+// Masks to spread a pixel's weights from calculate_weights(), in the lower 64 bits of a lane,
+// over the 4 channels of its left and right source pixels: w2 x4 w1 x4 for the top row and
+// w4 x4 w3 x4 for the bottom row.
+#define MASK_WEIGHTS_TOP_HALF _mm_set_epi8(3, 2, 3, 2, 3, 2, 3, 2, 1, 0, 1, 0, 1, 0, 1, 0)
+#define MASK_WEIGHTS_BOTTOM_HALF _mm_set_epi8(7, 6, 7, 6, 7, 6, 7, 6, 5, 4, 5, 4, 5, 4, 5, 4)
+
+// Weighted sums of the left and right source pixels of two 32bpp pixels, 16 bpc in the lower and
+// upper 64 bits of each lane. Each lane holds a pixel's top and bottom source pixel pairs,
+// widened to 16 bpc, and its weights in the lower 64 bits. The weights sum to at most 256, so the
+// sums fit in 16 bits.
+static inline __m256i blend_two_pixels_bgra(__m256i top, __m256i bottom, __m256i weights) {
+  const __m256i mask_top = _mm256_set_m128i(MASK_WEIGHTS_TOP_HALF, MASK_WEIGHTS_TOP_HALF);
+  const __m256i mask_bottom = _mm256_set_m128i(MASK_WEIGHTS_BOTTOM_HALF, MASK_WEIGHTS_BOTTOM_HALF);
+
+  return _mm256_add_epi16(_mm256_mullo_epi16(top, _mm256_shuffle_epi8(weights, mask_top)),
+                          _mm256_mullo_epi16(bottom, _mm256_shuffle_epi8(weights, mask_bottom)));
+}
+
+// Bilinear interpolation of 4 adjacent 32bpp output pixels from the top left source pixel of
+// each, and weights from calculate_weights(). Each row's source pixel pair is one 64 bit load and
+// the pixels stay in 32 bit lanes, so there are no shuffles to unpack or repack 24bpp. Returns
+// the 4 pixels in the lower 128 bits.
+static inline __m256i interpolate_bgra_packed(const interpolate::BGRAImage& image,
+                                              const interpolate::BGRAPixel* const source_pixels[4],
+                                              __m256i weights) {
+  const auto* const* p = source_pixels;
+  const __m256i zero = _mm256_setzero_si256();
+
+  // 4 3  |  2 1
+  const __m256i top = _mm256_set_epi64x(*((int64_t*) p[3]), *((int64_t*) p[2]),
+                                        *((int64_t*) p[1]), *((int64_t*) p[0]));
+  const __m256i bottom =
+      _mm256_set_epi64x(*((int64_t*) image.ptr_below(p[3])), *((int64_t*) image.ptr_below(p[2])),
+                        *((int64_t*) image.ptr_below(p[1])), *((int64_t*) image.ptr_below(p[0])));
+
+  // Pixels 1 and 3 widen from the lower 64 bits of each lane, and 2 and 4 from the upper
+  const __m256i sums_13 = blend_two_pixels_bgra(_mm256_unpacklo_epi8(top, zero),
+                                                _mm256_unpacklo_epi8(bottom, zero),
+                                                _mm256_unpacklo_epi64(weights, weights));
+  const __m256i sums_24 = blend_two_pixels_bgra(_mm256_unpackhi_epi8(top, zero),
+                                                _mm256_unpackhi_epi8(bottom, zero),
+                                                _mm256_unpackhi_epi64(weights, weights));
+
+  // Add the left and right sums and divide by 256. 16 bpc.
+  // 4 3  |  2 1
+  __m256i out = _mm256_add_epi16(_mm256_unpacklo_epi64(sums_13, sums_24),
+                                 _mm256_unpackhi_epi64(sums_13, sums_24));
+  out = _mm256_srli_epi16(out, 8);
+
+  // Convert to 8 bpc
+  // _ _ 4 3  |  _ _ 2 1
+  out = _mm256_packus_epi16(out, zero);
+
+  // _ _ _ _  |  4 3 2 1
+  return _mm256_permute4x64_epi64(out, _MM_SHUFFLE(3, 1, 2, 0));
+}
+
+// Write `count` (1-4) 32bpp output pixels from interpolate_bgra_packed(), as whole 32 bit lanes.
+// Writing fewer than 4 is for the tail of a row.
+static inline void write_output_pixels_bgra(__m256i packed, interpolate::BGRAPixel output_pixels[4],
+                                            int count = 4) {
+  const __m128i pixels = _mm256_castsi256_si128(packed);
+
+  if (count == 4) [[likely]] {
+    _mm_storeu_si128((__m128i*) output_pixels, pixels);
+  } else {
+    const __m128i mask = _mm_cmpgt_epi32(_mm_set1_epi32(count), _mm_set_epi32(3, 2, 1, 0));
+    _mm_maskstore_epi32((int*) output_pixels, mask, pixels);
+  }
+}
+
+// Bilinear interpolation of 4 adjacent 32bpp output pixels with the supplied coordinates and
+// weights from calculate_weights(). Only the first `count` output pixels are written.
+static inline void interpolate_bgra(const interpolate::BGRAImage& image,
+                                    const interpolate::InputCoords input_coords[4],
+                                    __m256i weights, interpolate::BGRAPixel output_pixels[4],
+                                    int count = 4) {
+  const interpolate::BGRAPixel* source_pixels[4];
+
+  for (auto i = 0; i < 4; i++) {
+    source_pixels[i] = image.ptr(input_coords[i].y, input_coords[i].x);
+  }
+
+  write_output_pixels_bgra(interpolate_bgra_packed(image, source_pixels, weights), output_pixels,
+                           count);
+}
+
+// Interpolate a row of 32bpp output pixels. Any count is supported. The last 1-3 pixels go
+// through the same SIMD path with padded coordinates.
+static inline void interpolate_bgra_row(const interpolate::BGRAImage& image,
+                                        const interpolate::InputCoords* input_coords,
+                                        interpolate::BGRAPixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 4 <= count; x += 4) {
+    interpolate_bgra(image, input_coords + x, calculate_weights(&input_coords[x].y),
+                     output_pixels + x);
+  }
+
+  if (x < count) {
+    alignas(32) interpolate::InputCoords padded[4];
+    copy_tail<4>(input_coords + x, count - x, padded);
+
+    interpolate_bgra(image, padded, calculate_weights(&padded[0].y), output_pixels + x,
+                     count - x);
+  }
+}
+
+//
+// 8 bit grayscale
+//
+
+// The top and bottom pairs of source pixels of 8 pixels of an 8 bit image, fetched with one 32
+// bit gather per row, and the fractions of their coordinates as 32 bit ints. A pair of 1 byte
+// pixels is in the lower 2 bytes of its element, and a pair of 2 byte pixels fills it.
+struct GatheredPairs {
+  __m256i top;
+  __m256i bottom;
+  __m256i fx;
+  __m256i fy;
+};
+
+// Fetch the source pixel pairs of 8 pixels, with the coordinates converted to fixed point and
+// rounded to nearest as in the exact mode.
+template <typename Pixel>
+static inline GatheredPairs gather_pairs(const interpolate::Image<Pixel>& image,
+                                         const interpolate::InputCoords input_coords[8]) {
+  static_assert(sizeof(Pixel) == 1 || sizeof(Pixel) == 2, "a pair must fit in 32 bits");
+
+  const __m256 scale = _mm256_set1_ps(float(FIXED_POINT_SCALE));
+  const __m256i mask = _mm256_set1_epi32(FIXED_POINT_MASK);
+
+  // x2 y2 x1 y1 ...
+  const __m256 coords_1234 = _mm256_loadu_ps(&input_coords[0].y);
+  const __m256 coords_5678 = _mm256_loadu_ps(&input_coords[4].y);
+
+  // Separate the y and x coordinates, in the order 8 7 4 3 | 6 5 2 1, then put them in order.
+  // Fixed point, rounded to nearest.
+  const __m256 ys_unordered = _mm256_shuffle_ps(coords_1234, coords_5678, _MM_SHUFFLE(2, 0, 2, 0));
+  const __m256 xs_unordered = _mm256_shuffle_ps(coords_1234, coords_5678, _MM_SHUFFLE(3, 1, 3, 1));
+  const __m256i ys = _mm256_permute4x64_epi64(
+      _mm256_cvtps_epi32(_mm256_mul_ps(ys_unordered, scale)), _MM_SHUFFLE(3, 1, 2, 0));
+  const __m256i xs = _mm256_permute4x64_epi64(
+      _mm256_cvtps_epi32(_mm256_mul_ps(xs_unordered, scale)), _MM_SHUFFLE(3, 1, 2, 0));
+
+  const __m256i rows = _mm256_srai_epi32(ys, FIXED_POINT_BITS);
+  __m256i columns = _mm256_srai_epi32(xs, FIXED_POINT_BITS);
+
+  if constexpr (sizeof(Pixel) == 2) {
+    columns = _mm256_slli_epi32(columns, 1);
+  }
+
+  // Byte offsets of the top left source pixels and of the pixels below them. The last row of the
+  // image is its own row below, as in Image::ptr_below().
+  const __m256i step = _mm256_set1_epi32(image.step);
+  const __m256i top = _mm256_add_epi32(_mm256_mullo_epi32(rows, step), columns);
+  const __m256i has_row_below = _mm256_cmpgt_epi32(_mm256_set1_epi32(image.rows - 1), rows);
+  const __m256i bottom = _mm256_add_epi32(top, _mm256_and_si256(has_row_below, step));
+
+  const auto* data = (const int*) image.data;
+
+  return {_mm256_i32gather_epi32(data, top, 1), _mm256_i32gather_epi32(data, bottom, 1),
+          _mm256_and_si256(xs, mask), _mm256_and_si256(ys, mask)};
+}
+
+// fx, 32 - fx, fx, 32 - fx as bytes, for maddubs with two pairs of bytes
+static inline __m256i gathered_weights_x(__m256i fx) {
+  const __m256i weights = _mm256_or_si256(
+      _mm256_sub_epi32(_mm256_set1_epi32(FIXED_POINT_SCALE), fx), _mm256_slli_epi32(fx, 8));
+
+  return _mm256_or_si256(weights, _mm256_slli_epi32(weights, 16));
+}
+
+// fy, 32 - fy as 16 bit ints, for madd with the top and bottom row sums
+static inline __m256i gathered_weights_y(__m256i fy) {
+  return _mm256_or_si256(_mm256_sub_epi32(_mm256_set1_epi32(FIXED_POINT_SCALE), fy),
+                         _mm256_slli_epi32(fy, 16));
+}
+
+// Weighted sum of the top and bottom row sums, in the lower and upper 16 bits of each element,
+// rounded to nearest. At most 255.
+static inline __m256i blend_row_sums(__m256i row_sums, __m256i weights_y) {
+  const __m256i out = _mm256_add_epi32(_mm256_madd_epi16(row_sums, weights_y),
+                                       _mm256_set1_epi32(1 << (EXACT_WEIGHT_BITS - 1)));
+
+  return _mm256_srli_epi32(out, EXACT_WEIGHT_BITS);
+}
+
+// Interpolate 8 grayscale pixels, rounded as in the exact mode (see
+// bilinear::plain::interpolate_gray()). Returns them as 32 bit ints.
+//
+// One gather per row fetches each pixel's left and right source pixels in the lower 2 bytes of a
+// 32 bit element. The top and bottom pairs share an element, so a single maddubs multiplies them
+// by the 5 bit horizontal weights as bytes, and a madd applies the vertical weights to the two
+// row sums. The separable sum is the same integer as the sum of the four weight products.
+static inline __m256i interpolate_gray_8(const interpolate::GrayImage& image,
+                                         const interpolate::InputCoords input_coords[8]) {
+  const auto pairs = gather_pairs(image, input_coords);
+
+  // bottom right, bottom left, top right, top left as bytes
+  const __m256i pixels =
+      _mm256_blend_epi16(pairs.top, _mm256_slli_epi32(pairs.bottom, 16), 0xaa);
+
+  // Sums of the bottom and top rows, 16 bit. At most 255 * 32, so maddubs doesn't saturate.
+  const __m256i row_sums = _mm256_maddubs_epi16(pixels, gathered_weights_x(pairs.fx));
+
+  return blend_row_sums(row_sums, gathered_weights_y(pairs.fy));
+}
+
+// Interpolate 16 grayscale output pixels. Only the first `count` output pixels are written.
+static inline void interpolate_gray(const interpolate::GrayImage& image,
+                                    const interpolate::InputCoords input_coords[16],
+                                    uint8_t output_pixels[16], int count = 16) {
+  const __m256i pixels_1_8 = interpolate_gray_8(image, input_coords);
+  const __m256i pixels_9_16 = interpolate_gray_8(image, input_coords + 8);
+
+  // Convert from 32 bit => 16 bit, in order
+  // 16-9  |  8-1
+  const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(pixels_1_8, pixels_9_16),
+                                                  _MM_SHUFFLE(3, 1, 2, 0));
+
+  // => 8 bit
+  const __m128i out =
+      _mm_packus_epi16(_mm256_castsi256_si128(packed), _mm256_extracti128_si256(packed, 1));
+
+  if (count == 16) [[likely]] {
+    _mm_storeu_si128((__m128i*) output_pixels, out);
+  } else {
+    alignas(16) uint8_t stored[16];
+    _mm_store_si128((__m128i*) stored, out);
+    memcpy(output_pixels, stored, count);
+  }
+}
+
+// Interpolate a row of grayscale output pixels. Any count is supported. The last 1-15 pixels go
+// through the same SIMD path with padded coordinates.
+static inline void interpolate_gray_row(const interpolate::GrayImage& image,
+                                        const interpolate::InputCoords* input_coords,
+                                        uint8_t* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 16 <= count; x += 16) {
+    interpolate_gray(image, input_coords + x, output_pixels + x);
+  }
+
+  if (x < count) {
+    alignas(32) interpolate::InputCoords padded[16];
+    copy_tail<16>(input_coords + x, count - x, padded);
+
+    interpolate_gray(image, padded, output_pixels + x, count - x);
+  }
+}
+
+// Mask to reorder each gathered pair of U V pixels, u v u v, to u u v v.
+#define MASK_DEINTERLEAVE_UV_HALF                                                                  \
+  _mm_set_epi8(15, 13, 14, 12, 11, 9, 10, 8, 7, 5, 6, 4, 3, 1, 2, 0)
+
+// Interpolate 8 U V pixels of an NV12 chroma plane, rounded as interpolate_gray_8(). Returns
+// u | (v << 8) as 32 bit ints.
+static inline __m256i interpolate_uv_8(const interpolate::UVImage& image,
+                                       const interpolate::InputCoords input_coords[8]) {
+  const auto pairs = gather_pairs(image, input_coords);
+  const __m256i deinterleave =
+      _mm256_set_m128i(MASK_DEINTERLEAVE_UV_HALF, MASK_DEINTERLEAVE_UV_HALF);
+  const __m256i weights_x = gathered_weights_x(pairs.fx);
+
+  // The U and V sums of each row, in the lower and upper 16 bits
+  const __m256i top_sums =
+      _mm256_maddubs_epi16(_mm256_shuffle_epi8(pairs.top, deinterleave), weights_x);
+  const __m256i bottom_sums =
+      _mm256_maddubs_epi16(_mm256_shuffle_epi8(pairs.bottom, deinterleave), weights_x);
+
+  // The top and bottom row sums of U, and of V
+  const __m256i u_sums = _mm256_blend_epi16(top_sums, _mm256_slli_epi32(bottom_sums, 16), 0xaa);
+  const __m256i v_sums = _mm256_blend_epi16(_mm256_srli_epi32(top_sums, 16), bottom_sums, 0xaa);
+
+  const __m256i weights_y = gathered_weights_y(pairs.fy);
+
+  return _mm256_or_si256(blend_row_sums(u_sums, weights_y),
+                         _mm256_slli_epi32(blend_row_sums(v_sums, weights_y), 8));
+}
+
+// Interpolate 16 U V output pixels. Only the first `count` output pixels are written.
+static inline void interpolate_uv(const interpolate::UVImage& image,
+                                  const interpolate::InputCoords input_coords[16],
+                                  interpolate::UVPixel output_pixels[16], int count = 16) {
+  const __m256i pixels_1_8 = interpolate_uv_8(image, input_coords);
+  const __m256i pixels_9_16 = interpolate_uv_8(image, input_coords + 8);
+
+  // Convert from 32 bit => 16 bit, in order
+  const __m256i out = _mm256_permute4x64_epi64(_mm256_packus_epi32(pixels_1_8, pixels_9_16),
+                                               _MM_SHUFFLE(3, 1, 2, 0));
+
+  if (count == 16) [[likely]] {
+    _mm256_storeu_si256((__m256i*) output_pixels, out);
+  } else {
+    alignas(32) uint8_t stored[32];
+    _mm256_store_si256((__m256i*) stored, out);
+    memcpy(output_pixels, stored, count * sizeof(interpolate::UVPixel));
+  }
+}
+
+// Interpolate a row of U V output pixels. Any count is supported. The last 1-15 pixels go
+// through the same SIMD path with padded coordinates.
+static inline void interpolate_uv_row(const interpolate::UVImage& image,
+                                      const interpolate::InputCoords* input_coords,
+                                      interpolate::UVPixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 16 <= count; x += 16) {
+    interpolate_uv(image, input_coords + x, output_pixels + x);
+  }
+
+  if (x < count) {
+    alignas(32) interpolate::InputCoords padded[16];
+    copy_tail<16>(input_coords + x, count - x, padded);
+
+    interpolate_uv(image, padded, output_pixels + x, count - x);
+  }
+}
+
+//
+// 16 bit and float channels
+//
+
+// Mask to shuffle a pair of 16 bpc source pixels, b g r b g r in the lower 12 bytes of a lane, so
+// the left and right values of each channel are adjacent: b b g g r r, then 2 zero words.
+#define MASK_INTERLEAVE_PAIR_16_HALF                                                               \
+  _mm_set_epi8(-1, -1, -1, -1, 11, 10, 5, 4, 9, 8, 3, 2, 7, 6, 1, 0)
+
+// Mask to pack the two 16 bpc pixels of a lane, _ r g b _ r g b, into its lower 12 bytes.
+#define MASK_PACK_PAIR_16_HALF _mm_set_epi8(-1, -1, -1, -1, 13, 12, 11, 10, 9, 8, 5, 4, 3, 2, 1, 0)
+
+// Interpolate two 16 bpc pixels. Each lane holds a pixel's top and bottom pairs of source pixels
+// in the lower 12 bytes of `top` and `bottom`, and its weights from calculate_weights() in the
+// lower 64 bits of `weights`. Returns _ r g b as 32 bit ints in each lane, truncated as
+// interpolate().
+//
+// madd multiplies signed 16 bit ints, so the channels are biased to -32768 - 32767 first, and
+// -32768 times the sum of the weights is subtracted from the 32 bit sums afterwards.
+static inline __m256i blend_two_pixels_16(__m256i top, __m256i bottom, __m256i weights) {
+  const __m256i mask_interleave =
+      _mm256_set_m128i(MASK_INTERLEAVE_PAIR_16_HALF, MASK_INTERLEAVE_PAIR_16_HALF);
+  const __m256i bias = _mm256_set1_epi16(-32768);
+
+  top = _mm256_xor_si256(_mm256_shuffle_epi8(top, mask_interleave), bias);
+  bottom = _mm256_xor_si256(_mm256_shuffle_epi8(bottom, mask_interleave), bias);
+
+  // w2 w1 w2 w1 ... and w4 w3 w4 w3 ...
+  const __m256i weights_top = _mm256_shuffle_epi32(weights, _MM_SHUFFLE(0, 0, 0, 0));
+  const __m256i weights_bottom = _mm256_shuffle_epi32(weights, _MM_SHUFFLE(1, 1, 1, 1));
+
+  __m256i out = _mm256_add_epi32(_mm256_madd_epi16(top, weights_top),
+                                 _mm256_madd_epi16(bottom, weights_bottom));
+  out = _mm256_sub_epi32(out,
+                         _mm256_madd_epi16(bias, _mm256_add_epi16(weights_top, weights_bottom)));
+
+  // Divide by 256
+  return _mm256_srli_epi32(out, 8);
+}
+
+// Bilinear interpolation of 4 adjacent 16 bpc output pixels with the supplied coordinates and
+// weights from calculate_weights(). Each row's source pixel pair is one 16 byte load. Only the
+// first `count` output pixels are written.
+static inline void interpolate_bgr16(const interpolate::BGR16Image& image,
+                                     const interpolate::InputCoords input_coords[4],
+                                     __m256i weights, interpolate::BGR16Pixel output_pixels[4],
+                                     int count = 4) {
+  const interpolate::BGR16Pixel* p[4];
+
+  for (auto i = 0; i < 4; i++) {
+    p[i] = image.ptr(input_coords[i].y, input_coords[i].x);
+  }
+
+  const auto load = [](const interpolate::BGR16Pixel* pixel) {
+    return _mm_loadu_si128((const __m128i*) pixel);
+  };
+
+  // 3  |  1 and 4  |  2
+  const __m256i top_13 = _mm256_set_m128i(load(p[2]), load(p[0]));
+  const __m256i bottom_13 =
+      _mm256_set_m128i(load(image.ptr_below(p[2])), load(image.ptr_below(p[0])));
+  const __m256i top_24 = _mm256_set_m128i(load(p[3]), load(p[1]));
+  const __m256i bottom_24 =
+      _mm256_set_m128i(load(image.ptr_below(p[3])), load(image.ptr_below(p[1])));
+
+  const __m256i sums_13 =
+      blend_two_pixels_16(top_13, bottom_13, _mm256_unpacklo_epi64(weights, weights));
+  const __m256i sums_24 =
+      blend_two_pixels_16(top_24, bottom_24, _mm256_unpackhi_epi64(weights, weights));
+
+  // Convert to 16 bpc, then pack the 4 pixels into the lower 24 bytes
+  // _ r g b _ r g b (4 3)  |  _ r g b _ r g b (2 1)
+  __m256i out = _mm256_packus_epi32(sums_13, sums_24);
+  out = _mm256_shuffle_epi8(out,
+                            _mm256_set_m128i(MASK_PACK_PAIR_16_HALF, MASK_PACK_PAIR_16_HALF));
+  out = _mm256_permutevar8x32_epi32(out, _mm256_set_epi32(7, 3, 6, 5, 4, 2, 1, 0));
+
+  if (count == 4) [[likely]] {
+    _mm256_maskstore_epi32((int*) output_pixels, _mm256_set_epi32(0, 0, -1, -1, -1, -1, -1, -1),
+                           out);
+  } else {
+    alignas(32) uint8_t stored[32];
+    _mm256_store_si256((__m256i*) stored, out);
+    memcpy(output_pixels, stored, count * sizeof(interpolate::BGR16Pixel));
+  }
+}
+
+// Interpolate a row of 16 bpc output pixels. Any count is supported. The last 1-3 pixels go
+// through the same SIMD path with padded coordinates.
+static inline void interpolate_bgr16_row(const interpolate::BGR16Image& image,
+                                         const interpolate::InputCoords* input_coords,
+                                         interpolate::BGR16Pixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 4 <= count; x += 4) {
+    interpolate_bgr16(image, input_coords + x, calculate_weights(&input_coords[x].y),
+                      output_pixels + x);
+  }
+
+  if (x < count) {
+    alignas(32) interpolate::InputCoords padded[4];
+    copy_tail<4>(input_coords + x, count - x, padded);
+
+    interpolate_bgr16(image, padded, calculate_weights(&padded[0].y), output_pixels + x,
+                      count - x);
+  }
+}
+
+// Calculate the float weights for the 4 surrounding pixels of 4 independent y x pairs, from the
+// fractional parts of their coordinates as in calculate_weights(). Returns w1 w2 w3 w4 of pixels
+// 1 and 3 in `weights_13`, and of pixels 2 and 4 in `weights_24`, one pixel per lane.
+static inline void calculate_weights_ps(const float sample_coords[8], __m256& weights_13,
+                                        __m256& weights_24) {
+  const __m256 initial = _mm256_loadu_ps(sample_coords);
+  const __m256 fractional = _mm256_sub_ps(initial, _mm256_floor_ps(initial));
+  const __m256 upper = _mm256_sub_ps(_mm256_set1_ps(1.0f), fractional);
+
+  const auto combine = [](__m256 combined) {
+    // x 1-x x 1-x  times  y y 1-y 1-y
+    return _mm256_mul_ps(_mm256_shuffle_ps(combined, combined, _MM_SHUFFLE(3, 2, 3, 2)),
+                         _mm256_shuffle_ps(combined, combined, _MM_SHUFFLE(1, 1, 0, 0)));
+  };
+
+  // x3 1-x3 y3 1-y3  |  x1 1-x1 y1 1-y1
+  weights_13 = combine(_mm256_unpacklo_ps(upper, fractional));
+  weights_24 = combine(_mm256_unpackhi_ps(upper, fractional));
+}
+
+// Bilinear interpolation of one float output pixel from its top left source pixel, and the
+// weights in lane `lane` of `weights`, from calculate_weights_ps(). Returns _ r g b. Each row's
+// source pixel pair is one 32 byte load, so up to 8 bytes past it are read and not used.
+template <int lane>
+static inline __m128 interpolate_one_pixel_float(const interpolate::BGRFloatImage& image,
+                                                 const interpolate::BGRFloatPixel* pixel,
+                                                 __m256 weights) {
+  constexpr int w = lane * 4;
+
+  // _ _ w2 w2 w2 w1 w1 w1 and _ _ w4 w4 w4 w3 w3 w3
+  const __m256 weights_top = _mm256_permutevar8x32_ps(
+      weights, _mm256_set_epi32(w, w, w + 1, w + 1, w + 1, w, w, w));
+  const __m256 weights_bottom = _mm256_permutevar8x32_ps(
+      weights, _mm256_set_epi32(w, w, w + 3, w + 3, w + 3, w + 2, w + 2, w + 2));
+
+  // _ _ r g b r g b
+  const __m256 top = _mm256_loadu_ps((const float*) pixel);
+  const __m256 bottom = _mm256_loadu_ps((const float*) image.ptr_below(pixel));
+
+  const __m256 sums = _mm256_fmadd_ps(bottom, weights_bottom, _mm256_mul_ps(top, weights_top));
+
+  // Add the right pixel's sums to the left's
+  const __m256 right = _mm256_permutevar8x32_ps(sums, _mm256_set_epi32(7, 7, 7, 7, 6, 5, 4, 3));
+
+  return _mm256_castps256_ps128(_mm256_add_ps(sums, right));
+}
+
+// Bilinear interpolation of 4 adjacent float output pixels with the supplied coordinates. Only
+// the first `count` output pixels are written.
+static inline void interpolate_bgr_float(const interpolate::BGRFloatImage& image,
+                                         const interpolate::InputCoords input_coords[4],
+                                         interpolate::BGRFloatPixel output_pixels[4],
+                                         int count = 4) {
+  __m256 weights_13, weights_24;
+  calculate_weights_ps(&input_coords[0].y, weights_13, weights_24);
+
+  const interpolate::BGRFloatPixel* p[4];
+
+  for (auto i = 0; i < 4; i++) {
+    p[i] = image.ptr(input_coords[i].y, input_coords[i].x);
+  }
+
+  const __m128 pixels[4] = {
+      interpolate_one_pixel_float<0>(image, p[0], weights_13),
+      interpolate_one_pixel_float<0>(image, p[1], weights_24),
+      interpolate_one_pixel_float<1>(image, p[2], weights_13),
+      interpolate_one_pixel_float<1>(image, p[3], weights_24),
+  };
+
+  // Each 16 byte store also writes the next pixel's blue channel, which is overwritten by the
+  // next store. The last pixel is a masked store, so nothing past the output is written.
+  for (auto i = 0; i < count - 1; i++) {
+    _mm_storeu_ps((float*) (output_pixels + i), pixels[i]);
+  }
+
+  _mm_maskstore_ps((float*) (output_pixels + count - 1), _mm_set_epi32(0, -1, -1, -1),
+                   pixels[count - 1]);
+}
+
+// Interpolate a row of float output pixels. Any count is supported. The last 1-3 pixels go
+// through the same SIMD path with padded coordinates.
+static inline void interpolate_bgr_float_row(const interpolate::BGRFloatImage& image,
+                                             const interpolate::InputCoords* input_coords,
+                                             interpolate::BGRFloatPixel* output_pixels,
+                                             int count) {
+  auto x = 0;
+
+  for (; x + 4 <= count; x += 4) {
+    interpolate_bgr_float(image, input_coords + x, output_pixels + x);
+  }
+
+  if (x < count) {
+    alignas(32) interpolate::InputCoords padded[4];
+    copy_tail<4>(input_coords + x, count - x, padded);
+
+    interpolate_bgr_float(image, padded, output_pixels + x, count - x);
+  }
+}
+
+//
+// NV12 to BGR
+//
+
+// Mask to pack the b b b b g g g g r r r r of 4 pixels to b g r b g r b g r b g r.
+#define MASK_PACK_BGR_PLANES_HALF _mm_set_epi8(-1, -1, -1, -1, 11, 7, 3, 10, 6, 2, 9, 5, 1, 8, 4, 0)
+
+// Convert 8 pixels to BGR, bit exact with plain::convert_nv12_row(). `luma` holds the 8 luma
+// pixels and `chroma` the 4 U V pixels of their 2x1 blocks, in the lower 8 bytes. Returns the
+// packed pixels in the lower 24 bytes.
+static inline __m256i convert_nv12_8(__m128i luma, __m128i chroma) {
+  // Luma, and the U and V of each pixel's block, as 32 bit ints
+  const __m256i y = _mm256_max_epi32(
+      _mm256_sub_epi32(_mm256_cvtepu8_epi32(luma), _mm256_set1_epi32(16)), _mm256_setzero_si256());
+  const __m256i u = _mm256_sub_epi32(
+      _mm256_cvtepu8_epi32(_mm_shuffle_epi8(chroma, _mm_set_epi64x(-1, 0x0606040402020000))),
+      _mm256_set1_epi32(128));
+  const __m256i v = _mm256_sub_epi32(
+      _mm256_cvtepu8_epi32(_mm_shuffle_epi8(chroma, _mm_set_epi64x(-1, 0x0707050503030101))),
+      _mm256_set1_epi32(128));
+
+  const __m256i y_round =
+      _mm256_add_epi32(_mm256_mullo_epi32(y, _mm256_set1_epi32(interpolate::YUV_CY)),
+                       _mm256_set1_epi32(1 << (interpolate::YUV_SHIFT - 1)));
+
+  const __m256i b = _mm256_srai_epi32(
+      _mm256_add_epi32(y_round, _mm256_mullo_epi32(u, _mm256_set1_epi32(interpolate::YUV_CUB))),
+      interpolate::YUV_SHIFT);
+  const __m256i g = _mm256_srai_epi32(
+      _mm256_add_epi32(
+          y_round,
+          _mm256_add_epi32(_mm256_mullo_epi32(u, _mm256_set1_epi32(interpolate::YUV_CUG)),
+                           _mm256_mullo_epi32(v, _mm256_set1_epi32(interpolate::YUV_CVG)))),
+      interpolate::YUV_SHIFT);
+  const __m256i r = _mm256_srai_epi32(
+      _mm256_add_epi32(y_round, _mm256_mullo_epi32(v, _mm256_set1_epi32(interpolate::YUV_CVR))),
+      interpolate::YUV_SHIFT);
+
+  // Saturate to 8 bits, b b b b g g g g r r r r r r r r in each lane, then pack the 4 pixels of
+  // each lane and move them to the lower 24 bytes
+  __m256i out = _mm256_packus_epi16(_mm256_packs_epi32(b, g), _mm256_packs_epi32(r, r));
+  out = _mm256_shuffle_epi8(out,
+                            _mm256_set_m128i(MASK_PACK_BGR_PLANES_HALF, MASK_PACK_BGR_PLANES_HALF));
+
+  return _mm256_permutevar8x32_epi32(out, _mm256_set_epi32(7, 3, 6, 5, 4, 2, 1, 0));
+}
+
+// Convert `count` luma pixels, and the U V pixels of their 2x1 blocks, to BGR. Any count is
+// supported. Each step writes 32 bytes, whose last 8 the next step overwrites, until the last
+// steps of the row, which store 24 bytes, and the last 1-7 pixels go through a buffer.
+static inline void convert_nv12_row(const uint8_t* luma, const interpolate::UVPixel* chroma,
+                                    interpolate::BGRPixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 8 <= count; x += 8) {
+    const __m256i out = convert_nv12_8(_mm_loadl_epi64((const __m128i*) (luma + x)),
+                                       _mm_loadl_epi64((const __m128i*) (chroma + x / 2)));
+
+    if (x + 11 <= count) [[likely]] {
+      _mm256_storeu_si256((__m256i*) (output_pixels + x), out);
+    } else {
+      _mm256_maskstore_epi32((int*) (output_pixels + x),
+                             _mm256_set_epi32(0, 0, -1, -1, -1, -1, -1, -1), out);
+    }
+  }
+
+  if (x < count) {
+    const auto tail = count - x;
+    alignas(16) uint8_t padded_luma[16] = {};
+    alignas(16) interpolate::UVPixel padded_chroma[8] = {};
+    memcpy(padded_luma, luma + x, tail);
+    memcpy(padded_chroma, chroma + x / 2, ((tail + 1) / 2) * sizeof(interpolate::UVPixel));
+
+    alignas(32) uint8_t stored[32];
+    _mm256_store_si256((__m256i*) stored,
+                       convert_nv12_8(_mm_load_si128((const __m128i*) padded_luma),
+                                      _mm_load_si128((const __m128i*) padded_chroma)));
+    memcpy(output_pixels + x, stored, tail * sizeof(interpolate::BGRPixel));
+  }
+}
+
+//
+// Borders
+//
+
+// Limits of the y x coordinates of interior source pixels, repeated for 4 pixels: those with a
+// row below, and a column to the right plus the 2 bytes after it that the 8 byte loads read, so
+// they are interpolated without bounds checks.
+static inline __m256 interior_limits(const interpolate::BGRImage& image) {
+  const auto y = float(image.rows - 1);
+  const auto x = float(image.cols - 2);
+
+  return _mm256_set_ps(x, y, x, y, x, y, x, y);
+}
+
+// Whether the source pixels of 4 output pixels are all interior, see interior_limits().
+// Comparisons with NaN are false, so NaN coordinates are never interior.
+static inline bool interior_step(__m256 coords, __m256 limits) {
+  const __m256 above = _mm256_cmp_ps(coords, _mm256_setzero_ps(), _CMP_GE_OQ);
+  const __m256 below = _mm256_cmp_ps(coords, limits, _CMP_LT_OQ);
+
+  return _mm256_movemask_ps(_mm256_and_ps(above, below)) == 0xff;
+}
+
+// Bilinear interpolation of 4 adjacent interior output pixels, as interpolate() without the
+// Image::ptr_below() checks. Only the first `count` output pixels are written.
+static inline void interpolate_interior(const interpolate::BGRImage& image, __m256 coords,
+                                        const interpolate::InputCoords input_coords[4],
+                                        interpolate::BGRPixel output_pixels[4], int count = 4) {
+  const __m256i weights = calculate_weights(coords);
+  const uint8_t* p[4];
+
+  for (auto i = 0; i < 4; i++) {
+    p[i] = (const uint8_t*) image.ptr(input_coords[i].y, input_coords[i].x);
+  }
+
+  const auto step = image.step;
+  const __m256i pixels_13 =
+      _mm256_set_epi64x(*((int64_t*) (p[2] + step)), *((int64_t*) p[2]),
+                        *((int64_t*) (p[0] + step)), *((int64_t*) p[0]));
+  const __m256i pixels_24 =
+      _mm256_set_epi64x(*((int64_t*) (p[3] + step)), *((int64_t*) p[3]),
+                        *((int64_t*) (p[1] + step)), *((int64_t*) p[1]));
+
+  write_output_pixels(blend_two_pixels(pixels_13, _mm256_unpacklo_epi64(weights, weights)),
+                      blend_two_pixels(pixels_24, _mm256_unpackhi_epi64(weights, weights)),
+                      output_pixels, count);
+}
+
+// Rows or columns `index` of an image side of `size` pixels, mapped through the border into the
+// image. For BorderType::constant, indices outside the image are clamped to it, and cleared in
+// `inside`, the mask of the indices in the image.
+template <interpolate::BorderType type>
+static inline __m128i border_index(__m128i index, int size, __m128i& inside) {
+  const __m128i last = _mm_set1_epi32(size - 1);
+
+  if constexpr (type == interpolate::BorderType::reflect) {
+    // Every 2 * size pixels repeat the image then its mirror image. The float division may be
+    // off by one either way, which the remainder is corrected for.
+    const auto period = 2 * size;
+    const __m128i periods = _mm_set1_epi32(period);
+    const __m128 quotient =
+        _mm_floor_ps(_mm_div_ps(_mm_cvtepi32_ps(index), _mm_set1_ps(float(period))));
+
+    index = _mm_sub_epi32(index, _mm_mullo_epi32(_mm_cvtps_epi32(quotient), periods));
+    index = _mm_add_epi32(index, _mm_and_si128(_mm_cmpgt_epi32(_mm_setzero_si128(), index),
+                                               periods));
+    index = _mm_sub_epi32(index, _mm_and_si128(_mm_cmpgt_epi32(index, _mm_set1_epi32(period - 1)),
+                                               periods));
+
+    const __m128i mirrored = _mm_sub_epi32(_mm_set1_epi32(period - 1), index);
+    inside = _mm_set1_epi32(-1);
+
+    return _mm_blendv_epi8(index, mirrored, _mm_cmpgt_epi32(index, last));
+  } else {
+    const __m128i clamped = _mm_min_epi32(_mm_max_epi32(index, _mm_setzero_si128()), last);
+    inside = _mm_cmpeq_epi32(clamped, index);
+
+    return clamped;
+  }
+}
+
+// A pixel in the upper 24 bits of each 32 bit element.
+static inline __m128i broadcast_pixel(const interpolate::BGRPixel& pixel) {
+  return _mm_set1_epi32(int((uint32_t(pixel.b) << 8) | (uint32_t(pixel.g) << 16) |
+                            (uint32_t(pixel.r) << 24)));
+}
+
+// Fetch 4 source pixels at byte offsets from the start of the image, each in the lower 24 bits of
+// a 32 bit element. Each is gathered from the byte before it, so the 32 bit loads never read past
+// the last pixel of the image. The first pixel has no byte before it, so it is masked off the
+// gather and taken from `first_pixel`, and so are BorderType::constant pixels that aren't
+// `inside`, from `border_pixel`. Both are from broadcast_pixel().
+template <interpolate::BorderType type>
+static inline __m128i fetch_border_pixels(const interpolate::BGRImage& image, __m128i offsets,
+                                          __m128i inside, __m128i first_pixel,
+                                          __m128i border_pixel) {
+  __m128i mask = _mm_cmpgt_epi32(offsets, _mm_setzero_si128());
+  __m128i pixels = first_pixel;
+
+  if constexpr (type == interpolate::BorderType::constant) {
+    mask = _mm_and_si128(mask, inside);
+    pixels = _mm_blendv_epi8(border_pixel, first_pixel, inside);
+  }
+
+  pixels = _mm_mask_i32gather_epi32(pixels, (const int*) image.data,
+                                    _mm_sub_epi32(offsets, _mm_set1_epi32(1)), mask, 1);
+
+  return _mm_srli_epi32(pixels, 8);
+}
+
+// Two pixels from fetch_border_pixels() side by side in the lower 48 bits of each 64 bit element,
+// as an 8 byte load of a source pixel and the one to its right.
+// 4 3  |  2 1
+static inline __m256i join_border_pixels(__m128i left, __m128i right) {
+  return _mm256_or_si256(_mm256_cvtepu32_epi64(left),
+                         _mm256_slli_epi64(_mm256_cvtepu32_epi64(right), 24));
+}
+
+// Bilinear interpolation of 4 adjacent output pixels with coordinates anywhere, inside or outside
+// the image, with the source pixels outside it sampled through the border. Each source pixel is a
+// 32 bit gather element from fetch_border_pixels(), so nothing outside the image is read. Only
+// the first `count` output pixels are written.
+template <interpolate::BorderType type>
+static inline void interpolate_edge(const interpolate::BGRImage& image, __m256 coords,
+                                    __m128i first_pixel, __m128i border_pixel,
+                                    interpolate::BGRPixel output_pixels[4], int count = 4) {
+  // max returns its second operand for NaN, so NaN coordinates become the lower limit
+  const __m256 limit = _mm256_set1_ps(interpolate::BORDER_COORDS_LIMIT);
+  coords = _mm256_min_ps(_mm256_max_ps(coords, _mm256_sub_ps(_mm256_setzero_ps(), limit)), limit);
+
+  // Rows in the lower lane and columns in the upper lane
+  const __m256i pack_pairs = _mm256_set_epi32(7, 5, 3, 1, 6, 4, 2, 0);
+  const __m256i floored =
+      _mm256_permutevar8x32_epi32(_mm256_cvtps_epi32(_mm256_floor_ps(coords)), pack_pairs);
+  const __m128i y = _mm256_castsi256_si128(floored);
+  const __m128i x = _mm256_extracti128_si256(floored, 1);
+  const __m128i one = _mm_set1_epi32(1);
+  const __m128i step = _mm_set1_epi32(image.step);
+  const __m128i pixel_size = _mm_set1_epi32(sizeof(interpolate::BGRPixel));
+
+  __m128i top_inside, bottom_inside, left_inside, right_inside;
+  const __m128i top = _mm_mullo_epi32(border_index<type>(y, image.rows, top_inside), step);
+  const __m128i bottom =
+      _mm_mullo_epi32(border_index<type>(_mm_add_epi32(y, one), image.rows, bottom_inside), step);
+  const __m128i left =
+      _mm_mullo_epi32(border_index<type>(x, image.cols, left_inside), pixel_size);
+  const __m128i right = _mm_mullo_epi32(
+      border_index<type>(_mm_add_epi32(x, one), image.cols, right_inside), pixel_size);
+
+  const auto fetch = [&](__m128i row, __m128i row_inside, __m128i col, __m128i col_inside) {
+    return fetch_border_pixels<type>(image, _mm_add_epi32(row, col),
+                                     _mm_and_si128(row_inside, col_inside), first_pixel,
+                                     border_pixel);
+  };
+
+  const __m256i top_pixels = join_border_pixels(fetch(top, top_inside, left, left_inside),
+                                                fetch(top, top_inside, right, right_inside));
+  const __m256i bottom_pixels =
+      join_border_pixels(fetch(bottom, bottom_inside, left, left_inside),
+                         fetch(bottom, bottom_inside, right, right_inside));
+
+  const __m256i weights = calculate_weights(coords);
+  const __m256i pixels_13 = _mm256_unpacklo_epi64(top_pixels, bottom_pixels);
+  const __m256i pixels_24 = _mm256_unpackhi_epi64(top_pixels, bottom_pixels);
+
+  write_output_pixels(blend_two_pixels(pixels_13, _mm256_unpacklo_epi64(weights, weights)),
+                      blend_two_pixels(pixels_24, _mm256_unpackhi_epi64(weights, weights)),
+                      output_pixels, count);
+}
+
+// Interpolate a row of output pixels with any coordinates, see Kernels::bilinear_border_row. Each
+// step of 4 pixels is classified once: interior steps go through interpolate_interior(), and the
+// rest through interpolate_edge(). The last 1-3 pixels go through the same paths with padded
+// coordinates.
+template <interpolate::BorderType type>
+static inline void interpolate_border_row(const interpolate::BGRImage& image,
+                                          const interpolate::InputCoords* input_coords,
+                                          interpolate::BGRPixel* output_pixels, int count,
+                                          const interpolate::Border& border) {
+  const __m256 limits = interior_limits(image);
+  const __m128i first_pixel = broadcast_pixel(*image.data);
+  const __m128i border_pixel = broadcast_pixel(border.value);
+
+  const auto interpolate_step = [&](const interpolate::InputCoords* step_coords,
+                                    interpolate::BGRPixel* step_output, int step_count) {
+    const __m256 coords = _mm256_loadu_ps(&step_coords[0].y);
+
+    if (interior_step(coords, limits)) [[likely]] {
+      interpolate_interior(image, coords, step_coords, step_output, step_count);
+    } else {
+      interpolate_edge<type>(image, coords, first_pixel, border_pixel, step_output, step_count);
+    }
+  };
+
+  auto x = 0;
+
+  for (; x + 4 <= count; x += 4) {
+    interpolate_step(input_coords + x, output_pixels + x, 4);
+  }
+
+  if (x < count) {
+    alignas(32) interpolate::InputCoords padded[4];
+    copy_tail<4>(input_coords + x, count - x, padded);
+
+    interpolate_step(padded, output_pixels + x, count - x);
+  }
+}
+
+static inline void interpolate_border_row(const interpolate::BGRImage& image,
+                                          const interpolate::InputCoords* input_coords,
+                                          interpolate::BGRPixel* output_pixels, int count,
+                                          const interpolate::Border& border) {
+  switch (border.type) {
+    case interpolate::BorderType::constant:
+      interpolate_border_row<interpolate::BorderType::constant>(image, input_coords,
+                                                                output_pixels, count, border);
+      break;
+    case interpolate::BorderType::replicate:
+      interpolate_border_row<interpolate::BorderType::replicate>(image, input_coords,
+                                                                 output_pixels, count, border);
+      break;
+    case interpolate::BorderType::reflect:
+      interpolate_border_row<interpolate::BorderType::reflect>(image, input_coords,
+                                                               output_pixels, count, border);
+      break;
+  }
 }
 
 }    // namespace interpolate::bilinear::avx2
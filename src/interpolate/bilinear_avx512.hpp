@@ -2,6 +2,8 @@
 
 #include <immintrin.h>
 
+#include "interpolate/streaming.hpp"
+#include "interpolate/tail.hpp"
 #include "interpolate/types.hpp"
 
 namespace interpolate::bilinear::avx512
@@ -11,32 +13,19 @@ namespace interpolate::bilinear::avx512
 // Weights
 //
 
-static const __m512i WEIGHTS_Y_SHUFFLE =
-    _mm512_set_epi8(11, 10, 11, 10, 9, 8, 9, 8, 3, 2, 3, 2, 1, 0, 1, 0,
-                    // Repeated
-                    11, 10, 11, 10, 9, 8, 9, 8, 3, 2, 3, 2, 1, 0, 1, 0,
-                    // Repeated
-                    11, 10, 11, 10, 9, 8, 9, 8, 3, 2, 3, 2, 1, 0, 1, 0,
-                    // Repeated
-                    11, 10, 11, 10, 9, 8, 9, 8, 3, 2, 3, 2, 1, 0, 1, 0);
-
-static inline __m512i calculate_weights(const float sample_coords[16]) {
-  const __m512 initial = _mm512_load_ps(sample_coords);
-
-  const __m512 floored = _mm512_floor_ps(initial);
-  const __m512 fractional = _mm512_sub_ps(initial, floored);
-
-  // Convert fractional parts to 32 bit ints in range 0-256
-  // ... | x2 y2 x1 y1
-  __m512i lower = _mm512_cvtps_epi32(_mm512_mul_ps(fractional, _mm512_set1_ps(256.0f)));
-
-  // Convert to 16 bit ints
-  // ... | 0 0 0 0 x2 y2 x1 y1
-  lower = _mm512_packs_epi32(lower, _mm512_set1_epi32(0));
+// Shuffle for the y weights, repeated in each 128 bit lane.
+#define WEIGHTS_Y_SHUFFLE_SINGLE_LANE 11, 10, 11, 10, 9, 8, 9, 8, 3, 2, 3, 2, 1, 0, 1, 0
 
+// Calculate the per pixel weights of 8 independent xy pairs from the fractional parts of their
+// coordinates as 16 bit ints in the range 0-256. Each 128 bit lane holds 2 pixels in its lower
+// 64 bits, in order. The upper 64 bits of each lane are ignored.
+// Eg: ... | _ _ _ _ x2 y2 x1 y1
+// Fractions with fewer than 8 bits give the exact products as weights, see EXACT_WEIGHT_BITS.
+template <int fraction_bits = 8>
+static inline __m512i combine_weights(__m512i lower) {
   // Subtract each value from 256
-  // ... | 256 256 256 256 1-x2 1-y2 1-x1 1-y1
-  const __m512i upper = _mm512_sub_epi16(_mm512_set1_epi16(256), lower);
+  // ... | _ _ _ _ 1-x2 1-y2 1-x1 1-y1
+  const __m512i upper = _mm512_sub_epi16(_mm512_set1_epi16(1 << fraction_bits), lower);
 
   // Combine all the weights into a single vector
   // ... | 1-y2  1-x1 x1  1-y1 y1
@@ -48,60 +37,112 @@ static inline __m512i calculate_weights(const float sample_coords[16]) {
 
   // y weights
   // ... | ...(1-y2)  y1 y1 (1-y1) (1-y1)
-  __m512i weights_y = _mm512_shuffle_epi8(combined, WEIGHTS_Y_SHUFFLE);
+  const __m512i weights_y_shuffle =
+      _mm512_set_epi8(WEIGHTS_Y_SHUFFLE_SINGLE_LANE, WEIGHTS_Y_SHUFFLE_SINGLE_LANE,
+                      WEIGHTS_Y_SHUFFLE_SINGLE_LANE, WEIGHTS_Y_SHUFFLE_SINGLE_LANE);
+  __m512i weights_y = _mm512_shuffle_epi8(combined, weights_y_shuffle);
 
-  // Multiply to get final per pixel weights. Divide by 256 to get back into correct range.
+  // Multiply to get final per pixel weights.
   // ... | ... (x2/y2)  w4 w3 w2 w1 (x1/y1)
   __m512i weights = _mm512_mullo_epi16(weights_x, weights_y);
-  weights = _mm512_srli_epi16(weights, 8);
 
-  // If both weights were 256, the result is 65536 which is all 0s in the lower 16 bits.
-  // Find the weights this happened to, and replace them with 256.
-  __m512i weights_hi = _mm512_mulhi_epi16(weights_x, weights_y);
-  __mmask32 weights_hi_mask = _mm512_cmpgt_epi16_mask(weights_hi, _mm512_setzero_si512());
-  weights = _mm512_mask_blend_epi16(weights_hi_mask, weights, _mm512_set1_epi16(256));
+  if constexpr (fraction_bits == 8) {
+    // Divide by 256 to get back into correct range.
+    weights = _mm512_srli_epi16(weights, 8);
+
+    // If both weights were 256, the result is 65536 which is all 0s in the lower 16 bits.
+    // Find the weights this happened to, and replace them with 256.
+    __m512i weights_hi = _mm512_mulhi_epi16(weights_x, weights_y);
+    __mmask32 weights_hi_mask = _mm512_cmpgt_epi16_mask(weights_hi, _mm512_setzero_si512());
+    weights = _mm512_mask_blend_epi16(weights_hi_mask, weights, _mm512_set1_epi16(256));
+  }
 
   return weights;
 }
 
+static inline __m512i calculate_weights(__m512 initial) {
+  const __m512 floored = _mm512_floor_ps(initial);
+  const __m512 fractional = _mm512_sub_ps(initial, floored);
+
+  // Convert fractional parts to 32 bit ints in range 0-256
+  // ... | x2 y2 x1 y1
+  __m512i lower = _mm512_cvtps_epi32(_mm512_mul_ps(fractional, _mm512_set1_ps(256.0f)));
+
+  // Convert to 16 bit ints
+  // ... | 0 0 0 0 x2 y2 x1 y1
+  lower = _mm512_packs_epi32(lower, _mm512_set1_epi32(0));
+
+  return combine_weights(lower);
+}
+
+// Rows of coordinates can start anywhere when the output width is arbitrary, so the load is
+// unaligned.
+static inline __m512i calculate_weights(const float sample_coords[16]) {
+  return calculate_weights(_mm512_loadu_ps(sample_coords));
+}
+
 // Masks to shuffle initial pixel data from packed 24bpp to 64bpp (16bpc) in each lane.
 // Eg, a 128 bit lane with the following data:
 // (16 other bits) rgb rgb (16 other bits) rgb rgb
 // Becomes:
 // g g g g b b b b
+//
+// The masks are built inside the functions that use them rather than as static vectors, so no
+// AVX512 instructions run during static initialisation on CPUs without AVX512.
 
 // Blue and green channels.
 #define MASK_SHUFFLE_BG_SINGLE_LANE -1, 12, -1, 9, -1, 4, -1, 1, -1, 11, -1, 8, -1, 3, -1, 0
-static const __m512i MASK_SHUFFLE_BG =
-    _mm512_set_epi8(MASK_SHUFFLE_BG_SINGLE_LANE, MASK_SHUFFLE_BG_SINGLE_LANE,
-                    MASK_SHUFFLE_BG_SINGLE_LANE, MASK_SHUFFLE_BG_SINGLE_LANE);
 
 // Red channel. The upper half of each 128 bit lane is not used.
 #define MASK_SHUFFLE_R0_SINGLE_LANE -1, -1, -1, -1, -1, -1, -1, -1, -1, 13, -1, 10, -1, 5, -1, 2
-static const __m512i MASK_SHUFFLE_R0 =
-    _mm512_set_epi8(MASK_SHUFFLE_R0_SINGLE_LANE, MASK_SHUFFLE_R0_SINGLE_LANE,
-                    MASK_SHUFFLE_R0_SINGLE_LANE, MASK_SHUFFLE_R0_SINGLE_LANE);
+
+// With VNNI, the top and bottom source pixels are shuffled separately instead, so the
+// multiply-adds of the two rows accumulate straight into one sum per channel.
+// _ _ r r g g b b
+#define MASK_SHUFFLE_TOP_SINGLE_LANE -1, -1, -1, -1, -1, 5, -1, 2, -1, 4, -1, 1, -1, 3, -1, 0
+#define MASK_SHUFFLE_BOTTOM_SINGLE_LANE -1, -1, -1, -1, -1, 13, -1, 10, -1, 12, -1, 9, -1, 11, -1, 8
 
 //
 // Interpolation
 //
 
-static inline __m512i interpolate_four_pixels(const interpolate::BGRImage& image,
-                                              const interpolate::InputCoords input_coords[7],
-                                              __m512i weights) {
-  // Load pixel data
-  const auto* p1 = image.ptr(input_coords[0].y, input_coords[0].x);
-  const auto* p2 = image.ptr(input_coords[2].y, input_coords[2].x);
-  const auto* p3 = image.ptr(input_coords[4].y, input_coords[4].x);
-  const auto* p4 = image.ptr(input_coords[6].y, input_coords[6].x);
+// Interpolate four pixels from their source pixel data. Each 128 bit lane holds the top and
+// bottom rows of a pixel's source pixels in its lower and upper 64 bits. The result is in the
+// format write_output_pixels() takes: an 8 bpc pixel in the lower 32 bits of each lane, or with
+// VBMI the 32 bpc sums before dividing by 256. 8 bit weights truncate the weighted sums, and
+// EXACT_WEIGHT_BITS weights round them to nearest.
+template <int weight_bits = 8>
+static inline __m512i blend_four_pixels(__m512i pixels, __m512i weights) {
+#ifdef __AVX512VNNI__
+  const __m512i mask_shuffle_top =
+      _mm512_set_epi8(MASK_SHUFFLE_TOP_SINGLE_LANE, MASK_SHUFFLE_TOP_SINGLE_LANE,
+                      MASK_SHUFFLE_TOP_SINGLE_LANE, MASK_SHUFFLE_TOP_SINGLE_LANE);
+  const __m512i mask_shuffle_bottom =
+      _mm512_set_epi8(MASK_SHUFFLE_BOTTOM_SINGLE_LANE, MASK_SHUFFLE_BOTTOM_SINGLE_LANE,
+                      MASK_SHUFFLE_BOTTOM_SINGLE_LANE, MASK_SHUFFLE_BOTTOM_SINGLE_LANE);
 
-  __m512i pixels = _mm512_set_epi64(*((int64_t*) image.ptr_below(p4)), *((int64_t*) p4),
-                                    *((int64_t*) image.ptr_below(p3)), *((int64_t*) p3),
-                                    *((int64_t*) image.ptr_below(p2)), *((int64_t*) p2),
-                                    *((int64_t*) image.ptr_below(p1)), *((int64_t*) p1));
+  const __m512i pixels_top = _mm512_shuffle_epi8(pixels, mask_shuffle_top);
+  const __m512i pixels_bottom = _mm512_shuffle_epi8(pixels, mask_shuffle_bottom);
+
+  // ... | w2 w1 w2 w1 w2 w1 w2 w1
+  const __m512i weights_top = _mm512_shuffle_epi32(weights, _MM_PERM_AAAA);
+  // ... | w4 w3 w4 w3 w4 w3 w4 w3
+  const __m512i weights_bottom = _mm512_shuffle_epi32(weights, _MM_PERM_BBBB);
+
+  // Multiply and add the top row, then the bottom row. 32 bpc.
+  // ... | _ r g b
+  __m512i out = _mm512_madd_epi16(pixels_top, weights_top);
+  out = _mm512_dpwssd_epi32(out, pixels_bottom, weights_bottom);
+#else
+  const __m512i mask_shuffle_bg =
+      _mm512_set_epi8(MASK_SHUFFLE_BG_SINGLE_LANE, MASK_SHUFFLE_BG_SINGLE_LANE,
+                      MASK_SHUFFLE_BG_SINGLE_LANE, MASK_SHUFFLE_BG_SINGLE_LANE);
+  const __m512i mask_shuffle_r0 =
+      _mm512_set_epi8(MASK_SHUFFLE_R0_SINGLE_LANE, MASK_SHUFFLE_R0_SINGLE_LANE,
+                      MASK_SHUFFLE_R0_SINGLE_LANE, MASK_SHUFFLE_R0_SINGLE_LANE);
 
-  __m512i pixels_bg = _mm512_shuffle_epi8(pixels, MASK_SHUFFLE_BG);
-  __m512i pixels_r0 = _mm512_shuffle_epi8(pixels, MASK_SHUFFLE_R0);
+  __m512i pixels_bg = _mm512_shuffle_epi8(pixels, mask_shuffle_bg);
+  __m512i pixels_r0 = _mm512_shuffle_epi8(pixels, mask_shuffle_r0);
 
   // Multiply with the pixel data and sum adjacent pairs to 32 bit ints
   // ... | g g b b
@@ -119,58 +160,155 @@ static inline __m512i interpolate_four_pixels(const interpolate::BGRImage& image
   // Add adjacent pairs again. 32 bpc.
   // ... | _ r g b
   __m512i out = _mm512_unpacklo_epi64(result_bg, result_r0);
+#endif
 
+  if constexpr (weight_bits != 8) {
+    // Round to nearest, and scale so the result is the sum divided by 256 like the 8 bit mode
+    out = _mm512_add_epi32(out, _mm512_set1_epi32(1 << (weight_bits - 1)));
+    out = _mm512_srli_epi32(out, weight_bits - 8);
+  }
+
+#ifndef __AVX512VBMI__
   // Divide by 256 to get back into correct range.
   out = _mm512_srli_epi32(out, 8);
 
   // Convert from 32bpc => 16bpc => 8bpc
   out = _mm512_packus_epi32(out, _mm512_setzero_si512());
   out = _mm512_packus_epi16(out, _mm512_setzero_si512());
+#endif
 
   return out;
 }
 
+// Interpolate four pixels from the top left source pixel of each.
+template <int weight_bits = 8>
+static inline __m512i interpolate_four_pixels(const interpolate::BGRImage& image,
+                                              const interpolate::BGRPixel* p1,
+                                              const interpolate::BGRPixel* p2,
+                                              const interpolate::BGRPixel* p3,
+                                              const interpolate::BGRPixel* p4, __m512i weights) {
+  // Load pixel data
+  __m512i pixels = _mm512_set_epi64(*((int64_t*) image.ptr_below(p4)), *((int64_t*) p4),
+                                    *((int64_t*) image.ptr_below(p3)), *((int64_t*) p3),
+                                    *((int64_t*) image.ptr_below(p2)), *((int64_t*) p2),
+                                    *((int64_t*) image.ptr_below(p1)), *((int64_t*) p1));
+
+  return blend_four_pixels<weight_bits>(pixels, weights);
+}
+
 // Slightly faster than memcpy
 static inline void memcpy_12(uint8_t* dst, const uint8_t* src) {
   *((uint64_t*) dst) = *((uint64_t*) src);
   *((uint32_t*) (dst + 8)) = *((uint32_t*) (src + 8));
 }
 
-static inline void write_output_pixels(__m512i pixels_1357, __m512i pixels_2468,
-                                       interpolate::BGRPixel output_pixels[8]) {
-
+#ifdef __AVX512VBMI__
+// Pack 8 interpolated pixels into packed 24bpp in the lower 24 bytes.
+static inline __m512i pack_output_pixels(__m512i pixels_1357, __m512i pixels_2468) {
+  // The sums are below 65536, so the second byte of each is the sum divided by 256. Pick those
+  // bytes out of both vectors and pack them into the lower 24 bytes in one instruction.
+  const __m512i pack = _mm512_set_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,    //
+                                       0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,    //
+                                       0, 0, 0, 0, 0, 0, 0, 0,                            //
+                                       121, 117, 113, 57, 53, 49,                         // 8, 7
+                                       105, 101, 97, 41, 37, 33,                          // 6, 5
+                                       89, 85, 81, 25, 21, 17,                            // 4, 3
+                                       73, 69, 65, 9, 5, 1                                // 2, 1
+  );
+  return _mm512_permutex2var_epi8(pixels_1357, pack, pixels_2468);
+}
+#else
+// Pack 8 interpolated pixels into packed 24bpp in the lower 96 bits of two lanes.
+// (unused) | _ 8 7 6 5 | (unused) | _ 4 3 2 1
+static inline __m512i combine_output_pixels(__m512i pixels_1357, __m512i pixels_2468) {
   // Unpack to get adjacent pixel data in lower 64 bits of each lane
   // _ _ 8 7 | _ _ 6 5 | _ _ 4 3 | _ _ 2 1
   __m512i combined = _mm512_unpacklo_epi32(pixels_1357, pixels_2468);
 
-  // If AVX512 VBMI was available, _mm512_permutexvar_epi8 could pack
-  // all the pixels into the lower 24 bytes in one instruction.
-
   // (unused) | 8 7 6 5 | (unused) | 4 3 2 1
   combined = _mm512_permutex_epi64(combined, _MM_SHUFFLE(3, 3, 2, 0));
 
   // Pack the pixels into the lower 96 bits of lanes 1 and 3
-  // (unused) | _ 8 7 6 5 | (unused) | _ 4 3 2 1
-  combined = _mm512_shuffle_epi8(combined,
-                                 _mm512_set_epi8(-1, -1, -1, -1, -1, -1, -1, -1,    // unused
-                                                 -1, -1, -1, -1, -1, -1, -1, -1,    // unused
-                                                 -1, -1, -1, -1,                    // unused
-                                                 30, 29, 28, 26, 25, 24,            // 8, 7
-                                                 22, 21, 20, 18, 17, 16,            // 6, 5
-                                                 -1, -1, -1, -1, -1, -1, -1, -1,    // unused
-                                                 -1, -1, -1, -1, -1, -1, -1, -1,    // unused
-                                                 -1, -1, -1, -1,                    // unused
-                                                 14, 13, 12, 10, 9, 8,              // 4, 3
-                                                 6, 5, 4, 2, 1, 0                   // 2, 1
-                                                 ));
+  return _mm512_shuffle_epi8(combined,
+                             _mm512_set_epi8(-1, -1, -1, -1, -1, -1, -1, -1,    // unused
+                                             -1, -1, -1, -1, -1, -1, -1, -1,    // unused
+                                             -1, -1, -1, -1,                    // unused
+                                             30, 29, 28, 26, 25, 24,            // 8, 7
+                                             22, 21, 20, 18, 17, 16,            // 6, 5
+                                             -1, -1, -1, -1, -1, -1, -1, -1,    // unused
+                                             -1, -1, -1, -1, -1, -1, -1, -1,    // unused
+                                             -1, -1, -1, -1,                    // unused
+                                             14, 13, 12, 10, 9, 8,              // 4, 3
+                                             6, 5, 4, 2, 1, 0                   // 2, 1
+                                             ));
+}
+
+// Pack 8 interpolated pixels into packed 24bpp in the lower 24 bytes.
+static inline __m512i pack_output_pixels(__m512i pixels_1357, __m512i pixels_2468) {
+  // Move pixels 5-8 next to pixels 1-4
+  // (unused) | 8 7 6 5 4 3 2 1
+  return _mm512_permutexvar_epi32(
+      _mm512_set_epi32(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 10, 9, 8, 2, 1, 0),
+      combine_output_pixels(pixels_1357, pixels_2468));
+}
+#endif
+
+// Write `count` (1-8) output pixels. Writing fewer than 8 is for the tail of a row.
+static inline void write_output_pixels(__m512i pixels_1357, __m512i pixels_2468,
+                                       interpolate::BGRPixel output_pixels[8], int count = 8) {
+  const auto mask = __mmask64((1ull << (count * sizeof(interpolate::BGRPixel))) - 1);
+
+#ifdef __AVX512VBMI__
+  _mm512_mask_storeu_epi8(output_pixels, mask, pack_output_pixels(pixels_1357, pixels_2468));
+#else
+  if (count < 8) [[unlikely]] {
+    // Only store the bytes of `count` pixels
+    _mm512_mask_storeu_epi8(output_pixels, mask, pack_output_pixels(pixels_1357, pixels_2468));
+    return;
+  }
 
   // Store pixel data
   alignas(64) uint8_t stored[64];
-  _mm512_store_si512((__m512i*) stored, combined);
+  _mm512_store_si512((__m512i*) stored, combine_output_pixels(pixels_1357, pixels_2468));
 
   // Write pixel data back to image.
   memcpy_12((uint8_t*) output_pixels, stored);
   memcpy_12((uint8_t*) (output_pixels + 4), stored + 32);
+#endif
+}
+
+// Bilinear interpolation of 8 adjacent output pixels from the top left source pixel of each,
+// and weights from calculate_weights(). Only the first `count` output pixels are written.
+template <int weight_bits = 8>
+static inline void interpolate(const interpolate::BGRImage& image,
+                               const interpolate::BGRPixel* const source_pixels[8],
+                               __m512i weights, interpolate::BGRPixel output_pixels[8],
+                               int count = 8) {
+  const auto* const* p = source_pixels;
+
+  const __m512i weights_1357 = _mm512_unpacklo_epi64(weights, weights);
+  const __m512i pixels_1357 =
+      interpolate_four_pixels<weight_bits>(image, p[0], p[2], p[4], p[6], weights_1357);
+
+  const __m512i weights_2468 = _mm512_unpackhi_epi64(weights, weights);
+  const __m512i pixels_2468 =
+      interpolate_four_pixels<weight_bits>(image, p[1], p[3], p[5], p[7], weights_2468);
+
+  write_output_pixels(pixels_1357, pixels_2468, output_pixels, count);
+}
+
+// Bilinear interpolation of 8 adjacent output pixels with the supplied coordinates and weights
+// from calculate_weights(). Only the first `count` output pixels are written.
+static inline void interpolate(const interpolate::BGRImage& image,
+                               const interpolate::InputCoords input_coords[8], __m512i weights,
+                               interpolate::BGRPixel output_pixels[8], int count = 8) {
+  const interpolate::BGRPixel* source_pixels[8];
+
+  for (auto i = 0; i < 8; i++) {
+    source_pixels[i] = image.ptr(input_coords[i].y, input_coords[i].x);
+  }
+
+  interpolate(image, source_pixels, weights, output_pixels, count);
 }
 
 // Bilinear interpolation of 8 adjacent output pixels with the supplied coordinates using AVX512.
@@ -180,13 +318,1567 @@ static inline void interpolate(const interpolate::BGRImage& image,
 
   const __m512i weights = calculate_weights(&input_coords[0].y);
 
+  interpolate(image, input_coords, weights, output_pixels);
+}
+
+//
+// Hardware gathers
+//
+
+// Byte offsets from the start of the image of the top left source pixel of 8 pixels, and of
+// the pixel below it, from y x coordinates as 32 bit ints. The last row of the image is its own
+// row below, as in BGRImage::ptr_below().
+static inline void source_offsets(const interpolate::BGRImage& image, __m512i coords,
+                                  __m256i& top, __m256i& bottom) {
+  // y * step + x * 3 in the lower 32 bits of each pair
+  __m512i offsets = _mm512_mullo_epi32(coords, _mm512_set1_epi64((3ll << 32) | image.step));
+  offsets = _mm512_add_epi32(offsets, _mm512_srli_epi64(offsets, 32));
+  top = _mm512_cvtepi64_epi32(offsets);
+
+  const __m256i ys = _mm512_cvtepi64_epi32(coords);
+  const __mmask8 has_row_below = _mm256_cmplt_epi32_mask(ys, _mm256_set1_epi32(image.rows - 1));
+  bottom = _mm256_mask_add_epi32(top, has_row_below, top, _mm256_set1_epi32(image.step));
+}
+
+// Bilinear interpolation of 8 adjacent output pixels, fetching the top and bottom source pixels
+// of each with one gather per row. Offsets are in bytes from the start of the image. Only the
+// first `count` output pixels are written.
+template <int weight_bits = 8>
+static inline void interpolate_gathered(const interpolate::BGRImage& image, __m256i top,
+                                        __m256i bottom, __m512i weights,
+                                        interpolate::BGRPixel output_pixels[8], int count = 8) {
+  // 8 7 6 5 4 3 2 1
+  const __m512i top_pixels = _mm512_i32gather_epi64(top, image.data, 1);
+  const __m512i bottom_pixels = _mm512_i32gather_epi64(bottom, image.data, 1);
+
+  const __m512i pixels_1357 = _mm512_unpacklo_epi64(top_pixels, bottom_pixels);
   const __m512i weights_1357 = _mm512_unpacklo_epi64(weights, weights);
-  const __m512i pixels_1357 = interpolate_four_pixels(image, input_coords, weights_1357);
 
+  const __m512i pixels_2468 = _mm512_unpackhi_epi64(top_pixels, bottom_pixels);
   const __m512i weights_2468 = _mm512_unpackhi_epi64(weights, weights);
-  const __m512i pixels_2468 = interpolate_four_pixels(image, input_coords + 1, weights_2468);
 
-  write_output_pixels(pixels_1357, pixels_2468, output_pixels);
+  write_output_pixels(blend_four_pixels<weight_bits>(pixels_1357, weights_1357),
+                      blend_four_pixels<weight_bits>(pixels_2468, weights_2468), output_pixels,
+                      count);
+}
+
+// Bilinear interpolation of 8 adjacent output pixels from their y x coordinates, with the
+// addresses calculated in registers and the source pixels fetched with gathers.
+static inline void interpolate_gathered(const interpolate::BGRImage& image, __m512 coords,
+                                        interpolate::BGRPixel output_pixels[8], int count = 8) {
+  // Coordinates are never negative, so truncating floors them
+  __m256i top, bottom;
+  source_offsets(image, _mm512_cvttps_epi32(coords), top, bottom);
+
+  interpolate_gathered(image, top, bottom, calculate_weights(coords), output_pixels, count);
+}
+
+// Mask for the first `count` 16 bit elements of a step, for masked loads of a row's tail.
+static inline __mmask16 tail_mask_16(int count) { return __mmask16((1u << count) - 1); }
+
+// Interpolate a row of output pixels. Any count is supported. The last 1-7 pixels go through
+// the same SIMD path with masked loads and stores.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_row(const interpolate::BGRImage& image,
+                                   const interpolate::InputCoords* input_coords,
+                                   interpolate::BGRPixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 8 <= count; x += 8) {
+    if constexpr (fetch == interpolate::Fetch::gather) {
+      interpolate_gathered(image, _mm512_loadu_ps(input_coords + x), output_pixels + x);
+    } else {
+      interpolate(image, input_coords + x, output_pixels + x);
+    }
+  }
+
+  if (x < count) {
+    // Masked off coordinates load as (0, 0), which is a valid pixel to read
+    const __m512 coords = _mm512_maskz_loadu_ps(tail_mask_16((count - x) * 2), input_coords + x);
+
+    if constexpr (fetch == interpolate::Fetch::gather) {
+      interpolate_gathered(image, coords, output_pixels + x, count - x);
+    } else {
+      alignas(64) interpolate::InputCoords padded[8];
+      _mm512_store_ps(&padded[0].y, coords);
+
+      interpolate(image, padded, calculate_weights(coords), output_pixels + x, count - x);
+    }
+  }
+}
+
+//
+// Streaming stores
+//
+
+// Interpolate 8 output pixels from their coordinates, returning them packed, see
+// pack_output_pixels().
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline __m512i interpolate_step(const interpolate::BGRImage& image,
+                                       const interpolate::InputCoords input_coords[8]) {
+  const __m512 coords = _mm512_loadu_ps(input_coords);
+  const __m512i weights = calculate_weights(coords);
+  const __m512i weights_1357 = _mm512_unpacklo_epi64(weights, weights);
+  const __m512i weights_2468 = _mm512_unpackhi_epi64(weights, weights);
+
+  if constexpr (fetch == interpolate::Fetch::gather) {
+    __m256i top, bottom;
+    source_offsets(image, _mm512_cvttps_epi32(coords), top, bottom);
+
+    const __m512i top_pixels = _mm512_i32gather_epi64(top, image.data, 1);
+    const __m512i bottom_pixels = _mm512_i32gather_epi64(bottom, image.data, 1);
+
+    return pack_output_pixels(
+        blend_four_pixels(_mm512_unpacklo_epi64(top_pixels, bottom_pixels), weights_1357),
+        blend_four_pixels(_mm512_unpackhi_epi64(top_pixels, bottom_pixels), weights_2468));
+  } else {
+    const interpolate::BGRPixel* p[8];
+
+    for (auto i = 0; i < 8; i++) {
+      p[i] = image.ptr(input_coords[i].y, input_coords[i].x);
+    }
+
+    return pack_output_pixels(
+        interpolate_four_pixels(image, p[0], p[2], p[4], p[6], weights_1357),
+        interpolate_four_pixels(image, p[1], p[3], p[5], p[7], weights_2468));
+  }
+}
+
+// Write 64 output pixels, 3 whole cache lines, with non-temporal stores. Each of `packed` holds
+// 8 pixels from interpolate_step(). The output must be 64 byte aligned.
+static inline void stream_output_pixels(const __m512i packed[8],
+                                        interpolate::BGRPixel output_pixels[64]) {
+  auto* output = (__m512i*) output_pixels;
+
+  // Each step is 6 32 bit elements. Indexes from 16 select from the second vector.
+  // Pixels 1-16 and the first 4 32 bit elements of 17-24
+  __m512i line = _mm512_permutex2var_epi32(
+      packed[0], _mm512_set_epi32(0, 0, 0, 0, 21, 20, 19, 18, 17, 16, 5, 4, 3, 2, 1, 0),
+      packed[1]);
+  line = _mm512_permutex2var_epi32(
+      line, _mm512_set_epi32(19, 18, 17, 16, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), packed[2]);
+  _mm512_stream_si512(output, line);
+
+  // The rest of 17-24, 25-40 and the first 2 32 bit elements of 41-48
+  line = _mm512_permutex2var_epi32(
+      packed[2], _mm512_set_epi32(0, 0, 0, 0, 0, 0, 0, 0, 21, 20, 19, 18, 17, 16, 5, 4),
+      packed[3]);
+  line = _mm512_permutex2var_epi32(
+      line, _mm512_set_epi32(0, 0, 21, 20, 19, 18, 17, 16, 7, 6, 5, 4, 3, 2, 1, 0), packed[4]);
+  line = _mm512_permutex2var_epi32(
+      line, _mm512_set_epi32(17, 16, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), packed[5]);
+  _mm512_stream_si512(output + 1, line);
+
+  // The rest of 41-48 and 49-64
+  line = _mm512_permutex2var_epi32(
+      packed[5], _mm512_set_epi32(0, 0, 0, 0, 0, 0, 21, 20, 19, 18, 17, 16, 5, 4, 3, 2),
+      packed[6]);
+  line = _mm512_permutex2var_epi32(
+      line, _mm512_set_epi32(21, 20, 19, 18, 17, 16, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0), packed[7]);
+  _mm512_stream_si512(output + 2, line);
+}
+
+// As interpolate_row(), writing the output with non-temporal stores so it doesn't evict the
+// source pixels from the cache. The pixels before the first cache line boundary and after the
+// last whole step of 64 pixels use regular stores. Call streaming_store_fence() after the last
+// row.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_streaming_row(const interpolate::BGRImage& image,
+                                             const interpolate::InputCoords* input_coords,
+                                             interpolate::BGRPixel* output_pixels, int count) {
+  auto x = interpolate::pixels_to_alignment<64>(output_pixels);
+  if (x > count) {
+    x = count;
+  }
+
+  interpolate_row<fetch>(image, input_coords, output_pixels, x);
+
+  for (; x + 64 <= count; x += 64) {
+    __m512i packed[8];
+
+    for (auto i = 0; i < 8; i++) {
+      packed[i] = interpolate_step<fetch>(image, input_coords + x + i * 8);
+    }
+
+    stream_output_pixels(packed, output_pixels + x);
+  }
+
+  interpolate_row<fetch>(image, input_coords + x, output_pixels + x, count - x);
+}
+
+//
+// Exact mode
+//
+
+// Interpolate 8 output pixels in the exact mode, see bilinear::plain::interpolate_exact(). Only
+// the first `count` output pixels are written.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_exact(const interpolate::BGRImage& image, __m512 coords,
+                                     interpolate::BGRPixel output_pixels[8], int count = 8) {
+  // Fixed point coordinates, rounded to nearest
+  // ... | x2 y2 x1 y1
+  const __m512i fixed =
+      _mm512_cvtps_epi32(_mm512_mul_ps(coords, _mm512_set1_ps(float(FIXED_POINT_SCALE))));
+  const __m512i ints = _mm512_srai_epi32(fixed, FIXED_POINT_BITS);
+
+  // ... | 0 0 0 0 x2 y2 x1 y1
+  const __m512i fractions = _mm512_packs_epi32(
+      _mm512_and_si512(fixed, _mm512_set1_epi32(FIXED_POINT_MASK)), _mm512_setzero_si512());
+  const __m512i weights = combine_weights<FIXED_POINT_BITS>(fractions);
+
+  if constexpr (fetch == interpolate::Fetch::gather) {
+    __m256i top, bottom;
+    source_offsets(image, ints, top, bottom);
+
+    interpolate_gathered<EXACT_WEIGHT_BITS>(image, top, bottom, weights, output_pixels, count);
+  } else {
+    alignas(64) int32_t yx[16];
+    _mm512_store_si512(yx, ints);
+
+    const interpolate::BGRPixel* source_pixels[8];
+
+    for (auto i = 0; i < 8; i++) {
+      source_pixels[i] = image.ptr(yx[i * 2], yx[i * 2 + 1]);
+    }
+
+    interpolate<EXACT_WEIGHT_BITS>(image, source_pixels, weights, output_pixels, count);
+  }
+}
+
+// Interpolate a row of output pixels in the exact mode. Any count is supported.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_exact_row(const interpolate::BGRImage& image,
+                                         const interpolate::InputCoords* input_coords,
+                                         interpolate::BGRPixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 8 <= count; x += 8) {
+    interpolate_exact<fetch>(image, _mm512_loadu_ps(input_coords + x), output_pixels + x);
+  }
+
+  if (x < count) {
+    // Masked off coordinates load as (0, 0), which is a valid pixel to read
+    const __m512 coords = _mm512_maskz_loadu_ps(tail_mask_16((count - x) * 2), input_coords + x);
+
+    interpolate_exact<fetch>(image, coords, output_pixels + x, count - x);
+  }
+}
+
+//
+// Warps
+//
+
+// Clamp the source coordinates of 8 pixels to the image, and interleave them as y x pairs.
+// Comparisons with NaN (eg from a perspective divide by 0) return the clamp bound.
+static inline __m512 clamp_and_interleave(const interpolate::BGRImage& image, __m256 xs,
+                                          __m256 ys) {
+  const __m256 max_x = _mm256_set1_ps(float(image.cols - 1));
+  const __m256 max_y = _mm256_set1_ps(float(image.rows - 1));
+  xs = _mm256_min_ps(_mm256_max_ps(xs, _mm256_setzero_ps()), max_x);
+  ys = _mm256_min_ps(_mm256_max_ps(ys, _mm256_setzero_ps()), max_y);
+
+  // 6 5 | 2 1
+  const __m256 unpacked_lo = _mm256_unpacklo_ps(ys, xs);
+  // 8 7 | 4 3
+  const __m256 unpacked_hi = _mm256_unpackhi_ps(ys, xs);
+
+  // 4 3 2 1
+  const __m256 coords_1234 = _mm256_permute2f128_ps(unpacked_lo, unpacked_hi, 0x20);
+  // 8 7 6 5
+  const __m256 coords_5678 = _mm256_permute2f128_ps(unpacked_lo, unpacked_hi, 0x31);
+
+  return _mm512_insertf32x8(_mm512_castps256_ps512(coords_1234), coords_5678, 1);
+}
+
+// Interpolate 8 output pixels from sampling coordinates generated in registers. Only the first
+// `count` output pixels are written.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_generated(const interpolate::BGRImage& image, __m512 coords,
+                                         interpolate::BGRPixel output_pixels[8], int count = 8) {
+  if constexpr (fetch == interpolate::Fetch::gather) {
+    interpolate_gathered(image, coords, output_pixels, count);
+    return;
+  }
+
+  // The weights come straight from the registers. The pixel addresses are calculated per
+  // pixel, so the coordinates also go through a small stack buffer that stays in L1.
+  alignas(64) interpolate::InputCoords input_coords[8];
+  _mm512_store_ps(&input_coords[0].y, coords);
+
+  interpolate(image, input_coords, calculate_weights(coords), output_pixels, count);
+}
+
+// Number of pixels to write in the step of a row starting at x.
+static inline int step_count(int x, int count) { return (count - x < 8) ? count - x : 8; }
+
+// Interpolate `count` pixels of output row y, starting at column x, with sampling coordinates
+// from an affine transform. Coordinates are clamped to the image. Any count is supported.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_affine_row(const interpolate::BGRImage& image,
+                                          const interpolate::AffineTransform& transform, int x,
+                                          int y, interpolate::BGRPixel* output_pixels,
+                                          int count) {
+  const auto& m = transform.m;
+  const __m256 lane = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+
+  // Column of each pixel. Coordinates are calculated from the column rather than accumulated,
+  // so rounding errors don't build up along the row.
+  __m256 columns = _mm256_add_ps(lane, _mm256_set1_ps(float(x)));
+  const __m256 columns_step = _mm256_set1_ps(8.0f);
+
+  const __m256 m00 = _mm256_set1_ps(m[0][0]);
+  const __m256 m10 = _mm256_set1_ps(m[1][0]);
+  const __m256 row_xs = _mm256_set1_ps(m[0][1] * y + m[0][2]);
+  const __m256 row_ys = _mm256_set1_ps(m[1][1] * y + m[1][2]);
+
+  for (auto i = 0; i < count; i += 8) {
+    const __m256 xs = _mm256_fmadd_ps(columns, m00, row_xs);
+    const __m256 ys = _mm256_fmadd_ps(columns, m10, row_ys);
+
+    interpolate_generated<fetch>(image, clamp_and_interleave(image, xs, ys), output_pixels + i,
+                                 step_count(i, count));
+
+    columns = _mm256_add_ps(columns, columns_step);
+  }
+}
+
+// As interpolate_affine_row(), with a perspective transform.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_perspective_row(const interpolate::BGRImage& image,
+                                               const interpolate::PerspectiveTransform& transform,
+                                               int x, int y, interpolate::BGRPixel* output_pixels,
+                                               int count) {
+  const auto& m = transform.m;
+  const __m256 lane = _mm256_set_ps(7.0f, 6.0f, 5.0f, 4.0f, 3.0f, 2.0f, 1.0f, 0.0f);
+
+  __m256 columns = _mm256_add_ps(lane, _mm256_set1_ps(float(x)));
+  const __m256 columns_step = _mm256_set1_ps(8.0f);
+
+  const __m256 m00 = _mm256_set1_ps(m[0][0]);
+  const __m256 m10 = _mm256_set1_ps(m[1][0]);
+  const __m256 m20 = _mm256_set1_ps(m[2][0]);
+  const __m256 row_xs = _mm256_set1_ps(m[0][1] * y + m[0][2]);
+  const __m256 row_ys = _mm256_set1_ps(m[1][1] * y + m[1][2]);
+  const __m256 row_ws = _mm256_set1_ps(m[2][1] * y + m[2][2]);
+
+  for (auto i = 0; i < count; i += 8) {
+    const __m256 ws = _mm256_fmadd_ps(columns, m20, row_ws);
+    const __m256 xs = _mm256_div_ps(_mm256_fmadd_ps(columns, m00, row_xs), ws);
+    const __m256 ys = _mm256_div_ps(_mm256_fmadd_ps(columns, m10, row_ys), ws);
+
+    interpolate_generated<fetch>(image, clamp_and_interleave(image, xs, ys), output_pixels + i,
+                                 step_count(i, count));
+
+    columns = _mm256_add_ps(columns, columns_step);
+  }
+}
+
+//
+// Compact maps
+//
+
+// Interpolate 8 output pixels from a fixed point map, with the 8 fractions already loaded,
+// rounded as the exact mode. Only the first `count` output pixels are written.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_fixed_point(const interpolate::BGRImage& image,
+                                           const interpolate::FixedPointCoords coords[8],
+                                           __m128i fractions,
+                                           interpolate::BGRPixel output_pixels[8], int count = 8) {
+  // Moves each pair of pixels to the lower 64 bits of its own 128 bit lane
+  const __m512i lanes = _mm512_set_epi64(3, 3, 2, 2, 1, 1, 0, 0);
+
+  // (fy << 5) | fx for each pixel, as 32 bit ints
+  const __m256i packed = _mm256_cvtepu16_epi32(fractions);
+
+  // Split into 16 bit ints
+  // x8 y8 ... x2 y2 x1 y1
+  const __m256i ys = _mm256_srli_epi32(packed, FIXED_POINT_BITS);
+  const __m256i xs = _mm256_and_si256(packed, _mm256_set1_epi32(FIXED_POINT_MASK));
+  const __m256i lower = _mm256_or_si256(ys, _mm256_slli_epi32(xs, 16));
+
+  const __m512i weights = combine_weights<FIXED_POINT_BITS>(
+      _mm512_permutexvar_epi64(lanes, _mm512_castsi256_si512(lower)));
+
+  if constexpr (fetch == interpolate::Fetch::gather) {
+    __m256i top, bottom;
+    source_offsets(image, _mm512_cvtepi16_epi32(_mm256_loadu_si256((const __m256i*) coords)),
+                   top, bottom);
+
+    interpolate_gathered<EXACT_WEIGHT_BITS>(image, top, bottom, weights, output_pixels, count);
+    return;
+  }
+
+  const interpolate::BGRPixel* source_pixels[8];
+
+  for (auto i = 0; i < 8; i++) {
+    source_pixels[i] = image.ptr(coords[i].y, coords[i].x);
+  }
+
+  interpolate<EXACT_WEIGHT_BITS>(image, source_pixels, weights, output_pixels, count);
+}
+
+// Interpolate a row of output pixels from a fixed point map. Any count is supported.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_fixed_point_row(const interpolate::BGRImage& image,
+                                               const interpolate::FixedPointCoords* coords,
+                                               const uint16_t* fractions,
+                                               interpolate::BGRPixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 8 <= count; x += 8) {
+    interpolate_fixed_point<fetch>(image, coords + x,
+                                   _mm_loadu_si128((const __m128i*) (fractions + x)),
+                                   output_pixels + x);
+  }
+
+  if (x < count) {
+    // Masked off coordinates and fractions load as zero, which is a valid pixel to read
+    const auto mask = (__mmask8) tail_mask_16(count - x);
+
+    alignas(32) interpolate::FixedPointCoords padded[8];
+    _mm256_store_si256((__m256i*) padded, _mm256_maskz_loadu_epi32(mask, coords + x));
+
+    interpolate_fixed_point<fetch>(image, padded, _mm_maskz_loadu_epi16(mask, fractions + x),
+                                   output_pixels + x, count - x);
+  }
+}
+
+// Interpolate `count` pixels of output row y, starting at column x, from a half float offset
+// map. Coordinates are clamped to the image. Any count is supported.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_half_float_row(const interpolate::BGRImage& image,
+                                              const interpolate::HalfFloatOffsets* offsets, int x,
+                                              int y, interpolate::BGRPixel* output_pixels,
+                                              int count) {
+  // Output pixel positions as y x pairs
+  const __m512 lane = _mm512_set_ps(7.0f, 0.0f, 6.0f, 0.0f, 5.0f, 0.0f, 4.0f, 0.0f,    //
+                                    3.0f, 0.0f, 2.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f);
+  __m512 positions = _mm512_add_ps(lane, _mm512_broadcast_f32x4(_mm_set_ps(x, y, x, y)));
+  const __m512 positions_step = _mm512_broadcast_f32x4(_mm_set_ps(8.0f, 0.0f, 8.0f, 0.0f));
+
+  const float max_x = image.cols - 1;
+  const float max_y = image.rows - 1;
+  const __m512 max_coords = _mm512_broadcast_f32x4(_mm_set_ps(max_x, max_y, max_x, max_y));
+
+  for (auto i = 0; i < count; i += 8) {
+    // The offsets past the end of a row's tail are masked off, and load as zero
+    const auto mask = tail_mask_16(step_count(i, count) * 2);
+
+    const __m512 coords_offsets = _mm512_cvtph_ps(_mm256_maskz_loadu_epi16(mask, offsets + i));
+    __m512 coords = _mm512_add_ps(positions, coords_offsets);
+    coords = _mm512_min_ps(_mm512_max_ps(coords, _mm512_setzero_ps()), max_coords);
+
+    interpolate_generated<fetch>(image, coords, output_pixels + i, step_count(i, count));
+
+    positions = _mm512_add_ps(positions, positions_step);
+  }
+}
+
+//
+// Remap plans
+//
+
+// Load the top and bottom source pixel data of four pixels from a RemapPlan.
+static inline __m512i load_planned_pixels(const uint8_t* data, int step, const int32_t* offsets,
+                                          int stride) {
+  const auto* p1 = data + offsets[0];
+  const auto* p2 = data + offsets[stride];
+  const auto* p3 = data + offsets[stride * 2];
+  const auto* p4 = data + offsets[stride * 3];
+
+  return _mm512_set_epi64(*((int64_t*) (p4 + step)), *((int64_t*) p4),    //
+                          *((int64_t*) (p3 + step)), *((int64_t*) p3),    //
+                          *((int64_t*) (p2 + step)), *((int64_t*) p2),    //
+                          *((int64_t*) (p1 + step)), *((int64_t*) p1));
+}
+
+// Interpolate 8 output pixels with offsets and weights from a RemapPlan. The weights are already
+// in register layout. Only the first `count` output pixels are written.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_planned(const interpolate::BGRImage& image,
+                                       const int32_t offsets[8], __m512i pixel_weights,
+                                       interpolate::BGRPixel output_pixels[8], int count = 8) {
+  if constexpr (fetch == interpolate::Fetch::gather) {
+    // Plans already moved pixels in the last row up a row, so every pixel has a row below
+    const __m256i top = _mm256_loadu_si256((const __m256i*) offsets);
+    const __m256i bottom = _mm256_add_epi32(top, _mm256_set1_epi32(image.step));
+
+    interpolate_gathered(image, top, bottom, pixel_weights, output_pixels, count);
+    return;
+  }
+
+  const auto* data = (const uint8_t*) image.data;
+  const auto step = image.step;
+
+  const __m512i pixels_1357 = load_planned_pixels(data, step, offsets, 2);
+  const __m512i weights_1357 = _mm512_unpacklo_epi64(pixel_weights, pixel_weights);
+
+  const __m512i pixels_2468 = load_planned_pixels(data, step, offsets + 1, 2);
+  const __m512i weights_2468 = _mm512_unpackhi_epi64(pixel_weights, pixel_weights);
+
+  write_output_pixels(blend_four_pixels(pixels_1357, weights_1357),
+                      blend_four_pixels(pixels_2468, weights_2468), output_pixels, count);
+}
+
+// Interpolate a row of output pixels with the offsets and weights from a RemapPlan. Any count is
+// supported.
+template <interpolate::Fetch fetch = interpolate::Fetch::scalar>
+static inline void interpolate_plan_row(const interpolate::BGRImage& image,
+                                        const int32_t* offsets,
+                                        const interpolate::BilinearWeights* weights,
+                                        interpolate::BGRPixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 8 <= count; x += 8) {
+    interpolate_planned<fetch>(image, offsets + x, _mm512_loadu_si512(weights + x),
+                               output_pixels + x);
+  }
+
+  if (x < count) {
+    // Masked off offsets load as zero, the first pixel of the image
+    const auto mask = (__mmask8) tail_mask_16(count - x);
+
+    alignas(32) int32_t padded[8];
+    _mm256_store_si256((__m256i*) padded, _mm256_maskz_loadu_epi32(mask, offsets + x));
+
+    interpolate_planned<fetch>(image, padded, _mm512_maskz_loadu_epi64(mask, weights + x),
+                               output_pixels + x, count - x);
+  }
+}
+
+//
+// Image pyramids
+//
+
+// Load `count` (1-8) pairs of source pixels of a row, with 2 pairs in the lower 12 bytes of each
+// 128 bit lane. Pixels past `count` pairs are 0.
+static inline __m512i load_downsample_pixels(const uint8_t* pixels, int count = 8) {
+  const auto mask = __mmask64((1ull << (count * 6)) - 1);
+  const __m512i loaded = _mm512_maskz_loadu_epi8(mask, pixels);
+  return _mm512_permutexvar_epi32(
+      _mm512_set_epi32(11, 11, 10, 9, 8, 8, 7, 6, 5, 5, 4, 3, 2, 2, 1, 0), loaded);
+}
+
+// Average the 2x2 blocks of 16 source pixels from two rows, from load_downsample_pixels(), into 8
+// output pixels packed as from pack_output_pixels().
+static inline __m512i downsample_pixels(__m512i top, __m512i bottom) {
+  // The first and second pixel of each block as 16 bit channels, in output order. Lanes 1 and 3
+  // leave their lower 2 channels empty, so the lanes can be joined with an OR after packing.
+  const __m512i first =
+      _mm512_set_epi8(-1, 8, -1, 7, -1, 6, -1, 2, -1, 1, -1, 0, -1, -1, -1, -1,    //
+                      -1, -1, -1, -1, -1, 8, -1, 7, -1, 6, -1, 2, -1, 1, -1, 0,    //
+                      -1, 8, -1, 7, -1, 6, -1, 2, -1, 1, -1, 0, -1, -1, -1, -1,    //
+                      -1, -1, -1, -1, -1, 8, -1, 7, -1, 6, -1, 2, -1, 1, -1, 0);
+  const __m512i second =
+      _mm512_set_epi8(-1, 11, -1, 10, -1, 9, -1, 5, -1, 4, -1, 3, -1, -1, -1, -1,    //
+                      -1, -1, -1, -1, -1, 11, -1, 10, -1, 9, -1, 5, -1, 4, -1, 3,    //
+                      -1, 11, -1, 10, -1, 9, -1, 5, -1, 4, -1, 3, -1, -1, -1, -1,    //
+                      -1, -1, -1, -1, -1, 11, -1, 10, -1, 9, -1, 5, -1, 4, -1, 3);
+
+  __m512i sums = _mm512_shuffle_epi8(top, first);
+  sums = _mm512_add_epi16(sums, _mm512_shuffle_epi8(top, second));
+  sums = _mm512_add_epi16(sums, _mm512_shuffle_epi8(bottom, first));
+  sums = _mm512_add_epi16(sums, _mm512_shuffle_epi8(bottom, second));
+  sums = _mm512_srli_epi16(_mm512_add_epi16(sums, _mm512_set1_epi16(2)), 2);
+
+  // 2 output pixels in bytes 0-5 of lanes 0 and 2, and bytes 2-7 of lanes 1 and 3
+  const __m512i packed = _mm512_packus_epi16(sums, _mm512_setzero_si512());
+
+  // Join them in the lower 24 bytes. The 32 bit element 2 of each lane is 0.
+  const __m512i lower = _mm512_permutexvar_epi32(
+      _mm512_set_epi32(2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 13, 9, 8, 5, 1, 0), packed);
+  const __m512i upper = _mm512_permutexvar_epi32(
+      _mm512_set_epi32(2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 12, 2, 2, 4, 2), packed);
+  return _mm512_or_si512(lower, upper);
+}
+
+// Row y of the image downscaled 2x, see bilinear::plain::downsample_row().
+static inline void downsample_row(const interpolate::BGRImage& image, int y,
+                                  interpolate::BGRPixel* output_pixels, int count) {
+  const auto* top = (const uint8_t*) image.ptr(2 * y, 0);
+  const auto* bottom = (const uint8_t*) image.ptr(2 * y + 1, 0);
+
+  for (auto x = 0; x < count; x += 8) {
+    const auto n = step_count(x, count);
+    const __m512i packed = downsample_pixels(load_downsample_pixels(top + x * 6, n),
+                                             load_downsample_pixels(bottom + x * 6, n));
+
+    const auto mask = __mmask64((1ull << (n * sizeof(interpolate::BGRPixel))) - 1);
+    _mm512_mask_storeu_epi8(output_pixels + x, mask, packed);
+  }
+}
+
+// Blend two rows of pixels, see bilinear::plain::blend_row().
+static inline void blend_row(const interpolate::BGRPixel* a, const interpolate::BGRPixel* b,
+                             int weight, interpolate::BGRPixel* output_pixels, int count) {
+  const auto* a_bytes = (const uint8_t*) a;
+  const auto* b_bytes = (const uint8_t*) b;
+  auto* output_bytes = (uint8_t*) output_pixels;
+
+  // The weighted sums are at most 255 * 256 + 128, which fits in unsigned 16 bits
+  const __m512i a_weight = _mm512_set1_epi16(256 - weight);
+  const __m512i b_weight = _mm512_set1_epi16(weight);
+  const __m512i half = _mm512_set1_epi16(128);
+  const __m512i zero = _mm512_setzero_si512();
+
+  const auto bytes = count * 3;
+
+  for (auto i = 0; i < bytes; i += 64) {
+    const auto mask = (bytes - i < 64) ? __mmask64((1ull << (bytes - i)) - 1) : ~__mmask64(0);
+    const __m512i a_data = _mm512_maskz_loadu_epi8(mask, a_bytes + i);
+    const __m512i b_data = _mm512_maskz_loadu_epi8(mask, b_bytes + i);
+
+    // 16 bit channels, in the same order in each lane as the packus below puts them back
+    const __m512i b_lower = _mm512_unpacklo_epi8(b_data, zero);
+    const __m512i b_upper = _mm512_unpackhi_epi8(b_data, zero);
+
+    __m512i lower = _mm512_mullo_epi16(_mm512_unpacklo_epi8(a_data, zero), a_weight);
+    __m512i upper = _mm512_mullo_epi16(_mm512_unpackhi_epi8(a_data, zero), a_weight);
+    lower = _mm512_add_epi16(lower, _mm512_mullo_epi16(b_lower, b_weight));
+    upper = _mm512_add_epi16(upper, _mm512_mullo_epi16(b_upper, b_weight));
+    lower = _mm512_srli_epi16(_mm512_add_epi16(lower, half), 8);
+    upper = _mm512_srli_epi16(_mm512_add_epi16(upper, half), 8);
+
+    _mm512_mask_storeu_epi8(output_bytes + i, mask, _mm512_packus_epi16(lower, upper));
+  }
+}
+
+//
+// Resizes
+//
+
+// Interpolate 8 adjacent output pixels of a resize from one row of source pixels, see
+// bilinear::plain::resize_row(). Only the first `count` output pixels are written.
+static inline void resize(const uint8_t* row, const int32_t offsets[8],
+                          const interpolate::ResizeWeights weights[8],
+                          interpolate::BGRPixel output_pixels[8], int count = 8) {
+  // The left and right source pixels of 2 output pixels in each 128 bit lane
+  // ... | (pixel 2) _ _ rgb rgb (pixel 1) _ _ rgb rgb
+  const __m512i pixels = _mm512_set_epi64(
+      *((int64_t*) (row + offsets[7])), *((int64_t*) (row + offsets[6])),
+      *((int64_t*) (row + offsets[5])), *((int64_t*) (row + offsets[4])),
+      *((int64_t*) (row + offsets[3])), *((int64_t*) (row + offsets[2])),
+      *((int64_t*) (row + offsets[1])), *((int64_t*) (row + offsets[0])));
+
+  // Each channel of the left and right source pixels next to each other, as for VNNI above
+  // ... | _ _ r r g g b b
+  const __m512i mask_shuffle_1357 =
+      _mm512_set_epi8(MASK_SHUFFLE_TOP_SINGLE_LANE, MASK_SHUFFLE_TOP_SINGLE_LANE,
+                      MASK_SHUFFLE_TOP_SINGLE_LANE, MASK_SHUFFLE_TOP_SINGLE_LANE);
+  const __m512i mask_shuffle_2468 =
+      _mm512_set_epi8(MASK_SHUFFLE_BOTTOM_SINGLE_LANE, MASK_SHUFFLE_BOTTOM_SINGLE_LANE,
+                      MASK_SHUFFLE_BOTTOM_SINGLE_LANE, MASK_SHUFFLE_BOTTOM_SINGLE_LANE);
+
+  // The weights of pixels 1, 3, 5 and 7, and of 2, 4, 6 and 8, broadcast to their lanes
+  // ... | w2 w1 w2 w1 w2 w1 w2 w1
+  const __m512i weights_8 = _mm512_castsi256_si512(_mm256_loadu_si256((const __m256i*) weights));
+  const __m512i weights_1357 = _mm512_permutexvar_epi32(
+      _mm512_set_epi32(6, 6, 6, 6, 4, 4, 4, 4, 2, 2, 2, 2, 0, 0, 0, 0), weights_8);
+  const __m512i weights_2468 = _mm512_permutexvar_epi32(
+      _mm512_set_epi32(7, 7, 7, 7, 5, 5, 5, 5, 3, 3, 3, 3, 1, 1, 1, 1), weights_8);
+
+  // Multiply and add, and round to nearest. 32 bpc.
+  // ... | _ r g b
+  const __m512i half = _mm512_set1_epi32(128);
+  __m512i pixels_1357 = _mm512_madd_epi16(_mm512_shuffle_epi8(pixels, mask_shuffle_1357),
+                                          weights_1357);
+  __m512i pixels_2468 = _mm512_madd_epi16(_mm512_shuffle_epi8(pixels, mask_shuffle_2468),
+                                          weights_2468);
+  pixels_1357 = _mm512_add_epi32(pixels_1357, half);
+  pixels_2468 = _mm512_add_epi32(pixels_2468, half);
+
+#ifndef __AVX512VBMI__
+  // Divide by 256, and convert from 32bpc => 16bpc => 8bpc
+  pixels_1357 = _mm512_srli_epi32(pixels_1357, 8);
+  pixels_2468 = _mm512_srli_epi32(pixels_2468, 8);
+  pixels_1357 = _mm512_packus_epi32(pixels_1357, _mm512_setzero_si512());
+  pixels_1357 = _mm512_packus_epi16(pixels_1357, _mm512_setzero_si512());
+  pixels_2468 = _mm512_packus_epi32(pixels_2468, _mm512_setzero_si512());
+  pixels_2468 = _mm512_packus_epi16(pixels_2468, _mm512_setzero_si512());
+#endif
+
+  write_output_pixels(pixels_1357, pixels_2468, output_pixels, count);
+}
+
+// Interpolate a row of output pixels of a resize, see bilinear::plain::resize_row(). Any count
+// is supported.
+static inline void resize_row(const interpolate::BGRPixel* row, const int32_t* offsets,
+                              const interpolate::ResizeWeights* weights,
+                              interpolate::BGRPixel* output_pixels, int count) {
+  const auto* data = (const uint8_t*) row;
+  auto x = 0;
+
+  for (; x + 8 <= count; x += 8) {
+    resize(data, offsets + x, weights + x, output_pixels + x);
+  }
+
+  if (x < count) {
+    int32_t padded_offsets[8];
+    interpolate::ResizeWeights padded_weights[8];
+    copy_tail<8>(offsets + x, count - x, padded_offsets);
+    copy_tail<8>(weights + x, count - x, padded_weights);
+
+    resize(data, padded_offsets, padded_weights, output_pixels + x, count - x);
+  }
+}
+
+//
+// 32bpp
+//
+
+// Shuffles to spread a pixel's weights from calculate_weights(), in the lower 64 bits of a lane,
+// over the 4 channels of its left and right source pixels: w2 x4 w1 x4 for the top row and
+// w4 x4 w3 x4 for the bottom row.
+#define MASK_WEIGHTS_TOP_SINGLE_LANE 3, 2, 3, 2, 3, 2, 3, 2, 1, 0, 1, 0, 1, 0, 1, 0
+#define MASK_WEIGHTS_BOTTOM_SINGLE_LANE 7, 6, 7, 6, 7, 6, 7, 6, 5, 4, 5, 4, 5, 4, 5, 4
+
+// Weighted sums of the left and right source pixels of four 32bpp pixels, 16 bpc in the lower
+// and upper 64 bits of each lane. Each lane holds a pixel's top and bottom source pixel pairs,
+// widened to 16 bpc, and its weights in the lower 64 bits. The weights sum to at most 256, so the
+// sums fit in 16 bits.
+static inline __m512i blend_four_pixels_bgra(__m512i top, __m512i bottom, __m512i weights) {
+  const __m512i mask_top =
+      _mm512_set_epi8(MASK_WEIGHTS_TOP_SINGLE_LANE, MASK_WEIGHTS_TOP_SINGLE_LANE,
+                      MASK_WEIGHTS_TOP_SINGLE_LANE, MASK_WEIGHTS_TOP_SINGLE_LANE);
+  const __m512i mask_bottom =
+      _mm512_set_epi8(MASK_WEIGHTS_BOTTOM_SINGLE_LANE, MASK_WEIGHTS_BOTTOM_SINGLE_LANE,
+                      MASK_WEIGHTS_BOTTOM_SINGLE_LANE, MASK_WEIGHTS_BOTTOM_SINGLE_LANE);
+
+  return _mm512_add_epi16(_mm512_mullo_epi16(top, _mm512_shuffle_epi8(weights, mask_top)),
+                          _mm512_mullo_epi16(bottom, _mm512_shuffle_epi8(weights, mask_bottom)));
+}
+
+// Bilinear interpolation of 8 adjacent 32bpp output pixels from the top left source pixel of
+// each, and weights from calculate_weights(). Each row's source pixel pair is one 64 bit load and
+// the pixels stay in 32 bit lanes, so there are no shuffles to unpack or repack 24bpp, and they
+// are written as whole 32 bit lanes. Only the first `count` output pixels are written.
+static inline void interpolate_bgra(const interpolate::BGRAImage& image,
+                                    const interpolate::BGRAPixel* const source_pixels[8],
+                                    __m512i weights, interpolate::BGRAPixel output_pixels[8],
+                                    int count = 8) {
+  const auto* const* p = source_pixels;
+  const __m512i zero = _mm512_setzero_si512();
+
+  // 8 7 | 6 5 | 4 3 | 2 1
+  const __m512i top =
+      _mm512_set_epi64(*((int64_t*) p[7]), *((int64_t*) p[6]), *((int64_t*) p[5]),
+                       *((int64_t*) p[4]), *((int64_t*) p[3]), *((int64_t*) p[2]),
+                       *((int64_t*) p[1]), *((int64_t*) p[0]));
+  const __m512i bottom = _mm512_set_epi64(
+      *((int64_t*) image.ptr_below(p[7])), *((int64_t*) image.ptr_below(p[6])),
+      *((int64_t*) image.ptr_below(p[5])), *((int64_t*) image.ptr_below(p[4])),
+      *((int64_t*) image.ptr_below(p[3])), *((int64_t*) image.ptr_below(p[2])),
+      *((int64_t*) image.ptr_below(p[1])), *((int64_t*) image.ptr_below(p[0])));
+
+  // Odd pixels widen from the lower 64 bits of each lane, and even pixels from the upper
+  const __m512i sums_1357 = blend_four_pixels_bgra(_mm512_unpacklo_epi8(top, zero),
+                                                   _mm512_unpacklo_epi8(bottom, zero),
+                                                   _mm512_unpacklo_epi64(weights, weights));
+  const __m512i sums_2468 = blend_four_pixels_bgra(_mm512_unpackhi_epi8(top, zero),
+                                                   _mm512_unpackhi_epi8(bottom, zero),
+                                                   _mm512_unpackhi_epi64(weights, weights));
+
+  // Add the left and right sums and divide by 256. 16 bpc.
+  // 8 7 | 6 5 | 4 3 | 2 1
+  __m512i out = _mm512_add_epi16(_mm512_unpacklo_epi64(sums_1357, sums_2468),
+                                 _mm512_unpackhi_epi64(sums_1357, sums_2468));
+  out = _mm512_srli_epi16(out, 8);
+
+  // Convert to 8 bpc, and move the pixels of each lane to the lower 256 bits
+  // _ _ 8 7 | _ _ 6 5 | _ _ 4 3 | _ _ 2 1
+  out = _mm512_packus_epi16(out, zero);
+  const __m256i pixels = _mm512_castsi512_si256(
+      _mm512_permutexvar_epi64(_mm512_set_epi64(0, 0, 0, 0, 6, 4, 2, 0), out));
+
+  if (count == 8) [[likely]] {
+    _mm256_storeu_si256((__m256i*) output_pixels, pixels);
+  } else {
+    _mm256_mask_storeu_epi32(output_pixels, (__mmask8) tail_mask_16(count), pixels);
+  }
+}
+
+// Bilinear interpolation of 8 adjacent 32bpp output pixels with the supplied coordinates and
+// weights from calculate_weights(). Only the first `count` output pixels are written.
+static inline void interpolate_bgra(const interpolate::BGRAImage& image,
+                                    const interpolate::InputCoords input_coords[8],
+                                    __m512i weights, interpolate::BGRAPixel output_pixels[8],
+                                    int count = 8) {
+  const interpolate::BGRAPixel* source_pixels[8];
+
+  for (auto i = 0; i < 8; i++) {
+    source_pixels[i] = image.ptr(input_coords[i].y, input_coords[i].x);
+  }
+
+  interpolate_bgra(image, source_pixels, weights, output_pixels, count);
+}
+
+// Interpolate a row of 32bpp output pixels. Any count is supported. The last 1-7 pixels go
+// through the same SIMD path with masked loads and stores.
+static inline void interpolate_bgra_row(const interpolate::BGRAImage& image,
+                                        const interpolate::InputCoords* input_coords,
+                                        interpolate::BGRAPixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 8 <= count; x += 8) {
+    interpolate_bgra(image, input_coords + x, calculate_weights(&input_coords[x].y),
+                     output_pixels + x);
+  }
+
+  if (x < count) {
+    // Masked off coordinates load as (0, 0), which is a valid pixel to read
+    const __m512 coords = _mm512_maskz_loadu_ps(tail_mask_16((count - x) * 2), input_coords + x);
+
+    alignas(64) interpolate::InputCoords padded[8];
+    _mm512_store_ps(&padded[0].y, coords);
+
+    interpolate_bgra(image, padded, calculate_weights(coords), output_pixels + x, count - x);
+  }
+}
+
+//
+// 8 bit grayscale
+//
+
+// The top and bottom pairs of source pixels of 16 pixels of an 8 bit image, and the fractions
+// of their coordinates. See avx2::GatheredPairs.
+struct GatheredPairs {
+  __m512i top;
+  __m512i bottom;
+  __m512i fx;
+  __m512i fy;
+};
+
+// Fetch the source pixel pairs of 16 pixels from two vectors of 8 y x coordinates, with the
+// coordinates converted to fixed point and rounded to nearest as in the exact mode.
+template <typename Pixel>
+static inline GatheredPairs gather_pairs(const interpolate::Image<Pixel>& image, __m512 coords_1_8,
+                                         __m512 coords_9_16) {
+  static_assert(sizeof(Pixel) == 1 || sizeof(Pixel) == 2, "a pair must fit in 32 bits");
+
+  const __m512 scale = _mm512_set1_ps(float(FIXED_POINT_SCALE));
+  const __m512i mask = _mm512_set1_epi32(FIXED_POINT_MASK);
+
+  // Separate the y and x coordinates, fixed point rounded to nearest
+  const __m512i even = _mm512_set_epi32(30, 28, 26, 24, 22, 20, 18, 16, 14, 12, 10, 8, 6, 4, 2, 0);
+  const __m512i odd = _mm512_set_epi32(31, 29, 27, 25, 23, 21, 19, 17, 15, 13, 11, 9, 7, 5, 3, 1);
+  const __m512i ys = _mm512_cvtps_epi32(
+      _mm512_mul_ps(_mm512_permutex2var_ps(coords_1_8, even, coords_9_16), scale));
+  const __m512i xs = _mm512_cvtps_epi32(
+      _mm512_mul_ps(_mm512_permutex2var_ps(coords_1_8, odd, coords_9_16), scale));
+
+  const __m512i rows = _mm512_srai_epi32(ys, FIXED_POINT_BITS);
+  __m512i columns = _mm512_srai_epi32(xs, FIXED_POINT_BITS);
+
+  if constexpr (sizeof(Pixel) == 2) {
+    columns = _mm512_slli_epi32(columns, 1);
+  }
+
+  // Byte offsets of the top left source pixels and of the pixels below them. The last row of the
+  // image is its own row below, as in Image::ptr_below().
+  const __m512i step = _mm512_set1_epi32(image.step);
+  const __m512i top = _mm512_add_epi32(_mm512_mullo_epi32(rows, step), columns);
+  const __mmask16 has_row_below = _mm512_cmplt_epi32_mask(rows, _mm512_set1_epi32(image.rows - 1));
+  const __m512i bottom = _mm512_mask_add_epi32(top, has_row_below, top, step);
+
+  return {_mm512_i32gather_epi32(top, image.data, 1), _mm512_i32gather_epi32(bottom, image.data, 1),
+          _mm512_and_si512(xs, mask), _mm512_and_si512(ys, mask)};
+}
+
+// fx, 32 - fx, fx, 32 - fx as bytes, for maddubs with two pairs of bytes
+static inline __m512i gathered_weights_x(__m512i fx) {
+  const __m512i weights = _mm512_or_si512(
+      _mm512_sub_epi32(_mm512_set1_epi32(FIXED_POINT_SCALE), fx), _mm512_slli_epi32(fx, 8));
+
+  return _mm512_or_si512(weights, _mm512_slli_epi32(weights, 16));
+}
+
+// fy, 32 - fy as 16 bit ints, for madd with the top and bottom row sums
+static inline __m512i gathered_weights_y(__m512i fy) {
+  return _mm512_or_si512(_mm512_sub_epi32(_mm512_set1_epi32(FIXED_POINT_SCALE), fy),
+                         _mm512_slli_epi32(fy, 16));
+}
+
+// Weighted sum of the top and bottom row sums, in the lower and upper 16 bits of each element,
+// rounded to nearest. At most 255.
+static inline __m512i blend_row_sums(__m512i row_sums, __m512i weights_y) {
+  const __m512i out = _mm512_add_epi32(_mm512_madd_epi16(row_sums, weights_y),
+                                       _mm512_set1_epi32(1 << (EXACT_WEIGHT_BITS - 1)));
+
+  return _mm512_srli_epi32(out, EXACT_WEIGHT_BITS);
+}
+
+// Interpolate 16 grayscale pixels from two vectors of 8 y x coordinates, rounded as in the exact
+// mode (see bilinear::plain::interpolate_gray()). Returns them as 32 bit ints. See
+// avx2::interpolate_gray_8() for the arithmetic.
+static inline __m512i interpolate_gray_16(const interpolate::GrayImage& image, __m512 coords_1_8,
+                                          __m512 coords_9_16) {
+  const auto pairs = gather_pairs(image, coords_1_8, coords_9_16);
+
+  // bottom right, bottom left, top right, top left as bytes
+  const __m512i pixels =
+      _mm512_mask_blend_epi16(0xaaaaaaaa, pairs.top, _mm512_slli_epi32(pairs.bottom, 16));
+
+  const __m512i row_sums = _mm512_maddubs_epi16(pixels, gathered_weights_x(pairs.fx));
+
+  return blend_row_sums(row_sums, gathered_weights_y(pairs.fy));
+}
+
+// Interpolate 32 grayscale output pixels from 4 vectors of 8 y x coordinates. Only the first
+// `count` output pixels are written.
+static inline void interpolate_gray(const interpolate::GrayImage& image, const __m512 coords[4],
+                                    uint8_t output_pixels[32], int count = 32) {
+  // The results are at most 255, so truncating to 8 bits doesn't need saturation
+  const __m128i pixels_1_16 =
+      _mm512_cvtepi32_epi8(interpolate_gray_16(image, coords[0], coords[1]));
+  const __m128i pixels_17_32 =
+      _mm512_cvtepi32_epi8(interpolate_gray_16(image, coords[2], coords[3]));
+  const __m256i out = _mm256_inserti128_si256(_mm256_castsi128_si256(pixels_1_16), pixels_17_32, 1);
+
+  if (count == 32) [[likely]] {
+    _mm256_storeu_si256((__m256i*) output_pixels, out);
+  } else {
+    _mm256_mask_storeu_epi8(output_pixels, __mmask32((1ull << count) - 1), out);
+  }
+}
+
+// Interpolate a row of grayscale output pixels. Any count is supported. The last 1-31 pixels go
+// through the same SIMD path with masked loads and stores.
+static inline void interpolate_gray_row(const interpolate::GrayImage& image,
+                                        const interpolate::InputCoords* input_coords,
+                                        uint8_t* output_pixels, int count) {
+  auto x = 0;
+  __m512 coords[4];
+
+  for (; x + 32 <= count; x += 32) {
+    for (auto i = 0; i < 4; i++) {
+      coords[i] = _mm512_loadu_ps(input_coords + x + i * 8);
+    }
+
+    interpolate_gray(image, coords, output_pixels + x);
+  }
+
+  if (x < count) {
+    // Masked off coordinates load as (0, 0), which is a valid pixel to read
+    for (auto i = 0; i < 4; i++) {
+      const auto start = x + i * 8;
+      const auto lane_count = (start < count) ? step_count(start, count) : 0;
+      coords[i] = _mm512_maskz_loadu_ps(tail_mask_16(lane_count * 2), input_coords + start);
+    }
+
+    interpolate_gray(image, coords, output_pixels + x, count - x);
+  }
+}
+
+// Mask to reorder each gathered pair of U V pixels, u v u v, to u u v v.
+#define MASK_DEINTERLEAVE_UV_SINGLE_LANE 15, 13, 14, 12, 11, 9, 10, 8, 7, 5, 6, 4, 3, 1, 2, 0
+
+// Interpolate 16 U V pixels of an NV12 chroma plane from two vectors of 8 y x coordinates. Returns
+// u | (v << 8) as 32 bit ints. See avx2::interpolate_uv_8().
+static inline __m512i interpolate_uv_16(const interpolate::UVImage& image, __m512 coords_1_8,
+                                        __m512 coords_9_16) {
+  const auto pairs = gather_pairs(image, coords_1_8, coords_9_16);
+  const __m512i deinterleave =
+      _mm512_set_epi8(MASK_DEINTERLEAVE_UV_SINGLE_LANE, MASK_DEINTERLEAVE_UV_SINGLE_LANE,
+                      MASK_DEINTERLEAVE_UV_SINGLE_LANE, MASK_DEINTERLEAVE_UV_SINGLE_LANE);
+  const __m512i weights_x = gathered_weights_x(pairs.fx);
+
+  // The U and V sums of each row, in the lower and upper 16 bits
+  const __m512i top_sums =
+      _mm512_maddubs_epi16(_mm512_shuffle_epi8(pairs.top, deinterleave), weights_x);
+  const __m512i bottom_sums =
+      _mm512_maddubs_epi16(_mm512_shuffle_epi8(pairs.bottom, deinterleave), weights_x);
+
+  // The top and bottom row sums of U, and of V
+  const __m512i u_sums =
+      _mm512_mask_blend_epi16(0xaaaaaaaa, top_sums, _mm512_slli_epi32(bottom_sums, 16));
+  const __m512i v_sums =
+      _mm512_mask_blend_epi16(0xaaaaaaaa, _mm512_srli_epi32(top_sums, 16), bottom_sums);
+
+  const __m512i weights_y = gathered_weights_y(pairs.fy);
+
+  return _mm512_or_si512(blend_row_sums(u_sums, weights_y),
+                         _mm512_slli_epi32(blend_row_sums(v_sums, weights_y), 8));
+}
+
+// Interpolate 32 U V output pixels from 4 vectors of 8 y x coordinates. Only the first `count`
+// output pixels are written.
+static inline void interpolate_uv(const interpolate::UVImage& image, const __m512 coords[4],
+                                  interpolate::UVPixel output_pixels[32], int count = 32) {
+  // The results are at most 0xffff, so truncating to 16 bits doesn't need saturation
+  const __m256i pixels_1_16 = _mm512_cvtepi32_epi16(interpolate_uv_16(image, coords[0], coords[1]));
+  const __m256i pixels_17_32 =
+      _mm512_cvtepi32_epi16(interpolate_uv_16(image, coords[2], coords[3]));
+  const __m512i out = _mm512_inserti64x4(_mm512_castsi256_si512(pixels_1_16), pixels_17_32, 1);
+
+  if (count == 32) [[likely]] {
+    _mm512_storeu_si512(output_pixels, out);
+  } else {
+    _mm512_mask_storeu_epi16(output_pixels, __mmask32((1ull << count) - 1), out);
+  }
+}
+
+// Interpolate a row of U V output pixels. Any count is supported. The last 1-31 pixels go
+// through the same SIMD path with masked loads and stores.
+static inline void interpolate_uv_row(const interpolate::UVImage& image,
+                                      const interpolate::InputCoords* input_coords,
+                                      interpolate::UVPixel* output_pixels, int count) {
+  auto x = 0;
+  __m512 coords[4];
+
+  for (; x + 32 <= count; x += 32) {
+    for (auto i = 0; i < 4; i++) {
+      coords[i] = _mm512_loadu_ps(input_coords + x + i * 8);
+    }
+
+    interpolate_uv(image, coords, output_pixels + x);
+  }
+
+  if (x < count) {
+    // Masked off coordinates load as (0, 0), which is a valid pixel to read
+    for (auto i = 0; i < 4; i++) {
+      const auto start = x + i * 8;
+      const auto lane_count = (start < count) ? step_count(start, count) : 0;
+      coords[i] = _mm512_maskz_loadu_ps(tail_mask_16(lane_count * 2), input_coords + start);
+    }
+
+    interpolate_uv(image, coords, output_pixels + x, count - x);
+  }
+}
+
+//
+// 16 bit and float channels
+//
+
+// Masks to interleave a pair of 16 bpc source pixels and to pack two 16 bpc output pixels in a
+// lane, see avx2::MASK_INTERLEAVE_PAIR_16_HALF and avx2::MASK_PACK_PAIR_16_HALF.
+#define MASK_INTERLEAVE_PAIR_16_SINGLE_LANE -1, -1, -1, -1, 11, 10, 5, 4, 9, 8, 3, 2, 7, 6, 1, 0
+#define MASK_PACK_PAIR_16_SINGLE_LANE -1, -1, -1, -1, 13, 12, 11, 10, 9, 8, 5, 4, 3, 2, 1, 0
+
+// Interpolate four 16 bpc pixels, one per lane, with 32 bit sums. See
+// avx2::blend_two_pixels_16().
+static inline __m512i blend_four_pixels_16(__m512i top, __m512i bottom, __m512i weights) {
+  const __m512i mask_interleave = _mm512_set_epi8(
+      MASK_INTERLEAVE_PAIR_16_SINGLE_LANE, MASK_INTERLEAVE_PAIR_16_SINGLE_LANE,
+      MASK_INTERLEAVE_PAIR_16_SINGLE_LANE, MASK_INTERLEAVE_PAIR_16_SINGLE_LANE);
+  const __m512i bias = _mm512_set1_epi16(-32768);
+
+  top = _mm512_xor_si512(_mm512_shuffle_epi8(top, mask_interleave), bias);
+  bottom = _mm512_xor_si512(_mm512_shuffle_epi8(bottom, mask_interleave), bias);
+
+  // ... | w2 w1 w2 w1 w2 w1 w2 w1  and  ... | w4 w3 w4 w3 w4 w3 w4 w3
+  const __m512i weights_top = _mm512_shuffle_epi32(weights, _MM_PERM_AAAA);
+  const __m512i weights_bottom = _mm512_shuffle_epi32(weights, _MM_PERM_BBBB);
+
+  __m512i out = _mm512_add_epi32(_mm512_madd_epi16(top, weights_top),
+                                 _mm512_madd_epi16(bottom, weights_bottom));
+  out = _mm512_sub_epi32(out,
+                         _mm512_madd_epi16(bias, _mm512_add_epi16(weights_top, weights_bottom)));
+
+  // Divide by 256
+  return _mm512_srli_epi32(out, 8);
+}
+
+// 16 bytes from each of 4 pointers, one per lane.
+static inline __m512i load_four_lanes(const void* p1, const void* p2, const void* p3,
+                                      const void* p4) {
+  const __m256i lower =
+      _mm256_set_m128i(_mm_loadu_si128((const __m128i*) p2), _mm_loadu_si128((const __m128i*) p1));
+  const __m256i upper =
+      _mm256_set_m128i(_mm_loadu_si128((const __m128i*) p4), _mm_loadu_si128((const __m128i*) p3));
+
+  return _mm512_inserti64x4(_mm512_castsi256_si512(lower), upper, 1);
+}
+
+// Bilinear interpolation of 8 adjacent 16 bpc output pixels with the supplied coordinates and
+// weights from calculate_weights(). Each row's source pixel pair is one 16 byte load. Only the
+// first `count` output pixels are written.
+static inline void interpolate_bgr16(const interpolate::BGR16Image& image,
+                                     const interpolate::InputCoords input_coords[8],
+                                     __m512i weights, interpolate::BGR16Pixel output_pixels[8],
+                                     int count = 8) {
+  const interpolate::BGR16Pixel* p[8];
+  const interpolate::BGR16Pixel* below[8];
+
+  for (auto i = 0; i < 8; i++) {
+    p[i] = image.ptr(input_coords[i].y, input_coords[i].x);
+    below[i] = image.ptr_below(p[i]);
+  }
+
+  const __m512i sums_1357 =
+      blend_four_pixels_16(load_four_lanes(p[0], p[2], p[4], p[6]),
+                           load_four_lanes(below[0], below[2], below[4], below[6]),
+                           _mm512_unpacklo_epi64(weights, weights));
+  const __m512i sums_2468 =
+      blend_four_pixels_16(load_four_lanes(p[1], p[3], p[5], p[7]),
+                           load_four_lanes(below[1], below[3], below[5], below[7]),
+                           _mm512_unpackhi_epi64(weights, weights));
+
+  // Convert to 16 bpc, then pack the 8 pixels into the lower 48 bytes
+  // _ r g b _ r g b (8 7) | ... | _ r g b _ r g b (2 1)
+  __m512i out = _mm512_packus_epi32(sums_1357, sums_2468);
+  out = _mm512_shuffle_epi8(out,
+                            _mm512_set_epi8(MASK_PACK_PAIR_16_SINGLE_LANE,
+                                            MASK_PACK_PAIR_16_SINGLE_LANE,
+                                            MASK_PACK_PAIR_16_SINGLE_LANE,
+                                            MASK_PACK_PAIR_16_SINGLE_LANE));
+  out = _mm512_permutexvar_epi32(
+      _mm512_set_epi32(15, 11, 7, 3, 14, 13, 12, 10, 9, 8, 6, 5, 4, 2, 1, 0), out);
+
+  if (count == 8) [[likely]] {
+    _mm512_mask_storeu_epi32(output_pixels, 0x0fff, out);
+  } else {
+    _mm512_mask_storeu_epi16(output_pixels, __mmask32((1u << (count * 3)) - 1), out);
+  }
+}
+
+// Interpolate a row of 16 bpc output pixels. Any count is supported. The last 1-7 pixels go
+// through the same SIMD path with masked loads and stores.
+static inline void interpolate_bgr16_row(const interpolate::BGR16Image& image,
+                                         const interpolate::InputCoords* input_coords,
+                                         interpolate::BGR16Pixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 8 <= count; x += 8) {
+    interpolate_bgr16(image, input_coords + x, calculate_weights(&input_coords[x].y),
+                      output_pixels + x);
+  }
+
+  if (x < count) {
+    // Masked off coordinates load as (0, 0), which is a valid pixel to read
+    const __m512 coords = _mm512_maskz_loadu_ps(tail_mask_16((count - x) * 2), input_coords + x);
+
+    alignas(64) interpolate::InputCoords padded[8];
+    _mm512_store_ps(&padded[0].y, coords);
+
+    interpolate_bgr16(image, padded, calculate_weights(coords), output_pixels + x, count - x);
+  }
+}
+
+// Calculate the float weights for the 4 surrounding pixels of 8 independent y x pairs, as
+// avx2::calculate_weights_ps(). Returns w1 w2 w3 w4 of pixels 1, 3, 5 and 7 in `weights_odd`,
+// and of pixels 2, 4, 6 and 8 in `weights_even`, one pixel per lane.
+static inline void calculate_weights_ps(__m512 initial, __m512& weights_odd,
+                                        __m512& weights_even) {
+  const __m512 fractional = _mm512_sub_ps(initial, _mm512_floor_ps(initial));
+  const __m512 upper = _mm512_sub_ps(_mm512_set1_ps(1.0f), fractional);
+
+  const auto combine = [](__m512 combined) {
+    // x 1-x x 1-x  times  y y 1-y 1-y
+    return _mm512_mul_ps(_mm512_shuffle_ps(combined, combined, _MM_SHUFFLE(3, 2, 3, 2)),
+                         _mm512_shuffle_ps(combined, combined, _MM_SHUFFLE(1, 1, 0, 0)));
+  };
+
+  weights_odd = combine(_mm512_unpacklo_ps(upper, fractional));
+  weights_even = combine(_mm512_unpackhi_ps(upper, fractional));
+}
+
+// Bilinear interpolation of float output pixels `pair` * 2 + 1 and + 2 of 8, from their top left
+// source pixels and the weights from calculate_weights_ps(). Returns b g r of the first in floats
+// 0-2 and of the second in floats 8-10. Each row's source pixel pair is one 32 byte load, so up
+// to 8 bytes past it are read and not used.
+template <int pair>
+static inline __m512 interpolate_two_pixels_float(const interpolate::BGRFloatImage& image,
+                                                  const interpolate::BGRFloatPixel* p1,
+                                                  const interpolate::BGRFloatPixel* p2,
+                                                  __m512 weights_odd, __m512 weights_even) {
+  // Pixel 1's weights are in lane `pair` of weights_odd, and pixel 2's in lane `pair` of
+  // weights_even, which permutex2var indexes from 16.
+  constexpr int a = pair * 4;
+  constexpr int b = 16 + pair * 4;
+
+  // _ _ w2 w2 w2 w1 w1 w1 for both pixels, then the same with w4 and w3
+  const __m512 weights_top = _mm512_permutex2var_ps(
+      weights_odd,
+      _mm512_set_epi32(b, b, b + 1, b + 1, b + 1, b, b, b, a, a, a + 1, a + 1, a + 1, a, a, a),
+      weights_even);
+  const __m512 weights_bottom = _mm512_permutex2var_ps(
+      weights_odd,
+      _mm512_set_epi32(b, b, b + 3, b + 3, b + 3, b + 2, b + 2, b + 2, a, a, a + 3, a + 3, a + 3,
+                       a + 2, a + 2, a + 2),
+      weights_even);
+
+  // _ _ r g b r g b for both pixels
+  const auto load = [](const interpolate::BGRFloatPixel* first,
+                       const interpolate::BGRFloatPixel* second) {
+    return _mm512_insertf32x8(_mm512_castps256_ps512(_mm256_loadu_ps((const float*) first)),
+                              _mm256_loadu_ps((const float*) second), 1);
+  };
+
+  const __m512 top = load(p1, p2);
+  const __m512 bottom = load(image.ptr_below(p1), image.ptr_below(p2));
+
+  const __m512 sums = _mm512_fmadd_ps(bottom, weights_bottom, _mm512_mul_ps(top, weights_top));
+
+  // Add the right pixels' sums to the left's
+  const __m512 right = _mm512_permutexvar_ps(
+      _mm512_set_epi32(15, 15, 15, 15, 14, 13, 12, 11, 7, 7, 7, 7, 6, 5, 4, 3), sums);
+
+  return _mm512_add_ps(sums, right);
+}
+
+// Bilinear interpolation of 8 adjacent float output pixels with the supplied coordinates. Only
+// the first `count` output pixels are written.
+static inline void interpolate_bgr_float(const interpolate::BGRFloatImage& image,
+                                         const interpolate::InputCoords input_coords[8],
+                                         __m512 coords, interpolate::BGRFloatPixel output_pixels[8],
+                                         int count = 8) {
+  __m512 weights_odd, weights_even;
+  calculate_weights_ps(coords, weights_odd, weights_even);
+
+  const interpolate::BGRFloatPixel* p[8];
+
+  for (auto i = 0; i < 8; i++) {
+    p[i] = image.ptr(input_coords[i].y, input_coords[i].x);
+  }
+
+  const __m512 pixels_12 =
+      interpolate_two_pixels_float<0>(image, p[0], p[1], weights_odd, weights_even);
+  const __m512 pixels_34 =
+      interpolate_two_pixels_float<1>(image, p[2], p[3], weights_odd, weights_even);
+  const __m512 pixels_56 =
+      interpolate_two_pixels_float<2>(image, p[4], p[5], weights_odd, weights_even);
+  const __m512 pixels_78 =
+      interpolate_two_pixels_float<3>(image, p[6], p[7], weights_odd, weights_even);
+
+  // Pack each 4 pixels into 12 floats
+  const __m512i pack = _mm512_set_epi32(0, 0, 0, 0, 26, 25, 24, 18, 17, 16, 10, 9, 8, 2, 1, 0);
+  const __m512 pixels_1234 = _mm512_permutex2var_ps(pixels_12, pack, pixels_34);
+  const __m512 pixels_5678 = _mm512_permutex2var_ps(pixels_56, pack, pixels_78);
+
+  auto* out = (float*) output_pixels;
+
+  if (count == 8) [[likely]] {
+    _mm512_mask_storeu_ps(out, 0x0fff, pixels_1234);
+    _mm512_mask_storeu_ps(out + 12, 0x0fff, pixels_5678);
+  } else {
+    const auto lower = (count < 4) ? count : 4;
+    _mm512_mask_storeu_ps(out, tail_mask_16(lower * 3), pixels_1234);
+    _mm512_mask_storeu_ps(out + 12, tail_mask_16((count - lower) * 3), pixels_5678);
+  }
+}
+
+// Interpolate a row of float output pixels. Any count is supported. The last 1-7 pixels go
+// through the same SIMD path with masked loads and stores.
+static inline void interpolate_bgr_float_row(const interpolate::BGRFloatImage& image,
+                                             const interpolate::InputCoords* input_coords,
+                                             interpolate::BGRFloatPixel* output_pixels,
+                                             int count) {
+  auto x = 0;
+
+  for (; x + 8 <= count; x += 8) {
+    interpolate_bgr_float(image, input_coords + x, _mm512_loadu_ps(input_coords + x),
+                          output_pixels + x);
+  }
+
+  if (x < count) {
+    // Masked off coordinates load as (0, 0), which is a valid pixel to read
+    const __m512 coords = _mm512_maskz_loadu_ps(tail_mask_16((count - x) * 2), input_coords + x);
+
+    alignas(64) interpolate::InputCoords padded[8];
+    _mm512_store_ps(&padded[0].y, coords);
+
+    interpolate_bgr_float(image, padded, coords, output_pixels + x, count - x);
+  }
+}
+
+//
+// NV12 to BGR
+//
+
+// Mask to pack the b b b b g g g g r r r r of 4 pixels to b g r b g r b g r b g r in each lane,
+// see avx2::MASK_PACK_BGR_PLANES_HALF.
+#define MASK_PACK_BGR_PLANES_SINGLE_LANE -1, -1, -1, -1, 11, 7, 3, 10, 6, 2, 9, 5, 1, 8, 4, 0
+
+// Convert 16 pixels to BGR, bit exact with plain::convert_nv12_row(). `luma` holds the 16 luma
+// pixels and `chroma` the 8 U V pixels of their 2x1 blocks. Returns the packed pixels in the
+// lower 48 bytes.
+static inline __m512i convert_nv12_16(__m128i luma, __m128i chroma) {
+  // Luma, and the U and V of each pixel's block, as 32 bit ints
+  const __m512i y = _mm512_max_epi32(
+      _mm512_sub_epi32(_mm512_cvtepu8_epi32(luma), _mm512_set1_epi32(16)), _mm512_setzero_si512());
+  const __m512i u = _mm512_sub_epi32(
+      _mm512_cvtepu8_epi32(_mm_shuffle_epi8(
+          chroma, _mm_set_epi8(14, 14, 12, 12, 10, 10, 8, 8, 6, 6, 4, 4, 2, 2, 0, 0))),
+      _mm512_set1_epi32(128));
+  const __m512i v = _mm512_sub_epi32(
+      _mm512_cvtepu8_epi32(_mm_shuffle_epi8(
+          chroma, _mm_set_epi8(15, 15, 13, 13, 11, 11, 9, 9, 7, 7, 5, 5, 3, 3, 1, 1))),
+      _mm512_set1_epi32(128));
+
+  const __m512i y_round =
+      _mm512_add_epi32(_mm512_mullo_epi32(y, _mm512_set1_epi32(interpolate::YUV_CY)),
+                       _mm512_set1_epi32(1 << (interpolate::YUV_SHIFT - 1)));
+
+  const __m512i b = _mm512_srai_epi32(
+      _mm512_add_epi32(y_round, _mm512_mullo_epi32(u, _mm512_set1_epi32(interpolate::YUV_CUB))),
+      interpolate::YUV_SHIFT);
+  const __m512i g = _mm512_srai_epi32(
+      _mm512_add_epi32(
+          y_round,
+          _mm512_add_epi32(_mm512_mullo_epi32(u, _mm512_set1_epi32(interpolate::YUV_CUG)),
+                           _mm512_mullo_epi32(v, _mm512_set1_epi32(interpolate::YUV_CVG)))),
+      interpolate::YUV_SHIFT);
+  const __m512i r = _mm512_srai_epi32(
+      _mm512_add_epi32(y_round, _mm512_mullo_epi32(v, _mm512_set1_epi32(interpolate::YUV_CVR))),
+      interpolate::YUV_SHIFT);
+
+  // Saturate to 8 bits and pack the 4 pixels of each lane, then move them to the lower 48 bytes
+  __m512i out = _mm512_packus_epi16(_mm512_packs_epi32(b, g), _mm512_packs_epi32(r, r));
+  out = _mm512_shuffle_epi8(out, _mm512_set_epi8(MASK_PACK_BGR_PLANES_SINGLE_LANE,
+                                                 MASK_PACK_BGR_PLANES_SINGLE_LANE,
+                                                 MASK_PACK_BGR_PLANES_SINGLE_LANE,
+                                                 MASK_PACK_BGR_PLANES_SINGLE_LANE));
+
+  return _mm512_permutexvar_epi32(
+      _mm512_set_epi32(0, 0, 0, 0, 14, 13, 12, 10, 9, 8, 6, 5, 4, 2, 1, 0), out);
+}
+
+// Convert `count` luma pixels, and the U V pixels of their 2x1 blocks, to BGR. Any count is
+// supported. The last 1-15 pixels go through the same path with masked loads and stores.
+static inline void convert_nv12_row(const uint8_t* luma, const interpolate::UVPixel* chroma,
+                                    interpolate::BGRPixel* output_pixels, int count) {
+  for (auto x = 0; x < count; x += 16) {
+    const auto lanes = (x + 16 <= count) ? 16 : count - x;
+    const auto chroma_bytes = ((lanes + 1) / 2) * int(sizeof(interpolate::UVPixel));
+
+    const __m128i luma_16 = _mm_maskz_loadu_epi8(__mmask16((1u << lanes) - 1), luma + x);
+    const __m128i chroma_8 =
+        _mm_maskz_loadu_epi8(__mmask16((1u << chroma_bytes) - 1), chroma + x / 2);
+
+    const auto mask = __mmask64((1ull << (lanes * sizeof(interpolate::BGRPixel))) - 1);
+    _mm512_mask_storeu_epi8(output_pixels + x, mask, convert_nv12_16(luma_16, chroma_8));
+  }
+}
+
+//
+// Borders
+//
+
+// Limits of the y x coordinates of interior source pixels, repeated for 8 pixels: those with a
+// row below, and a column to the right plus the 2 bytes after it that the 8 byte loads read, so
+// they are interpolated without bounds checks.
+static inline __m512 interior_limits(const interpolate::BGRImage& image) {
+  const auto y = float(image.rows - 1);
+  const auto x = float(image.cols - 2);
+
+  return _mm512_set4_ps(x, y, x, y);
+}
+
+// Whether the source pixels of 8 output pixels are all interior, see interior_limits().
+// Comparisons with NaN are false, so NaN coordinates are never interior.
+static inline bool interior_step(__m512 coords, __m512 limits) {
+  const __mmask16 above = _mm512_cmp_ps_mask(coords, _mm512_setzero_ps(), _CMP_GE_OQ);
+
+  return _mm512_mask_cmp_ps_mask(above, coords, limits, _CMP_LT_OQ) == 0xffff;
+}
+
+// Bilinear interpolation of 8 adjacent interior output pixels, as interpolate() without the
+// Image::ptr_below() checks. Only the first `count` output pixels are written.
+static inline void interpolate_interior(const interpolate::BGRImage& image, __m512 coords,
+                                        const interpolate::InputCoords input_coords[8],
+                                        interpolate::BGRPixel output_pixels[8], int count = 8) {
+  const __m512i weights = calculate_weights(coords);
+  const uint8_t* p[8];
+
+  for (auto i = 0; i < 8; i++) {
+    p[i] = (const uint8_t*) image.ptr(input_coords[i].y, input_coords[i].x);
+  }
+
+  const auto step = image.step;
+  const __m512i pixels_1357 =
+      _mm512_set_epi64(*((int64_t*) (p[6] + step)), *((int64_t*) p[6]),
+                       *((int64_t*) (p[4] + step)), *((int64_t*) p[4]),
+                       *((int64_t*) (p[2] + step)), *((int64_t*) p[2]),
+                       *((int64_t*) (p[0] + step)), *((int64_t*) p[0]));
+  const __m512i pixels_2468 =
+      _mm512_set_epi64(*((int64_t*) (p[7] + step)), *((int64_t*) p[7]),
+                       *((int64_t*) (p[5] + step)), *((int64_t*) p[5]),
+                       *((int64_t*) (p[3] + step)), *((int64_t*) p[3]),
+                       *((int64_t*) (p[1] + step)), *((int64_t*) p[1]));
+
+  write_output_pixels(blend_four_pixels(pixels_1357, _mm512_unpacklo_epi64(weights, weights)),
+                      blend_four_pixels(pixels_2468, _mm512_unpackhi_epi64(weights, weights)),
+                      output_pixels, count);
+}
+
+// Rows or columns `index` of an image side of `size` pixels, mapped through the border into the
+// image. For BorderType::constant, indices outside the image are clamped to it, and cleared in
+// `inside`, the mask of the indices in the image.
+template <interpolate::BorderType type>
+static inline __m256i border_index(__m256i index, int size, __mmask8& inside) {
+  const __m256i last = _mm256_set1_epi32(size - 1);
+
+  if constexpr (type == interpolate::BorderType::reflect) {
+    // Every 2 * size pixels repeat the image then its mirror image. The float division may be
+    // off by one either way, which the remainder is corrected for.
+    const auto period = 2 * size;
+    const __m256i periods = _mm256_set1_epi32(period);
+    const __m256i period_last = _mm256_set1_epi32(period - 1);
+    const __m256 quotient =
+        _mm256_floor_ps(_mm256_div_ps(_mm256_cvtepi32_ps(index), _mm256_set1_ps(float(period))));
+
+    index = _mm256_sub_epi32(index, _mm256_mullo_epi32(_mm256_cvtps_epi32(quotient), periods));
+    index = _mm256_mask_add_epi32(
+        index, _mm256_cmplt_epi32_mask(index, _mm256_setzero_si256()), index, periods);
+    index = _mm256_mask_sub_epi32(index, _mm256_cmpgt_epi32_mask(index, period_last), index,
+                                  periods);
+    inside = 0xff;
+
+    return _mm256_mask_sub_epi32(index, _mm256_cmpgt_epi32_mask(index, last), period_last,
+                                 index);
+  } else {
+    const __m256i clamped =
+        _mm256_min_epi32(_mm256_max_epi32(index, _mm256_setzero_si256()), last);
+    inside = _mm256_cmpeq_epi32_mask(clamped, index);
+
+    return clamped;
+  }
+}
+
+// A pixel in the upper 24 bits of each 32 bit element.
+static inline __m256i broadcast_pixel(const interpolate::BGRPixel& pixel) {
+  return _mm256_set1_epi32(int((uint32_t(pixel.b) << 8) | (uint32_t(pixel.g) << 16) |
+                               (uint32_t(pixel.r) << 24)));
+}
+
+// Fetch 8 source pixels at byte offsets from the start of the image, each in the lower 24 bits of
+// a 32 bit element. Each is gathered from the byte before it, so the 32 bit loads never read past
+// the last pixel of the image. The first pixel has no byte before it, so it is masked off the
+// gather and taken from `first_pixel`, and so are BorderType::constant pixels that aren't
+// `inside`, from `border_pixel`. Both are from broadcast_pixel().
+template <interpolate::BorderType type>
+static inline __m256i fetch_border_pixels(const interpolate::BGRImage& image, __m256i offsets,
+                                          __mmask8 inside, __m256i first_pixel,
+                                          __m256i border_pixel) {
+  __mmask8 mask = _mm256_cmpgt_epi32_mask(offsets, _mm256_setzero_si256());
+  __m256i pixels = first_pixel;
+
+  if constexpr (type == interpolate::BorderType::constant) {
+    mask &= inside;
+    pixels = _mm256_mask_blend_epi32(inside, border_pixel, first_pixel);
+  }
+
+  pixels = _mm256_mmask_i32gather_epi32(pixels, mask,
+                                        _mm256_sub_epi32(offsets, _mm256_set1_epi32(1)),
+                                        image.data, 1);
+
+  return _mm256_srli_epi32(pixels, 8);
+}
+
+// Two pixels from fetch_border_pixels() side by side in the lower 48 bits of each 64 bit element,
+// as an 8 byte load of a source pixel and the one to its right.
+// 8 7 6 5 4 3 2 1
+static inline __m512i join_border_pixels(__m256i left, __m256i right) {
+  return _mm512_or_si512(_mm512_cvtepu32_epi64(left),
+                         _mm512_slli_epi64(_mm512_cvtepu32_epi64(right), 24));
+}
+
+// Bilinear interpolation of 8 adjacent output pixels with coordinates anywhere, inside or outside
+// the image, with the source pixels outside it sampled through the border. Each source pixel is a
+// 32 bit gather element from fetch_border_pixels(), so nothing outside the image is read. Only
+// the first `count` output pixels are written.
+template <interpolate::BorderType type>
+static inline void interpolate_edge(const interpolate::BGRImage& image, __m512 coords,
+                                    __m256i first_pixel, __m256i border_pixel,
+                                    interpolate::BGRPixel output_pixels[8], int count = 8) {
+  // max returns its second operand for NaN, so NaN coordinates become the lower limit
+  const __m512 limit = _mm512_set1_ps(interpolate::BORDER_COORDS_LIMIT);
+  coords = _mm512_min_ps(_mm512_max_ps(coords, _mm512_sub_ps(_mm512_setzero_ps(), limit)), limit);
+
+  // Rows in the lower 32 bits of each pair, columns in the upper
+  const __m512i floored = _mm512_cvtps_epi32(_mm512_floor_ps(coords));
+  const __m256i y = _mm512_cvtepi64_epi32(floored);
+  const __m256i x = _mm512_cvtepi64_epi32(_mm512_srli_epi64(floored, 32));
+  const __m256i one = _mm256_set1_epi32(1);
+  const __m256i step = _mm256_set1_epi32(image.step);
+  const __m256i pixel_size = _mm256_set1_epi32(sizeof(interpolate::BGRPixel));
+
+  __mmask8 top_inside, bottom_inside, left_inside, right_inside;
+  const __m256i top = _mm256_mullo_epi32(border_index<type>(y, image.rows, top_inside), step);
+  const __m256i bottom = _mm256_mullo_epi32(
+      border_index<type>(_mm256_add_epi32(y, one), image.rows, bottom_inside), step);
+  const __m256i left =
+      _mm256_mullo_epi32(border_index<type>(x, image.cols, left_inside), pixel_size);
+  const __m256i right = _mm256_mullo_epi32(
+      border_index<type>(_mm256_add_epi32(x, one), image.cols, right_inside), pixel_size);
+
+  const auto fetch = [&](__m256i row, __mmask8 row_inside, __m256i col, __mmask8 col_inside) {
+    return fetch_border_pixels<type>(image, _mm256_add_epi32(row, col), row_inside & col_inside,
+                                     first_pixel, border_pixel);
+  };
+
+  const __m512i top_pixels = join_border_pixels(fetch(top, top_inside, left, left_inside),
+                                                fetch(top, top_inside, right, right_inside));
+  const __m512i bottom_pixels =
+      join_border_pixels(fetch(bottom, bottom_inside, left, left_inside),
+                         fetch(bottom, bottom_inside, right, right_inside));
+
+  const __m512i weights = calculate_weights(coords);
+  const __m512i pixels_1357 = _mm512_unpacklo_epi64(top_pixels, bottom_pixels);
+  const __m512i pixels_2468 = _mm512_unpackhi_epi64(top_pixels, bottom_pixels);
+
+  write_output_pixels(blend_four_pixels(pixels_1357, _mm512_unpacklo_epi64(weights, weights)),
+                      blend_four_pixels(pixels_2468, _mm512_unpackhi_epi64(weights, weights)),
+                      output_pixels, count);
+}
+
+// Interpolate a row of output pixels with any coordinates, see Kernels::bilinear_border_row. Each
+// step of 8 pixels is classified once: interior steps go through interpolate_interior(), and the
+// rest through interpolate_edge(). The last 1-7 pixels go through the same paths with masked
+// loads and stores.
+template <interpolate::BorderType type>
+static inline void interpolate_border_row(const interpolate::BGRImage& image,
+                                          const interpolate::InputCoords* input_coords,
+                                          interpolate::BGRPixel* output_pixels, int count,
+                                          const interpolate::Border& border) {
+  const __m512 limits = interior_limits(image);
+  const __m256i first_pixel = broadcast_pixel(*image.data);
+  const __m256i border_pixel = broadcast_pixel(border.value);
+
+  const auto interpolate_step = [&](const interpolate::InputCoords* step_coords, __m512 coords,
+                                    interpolate::BGRPixel* step_output, int step_count) {
+    if (interior_step(coords, limits)) [[likely]] {
+      interpolate_interior(image, coords, step_coords, step_output, step_count);
+    } else {
+      interpolate_edge<type>(image, coords, first_pixel, border_pixel, step_output, step_count);
+    }
+  };
+
+  auto x = 0;
+
+  for (; x + 8 <= count; x += 8) {
+    interpolate_step(input_coords + x, _mm512_loadu_ps(input_coords + x), output_pixels + x, 8);
+  }
+
+  if (x < count) {
+    // Masked off coordinates load as (0, 0)
+    const __m512 coords = _mm512_maskz_loadu_ps(tail_mask_16((count - x) * 2), input_coords + x);
+
+    alignas(64) interpolate::InputCoords padded[8];
+    _mm512_store_ps(&padded[0].y, coords);
+
+    interpolate_step(padded, coords, output_pixels + x, count - x);
+  }
+}
+
+static inline void interpolate_border_row(const interpolate::BGRImage& image,
+                                          const interpolate::InputCoords* input_coords,
+                                          interpolate::BGRPixel* output_pixels, int count,
+                                          const interpolate::Border& border) {
+  switch (border.type) {
+    case interpolate::BorderType::constant:
+      interpolate_border_row<interpolate::BorderType::constant>(image, input_coords,
+                                                                output_pixels, count, border);
+      break;
+    case interpolate::BorderType::replicate:
+      interpolate_border_row<interpolate::BorderType::replicate>(image, input_coords,
+                                                                 output_pixels, count, border);
+      break;
+    case interpolate::BorderType::reflect:
+      interpolate_border_row<interpolate::BorderType::reflect>(image, input_coords,
+                                                               output_pixels, count, border);
+      break;
+  }
 }
 
 }    // namespace interpolate::bilinear::avx512
@@ -1,5 +1,9 @@
 #pragma once
 
+#include <string.h>
+#include <type_traits>
+
+#include "interpolate/compact_maps.hpp"
 #include "interpolate/types.hpp"
 
 namespace interpolate::bilinear::plain
@@ -39,7 +43,9 @@ static inline interpolate::BGRPixel interpolate(const interpolate::BGRImage& ima
   return {uint8_t(outb >> 8), uint8_t(outg >> 8), uint8_t(outr >> 8)};
 }
 
-template <int N>
+// Interpolate N output pixels. Without `check_below`, the source pixels must not be in the last
+// row of the image, see interior_step().
+template <int N, bool check_below = true>
 static inline void interpolate_multiple(const interpolate::BGRImage& image,
                                         interpolate::BGRPixel* output,
                                         const interpolate::InputCoords* input_coords) {
@@ -53,7 +59,7 @@ static inline void interpolate_multiple(const interpolate::BGRImage& image,
     const auto* pixel = image.ptr(py, px);
     const auto& p1 = pixel[0];
     const auto& p2 = pixel[1];
-    const auto* pixel_below = image.ptr_below(pixel);
+    const auto* pixel_below = check_below ? image.ptr_below(pixel) : image.ptr(py + 1, px);
     const auto& p3 = pixel_below[0];
     const auto& p4 = pixel_below[1];
 
@@ -80,4 +86,633 @@ static inline void interpolate_multiple(const interpolate::BGRImage& image,
   memcpy(output, output_pixels, sizeof(interpolate::BGRPixel) * N);
 }
 
+// Interpolate a row of output pixels. Any count is supported.
+static inline void interpolate_row(const interpolate::BGRImage& image,
+                                   const interpolate::InputCoords* input_coords,
+                                   interpolate::BGRPixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 4 <= count; x += 4) {
+    interpolate_multiple<4>(image, output_pixels + x, input_coords + x);
+  }
+
+  for (; x < count; x++) {
+    output_pixels[x] = interpolate(image, input_coords[x]);
+  }
+}
+
+//
+// Exact mode
+//
+
+// Bilinear interpolation from the top left source pixel and the fractional parts of a fixed
+// point coordinate, with EXACT_WEIGHT_BITS weights. The weighted sum is rounded to nearest.
+static inline interpolate::BGRPixel interpolate_fractions(const interpolate::BGRImage& image,
+                                                          const interpolate::BGRPixel* pixel,
+                                                          int fx, int fy) {
+  // Four neighbouring pixels
+  const auto& p1 = pixel[0];
+  const auto& p2 = pixel[1];
+  const auto* pixel_below = image.ptr_below(pixel);
+  const auto& p3 = pixel_below[0];
+  const auto& p4 = pixel_below[1];
+
+  int fx1 = FIXED_POINT_SCALE - fx;
+  int fy1 = FIXED_POINT_SCALE - fy;
+
+  int w1 = fx1 * fy1;
+  int w2 = fx * fy1;
+  int w3 = fx1 * fy;
+  int w4 = fx * fy;
+
+  // Calculate the weighted sum of pixels (for each color channel), rounded to nearest
+  const int round = 1 << (EXACT_WEIGHT_BITS - 1);
+  int outr = p1.r * w1 + p2.r * w2 + p3.r * w3 + p4.r * w4 + round;
+  int outg = p1.g * w1 + p2.g * w2 + p3.g * w3 + p4.g * w4 + round;
+  int outb = p1.b * w1 + p2.b * w2 + p3.b * w3 + p4.b * w4 + round;
+
+  return {uint8_t(outb >> EXACT_WEIGHT_BITS), uint8_t(outg >> EXACT_WEIGHT_BITS),
+          uint8_t(outr >> EXACT_WEIGHT_BITS)};
+}
+
+// Bilinear interpolation rounded the same way as cv::remap with INTER_LINEAR: coordinates are
+// rounded to the nearest 1/32 of a pixel, and the weighted sum of EXACT_WEIGHT_BITS weights is
+// rounded to nearest. The SIMD implementations give identical results.
+static inline interpolate::BGRPixel interpolate_exact(
+    const interpolate::BGRImage& image, const interpolate::InputCoords& input_coords) {
+  // Round to nearest, ties to even, like the SIMD float to int conversions
+  const auto x = int(lrintf(input_coords.x * FIXED_POINT_SCALE));
+  const auto y = int(lrintf(input_coords.y * FIXED_POINT_SCALE));
+
+  return interpolate_fractions(image, image.ptr(y >> FIXED_POINT_BITS, x >> FIXED_POINT_BITS),
+                               x & FIXED_POINT_MASK, y & FIXED_POINT_MASK);
+}
+
+// Interpolate a row of output pixels in the exact mode. Any count is supported.
+static inline void interpolate_exact_row(const interpolate::BGRImage& image,
+                                         const interpolate::InputCoords* input_coords,
+                                         interpolate::BGRPixel* output_pixels, int count) {
+  for (auto i = 0; i < count; i++) {
+    output_pixels[i] = interpolate_exact(image, input_coords[i]);
+  }
+}
+
+//
+// Warps
+//
+
+// Clamp source coordinates to the image. Comparisons with NaN return the clamp bound.
+static inline interpolate::InputCoords clamp_coords(const interpolate::BGRImage& image, float x,
+                                                    float y) {
+  x = (x > 0.0f) ? x : 0.0f;
+  y = (y > 0.0f) ? y : 0.0f;
+  x = (x < float(image.cols - 1)) ? x : float(image.cols - 1);
+  y = (y < float(image.rows - 1)) ? y : float(image.rows - 1);
+
+  return {y, x};
+}
+
+// Interpolate `count` pixels of output row y, starting at column x, with sampling coordinates
+// from an affine transform. Coordinates are clamped to the image.
+static inline void interpolate_affine_row(const interpolate::BGRImage& image,
+                                          const interpolate::AffineTransform& transform, int x,
+                                          int y, interpolate::BGRPixel* output_pixels,
+                                          int count) {
+  const auto& m = transform.m;
+  const auto row_x = m[0][1] * y + m[0][2];
+  const auto row_y = m[1][1] * y + m[1][2];
+
+  for (auto i = 0; i < count; i++) {
+    auto source_x = m[0][0] * float(x + i) + row_x;
+    auto source_y = m[1][0] * float(x + i) + row_y;
+
+    output_pixels[i] = interpolate(image, clamp_coords(image, source_x, source_y));
+  }
+}
+
+// As interpolate_affine_row(), with a perspective transform.
+static inline void interpolate_perspective_row(const interpolate::BGRImage& image,
+                                               const interpolate::PerspectiveTransform& transform,
+                                               int x, int y, interpolate::BGRPixel* output_pixels,
+                                               int count) {
+  const auto& m = transform.m;
+  const auto row_x = m[0][1] * y + m[0][2];
+  const auto row_y = m[1][1] * y + m[1][2];
+  const auto row_w = m[2][1] * y + m[2][2];
+
+  for (auto i = 0; i < count; i++) {
+    auto w = m[2][0] * float(x + i) + row_w;
+    auto source_x = (m[0][0] * float(x + i) + row_x) / w;
+    auto source_y = (m[1][0] * float(x + i) + row_y) / w;
+
+    output_pixels[i] = interpolate(image, clamp_coords(image, source_x, source_y));
+  }
+}
+
+//
+// Compact maps
+//
+
+// Bilinear interpolation with a fixed point coordinate, rounded as interpolate_exact(). The
+// SIMD implementations give identical results.
+static inline interpolate::BGRPixel interpolate_fixed_point(
+    const interpolate::BGRImage& image, const interpolate::FixedPointCoords& coords,
+    uint16_t fraction) {
+  return interpolate_fractions(image, image.ptr(coords.y, coords.x), fraction & FIXED_POINT_MASK,
+                               fraction >> FIXED_POINT_BITS);
+}
+
+// Interpolate a row of output pixels from a fixed point map. Any count is supported.
+static inline void interpolate_fixed_point_row(const interpolate::BGRImage& image,
+                                               const interpolate::FixedPointCoords* coords,
+                                               const uint16_t* fractions,
+                                               interpolate::BGRPixel* output_pixels, int count) {
+  for (auto i = 0; i < count; i++) {
+    output_pixels[i] = interpolate_fixed_point(image, coords[i], fractions[i]);
+  }
+}
+
+// Interpolate `count` pixels of output row y, starting at column x, from a half float offset
+// map. Coordinates are clamped to the image. Any count is supported.
+static inline void interpolate_half_float_row(const interpolate::BGRImage& image,
+                                              const interpolate::HalfFloatOffsets* offsets, int x,
+                                              int y, interpolate::BGRPixel* output_pixels,
+                                              int count) {
+  for (auto i = 0; i < count; i++) {
+    auto source_x = float(x + i) + half_to_float(offsets[i].x);
+    auto source_y = float(y) + half_to_float(offsets[i].y);
+
+    output_pixels[i] = interpolate(image, clamp_coords(image, source_x, source_y));
+  }
+}
+
+//
+// Remap plans
+//
+
+// Interpolate a row of output pixels with the offsets and weights from a RemapPlan. Any count is
+// supported.
+static inline void interpolate_plan_row(const interpolate::BGRImage& image,
+                                        const int32_t* offsets,
+                                        const interpolate::BilinearWeights* weights,
+                                        interpolate::BGRPixel* output_pixels, int count) {
+  const auto* data = (const uint8_t*) image.data;
+
+  for (auto i = 0; i < count; i++) {
+    // Four neighbouring pixels. Plans never sample below the last row.
+    const auto* pixel = (const interpolate::BGRPixel*) (data + offsets[i]);
+    const auto* pixel_below = (const interpolate::BGRPixel*) (data + offsets[i] + image.step);
+
+    const auto& p1 = pixel[0];
+    const auto& p2 = pixel[1];
+    const auto& p3 = pixel_below[0];
+    const auto& p4 = pixel_below[1];
+
+    const auto* w = weights[i].w;
+
+    // Calculate the weighted sum of pixels (for each color channel)
+    int outr = p1.r * w[0] + p2.r * w[1] + p3.r * w[2] + p4.r * w[3];
+    int outg = p1.g * w[0] + p2.g * w[1] + p3.g * w[2] + p4.g * w[3];
+    int outb = p1.b * w[0] + p2.b * w[1] + p3.b * w[2] + p4.b * w[3];
+
+    output_pixels[i] = {uint8_t(outb >> 8), uint8_t(outg >> 8), uint8_t(outr >> 8)};
+  }
+}
+
+//
+// Image pyramids
+//
+
+// Row y of the image downscaled 2x, each output pixel the rounded average of a 2x2 block of
+// source pixels. The image must have at least 2 * y + 2 rows and 2 * count columns.
+static inline void downsample_row(const interpolate::BGRImage& image, int y,
+                                  interpolate::BGRPixel* output_pixels, int count) {
+  const auto* top = image.ptr(2 * y, 0);
+  const auto* bottom = image.ptr(2 * y + 1, 0);
+
+  for (auto i = 0; i < count; i++) {
+    const auto& p1 = top[2 * i];
+    const auto& p2 = top[2 * i + 1];
+    const auto& p3 = bottom[2 * i];
+    const auto& p4 = bottom[2 * i + 1];
+
+    output_pixels[i] = {uint8_t((p1.b + p2.b + p3.b + p4.b + 2) >> 2),
+                        uint8_t((p1.g + p2.g + p3.g + p4.g + 2) >> 2),
+                        uint8_t((p1.r + p2.r + p3.r + p4.r + 2) >> 2)};
+  }
+}
+
+// Blend two rows of pixels, (a * (256 - weight) + b * weight) / 256 rounded to nearest, for
+// weights in the range 0-256.
+static inline void blend_row(const interpolate::BGRPixel* a, const interpolate::BGRPixel* b,
+                             int weight, interpolate::BGRPixel* output_pixels, int count) {
+  const auto* a_bytes = (const uint8_t*) a;
+  const auto* b_bytes = (const uint8_t*) b;
+  auto* output_bytes = (uint8_t*) output_pixels;
+
+  for (auto i = 0; i < count * 3; i++) {
+    output_bytes[i] = uint8_t((a_bytes[i] * (256 - weight) + b_bytes[i] * weight + 128) >> 8);
+  }
+}
+
+//
+// Resizes
+//
+
+// Interpolate a row of output pixels of a resize from one row of source pixels, with the byte
+// offsets of the left source pixels and their weights from a ResizePlan. Rounded to nearest. Any
+// count is supported.
+static inline void resize_row(const interpolate::BGRPixel* row, const int32_t* offsets,
+                              const interpolate::ResizeWeights* weights,
+                              interpolate::BGRPixel* output_pixels, int count) {
+  const auto* data = (const uint8_t*) row;
+
+  for (auto i = 0; i < count; i++) {
+    const auto* pixel = (const interpolate::BGRPixel*) (data + offsets[i]);
+
+    const auto& p1 = pixel[0];
+    const auto& p2 = pixel[1];
+    const auto* w = weights[i].w;
+
+    output_pixels[i] = {uint8_t((p1.b * w[0] + p2.b * w[1] + 128) >> 8),
+                        uint8_t((p1.g * w[0] + p2.g * w[1] + 128) >> 8),
+                        uint8_t((p1.r * w[0] + p2.r * w[1] + 128) >> 8)};
+  }
+}
+
+//
+// 32bpp
+//
+
+// As interpolate(), for a BGRA or BGRX image. The alpha channel is interpolated too.
+static inline interpolate::BGRAPixel interpolate_bgra(
+    const interpolate::BGRAImage& image, const interpolate::InputCoords& input_coords) {
+  auto px = int(input_coords.x);    // floor x
+  auto py = int(input_coords.y);    // floor y
+
+  // Four neighbouring pixels
+  const auto* pixel = image.ptr(py, px);
+
+  const auto& p1 = pixel[0];
+  const auto& p2 = pixel[1];
+  const auto* pixel_below = image.ptr_below(pixel);
+  const auto& p3 = pixel_below[0];
+  const auto& p4 = pixel_below[1];
+
+  // Calculate the weights for each pixel
+  float fx = input_coords.x - px;
+  float fy = input_coords.y - py;
+  float fx1 = 1.0f - fx;
+  float fy1 = 1.0f - fy;
+
+  int w1 = fx1 * fy1 * 256.0f;
+  int w2 = fx * fy1 * 256.0f;
+  int w3 = fx1 * fy * 256.0f;
+  int w4 = fx * fy * 256.0f;
+
+  int outb = p1.b * w1 + p2.b * w2 + p3.b * w3 + p4.b * w4;
+  int outg = p1.g * w1 + p2.g * w2 + p3.g * w3 + p4.g * w4;
+  int outr = p1.r * w1 + p2.r * w2 + p3.r * w3 + p4.r * w4;
+  int outa = p1.a * w1 + p2.a * w2 + p3.a * w3 + p4.a * w4;
+
+  return {uint8_t(outb >> 8), uint8_t(outg >> 8), uint8_t(outr >> 8), uint8_t(outa >> 8)};
+}
+
+// Interpolate a row of 32bpp output pixels. Any count is supported.
+static inline void interpolate_bgra_row(const interpolate::BGRAImage& image,
+                                        const interpolate::InputCoords* input_coords,
+                                        interpolate::BGRAPixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 4 <= count; x += 4) {
+    interpolate::BGRAPixel pixels[4];
+
+    for (auto i = 0; i < 4; i++) {
+      pixels[i] = interpolate_bgra(image, input_coords[x + i]);
+    }
+
+    memcpy(output_pixels + x, pixels, sizeof(pixels));
+  }
+
+  for (; x < count; x++) {
+    output_pixels[x] = interpolate_bgra(image, input_coords[x]);
+  }
+}
+
+//
+// 8 bit grayscale
+//
+
+// Bilinear interpolation of a single channel image, eg a luma plane, rounded the same way as
+// interpolate_exact(). The SIMD implementations give identical results.
+static inline uint8_t interpolate_gray(const interpolate::GrayImage& image,
+                                       const interpolate::InputCoords& input_coords) {
+  // Round to nearest, ties to even, like the SIMD float to int conversions
+  const auto x = int(lrintf(input_coords.x * FIXED_POINT_SCALE));
+  const auto y = int(lrintf(input_coords.y * FIXED_POINT_SCALE));
+
+  // Four neighbouring pixels
+  const auto* pixel = image.ptr(y >> FIXED_POINT_BITS, x >> FIXED_POINT_BITS);
+  const auto* pixel_below = image.ptr_below(pixel);
+
+  int fx = x & FIXED_POINT_MASK;
+  int fy = y & FIXED_POINT_MASK;
+  int fx1 = FIXED_POINT_SCALE - fx;
+  int fy1 = FIXED_POINT_SCALE - fy;
+
+  const int round = 1 << (EXACT_WEIGHT_BITS - 1);
+  int out = pixel[0] * fx1 * fy1 + pixel[1] * fx * fy1 + pixel_below[0] * fx1 * fy +
+            pixel_below[1] * fx * fy + round;
+
+  return uint8_t(out >> EXACT_WEIGHT_BITS);
+}
+
+// Interpolate a row of grayscale output pixels. Any count is supported.
+static inline void interpolate_gray_row(const interpolate::GrayImage& image,
+                                        const interpolate::InputCoords* input_coords,
+                                        uint8_t* output_pixels, int count) {
+  for (auto i = 0; i < count; i++) {
+    output_pixels[i] = interpolate_gray(image, input_coords[i]);
+  }
+}
+
+// As interpolate_gray(), for the interleaved U V plane of an NV12 frame.
+static inline interpolate::UVPixel interpolate_uv(const interpolate::UVImage& image,
+                                                  const interpolate::InputCoords& input_coords) {
+  const auto x = int(lrintf(input_coords.x * FIXED_POINT_SCALE));
+  const auto y = int(lrintf(input_coords.y * FIXED_POINT_SCALE));
+
+  // Four neighbouring pixels
+  const auto* pixel = image.ptr(y >> FIXED_POINT_BITS, x >> FIXED_POINT_BITS);
+  const auto* pixel_below = image.ptr_below(pixel);
+
+  int fx = x & FIXED_POINT_MASK;
+  int fy = y & FIXED_POINT_MASK;
+  int fx1 = FIXED_POINT_SCALE - fx;
+  int fy1 = FIXED_POINT_SCALE - fy;
+
+  const int round = 1 << (EXACT_WEIGHT_BITS - 1);
+  int outu = pixel[0].u * fx1 * fy1 + pixel[1].u * fx * fy1 + pixel_below[0].u * fx1 * fy +
+             pixel_below[1].u * fx * fy + round;
+  int outv = pixel[0].v * fx1 * fy1 + pixel[1].v * fx * fy1 + pixel_below[0].v * fx1 * fy +
+             pixel_below[1].v * fx * fy + round;
+
+  return {uint8_t(outu >> EXACT_WEIGHT_BITS), uint8_t(outv >> EXACT_WEIGHT_BITS)};
+}
+
+// Interpolate a row of U V output pixels. Any count is supported.
+static inline void interpolate_uv_row(const interpolate::UVImage& image,
+                                      const interpolate::InputCoords* input_coords,
+                                      interpolate::UVPixel* output_pixels, int count) {
+  for (auto i = 0; i < count; i++) {
+    output_pixels[i] = interpolate_uv(image, input_coords[i]);
+  }
+}
+
+//
+// 16 bit and float channels
+//
+
+// As interpolate(), for 16 bit or float channels. 16 bit channels are weighted with the same 8
+// bit weights and truncated, accumulating in 32 bits. Float channels are weighted with float
+// weights and not rounded.
+template <typename Channel>
+static inline interpolate::BasicBGRPixel<Channel> interpolate_deep(
+    const interpolate::Image<interpolate::BasicBGRPixel<Channel>>& image,
+    const interpolate::InputCoords& input_coords) {
+  auto px = int(input_coords.x);    // floor x
+  auto py = int(input_coords.y);    // floor y
+
+  // Four neighbouring pixels
+  const auto* pixel = image.ptr(py, px);
+
+  const auto& p1 = pixel[0];
+  const auto& p2 = pixel[1];
+  const auto* pixel_below = image.ptr_below(pixel);
+  const auto& p3 = pixel_below[0];
+  const auto& p4 = pixel_below[1];
+
+  // Calculate the weights for each pixel
+  float fx = input_coords.x - px;
+  float fy = input_coords.y - py;
+  float fx1 = 1.0f - fx;
+  float fy1 = 1.0f - fy;
+
+  if constexpr (std::is_same_v<Channel, float>) {
+    float w1 = fx1 * fy1;
+    float w2 = fx * fy1;
+    float w3 = fx1 * fy;
+    float w4 = fx * fy;
+
+    return {p1.b * w1 + p2.b * w2 + p3.b * w3 + p4.b * w4,
+            p1.g * w1 + p2.g * w2 + p3.g * w3 + p4.g * w4,
+            p1.r * w1 + p2.r * w2 + p3.r * w3 + p4.r * w4};
+  } else {
+    uint32_t w1 = fx1 * fy1 * 256.0f;
+    uint32_t w2 = fx * fy1 * 256.0f;
+    uint32_t w3 = fx1 * fy * 256.0f;
+    uint32_t w4 = fx * fy * 256.0f;
+
+    uint32_t outb = p1.b * w1 + p2.b * w2 + p3.b * w3 + p4.b * w4;
+    uint32_t outg = p1.g * w1 + p2.g * w2 + p3.g * w3 + p4.g * w4;
+    uint32_t outr = p1.r * w1 + p2.r * w2 + p3.r * w3 + p4.r * w4;
+
+    return {Channel(outb >> 8), Channel(outg >> 8), Channel(outr >> 8)};
+  }
+}
+
+// Interpolate a row of 16 bit or float output pixels. Any count is supported.
+template <typename Channel>
+static inline void interpolate_deep_row(
+    const interpolate::Image<interpolate::BasicBGRPixel<Channel>>& image,
+    const interpolate::InputCoords* input_coords,
+    interpolate::BasicBGRPixel<Channel>* output_pixels, int count) {
+  for (auto i = 0; i < count; i++) {
+    output_pixels[i] = interpolate_deep(image, input_coords[i]);
+  }
+}
+
+static inline void interpolate_bgr16_row(const interpolate::BGR16Image& image,
+                                         const interpolate::InputCoords* input_coords,
+                                         interpolate::BGR16Pixel* output_pixels, int count) {
+  interpolate_deep_row(image, input_coords, output_pixels, count);
+}
+
+static inline void interpolate_bgr_float_row(const interpolate::BGRFloatImage& image,
+                                             const interpolate::InputCoords* input_coords,
+                                             interpolate::BGRFloatPixel* output_pixels,
+                                             int count) {
+  interpolate_deep_row(image, input_coords, output_pixels, count);
+}
+
+//
+// NV12 to BGR
+//
+
+static inline uint8_t saturate_to_8_bits(int value) {
+  return uint8_t((value < 0) ? 0 : (value > 255) ? 255 : value);
+}
+
+static inline interpolate::BGRPixel yuv_to_bgr(int luma, int b_uv, int g_uv, int r_uv) {
+  const auto y = ((luma > 16) ? luma - 16 : 0) * interpolate::YUV_CY;
+
+  return {saturate_to_8_bits((y + b_uv) >> interpolate::YUV_SHIFT),
+          saturate_to_8_bits((y + g_uv) >> interpolate::YUV_SHIFT),
+          saturate_to_8_bits((y + r_uv) >> interpolate::YUV_SHIFT)};
+}
+
+// Convert `count` luma pixels, and the U V pixels of their 2x1 blocks, to BGR. The chroma terms
+// are calculated once for each block.
+static inline void convert_nv12_row(const uint8_t* luma, const interpolate::UVPixel* chroma,
+                                    interpolate::BGRPixel* output_pixels, int count) {
+  const int round = 1 << (interpolate::YUV_SHIFT - 1);
+
+  for (auto x = 0; x < count; x += 2) {
+    const auto u = int(chroma[x / 2].u) - 128;
+    const auto v = int(chroma[x / 2].v) - 128;
+    const auto b_uv = round + interpolate::YUV_CUB * u;
+    const auto g_uv = round + interpolate::YUV_CUG * u + interpolate::YUV_CVG * v;
+    const auto r_uv = round + interpolate::YUV_CVR * v;
+
+    output_pixels[x] = yuv_to_bgr(luma[x], b_uv, g_uv, r_uv);
+
+    if (x + 1 < count) [[likely]] {
+      output_pixels[x + 1] = yuv_to_bgr(luma[x + 1], b_uv, g_uv, r_uv);
+    }
+  }
+}
+
+//
+// Borders
+//
+
+// Row or column `index` of an image side of `size` pixels, mapped through the border into the
+// image, or -1 for a BorderType::constant pixel outside it.
+template <interpolate::BorderType type>
+static inline int border_index(int index, int size) {
+  if constexpr (type == interpolate::BorderType::constant) {
+    return (index >= 0 && index < size) ? index : -1;
+  } else if constexpr (type == interpolate::BorderType::replicate) {
+    return (index < 0) ? 0 : ((index < size) ? index : size - 1);
+  } else {
+    // Every 2 * size pixels repeat the image then its mirror image
+    const auto period = 2 * size;
+    index %= period;
+    index = (index < 0) ? index + period : index;
+    return (index < size) ? index : period - 1 - index;
+  }
+}
+
+// Source pixel at a row and column from border_index().
+static inline interpolate::BGRPixel border_pixel(const interpolate::BGRImage& image, int row,
+                                                 int col, const interpolate::Border& border) {
+  return (row < 0 || col < 0) ? border.value : *image.ptr(row, col);
+}
+
+// Bilinear interpolation with coordinates anywhere, inside or outside the image, with the source
+// pixels outside it sampled through the border. Weighted the same as interpolate().
+template <interpolate::BorderType type>
+static inline interpolate::BGRPixel interpolate_border(
+    const interpolate::BGRImage& image, const interpolate::InputCoords& input_coords,
+    const interpolate::Border& border) {
+  // Comparisons with NaN return the lower limit
+  auto x = (input_coords.x > -BORDER_COORDS_LIMIT) ? input_coords.x : -BORDER_COORDS_LIMIT;
+  auto y = (input_coords.y > -BORDER_COORDS_LIMIT) ? input_coords.y : -BORDER_COORDS_LIMIT;
+  x = (x < BORDER_COORDS_LIMIT) ? x : BORDER_COORDS_LIMIT;
+  y = (y < BORDER_COORDS_LIMIT) ? y : BORDER_COORDS_LIMIT;
+
+  const auto px = int(floorf(x));
+  const auto py = int(floorf(y));
+
+  // Four neighbouring pixels
+  const auto left = border_index<type>(px, image.cols);
+  const auto right = border_index<type>(px + 1, image.cols);
+  const auto top = border_index<type>(py, image.rows);
+  const auto bottom = border_index<type>(py + 1, image.rows);
+
+  const auto p1 = border_pixel(image, top, left, border);
+  const auto p2 = border_pixel(image, top, right, border);
+  const auto p3 = border_pixel(image, bottom, left, border);
+  const auto p4 = border_pixel(image, bottom, right, border);
+
+  float fx = x - px;
+  float fy = y - py;
+  float fx1 = 1.0f - fx;
+  float fy1 = 1.0f - fy;
+
+  int w1 = fx1 * fy1 * 256.0f;
+  int w2 = fx * fy1 * 256.0f;
+  int w3 = fx1 * fy * 256.0f;
+  int w4 = fx * fy * 256.0f;
+
+  int outr = p1.r * w1 + p2.r * w2 + p3.r * w3 + p4.r * w4;
+  int outg = p1.g * w1 + p2.g * w2 + p3.g * w3 + p4.g * w4;
+  int outb = p1.b * w1 + p2.b * w2 + p3.b * w3 + p4.b * w4;
+
+  return {uint8_t(outb >> 8), uint8_t(outg >> 8), uint8_t(outr >> 8)};
+}
+
+// Whether the source pixels of N output pixels are all inside the image, with a column to their
+// right and a row below, so they can be interpolated without bounds checks. Comparisons with NaN
+// are false, so NaN coordinates are never interior.
+template <int N>
+static inline bool interior_step(const interpolate::BGRImage& image,
+                                 const interpolate::InputCoords* input_coords) {
+  const auto max_x = float(image.cols - 1);
+  const auto max_y = float(image.rows - 1);
+  auto interior = true;
+
+  for (auto i = 0; i < N; i++) {
+    const auto& coords = input_coords[i];
+    interior &= coords.x >= 0.0f && coords.x < max_x && coords.y >= 0.0f && coords.y < max_y;
+  }
+
+  return interior;
+}
+
+// Interpolate a row of output pixels with any coordinates, see Kernels::bilinear_border_row.
+// Interior steps of 4 pixels are interpolated as interpolate_row() does, without
+// Image::ptr_below().
+template <interpolate::BorderType type>
+static inline void interpolate_border_row(const interpolate::BGRImage& image,
+                                          const interpolate::InputCoords* input_coords,
+                                          interpolate::BGRPixel* output_pixels, int count,
+                                          const interpolate::Border& border) {
+  auto x = 0;
+
+  for (; x + 4 <= count; x += 4) {
+    if (interior_step<4>(image, input_coords + x)) [[likely]] {
+      interpolate_multiple<4, false>(image, output_pixels + x, input_coords + x);
+    } else {
+      for (auto i = x; i < x + 4; i++) {
+        output_pixels[i] = interpolate_border<type>(image, input_coords[i], border);
+      }
+    }
+  }
+
+  for (; x < count; x++) {
+    output_pixels[x] = interpolate_border<type>(image, input_coords[x], border);
+  }
+}
+
+static inline void interpolate_border_row(const interpolate::BGRImage& image,
+                                          const interpolate::InputCoords* input_coords,
+                                          interpolate::BGRPixel* output_pixels, int count,
+                                          const interpolate::Border& border) {
+  switch (border.type) {
+    case interpolate::BorderType::constant:
+      interpolate_border_row<interpolate::BorderType::constant>(image, input_coords,
+                                                                output_pixels, count, border);
+      break;
+    case interpolate::BorderType::replicate:
+      interpolate_border_row<interpolate::BorderType::replicate>(image, input_coords,
+                                                                 output_pixels, count, border);
+      break;
+    case interpolate::BorderType::reflect:
+      interpolate_border_row<interpolate::BorderType::reflect>(image, input_coords,
+                                                               output_pixels, count, border);
+      break;
+  }
+}
+
 }    // namespace interpolate::bilinear::plain
@@ -1,6 +1,9 @@
 #pragma once
 
 #include <immintrin.h>
+#include <string.h>
+
+#include "interpolate/tail.hpp"
 #include "interpolate/types.hpp"
 
 namespace interpolate::bilinear::sse4
@@ -13,26 +16,18 @@ namespace interpolate::bilinear::sse4
 static const __m128i WEIGHTS_Y_SHUFFLE =
     _mm_set_epi8(11, 10, 11, 10, 9, 8, 9, 8, 3, 2, 3, 2, 1, 0, 1, 0);
 
-// Calculate the interpolation weights for 2 pixels.
+// Calculate the interpolation weights for 2 pixels from the fractional parts of their
+// coordinates as 16 bit ints, with `fraction_bits` bits.
+// 0 0 0 0   x2 y2 x1 y1
 // Returns weights as 16 bit ints.
 // (px2) w4 w3 w2 w1  (px1) w4 w3 w2 w1
-static inline __m128i calc_weights(const float sample_coords[4]) {
-  const __m128 initial = _mm_castsi128_ps(_mm_stream_load_si128((__m128i*) sample_coords));
-
-  const __m128 floored = _mm_floor_ps(initial);
-  const __m128 fractional = _mm_sub_ps(initial, floored);
-
-  // Convert fractional parts to 32 bit ints in range 0-256
-  // x2 y2 x1 y1
-  __m128i lower = _mm_cvtps_epi32(_mm_mul_ps(fractional, _mm_set1_ps(256.0f)));
-
-  // Convert to 16 bit ints
-  // 0 0 0 0   x2 y2 x1 y1
-  lower = _mm_packs_epi32(lower, _mm_set1_epi32(0));
-
+// With 8 bit fractions the weights are divided by 256 to 8 bits. With fewer bits the weights
+// are the exact products, see EXACT_WEIGHT_BITS.
+template <int fraction_bits = 8>
+static inline __m128i combine_weights(__m128i lower) {
   // Get the 1-fractional from the 16 bit result
   // 256 256 256 256  1-x2 1-y2 1-x1 1-y1
-  const __m128i upper = _mm_sub_epi16(_mm_set1_epi16(256), lower);
+  const __m128i upper = _mm_sub_epi16(_mm_set1_epi16(1 << fraction_bits), lower);
 
   // Combine so we have all the parts in one value to shuffle
   // x2 (1-x2) y2 (1-y2)   x1 (1-x1) y1 (1-y1)
@@ -45,18 +40,65 @@ static inline __m128i calc_weights(const float sample_coords[4]) {
   // Shuffle 16 bit numbers as 8 bits because there is no _mm256_shuffle_epi16
   __m128i weights_y = _mm_shuffle_epi8(combined, WEIGHTS_Y_SHUFFLE);
 
-  // Multiply to get per pixel weights. Divide by 256 to get back into correct range.
-  __m128i weights = _mm_srli_epi16(_mm_mullo_epi16(weights_x, weights_y), 8);
+  // Multiply to get per pixel weights
+  __m128i weights = _mm_mullo_epi16(weights_x, weights_y);
+
+  if constexpr (fraction_bits == 8) {
+    // Divide by 256 to get back into correct range.
+    weights = _mm_srli_epi16(weights, 8);
 
-  // If both weights were 256, the result is 65536 which is all 0s in the lower 16 bits.
-  // Find the weights this happened to, and replace them with 256.
-  __m128i weights_hi = _mm_mulhi_epi16(weights_x, weights_y);
-  __m128i weights_hi_mask = _mm_cmpgt_epi16(weights_hi, _mm_setzero_si128());
-  weights = _mm_blendv_epi8(weights, _mm_set1_epi16(256), weights_hi_mask);
+    // If both weights were 256, the result is 65536 which is all 0s in the lower 16 bits.
+    // Find the weights this happened to, and replace them with 256.
+    __m128i weights_hi = _mm_mulhi_epi16(weights_x, weights_y);
+    __m128i weights_hi_mask = _mm_cmpgt_epi16(weights_hi, _mm_setzero_si128());
+    weights = _mm_blendv_epi8(weights, _mm_set1_epi16(256), weights_hi_mask);
+  }
 
   return weights;
 }
 
+// Calculate the interpolation weights for 2 pixels.
+// Returns weights as 16 bit ints.
+// (px2) w4 w3 w2 w1  (px1) w4 w3 w2 w1
+// The load is unaligned, as rows of coordinates can start anywhere when the output width is odd.
+static inline __m128i calc_weights(const float sample_coords[4]) {
+  const __m128 initial = _mm_loadu_ps(sample_coords);
+
+  const __m128 floored = _mm_floor_ps(initial);
+  const __m128 fractional = _mm_sub_ps(initial, floored);
+
+  // Convert fractional parts to 32 bit ints in range 0-256
+  // x2 y2 x1 y1
+  __m128i lower = _mm_cvtps_epi32(_mm_mul_ps(fractional, _mm_set1_ps(256.0f)));
+
+  // Convert to 16 bit ints
+  // 0 0 0 0   x2 y2 x1 y1
+  lower = _mm_packs_epi32(lower, _mm_set1_epi32(0));
+
+  return combine_weights(lower);
+}
+
+// Spread the weights of 2 pixels from calc_weights() over the channels of their source pixels,
+// 4 channels of the left pixel then 4 of the right one for each row of each pixel.
+static inline void channel_weights(__m128i weights, __m128i& pixel1_w12, __m128i& pixel1_w34,
+                                   __m128i& pixel2_w12, __m128i& pixel2_w34) {
+  // Prepare weights for pixel 1
+  pixel1_w12 = _mm_shufflelo_epi16(weights, _MM_SHUFFLE(1, 1, 0, 0));
+  pixel1_w34 = _mm_shufflelo_epi16(weights, _MM_SHUFFLE(3, 3, 2, 2));
+  // w2 w2 w2 w2 w1 w1 w1 w1
+  pixel1_w12 = _mm_unpacklo_epi16(pixel1_w12, pixel1_w12);
+  // w4 w4 w4 w4 w3 w3 w3 w3
+  pixel1_w34 = _mm_unpacklo_epi16(pixel1_w34, pixel1_w34);
+
+  // Prepare weights for pixel 2
+  pixel2_w12 = _mm_shufflehi_epi16(weights, _MM_SHUFFLE(1, 1, 0, 0));
+  pixel2_w34 = _mm_shufflehi_epi16(weights, _MM_SHUFFLE(3, 3, 2, 2));
+  // w2 w2 w2 w2 w1 w1 w1 w1
+  pixel2_w12 = _mm_unpackhi_epi16(pixel2_w12, pixel2_w12);
+  // w4 w4 w4 w4 w3 w3 w3 w3
+  pixel2_w34 = _mm_unpackhi_epi16(pixel2_w34, pixel2_w34);
+}
+
 static inline __m128i interpolate_one_pixel(const interpolate::BGRImage& image,
                                             const interpolate::InputCoords& input_coords,
                                             __m128i w12, __m128i w34) {
@@ -96,7 +138,7 @@ static inline __m128i interpolate_one_pixel(const interpolate::BGRImage& image,
 
 static inline void write_output_pixels(__m128i pixel_1, __m128i pixel_2,
                                        interpolate::BGRPixel output_pixels[2],
-                                       bool can_write_third_pixel) {
+                                       bool can_write_third_pixel, int count = 2) {
   // _ _ 2 1
   __m128i combined = _mm_unpacklo_epi32(pixel_1, pixel_2);
 
@@ -108,38 +150,195 @@ static inline void write_output_pixels(__m128i pixel_1, __m128i pixel_2,
                                   // Packed pixel data
                                   6, 5, 4, 2, 1, 0));
 
-  // Write the pixel data. Faster to write 8 bytes when allowed.
+  // Write the pixel data. Faster to write 8 bytes when allowed. Only pixel 1 is written for the
+  // last pixel of an odd length row.
   uint64_t interpolated_pixels = _mm_cvtsi128_si64(combined);
-  memcpy(output_pixels, &interpolated_pixels, can_write_third_pixel ? 8 : 6);
+  memcpy(output_pixels, &interpolated_pixels,
+         count == 1 ? sizeof(interpolate::BGRPixel) : (can_write_third_pixel ? 8 : 6));
 }
 
 static inline void interpolate(const interpolate::BGRImage& image,
                                const interpolate::InputCoords input_coords[2],
-                               interpolate::BGRPixel output_pixels[2], bool can_write_third_pixel) {
+                               interpolate::BGRPixel output_pixels[2], bool can_write_third_pixel,
+                               int count = 2) {
 
   // Calculate the weights for 2 pixels
-  __m128i weights = calc_weights(&input_coords[0].y);
-
-  // Prepare weights for pixel 1
-  __m128i pixel1_w12 = _mm_shufflelo_epi16(weights, _MM_SHUFFLE(1, 1, 0, 0));
-  __m128i pixel1_w34 = _mm_shufflelo_epi16(weights, _MM_SHUFFLE(3, 3, 2, 2));
-  // w2 w2 w2 w2 w1 w1 w1 w1
-  pixel1_w12 = _mm_unpacklo_epi16(pixel1_w12, pixel1_w12);
-  // w4 w4 w4 w4 w3 w3 w3 w3
-  pixel1_w34 = _mm_unpacklo_epi16(pixel1_w34, pixel1_w34);
-
-  // Prepare weights for pixel 2
-  __m128i pixel2_w12 = _mm_shufflehi_epi16(weights, _MM_SHUFFLE(1, 1, 0, 0));
-  __m128i pixel2_w34 = _mm_shufflehi_epi16(weights, _MM_SHUFFLE(3, 3, 2, 2));
-  // w2 w2 w2 w2 w1 w1 w1 w1
-  pixel2_w12 = _mm_unpackhi_epi16(pixel2_w12, pixel2_w12);
-  // w4 w4 w4 w4 w3 w3 w3 w3
-  pixel2_w34 = _mm_unpackhi_epi16(pixel2_w34, pixel2_w34);
+  __m128i pixel1_w12, pixel1_w34, pixel2_w12, pixel2_w34;
+  channel_weights(calc_weights(&input_coords[0].y), pixel1_w12, pixel1_w34, pixel2_w12,
+                  pixel2_w34);
 
   const __m128i pixel_1 = interpolate_one_pixel(image, input_coords[0], pixel1_w12, pixel1_w34);
   const __m128i pixel_2 = interpolate_one_pixel(image, input_coords[1], pixel2_w12, pixel2_w34);
 
-  write_output_pixels(pixel_1, pixel_2, output_pixels, can_write_third_pixel);
+  write_output_pixels(pixel_1, pixel_2, output_pixels, can_write_third_pixel, count);
+}
+
+// Interpolate a row of output pixels. Any count is supported.
+static inline void interpolate_row(const interpolate::BGRImage& image,
+                                   const interpolate::InputCoords* input_coords,
+                                   interpolate::BGRPixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 2 <= count; x += 2) {
+    // The last pair in the row must not write past the end of the row.
+    auto can_write_third_pixel = (x + 2 < count);
+
+    interpolate(image, input_coords + x, output_pixels + x, can_write_third_pixel);
+  }
+
+  if (x < count) {
+    interpolate::InputCoords padded[2];
+    copy_tail<2>(input_coords + x, count - x, padded);
+
+    interpolate(image, padded, output_pixels + x, false, count - x);
+  }
+}
+
+//
+// Exact mode
+//
+
+// Interpolate one pixel in the exact mode, from its top left source pixel and its top and bottom
+// weight pairs. The products don't fit the 16 bit multiplies above, so they are summed in 32
+// bits with madd, and rounded to nearest.
+// Returns the pixel in the lower 32 bits.
+static inline __m128i interpolate_one_pixel_exact(const interpolate::BGRImage& image,
+                                                  const interpolate::BGRPixel* p0, __m128i w12,
+                                                  __m128i w34) {
+  // Each channel of the left and right pixels next to each other, as 16 bit ints
+  // _ _ r r g g b b
+  const __m128i shuffle =
+      _mm_set_epi8(-1, -1, -1, -1, -1, 5, -1, 2, -1, 4, -1, 1, -1, 3, -1, 0);
+  const __m128i p12 = _mm_shuffle_epi8(_mm_loadl_epi64((const __m128i*) p0), shuffle);
+  const __m128i p34 =
+      _mm_shuffle_epi8(_mm_loadl_epi64((const __m128i*) image.ptr_below(p0)), shuffle);
+
+  // _ r g b, 32 bpc
+  __m128i out = _mm_add_epi32(_mm_madd_epi16(p12, w12), _mm_madd_epi16(p34, w34));
+
+  out = _mm_add_epi32(out, _mm_set1_epi32(1 << (EXACT_WEIGHT_BITS - 1)));
+  out = _mm_srli_epi32(out, EXACT_WEIGHT_BITS);
+
+  // Convert from 32bpc => 16bpc => 8bpc
+  out = _mm_packus_epi32(out, _mm_setzero_si128());
+  return _mm_packus_epi16(out, _mm_setzero_si128());
+}
+
+// Interpolate 2 output pixels in the exact mode, see bilinear::plain::interpolate_exact(). Only
+// the first `count` output pixels are written.
+static inline void interpolate_exact(const interpolate::BGRImage& image,
+                                     const interpolate::InputCoords input_coords[2],
+                                     interpolate::BGRPixel output_pixels[2],
+                                     bool can_write_third_pixel, int count = 2) {
+  const __m128 coords = _mm_loadu_ps(&input_coords[0].y);
+
+  // Fixed point coordinates, rounded to nearest
+  // x2 y2 x1 y1
+  const __m128i fixed =
+      _mm_cvtps_epi32(_mm_mul_ps(coords, _mm_set1_ps(float(FIXED_POINT_SCALE))));
+  const __m128i ints = _mm_srai_epi32(fixed, FIXED_POINT_BITS);
+
+  // 0 0 0 0   x2 y2 x1 y1
+  const __m128i fractions =
+      _mm_packs_epi32(_mm_and_si128(fixed, _mm_set1_epi32(FIXED_POINT_MASK)), _mm_setzero_si128());
+  const __m128i weights = combine_weights<FIXED_POINT_BITS>(fractions);
+
+  const auto* p1 = image.ptr(_mm_extract_epi32(ints, 0), _mm_extract_epi32(ints, 1));
+  const auto* p2 = image.ptr(_mm_extract_epi32(ints, 2), _mm_extract_epi32(ints, 3));
+
+  const __m128i pixel_1 = interpolate_one_pixel_exact(
+      image, p1, _mm_shuffle_epi32(weights, _MM_SHUFFLE(0, 0, 0, 0)),
+      _mm_shuffle_epi32(weights, _MM_SHUFFLE(1, 1, 1, 1)));
+  const __m128i pixel_2 = interpolate_one_pixel_exact(
+      image, p2, _mm_shuffle_epi32(weights, _MM_SHUFFLE(2, 2, 2, 2)),
+      _mm_shuffle_epi32(weights, _MM_SHUFFLE(3, 3, 3, 3)));
+
+  write_output_pixels(pixel_1, pixel_2, output_pixels, can_write_third_pixel, count);
+}
+
+// Interpolate a row of output pixels in the exact mode. Any count is supported.
+static inline void interpolate_exact_row(const interpolate::BGRImage& image,
+                                         const interpolate::InputCoords* input_coords,
+                                         interpolate::BGRPixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 2 <= count; x += 2) {
+    interpolate_exact(image, input_coords + x, output_pixels + x, x + 2 < count);
+  }
+
+  if (x < count) {
+    interpolate::InputCoords padded[2];
+    copy_tail<2>(input_coords + x, count - x, padded);
+
+    interpolate_exact(image, padded, output_pixels + x, false, count - x);
+  }
+}
+
+//
+// 32bpp
+//
+
+// Weighted sums of the left and right source pixels of one 32bpp pixel, 16 bpc in the lower and
+// upper 64 bits, from its top left source pixel and weights from channel_weights(). Each row's
+// pixel pair is one 64 bit load, widened to 16 bpc without a shuffle. The weights sum to at most
+// 256, so the sums fit in 16 bits.
+static inline __m128i interpolate_one_pixel_bgra(const interpolate::BGRAImage& image,
+                                                 const interpolate::BGRAPixel* p0, __m128i w12,
+                                                 __m128i w34) {
+  // a2 r2 g2 b2 a1 r1 g1 b1
+  const __m128i p12 = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*) p0));
+  const __m128i p34 = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*) image.ptr_below(p0)));
+
+  return _mm_add_epi16(_mm_mullo_epi16(p12, w12), _mm_mullo_epi16(p34, w34));
+}
+
+// Interpolate 2 32bpp output pixels. Only the first `count` output pixels are written.
+static inline void interpolate_bgra(const interpolate::BGRAImage& image,
+                                    const interpolate::InputCoords input_coords[2],
+                                    interpolate::BGRAPixel output_pixels[2], int count = 2) {
+  __m128i pixel1_w12, pixel1_w34, pixel2_w12, pixel2_w34;
+  channel_weights(calc_weights(&input_coords[0].y), pixel1_w12, pixel1_w34, pixel2_w12,
+                  pixel2_w34);
+
+  const auto* p1 = image.ptr(input_coords[0].y, input_coords[0].x);
+  const auto* p2 = image.ptr(input_coords[1].y, input_coords[1].x);
+
+  const __m128i sums_1 = interpolate_one_pixel_bgra(image, p1, pixel1_w12, pixel1_w34);
+  const __m128i sums_2 = interpolate_one_pixel_bgra(image, p2, pixel2_w12, pixel2_w34);
+
+  // Add the left and right sums and divide by 256
+  // a2 r2 g2 b2 a1 r1 g1 b1
+  __m128i out =
+      _mm_add_epi16(_mm_unpacklo_epi64(sums_1, sums_2), _mm_unpackhi_epi64(sums_1, sums_2));
+  out = _mm_srli_epi16(out, 8);
+
+  // Convert to 8bpc. The pixels are already in order, so there is nothing to repack.
+  out = _mm_packus_epi16(out, _mm_setzero_si128());
+
+  if (count == 2) [[likely]] {
+    _mm_storel_epi64((__m128i*) output_pixels, out);
+  } else {
+    const auto pixel = _mm_cvtsi128_si32(out);
+    memcpy(output_pixels, &pixel, sizeof(interpolate::BGRAPixel));
+  }
+}
+
+// Interpolate a row of 32bpp output pixels. Any count is supported.
+static inline void interpolate_bgra_row(const interpolate::BGRAImage& image,
+                                        const interpolate::InputCoords* input_coords,
+                                        interpolate::BGRAPixel* output_pixels, int count) {
+  auto x = 0;
+
+  for (; x + 2 <= count; x += 2) {
+    interpolate_bgra(image, input_coords + x, output_pixels + x);
+  }
+
+  if (x < count) {
+    interpolate::InputCoords padded[2];
+    copy_tail<2>(input_coords + x, count - x, padded);
+
+    interpolate_bgra(image, padded, output_pixels + x, count - x);
+  }
 }
 
 }    // namespace interpolate::bilinear::sse4
@@ -0,0 +1,89 @@
+#include "interpolate/buffer_pool.hpp"
+
+#include <new>
+#include <stdlib.h>
+
+namespace interpolate
+{
+
+// Rows and buffers are aligned to cache lines
+static constexpr size_t ALIGNMENT = 64;
+
+ImageBufferPool::Buffer& ImageBufferPool::Buffer::operator=(Buffer&& other) noexcept {
+  if (this != &other) {
+    release();
+    pool_ = other.pool_;
+    image_ = other.image_;
+    other.pool_ = nullptr;
+  }
+
+  return *this;
+}
+
+void ImageBufferPool::Buffer::release() {
+  if (pool_ != nullptr) {
+    pool_->release(image_.data);
+    pool_ = nullptr;
+  }
+}
+
+ImageBufferPool::~ImageBufferPool() {
+  for (const auto& allocation : allocations_) {
+    free(allocation.data);
+  }
+}
+
+ImageBufferPool::Buffer ImageBufferPool::acquire(int rows, int cols) {
+  const auto step = (size_t(cols) * sizeof(BGRPixel) + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+
+  // The kernels read and write a few bytes past the last pixel
+  const auto size = step * rows + ALIGNMENT;
+
+  auto lock = std::lock_guard<std::mutex>(mutex_);
+  void* data = nullptr;
+
+  // Smallest free buffer that is large enough
+  auto best = free_.end();
+
+  for (auto it = free_.begin(); it != free_.end(); it++) {
+    if (it->size >= size && (best == free_.end() || it->size < best->size)) {
+      best = it;
+    }
+  }
+
+  if (best != free_.end()) {
+    data = best->data;
+    free_.erase(best);
+  } else {
+    data = aligned_alloc(ALIGNMENT, size);
+
+    if (data == nullptr) {
+      throw std::bad_alloc();
+    }
+
+    allocations_.push_back({data, size});
+
+    // So returning buffers never allocates
+    free_.reserve(allocations_.size());
+  }
+
+  return Buffer(this, BGRImage(rows, cols, int(step), (BGRPixel*) data));
+}
+
+size_t ImageBufferPool::allocated() const {
+  auto lock = std::lock_guard<std::mutex>(mutex_);
+  return allocations_.size();
+}
+
+void ImageBufferPool::release(void* data) {
+  auto lock = std::lock_guard<std::mutex>(mutex_);
+
+  for (const auto& allocation : allocations_) {
+    if (allocation.data == data) {
+      free_.push_back(allocation);
+      return;
+    }
+  }
+}
+
+}    // namespace interpolate
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <mutex>
+#include <stddef.h>
+#include <utility>
+#include <vector>
+
+#include "interpolate/types.hpp"
+
+namespace interpolate
+{
+
+// Reusable output images, for callers that want the library to manage output buffers without a
+// heap allocation per frame. Once the pool holds as many buffers as are in use at once, acquiring
+// a buffer never allocates.
+class ImageBufferPool
+{
+public:
+  // An image from the pool, returned to the pool when destroyed.
+  class Buffer
+  {
+  public:
+    Buffer() {}
+    Buffer(Buffer&& other) noexcept { *this = std::move(other); }
+    Buffer& operator=(Buffer&& other) noexcept;
+    ~Buffer() { release(); }
+
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+
+    // The image to write into. Rows are aligned to 64 bytes.
+    const BGRImage& image() const { return image_; }
+
+  private:
+    friend class ImageBufferPool;
+
+    Buffer(ImageBufferPool* pool, const BGRImage& image) : pool_(pool), image_(image) {}
+    void release();
+
+    ImageBufferPool* pool_ = nullptr;
+    BGRImage image_;
+  };
+
+  ImageBufferPool() {}
+  ~ImageBufferPool();
+
+  ImageBufferPool(const ImageBufferPool&) = delete;
+  ImageBufferPool& operator=(const ImageBufferPool&) = delete;
+
+  // An image of rows x cols pixels. Reuses a free buffer that is large enough if there is one,
+  // otherwise allocates a new one. The pool must outlive the buffer. Thread safe.
+  Buffer acquire(int rows, int cols);
+
+  // Number of buffers the pool has allocated.
+  size_t allocated() const;
+
+private:
+  struct Allocation {
+    void* data;
+    size_t size;
+  };
+
+  void release(void* data);
+
+  mutable std::mutex mutex_;
+  std::vector<Allocation> allocations_;
+  std::vector<Allocation> free_;
+};
+
+}    // namespace interpolate
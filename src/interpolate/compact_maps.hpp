@@ -0,0 +1,98 @@
+#pragma once
+
+#include <math.h>
+#include <string.h>
+
+#include "interpolate/types.hpp"
+
+namespace interpolate
+{
+
+//
+// Half floats
+//
+
+// Convert a float to a half float, rounding to nearest even. Values too large for a half float
+// become infinity.
+static inline uint16_t float_to_half(float value) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+
+  const uint32_t sign = (bits >> 16) & 0x8000;
+  const uint32_t abs_bits = bits & 0x7fffffff;
+
+  // NaN
+  if (abs_bits > 0x7f800000) {
+    return sign | 0x7e00;
+  }
+
+  // Overflow to infinity
+  if (abs_bits >= 0x477ff000) {
+    return sign | 0x7c00;
+  }
+
+  // Normal half float
+  if (abs_bits >= 0x38800000) {
+    const uint32_t rounded = abs_bits + 0xfff + ((abs_bits >> 13) & 1);
+    return sign | ((rounded - 0x38000000) >> 13);
+  }
+
+  // Subnormal half float, or 0
+  float abs_value;
+  memcpy(&abs_value, &abs_bits, sizeof(abs_value));
+  return sign | uint16_t(lrintf(abs_value * 16777216.0f));
+}
+
+static inline float half_to_float(uint16_t half) {
+  const uint32_t sign = uint32_t(half & 0x8000) << 16;
+  const uint32_t exponent = (half >> 10) & 0x1f;
+  const uint32_t mantissa = half & 0x3ff;
+
+  uint32_t bits;
+
+  if (exponent == 0x1f) {
+    // Infinity or NaN
+    bits = sign | 0x7f800000 | (mantissa << 13);
+  } else if (exponent != 0) {
+    bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+  } else {
+    // Subnormal half float, or 0
+    float value = float(mantissa) / 16777216.0f;
+    memcpy(&bits, &value, sizeof(bits));
+    bits |= sign;
+  }
+
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+//
+// Map conversion
+//
+
+// Convert a row of float coordinates to fixed point. The integer parts go in `coords`, and the
+// fractional parts in `fractions`. Coordinates must be within the range of int16_t.
+static inline void convert_to_fixed_point(const InputCoords* input_coords,
+                                          FixedPointCoords* coords, uint16_t* fractions,
+                                          int count) {
+  for (auto i = 0; i < count; i++) {
+    const auto x = int(lrintf(input_coords[i].x * FIXED_POINT_SCALE));
+    const auto y = int(lrintf(input_coords[i].y * FIXED_POINT_SCALE));
+
+    coords[i] = {int16_t(y >> FIXED_POINT_BITS), int16_t(x >> FIXED_POINT_BITS)};
+    fractions[i] = uint16_t(((y & FIXED_POINT_MASK) << FIXED_POINT_BITS) | (x & FIXED_POINT_MASK));
+  }
+}
+
+// Convert a row of float coordinates for output row y, starting at column x, to half float
+// offsets from the output pixel positions.
+static inline void convert_to_half_float_offsets(const InputCoords* input_coords, int x, int y,
+                                                 HalfFloatOffsets* offsets, int count) {
+  for (auto i = 0; i < count; i++) {
+    offsets[i] = {float_to_half(input_coords[i].y - float(y)),
+                  float_to_half(input_coords[i].x - float(x + i))};
+  }
+}
+
+}    // namespace interpolate
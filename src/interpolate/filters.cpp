@@ -0,0 +1,74 @@
+#include "interpolate/filters.hpp"
+
+#include <math.h>
+
+namespace interpolate
+{
+
+// Round the weights of one fraction to fixed point. The rounding error of the sum goes on the
+// largest weight, so the weights sum to exactly 1 << FILTER_WEIGHT_BITS and flat areas keep
+// their value.
+template <int taps>
+static void quantise_weights(const float (&weights)[taps], int16_t (&fixed_point)[taps]) {
+  auto sum = 0.0f;
+  for (auto w : weights) {
+    sum += w;
+  }
+
+  auto fixed_point_sum = 0;
+  auto largest = 0;
+
+  for (auto k = 0; k < taps; k++) {
+    fixed_point[k] = int16_t(lrintf(weights[k] / sum * (1 << FILTER_WEIGHT_BITS)));
+    fixed_point_sum += fixed_point[k];
+
+    if (weights[k] > weights[largest]) {
+      largest = k;
+    }
+  }
+
+  fixed_point[largest] += int16_t((1 << FILTER_WEIGHT_BITS) - fixed_point_sum);
+}
+
+// Same kernel as OpenCV's INTER_CUBIC.
+static void bicubic_weights(float t, float (&weights)[4]) {
+  const auto a = -0.75f;
+
+  weights[0] = ((a * (t + 1) - 5 * a) * (t + 1) + 8 * a) * (t + 1) - 4 * a;
+  weights[1] = ((a + 2) * t - (a + 3)) * t * t + 1;
+  weights[2] = ((a + 2) * (1 - t) - (a + 3)) * (1 - t) * (1 - t) + 1;
+  weights[3] = 1.0f - weights[0] - weights[1] - weights[2];
+}
+
+static float sinc(float x) {
+  if (fabsf(x) < 1e-6f) {
+    return 1.0f;
+  }
+
+  return sinf(float(M_PI) * x) / (float(M_PI) * x);
+}
+
+static void lanczos3_weights(float t, float (&weights)[6]) {
+  for (auto k = 0; k < 6; k++) {
+    const auto distance = t - float(k - 2);
+    weights[k] = sinc(distance) * sinc(distance / 3.0f);
+  }
+}
+
+template <int taps, typename Kernel>
+static FilterWeights<taps> build_weights(Kernel kernel) {
+  auto table = FilterWeights<taps>();
+
+  for (auto f = 0; f < FIXED_POINT_SCALE; f++) {
+    float weights[taps];
+    kernel(float(f) / FIXED_POINT_SCALE, weights);
+    quantise_weights(weights, table.w[f]);
+  }
+
+  return table;
+}
+
+const FilterWeights<4> BICUBIC_WEIGHTS = build_weights<4>(bicubic_weights);
+const FilterWeights<6> LANCZOS3_WEIGHTS = build_weights<6>(lanczos3_weights);
+
+}    // namespace interpolate
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "interpolate/types.hpp"
+
+namespace interpolate
+{
+
+// Separable interpolation filters with more taps than bilinear, for final renders. Bicubic
+// samples 4x4 source pixels with OpenCV's INTER_CUBIC kernel (a = -0.75), and Lanczos-3 samples
+// 6x6.
+enum class Filter { bicubic, lanczos3 };
+
+template <Filter filter>
+static constexpr int FILTER_TAPS = (filter == Filter::bicubic) ? 4 : 6;
+
+// Offset of the first tap in each direction from the integer part of a coordinate.
+template <Filter filter>
+static constexpr int FILTER_FIRST_TAP = 1 - FILTER_TAPS<filter> / 2;
+
+// Pixels of each source row the SIMD kernels read from the first tap, with a 16 byte load for
+// every two pairs of taps. Pixels whose loads would pass the edges of the image go through the
+// plain implementation instead.
+template <Filter filter>
+static constexpr int FILTER_LOAD_PIXELS = (filter == Filter::bicubic) ? 6 : 10;
+
+// Bits of the fixed point filter weights. The weights of each fraction sum to exactly
+// 1 << FILTER_WEIGHT_BITS.
+static constexpr int FILTER_WEIGHT_BITS = 14;
+
+// Filter weights for each fraction of a pixel. Coordinates are rounded to FIXED_POINT_BITS
+// fractional bits, as in the exact mode, so the weights are looked up instead of calculated.
+// Weight k of fraction f weights the source pixel k - (taps / 2 - 1) pixels from the integer
+// part of the coordinate.
+template <int taps>
+struct FilterWeights {
+  int16_t w[FIXED_POINT_SCALE][taps];
+};
+
+extern const FilterWeights<4> BICUBIC_WEIGHTS;
+extern const FilterWeights<6> LANCZOS3_WEIGHTS;
+
+template <Filter filter>
+static inline const FilterWeights<FILTER_TAPS<filter>>& filter_weights() {
+  if constexpr (filter == Filter::bicubic) {
+    return BICUBIC_WEIGHTS;
+  } else {
+    return LANCZOS3_WEIGHTS;
+  }
+}
+
+}    // namespace interpolate
@@ -0,0 +1,143 @@
+#include "interpolate/image_pyramid.hpp"
+
+#include <algorithm>
+#include <math.h>
+#include <stdexcept>
+
+#include "interpolate/kernels.hpp"
+
+namespace interpolate
+{
+
+void ImagePyramid::update(const BGRImage& source, Isa isa) {
+  if (source.data == source_.data && source.rows == source_.rows && source.cols == source_.cols &&
+      source.step == source_.step && !levels_.empty()) {
+    return;
+  }
+
+  const auto& kernels = supported_kernels(isa);
+
+  source_ = source;
+  levels_.assign(1, source);
+
+  // Back to the pool, to be acquired again for the levels of the same size
+  buffers_.clear();
+
+  while (levels_.back().rows / 2 >= 2 && levels_.back().cols / 2 >= 2) {
+    const auto& above = levels_.back();
+
+    buffers_.push_back(storage_.acquire(above.rows / 2, above.cols / 2));
+    const auto& level = buffers_.back().image();
+
+    for (auto y = 0; y < level.rows; y++) {
+      kernels.downsample_row(above, y, level.row(y), level.cols);
+    }
+
+    levels_.push_back(level);
+  }
+
+  builds_++;
+}
+
+void ImagePyramid::level_coords(int level, const InputCoords* coords, InputCoords* level_coords,
+                                int count) const {
+  // The centre of level pixel x is between source pixels 2x and 2x + 1 of the level above
+  const auto scale = 1.0f / float(1 << level);
+  const auto offset = 0.5f * scale - 0.5f;
+  const auto max_y = float(levels_[level].rows - 1);
+  const auto max_x = float(levels_[level].cols - 1);
+
+  // Written as comparisons rather than fminf() and fmaxf() so the loop vectorises
+  for (auto i = 0; i < count; i++) {
+    const auto y = coords[i].y * scale + offset;
+    const auto x = coords[i].x * scale + offset;
+    const auto above_y = y > 0.0f ? y : 0.0f;
+    const auto above_x = x > 0.0f ? x : 0.0f;
+
+    level_coords[i] = {above_y < max_y ? above_y : max_y, above_x < max_x ? above_x : max_x};
+  }
+}
+
+float ImagePyramid::level_of_detail(float footprint) const {
+  if (!(footprint > 1.0f)) {
+    return 0.0f;
+  }
+
+  return fminf(log2f(footprint), float(levels() - 1));
+}
+
+// Source pixels per output pixel around a row segment of a map: the larger of the distances
+// between the coordinates of horizontally and vertically adjacent output pixels.
+static float footprint(const CoordsMap& map, int y, int x, int count) {
+  const auto* coords = map.row(y) + x;
+
+  const auto distance = [](const InputCoords& a, const InputCoords& b) {
+    return hypotf(a.y - b.y, a.x - b.x);
+  };
+
+  auto dx = 0.0f;
+  auto dy = 0.0f;
+
+  if (count > 1) {
+    dx = distance(coords[count - 1], coords[0]) / float(count - 1);
+  }
+
+  if (map.rows > 1) {
+    auto other_y = (y + 1 < map.rows) ? y + 1 : y - 1;
+    dy = distance(map.row(other_y)[x], coords[0]);
+  }
+
+  return std::max(dx, dy);
+}
+
+// Interpolate `count` output pixels from a level of the pyramid, with source image coordinates.
+static void sample_level(const ImagePyramid& pyramid, const Kernels& kernels, int level,
+                         const InputCoords* coords, InputCoords* level_coords,
+                         BGRPixel* output_pixels, int count) {
+  if (level == 0) {
+    kernels.bilinear_row(pyramid.level(0), coords, output_pixels, count);
+    return;
+  }
+
+  pyramid.level_coords(level, coords, level_coords, count);
+  kernels.bilinear_row(pyramid.level(level), level_coords, output_pixels, count);
+}
+
+void remap(const ImagePyramid& pyramid, const CoordsMap& map, const BGRImage& output,
+           MipmapFilter filter, Isa isa, ThreadPool& pool) {
+  if (output.rows != map.rows || output.cols != map.cols) {
+    throw std::runtime_error("output image must be the same size as the map");
+  }
+
+  const auto& kernels = supported_kernels(isa);
+  const auto trilinear = filter == MipmapFilter::trilinear;
+
+  pool.parallel_for(output.rows, 0, [&](int begin, int end) {
+    InputCoords level_coords[MIPMAP_SEGMENT];
+    BGRPixel lower_level_pixels[MIPMAP_SEGMENT];
+
+    for (auto y = begin; y < end; y++) {
+      const auto* coords_row = map.row(y);
+      auto* output_row = output.row(y);
+
+      for (auto x = 0; x < output.cols; x += MIPMAP_SEGMENT) {
+        auto count = std::min(MIPMAP_SEGMENT, output.cols - x);
+        auto lod = pyramid.level_of_detail(footprint(map, y, x, count));
+
+        auto level = trilinear ? int(lod) : int(lod + 0.5f);
+        auto weight = trilinear ? int((lod - level) * 256.0f) : 0;
+
+        sample_level(pyramid, kernels, level, coords_row + x, level_coords, output_row + x,
+                     count);
+
+        if (weight > 0) {
+          sample_level(pyramid, kernels, level + 1, coords_row + x, level_coords,
+                       lower_level_pixels, count);
+          kernels.blend_row(output_row + x, lower_level_pixels, weight, output_row + x, count);
+        }
+      }
+    }
+  });
+}
+
+}    // namespace interpolate
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+#include "interpolate/buffer_pool.hpp"
+#include "interpolate/isa.hpp"
+#include "interpolate/thread_pool.hpp"
+#include "interpolate/types.hpp"
+
+namespace interpolate
+{
+
+// Mipmap levels of a source image for heavy downscales. Level 0 is the source image, and each
+// level below is half the size of the one above, rounded down, each pixel the average of a 2x2
+// block. Sampling a level whose pixels are about the size of the output pixels avoids the aliasing
+// of plain bilinear interpolation, and reads a much smaller area of memory.
+//
+// The levels are built with the downsample kernels of an instruction set, and kept until the
+// pyramid is updated with a different source image, so a pyramid of a source image that doesn't
+// change is reused across frames.
+class ImagePyramid
+{
+public:
+  ImagePyramid() {}
+
+  ImagePyramid(const ImagePyramid&) = delete;
+  ImagePyramid& operator=(const ImagePyramid&) = delete;
+
+  // Build the levels of `source` with the kernels for `isa`, unless they were already built from
+  // the same image: the same pixels pointer, size and step. Call invalidate() first if the
+  // source pixels have been written in place. The source image must outlive the pyramid's use.
+  void update(const BGRImage& source, Isa isa);
+
+  // Forget the source image, so the next update() rebuilds the levels.
+  void invalidate() { source_ = BGRImage(); }
+
+  // Number of levels, including the source image. Levels stop before either side would be
+  // smaller than 2 pixels.
+  int levels() const { return (int) levels_.size(); }
+
+  const BGRImage& level(int level) const { return levels_[level]; }
+
+  // Number of times the levels have been built.
+  size_t builds() const { return builds_; }
+
+  // Convert `count` source image coordinates to coordinates in `level`, clamped to the level.
+  void level_coords(int level, const InputCoords* coords, InputCoords* level_coords,
+                    int count) const;
+
+  // Level of detail for sampling `footprint` source pixels per output pixel: log2(footprint),
+  // clamped to the levels of the pyramid. 0 when magnifying.
+  float level_of_detail(float footprint) const;
+
+private:
+  BGRImage source_;
+  std::vector<BGRImage> levels_;
+
+  // Pixels of the levels below the source image, with rows aligned to cache lines. Rebuilding
+  // the levels for a new source image of the same size reuses the same buffers.
+  ImageBufferPool storage_;
+  std::vector<ImageBufferPool::Buffer> buffers_;
+
+  size_t builds_ = 0;
+};
+
+// How a mipmapped remap samples the pyramid: from the nearest level to the local scale of the map,
+// or from the two levels either side of it, blended (trilinear).
+enum class MipmapFilter { nearest_level, trilinear };
+
+// Bilinear interpolation of a whole frame from a coordinate map in source image coordinates,
+// sampling each segment of MIPMAP_SEGMENT output pixels of a row from the pyramid level that
+// matches the local scale of the map, so heavy downscales don't alias. The rows are spread over
+// the threads of a pool. The pyramid must have been updated with the source image first.
+//
+// The output must be the size of the map, and `isa` supported by the CPU (see isa_supported()),
+// or a std::runtime_error is thrown.
+void remap(const ImagePyramid& pyramid, const CoordsMap& map, const BGRImage& output,
+           MipmapFilter filter, Isa isa, ThreadPool& pool);
+
+// Output row segments of a mipmapped remap sample one level, or one pair of levels.
+static constexpr int MIPMAP_SEGMENT = 64;
+
+}    // namespace interpolate
@@ -0,0 +1,113 @@
+#include "interpolate/isa.hpp"
+
+#include <atomic>
+#include <stdexcept>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+namespace interpolate
+{
+
+const char* isa_name(Isa isa) {
+  switch (isa) {
+    case Isa::plain:
+      return "plain";
+    case Isa::sse4:
+      return "sse4";
+    case Isa::avx2:
+      return "avx2";
+    case Isa::avx512:
+      return "avx512";
+    case Isa::avx512_icl:
+      return "avx512_icl";
+    case Isa::avx2_gather:
+      return "avx2_gather";
+    case Isa::avx512_gather:
+      return "avx512_gather";
+  }
+
+  return "unknown";
+}
+
+Isa isa_from_name(const char* name) {
+  for (auto isa : ALL_ISAS) {
+    if (strcmp(name, isa_name(isa)) == 0) {
+      return isa;
+    }
+  }
+
+  throw std::runtime_error(std::string("unknown instruction set: ") + name);
+}
+
+bool isa_supported(Isa isa) {
+  // Also checks the OS saves the extended register state (XGETBV).
+  __builtin_cpu_init();
+
+  switch (isa) {
+    case Isa::plain:
+      return true;
+    case Isa::sse4:
+      return __builtin_cpu_supports("sse4.1");
+    case Isa::avx2:
+    case Isa::avx2_gather:
+      return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") &&
+             __builtin_cpu_supports("f16c");
+    case Isa::avx512:
+    case Isa::avx512_gather:
+      return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+             __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512dq");
+    case Isa::avx512_icl:
+      return isa_supported(Isa::avx512) && __builtin_cpu_supports("avx512vbmi") &&
+             __builtin_cpu_supports("avx512vnni");
+  }
+
+  return false;
+}
+
+Isa best_isa() {
+  auto best = Isa::plain;
+
+  for (auto isa : {Isa::plain, Isa::sse4, Isa::avx2, Isa::avx512, Isa::avx512_icl}) {
+    if (isa_supported(isa)) {
+      best = isa;
+    }
+  }
+
+  return best;
+}
+
+static Isa initial_isa() {
+  const char* name = getenv("BILINEAR_ISA");
+
+  if (name == nullptr || *name == '\0') {
+    return best_isa();
+  }
+
+  auto isa = isa_from_name(name);
+
+  if (!isa_supported(isa)) {
+    throw std::runtime_error(std::string("BILINEAR_ISA not supported by this CPU: ") + name);
+  }
+
+  return isa;
+}
+
+// Resolved once, on first use.
+static std::atomic<Isa>& active_isa_storage() {
+  static std::atomic<Isa> active(initial_isa());
+  return active;
+}
+
+Isa active_isa() { return active_isa_storage().load(std::memory_order_relaxed); }
+
+void set_active_isa(Isa isa) {
+  if (!isa_supported(isa)) {
+    throw std::runtime_error(std::string("instruction set not supported by this CPU: ") +
+                             isa_name(isa));
+  }
+
+  active_isa_storage().store(isa, std::memory_order_relaxed);
+}
+
+}    // namespace interpolate
@@ -0,0 +1,40 @@
+#pragma once
+
+namespace interpolate
+{
+
+// Instruction sets with an interpolation implementation, from slowest to fastest.
+//
+// avx512_icl is avx512 plus the VBMI and VNNI extensions (Ice Lake and later), which shorten
+// the blending and packing of each step of output pixels.
+//
+// avx2_gather and avx512_gather are variants of avx2 and avx512 that calculate source pixel
+// addresses in vector registers and fetch the source pixels with hardware gathers. Whether
+// gathers beat scalar loads depends on the microarchitecture, so they are never picked by
+// best_isa() and have to be selected, eg with BILINEAR_ISA=avx512_gather.
+enum class Isa { plain, sse4, avx2, avx512, avx512_icl, avx2_gather, avx512_gather };
+
+static constexpr Isa ALL_ISAS[] = {Isa::plain,      Isa::sse4,        Isa::avx2,
+                                   Isa::avx512,     Isa::avx512_icl,  Isa::avx2_gather,
+                                   Isa::avx512_gather};
+
+const char* isa_name(Isa isa);
+
+// Parse an instruction set name as returned by isa_name(). Throws if the name is unknown.
+Isa isa_from_name(const char* name);
+
+// Whether the CPU (and OS) supports an instruction set. Checked with CPUID at runtime.
+bool isa_supported(Isa isa);
+
+// The fastest instruction set supported by the CPU, not counting the gather variants.
+Isa best_isa();
+
+// The instruction set used by the dispatched kernels. Defaults to best_isa(), unless the
+// BILINEAR_ISA environment variable names a different one (eg BILINEAR_ISA=avx2).
+Isa active_isa();
+
+// Force the dispatched kernels to use a specific instruction set, eg for A/B benchmarking.
+// Throws if the CPU doesn't support it.
+void set_active_isa(Isa isa);
+
+}    // namespace interpolate
@@ -0,0 +1,55 @@
+#include "interpolate/kernels.hpp"
+
+#include <stdexcept>
+
+namespace interpolate
+{
+
+const Kernels& kernels_for(Isa isa) {
+  switch (isa) {
+    case Isa::plain:
+      return kernels_plain;
+    case Isa::sse4:
+      return kernels_sse4;
+    case Isa::avx2:
+      return kernels_avx2;
+    case Isa::avx512:
+      return kernels_avx512;
+    case Isa::avx512_icl:
+      return kernels_avx512_icl;
+    case Isa::avx2_gather:
+      return kernels_avx2_gather;
+    case Isa::avx512_gather:
+      return kernels_avx512_gather;
+  }
+
+  return kernels_plain;
+}
+
+const Kernels& supported_kernels(Isa isa) {
+  if (!isa_supported(isa)) {
+    throw std::runtime_error("instruction set not supported by this CPU");
+  }
+
+  return kernels_for(isa);
+}
+
+int bilinear_row_step(Isa isa) {
+  switch (isa) {
+    case Isa::plain:
+      return 1;
+    case Isa::sse4:
+      return 2;
+    case Isa::avx2:
+    case Isa::avx2_gather:
+      return 4;
+    case Isa::avx512:
+    case Isa::avx512_icl:
+    case Isa::avx512_gather:
+      return 8;
+  }
+
+  return 1;
+}
+
+}    // namespace interpolate
@@ -0,0 +1,149 @@
+#pragma once
+
+#include "interpolate/isa.hpp"
+#include "interpolate/types.hpp"
+
+namespace interpolate
+{
+
+// Entry points implemented for each instruction set. Each table lives in its own translation
+// unit, compiled with the flags for that instruction set, so one binary runs on any x86-64 CPU.
+struct Kernels {
+  // Bilinear interpolation of a row of output pixels from a row of sampling coordinates.
+  // Any count is supported. The SIMD implementations process several pixels at a time, and
+  // finish the last partial step of a row with padded or masked loads and partial stores.
+  void (*bilinear_row)(const BGRImage& image, const InputCoords* input_coords,
+                       BGRPixel* output_pixels, int count);
+
+  // As bilinear_row, writing whole cache lines of the output with non-temporal stores. The output
+  // bypasses the cache instead of being read for ownership and evicting the source pixels, which
+  // is faster when the output is much larger than the cache. The caller must call
+  // streaming_store_fence() (see streaming.hpp) after its last row, before the output is used.
+  // The plain and sse4 tables use regular stores.
+  void (*bilinear_streaming_row)(const BGRImage& image, const InputCoords* input_coords,
+                                 BGRPixel* output_pixels, int count);
+
+  // As bilinear_row, rounded the same way as cv::remap with INTER_LINEAR: coordinates are
+  // rounded to the nearest 1/32 of a pixel, and the weighted sums of EXACT_WEIGHT_BITS weights
+  // are rounded to nearest. Every instruction set gives identical output. Slower than
+  // bilinear_row, which truncates 8 bit weights and differs slightly between instruction sets.
+  void (*bilinear_exact_row)(const BGRImage& image, const InputCoords* input_coords,
+                             BGRPixel* output_pixels, int count);
+
+  // Interpolation of a row of output pixels with a separable filter of 4x4 (bicubic) or 6x6
+  // (Lanczos-3) taps, see filters.hpp. Coordinates are rounded to the nearest 1/32 of a pixel as
+  // in the exact mode, and taps outside the image repeat the edge pixels. Every instruction set
+  // gives identical output. Pixels near the edges of the image, and the last partial step of a
+  // row, go through the plain implementation.
+  void (*bicubic_row)(const BGRImage& image, const InputCoords* input_coords,
+                      BGRPixel* output_pixels, int count);
+  void (*lanczos3_row)(const BGRImage& image, const InputCoords* input_coords,
+                       BGRPixel* output_pixels, int count);
+
+  // Bilinear interpolation of `count` pixels of output row y, starting at column x, with the
+  // sampling coordinates generated from a transform instead of read from a map. Coordinates
+  // are clamped to the image. The sse4 table uses the plain implementation.
+  void (*bilinear_affine_row)(const BGRImage& image, const AffineTransform& transform, int x,
+                              int y, BGRPixel* output_pixels, int count);
+  void (*bilinear_perspective_row)(const BGRImage& image, const PerspectiveTransform& transform,
+                                   int x, int y, BGRPixel* output_pixels, int count);
+
+  // Bilinear interpolation of a row of output pixels from the compact map formats, see
+  // compact_maps.hpp. The half float map holds offsets from output row y, starting at column x,
+  // and its coordinates are clamped to the image.
+  void (*bilinear_fixed_point_row)(const BGRImage& image, const FixedPointCoords* coords,
+                                   const uint16_t* fractions, BGRPixel* output_pixels, int count);
+  void (*bilinear_half_float_row)(const BGRImage& image, const HalfFloatOffsets* offsets, int x,
+                                  int y, BGRPixel* output_pixels, int count);
+
+  // Bilinear interpolation of a row of output pixels with the offsets and weights of a row of a
+  // RemapPlan (see remap_plan.hpp). The plan must be compatible with the image.
+  void (*bilinear_plan_row)(const BGRImage& image, const int32_t* offsets,
+                            const BilinearWeights* weights, BGRPixel* output_pixels, int count);
+
+  // Row y of an image downscaled 2x, each output pixel the rounded average of a 2x2 block of
+  // source pixels, to build an ImagePyramid (see image_pyramid.hpp). The image must have at
+  // least 2 * y + 2 rows and 2 * count columns. Every instruction set gives identical output.
+  void (*downsample_row)(const BGRImage& image, int y, BGRPixel* output_pixels, int count);
+
+  // Blend two rows of pixels, (a * (256 - weight) + b * weight) / 256 rounded to nearest, for
+  // weights 0-256. Blends the samples of two pyramid levels. The sse4 table uses the plain
+  // implementation of both pyramid kernels.
+  void (*blend_row)(const BGRPixel* a, const BGRPixel* b, int weight, BGRPixel* output_pixels,
+                    int count);
+
+  // Bilinear interpolation of a row of output pixels of a resize from one row of source pixels,
+  // with the byte offsets of the left source pixels and their weights from a ResizePlan (see
+  // resize_plan.hpp). Rounded to nearest, and every instruction set gives identical output. The
+  // sse4 table uses the plain implementation.
+  void (*resize_row)(const BGRPixel* row, const int32_t* offsets, const ResizeWeights* weights,
+                     BGRPixel* output_pixels, int count);
+
+  // As bilinear_row, for 32bpp BGRA or BGRX images. Each row's pair of source pixels is one 64
+  // bit load and output pixels are written as whole 32 bit lanes, so the SIMD implementations
+  // skip the shuffles that unpack and repack 24bpp. The results match bilinear_row on the B, G
+  // and R channels. The gather tables use scalar fetches.
+  void (*bilinear_bgra_row)(const BGRAImage& image, const InputCoords* input_coords,
+                            BGRAPixel* output_pixels, int count);
+
+  // Bilinear interpolation of a row of 8 bit single channel output pixels, eg luma. Rounded as
+  // bilinear_exact_row, and every instruction set gives identical output. The AVX2 and AVX512
+  // implementations fetch each row's pair of source pixels with a gather and weight them with
+  // maddubs, 16 and 32 output pixels per iteration. The sse4 table uses the plain
+  // implementation.
+  void (*bilinear_gray_row)(const GrayImage& image, const InputCoords* input_coords,
+                            uint8_t* output_pixels, int count);
+
+  // As bilinear_gray_row, for the interleaved U V plane of an NV12 frame. Each pair of U V
+  // pixels is one 32 bit gather element.
+  void (*bilinear_uv_row)(const UVImage& image, const InputCoords* input_coords,
+                          UVPixel* output_pixels, int count);
+
+  // Convert a row of `count` NV12 pixels to BGR: the luma pixels, and the U V pixels of their
+  // 2x1 blocks. Bit exact with OpenCV's COLOR_YUV2BGR_NV12 on every instruction set.
+  void (*nv12_to_bgr_row)(const uint8_t* luma, const UVPixel* chroma, BGRPixel* output_pixels,
+                          int count);
+
+  // As bilinear_row, for 16 bit channels, eg 10 or 12 bit HDR frames, and for float channels.
+  // 16 bit channels are weighted with the same 8 bit weights and truncated, accumulating in 32
+  // bits. Float channels are weighted with float weights, with FMA in the SIMD implementations.
+  // The sse4 table uses the plain implementations.
+  void (*bilinear_bgr16_row)(const BGR16Image& image, const InputCoords* input_coords,
+                             BGR16Pixel* output_pixels, int count);
+  void (*bilinear_bgr_float_row)(const BGRFloatImage& image, const InputCoords* input_coords,
+                                 BGRFloatPixel* output_pixels, int count);
+
+  // As bilinear_row, for coordinates anywhere, inside or outside the image, with the source
+  // pixels outside it sampled through `border`. Each SIMD step of output pixels is classified
+  // once: if all its source pixels are interior, with a row below and a column to the right, it
+  // is interpolated as bilinear_row does without Image::ptr_below()'s check, and otherwise the
+  // source rows and columns are mapped through the border in registers, without branches, and
+  // fetched with 32 bit gathers. Nothing outside the image's pixels is read. The sse4 table uses
+  // the plain implementation, and the gather tables use scalar fetches on the interior.
+  void (*bilinear_border_row)(const BGRImage& image, const InputCoords* input_coords,
+                              BGRPixel* output_pixels, int count, const Border& border);
+};
+
+extern const Kernels kernels_plain;
+extern const Kernels kernels_sse4;
+extern const Kernels kernels_avx2;
+extern const Kernels kernels_avx512;
+extern const Kernels kernels_avx512_icl;
+extern const Kernels kernels_avx2_gather;
+extern const Kernels kernels_avx512_gather;
+
+// Kernels for a specific instruction set. The caller must check isa_supported() first.
+const Kernels& kernels_for(Isa isa);
+
+// As kernels_for(), for entry points that take an instruction set from the caller: throws a
+// std::runtime_error if the CPU doesn't support it.
+const Kernels& supported_kernels(Isa isa);
+
+// Kernels for the active instruction set (see active_isa()).
+static inline const Kernels& kernels() { return kernels_for(active_isa()); }
+
+// Number of output pixels the bilinear kernels process per step. Rows and tiles whose widths are
+// multiples of this avoid the slower partial step at the end of each row.
+int bilinear_row_step(Isa isa);
+
+}    // namespace interpolate
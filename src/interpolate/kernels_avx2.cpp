@@ -0,0 +1,62 @@
+// Compiled with the avx2 instruction set flags, see CMakeLists.txt.
+
+#include "interpolate/bicubic_avx2.hpp"
+#include "interpolate/bilinear_avx2.hpp"
+#include "interpolate/kernels.hpp"
+
+namespace interpolate
+{
+
+const Kernels kernels_avx2 = [] {
+  auto kernels = Kernels();
+  kernels.bilinear_row = bilinear::avx2::interpolate_row;
+  kernels.bilinear_streaming_row = bilinear::avx2::interpolate_streaming_row;
+  kernels.bilinear_exact_row = bilinear::avx2::interpolate_exact_row;
+  kernels.bicubic_row = bicubic::avx2::interpolate_row<Filter::bicubic>;
+  kernels.lanczos3_row = bicubic::avx2::interpolate_row<Filter::lanczos3>;
+  kernels.bilinear_affine_row = bilinear::avx2::interpolate_affine_row;
+  kernels.bilinear_perspective_row = bilinear::avx2::interpolate_perspective_row;
+  kernels.bilinear_fixed_point_row = bilinear::avx2::interpolate_fixed_point_row;
+  kernels.bilinear_half_float_row = bilinear::avx2::interpolate_half_float_row;
+  kernels.bilinear_plan_row = bilinear::avx2::interpolate_plan_row;
+  kernels.downsample_row = bilinear::avx2::downsample_row;
+  kernels.blend_row = bilinear::avx2::blend_row;
+  kernels.resize_row = bilinear::avx2::resize_row;
+  kernels.bilinear_bgra_row = bilinear::avx2::interpolate_bgra_row;
+  kernels.bilinear_gray_row = bilinear::avx2::interpolate_gray_row;
+  kernels.bilinear_uv_row = bilinear::avx2::interpolate_uv_row;
+  kernels.nv12_to_bgr_row = bilinear::avx2::convert_nv12_row;
+  kernels.bilinear_bgr16_row = bilinear::avx2::interpolate_bgr16_row;
+  kernels.bilinear_bgr_float_row = bilinear::avx2::interpolate_bgr_float_row;
+  kernels.bilinear_border_row = bilinear::avx2::interpolate_border_row;
+  return kernels;
+}();
+
+// Fetches source pixels with hardware gathers, see isa.hpp.
+const Kernels kernels_avx2_gather = [] {
+  auto kernels = Kernels();
+  kernels.bilinear_row = bilinear::avx2::interpolate_row<Fetch::gather>;
+  kernels.bilinear_streaming_row =
+      bilinear::avx2::interpolate_streaming_row<Fetch::gather>;
+  kernels.bilinear_exact_row = bilinear::avx2::interpolate_exact_row<Fetch::gather>;
+  kernels.bicubic_row = bicubic::avx2::interpolate_row<Filter::bicubic>;
+  kernels.lanczos3_row = bicubic::avx2::interpolate_row<Filter::lanczos3>;
+  kernels.bilinear_affine_row = bilinear::avx2::interpolate_affine_row<Fetch::gather>;
+  kernels.bilinear_perspective_row = bilinear::avx2::interpolate_perspective_row<Fetch::gather>;
+  kernels.bilinear_fixed_point_row = bilinear::avx2::interpolate_fixed_point_row<Fetch::gather>;
+  kernels.bilinear_half_float_row = bilinear::avx2::interpolate_half_float_row<Fetch::gather>;
+  kernels.bilinear_plan_row = bilinear::avx2::interpolate_plan_row<Fetch::gather>;
+  kernels.downsample_row = bilinear::avx2::downsample_row;
+  kernels.blend_row = bilinear::avx2::blend_row;
+  kernels.resize_row = bilinear::avx2::resize_row;
+  kernels.bilinear_bgra_row = bilinear::avx2::interpolate_bgra_row;
+  kernels.bilinear_gray_row = bilinear::avx2::interpolate_gray_row;
+  kernels.bilinear_uv_row = bilinear::avx2::interpolate_uv_row;
+  kernels.nv12_to_bgr_row = bilinear::avx2::convert_nv12_row;
+  kernels.bilinear_bgr16_row = bilinear::avx2::interpolate_bgr16_row;
+  kernels.bilinear_bgr_float_row = bilinear::avx2::interpolate_bgr_float_row;
+  kernels.bilinear_border_row = bilinear::avx2::interpolate_border_row;
+  return kernels;
+}();
+
+}    // namespace interpolate
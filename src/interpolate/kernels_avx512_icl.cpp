@@ -0,0 +1,36 @@
+// Compiled with the avx512 instruction set flags plus VBMI and VNNI, see CMakeLists.txt. The
+// kernels are the avx512 ones, which use the extensions where they are enabled.
+
+#include "interpolate/bicubic_avx512.hpp"
+#include "interpolate/bilinear_avx512.hpp"
+#include "interpolate/kernels.hpp"
+
+namespace interpolate
+{
+
+const Kernels kernels_avx512_icl = [] {
+  auto kernels = Kernels();
+  kernels.bilinear_row = bilinear::avx512::interpolate_row;
+  kernels.bilinear_streaming_row = bilinear::avx512::interpolate_streaming_row;
+  kernels.bilinear_exact_row = bilinear::avx512::interpolate_exact_row;
+  kernels.bicubic_row = bicubic::avx512::interpolate_row<Filter::bicubic>;
+  kernels.lanczos3_row = bicubic::avx512::interpolate_row<Filter::lanczos3>;
+  kernels.bilinear_affine_row = bilinear::avx512::interpolate_affine_row;
+  kernels.bilinear_perspective_row = bilinear::avx512::interpolate_perspective_row;
+  kernels.bilinear_fixed_point_row = bilinear::avx512::interpolate_fixed_point_row;
+  kernels.bilinear_half_float_row = bilinear::avx512::interpolate_half_float_row;
+  kernels.bilinear_plan_row = bilinear::avx512::interpolate_plan_row;
+  kernels.downsample_row = bilinear::avx512::downsample_row;
+  kernels.blend_row = bilinear::avx512::blend_row;
+  kernels.resize_row = bilinear::avx512::resize_row;
+  kernels.bilinear_bgra_row = bilinear::avx512::interpolate_bgra_row;
+  kernels.bilinear_gray_row = bilinear::avx512::interpolate_gray_row;
+  kernels.bilinear_uv_row = bilinear::avx512::interpolate_uv_row;
+  kernels.nv12_to_bgr_row = bilinear::avx512::convert_nv12_row;
+  kernels.bilinear_bgr16_row = bilinear::avx512::interpolate_bgr16_row;
+  kernels.bilinear_bgr_float_row = bilinear::avx512::interpolate_bgr_float_row;
+  kernels.bilinear_border_row = bilinear::avx512::interpolate_border_row;
+  return kernels;
+}();
+
+}    // namespace interpolate
@@ -0,0 +1,37 @@
+#include "interpolate/bicubic_plain.hpp"
+#include "interpolate/bilinear_plain.hpp"
+#include "interpolate/kernels.hpp"
+
+namespace interpolate
+{
+
+const Kernels kernels_plain = [] {
+  auto kernels = Kernels();
+  kernels.bilinear_row = bilinear::plain::interpolate_row;
+  kernels.bilinear_exact_row = bilinear::plain::interpolate_exact_row;
+  kernels.bicubic_row = bicubic::plain::interpolate_row<Filter::bicubic>;
+  kernels.lanczos3_row = bicubic::plain::interpolate_row<Filter::lanczos3>;
+
+  // Regular stores, there is no streaming implementation
+  kernels.bilinear_streaming_row = bilinear::plain::interpolate_row;
+
+  kernels.bilinear_affine_row = bilinear::plain::interpolate_affine_row;
+  kernels.bilinear_perspective_row = bilinear::plain::interpolate_perspective_row;
+  kernels.bilinear_fixed_point_row = bilinear::plain::interpolate_fixed_point_row;
+  kernels.bilinear_half_float_row = bilinear::plain::interpolate_half_float_row;
+  kernels.bilinear_plan_row = bilinear::plain::interpolate_plan_row;
+  kernels.downsample_row = bilinear::plain::downsample_row;
+  kernels.blend_row = bilinear::plain::blend_row;
+  kernels.resize_row = bilinear::plain::resize_row;
+  kernels.bilinear_bgra_row = bilinear::plain::interpolate_bgra_row;
+  kernels.bilinear_gray_row = bilinear::plain::interpolate_gray_row;
+  kernels.bilinear_uv_row = bilinear::plain::interpolate_uv_row;
+  kernels.nv12_to_bgr_row = bilinear::plain::convert_nv12_row;
+  kernels.bilinear_bgr16_row = bilinear::plain::interpolate_bgr16_row;
+  kernels.bilinear_bgr_float_row = bilinear::plain::interpolate_bgr_float_row;
+  kernels.bilinear_border_row = bilinear::plain::interpolate_border_row;
+
+  return kernels;
+}();
+
+}    // namespace interpolate
@@ -0,0 +1,42 @@
+// Compiled with the sse4 instruction set flags, see CMakeLists.txt.
+
+#include "interpolate/bicubic_sse4.hpp"
+#include "interpolate/bilinear_plain.hpp"
+#include "interpolate/bilinear_sse4.hpp"
+#include "interpolate/kernels.hpp"
+
+namespace interpolate
+{
+
+const Kernels kernels_sse4 = [] {
+  auto kernels = Kernels();
+  kernels.bilinear_row = bilinear::sse4::interpolate_row;
+  kernels.bilinear_exact_row = bilinear::sse4::interpolate_exact_row;
+  kernels.bicubic_row = bicubic::sse4::interpolate_row<Filter::bicubic>;
+  kernels.lanczos3_row = bicubic::sse4::interpolate_row<Filter::lanczos3>;
+  kernels.bilinear_bgra_row = bilinear::sse4::interpolate_bgra_row;
+
+  // Regular stores, there is no SSE4 streaming implementation
+  kernels.bilinear_streaming_row = bilinear::sse4::interpolate_row;
+
+  // No SSE4 specific warp, compact map, remap plan, pyramid, resize, grayscale or 16 bit
+  // and float implementations
+  kernels.bilinear_affine_row = bilinear::plain::interpolate_affine_row;
+  kernels.bilinear_perspective_row = bilinear::plain::interpolate_perspective_row;
+  kernels.bilinear_fixed_point_row = bilinear::plain::interpolate_fixed_point_row;
+  kernels.bilinear_half_float_row = bilinear::plain::interpolate_half_float_row;
+  kernels.bilinear_plan_row = bilinear::plain::interpolate_plan_row;
+  kernels.downsample_row = bilinear::plain::downsample_row;
+  kernels.blend_row = bilinear::plain::blend_row;
+  kernels.resize_row = bilinear::plain::resize_row;
+  kernels.bilinear_gray_row = bilinear::plain::interpolate_gray_row;
+  kernels.bilinear_uv_row = bilinear::plain::interpolate_uv_row;
+  kernels.nv12_to_bgr_row = bilinear::plain::convert_nv12_row;
+  kernels.bilinear_bgr16_row = bilinear::plain::interpolate_bgr16_row;
+  kernels.bilinear_bgr_float_row = bilinear::plain::interpolate_bgr_float_row;
+  kernels.bilinear_border_row = bilinear::plain::interpolate_border_row;
+
+  return kernels;
+}();
+
+}    // namespace interpolate
@@ -0,0 +1,331 @@
+#include "interpolate/numa.hpp"
+
+#include <chrono>
+#include <stdexcept>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <utility>
+
+#include "interpolate/streaming.hpp"
+
+#ifdef BILINEAR_HAVE_NUMA
+#include <numa.h>
+#endif
+
+namespace interpolate
+{
+
+// Rows are aligned to cache lines
+static constexpr size_t ROW_ALIGNMENT = 64;
+
+static size_t page_size() { return size_t(sysconf(_SC_PAGESIZE)); }
+
+static size_t round_up(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+std::vector<NumaNode> numa_nodes() {
+  const auto cpus = allowed_cpus();
+
+#ifdef BILINEAR_HAVE_NUMA
+  if (numa_available() >= 0) {
+    auto nodes = std::vector<NumaNode>();
+    auto* mask = numa_allocate_cpumask();
+
+    for (auto node = 0; node <= numa_max_node(); node++) {
+      if (numa_node_to_cpus(node, mask) != 0) {
+        continue;
+      }
+
+      auto node_cpus = std::vector<int>();
+
+      for (auto cpu : cpus) {
+        if (numa_bitmask_isbitset(mask, cpu)) {
+          node_cpus.push_back(cpu);
+        }
+      }
+
+      if (!node_cpus.empty()) {
+        nodes.push_back({node, node_cpus});
+      }
+    }
+
+    numa_free_cpumask(mask);
+
+    if (!nodes.empty()) {
+      return nodes;
+    }
+  }
+#endif
+
+  return {NumaNode{0, cpus}};
+}
+
+// Page aligned memory for a node, bound to it with libnuma. Not touched here, so without
+// libnuma the pages are placed on the node of the thread that first writes them.
+static void* allocate_on_node(size_t size, int node) {
+#ifdef BILINEAR_HAVE_NUMA
+  if (numa_available() >= 0) {
+    auto* data = numa_alloc_onnode(size, node);
+
+    if (data == nullptr) {
+      throw std::bad_alloc();
+    }
+
+    return data;
+  }
+#else
+  (void) node;
+#endif
+
+  auto* data = aligned_alloc(page_size(), round_up(size, page_size()));
+
+  if (data == nullptr) {
+    throw std::bad_alloc();
+  }
+
+  return data;
+}
+
+static void free_on_node(void* data, size_t size) {
+#ifdef BILINEAR_HAVE_NUMA
+  if (numa_available() >= 0) {
+    numa_free(data, size);
+    return;
+  }
+#else
+  (void) size;
+#endif
+
+  free(data);
+}
+
+// Memory on a node.
+struct NodeMemory {
+  void* data = nullptr;
+  size_t size = 0;
+
+  NodeMemory() {}
+  NodeMemory(size_t size, int node) : data(allocate_on_node(size, node)), size(size) {}
+  ~NodeMemory() {
+    if (data != nullptr) {
+      free_on_node(data, size);
+    }
+  }
+
+  NodeMemory& operator=(NodeMemory&& other) noexcept {
+    std::swap(data, other.data);
+    std::swap(size, other.size);
+    return *this;
+  }
+
+  NodeMemory(const NodeMemory&) = delete;
+  NodeMemory& operator=(const NodeMemory&) = delete;
+};
+
+struct NumaRemap::Node {
+  NumaNode numa_node;
+  ThreadPool pool;
+
+  // Output rows [begin, end)
+  int begin;
+  int end;
+
+  // The node's rows of the map, in its own memory if the map is localised
+  CoordsMap map;
+  NodeMemory map_memory;
+
+  // Copy of the source image, if it is replicated
+  BGRImage source;
+  NodeMemory source_memory;
+
+  double seconds = 0.0;
+
+  Node(const NumaNode& numa_node, const ThreadPool::Options& options, int begin, int end)
+      : numa_node(numa_node), pool(options), begin(begin), end(end) {}
+};
+
+NumaRemap::NumaRemap(const CoordsMap& map, int source_rows, int source_cols, Isa isa,
+                     const Options& options)
+    : source_rows_(source_rows),
+      source_cols_(source_cols),
+      kernels_(supported_kernels(isa)),
+      options_(options) {
+  const auto numa_nodes = interpolate::numa_nodes();
+
+  auto total_cpus = size_t(0);
+  for (const auto& numa_node : numa_nodes) {
+    total_cpus += numa_node.cpus.size();
+  }
+
+  // Rows in proportion to the CPUs of each node
+  auto cpus_before = size_t(0);
+
+  for (const auto& numa_node : numa_nodes) {
+    auto begin = int(map.rows * cpus_before / total_cpus);
+    cpus_before += numa_node.cpus.size();
+    auto end = int(map.rows * cpus_before / total_cpus);
+
+    auto pool_options = ThreadPool::Options();
+    pool_options.threads = int(numa_node.cpus.size());
+    pool_options.cpus = numa_node.cpus;
+
+    auto node = std::make_unique<Node>(numa_node, pool_options, begin, end);
+    auto rows = end - begin;
+
+    // Allocated here as parallel_for() bodies mustn't throw, and placed by the node's threads below
+    if (options.localise_map) {
+      const auto map_step = size_t(map.cols) * sizeof(InputCoords);
+      node->map_memory = NodeMemory(map_step * rows + ROW_ALIGNMENT, numa_node.node);
+      node->map = CoordsMap(rows, map.cols, int(map_step), (InputCoords*) node->map_memory.data);
+    } else {
+      node->map = CoordsMap(rows, map.cols, map.step, map.row(begin));
+    }
+
+    // The kernels read a few bytes past the last source pixel they sample, so the replica has
+    // some slack after its last row
+    if (options.replicate_source) {
+      const auto source_step = round_up(size_t(source_cols) * sizeof(BGRPixel), ROW_ALIGNMENT);
+      node->source_memory = NodeMemory(source_step * source_rows + ROW_ALIGNMENT, numa_node.node);
+      node->source = BGRImage(source_rows, source_cols, int(source_step),
+                              (BGRPixel*) node->source_memory.data);
+    }
+
+    nodes_.push_back(std::move(node));
+  }
+
+  auto lead_options = ThreadPool::Options();
+  lead_options.threads = int(nodes_.size());
+
+  for (const auto& node : nodes_) {
+    lead_options.cpus.push_back(node->numa_node.cpus[0]);
+  }
+
+  leads_ = std::make_unique<ThreadPool>(lead_options);
+
+  // The output. Allocated last so it doesn't leak if anything above throws.
+  const auto step = round_up(size_t(map.cols) * sizeof(BGRPixel), ROW_ALIGNMENT);
+  const auto output_size = step * map.rows;
+  output_data_ = aligned_alloc(page_size(), round_up(output_size, page_size()));
+
+  if (output_data_ == nullptr) {
+    throw std::bad_alloc();
+  }
+
+  output_ = BGRImage(map.rows, map.cols, int(step), (BGRPixel*) output_data_);
+
+  // Place each node's memory by touching it from the node's own threads
+  leads_->parallel_for(nodes(), 1, [&](int begin, int end) {
+    for (auto index = begin; index < end; index++) {
+      auto& node = *nodes_[index];
+      auto rows = node.end - node.begin;
+
+#ifdef BILINEAR_HAVE_NUMA
+      // Bind the pages wholly inside the node's rows, in case the memory policy isn't first touch
+      if (numa_available() >= 0) {
+        auto first = round_up(uintptr_t(output_.row(node.begin)), page_size());
+        auto last = uintptr_t(output_.row(node.end)) / page_size() * page_size();
+
+        if (last > first) {
+          numa_tonode_memory((void*) first, last - first, node.numa_node.node);
+        }
+      }
+#endif
+
+      node.pool.parallel_for(rows, 0, [&](int row_begin, int row_end) {
+        memset(output_.row(node.begin + row_begin), 0, size_t(row_end - row_begin) * step);
+      });
+
+      if (options_.localise_map) {
+        node.pool.parallel_for(rows, 0, [&](int row_begin, int row_end) {
+          for (auto y = row_begin; y < row_end; y++) {
+            memcpy((void*) node.map.row(y), map.row(node.begin + y),
+                   size_t(map.cols) * sizeof(InputCoords));
+          }
+        });
+      }
+
+      if (options_.replicate_source) {
+        node.pool.parallel_for(source_rows, 0, [&](int row_begin, int row_end) {
+          memset(node.source.row(row_begin), 0,
+                 size_t(row_end - row_begin) * size_t(node.source.step));
+        });
+      }
+    }
+  });
+}
+
+NumaRemap::~NumaRemap() {
+  // Stop the threads before freeing the memory they use
+  leads_.reset();
+  nodes_.clear();
+  free(output_data_);
+}
+
+const NumaNode& NumaRemap::node(int index) const { return nodes_.at(index)->numa_node; }
+
+int NumaRemap::node_rows(int index) const {
+  const auto& node = *nodes_.at(index);
+  return node.end - node.begin;
+}
+
+int NumaRemap::node_threads(int index) const { return nodes_.at(index)->pool.threads(); }
+
+double NumaRemap::node_seconds(int index) const { return nodes_.at(index)->seconds; }
+
+void NumaRemap::reset_node_seconds() {
+  for (auto& node : nodes_) {
+    node->seconds = 0.0;
+  }
+}
+
+void NumaRemap::remap(const BGRImage& source) {
+  if (source.rows != source_rows_ || source.cols != source_cols_) {
+    throw std::runtime_error("source image must be the size the NUMA remap was created for");
+  }
+
+  // Each node's chunk starts on its lead thread. A lead that finishes first can take another
+  // node's chunk before that node's lead wakes up, which only moves the caller of that node's
+  // pool off the node.
+  leads_->parallel_for(nodes(), 1, [&](int begin, int end) {
+    for (auto index = begin; index < end; index++) {
+      run_node(*nodes_[index], source);
+    }
+  });
+}
+
+void NumaRemap::run_node(Node& node, const BGRImage& source) {
+  const auto start = std::chrono::steady_clock::now();
+  auto image = source;
+
+  if (options_.replicate_source) {
+    const auto row_bytes = size_t(source.cols) * sizeof(BGRPixel);
+
+    node.pool.parallel_for(source.rows, 0, [&](int begin, int end) {
+      for (auto y = begin; y < end; y++) {
+        memcpy(node.source.row(y), source.ptr(y, 0), row_bytes);
+      }
+    });
+
+    image = node.source;
+  }
+
+  const auto streaming = options_.store == Store::streaming;
+  const auto bilinear_row = streaming ? kernels_.bilinear_streaming_row : kernels_.bilinear_row;
+
+  node.pool.parallel_for(node.end - node.begin, 0, [&](int begin, int end) {
+    for (auto y = begin; y < end; y++) {
+      bilinear_row(image, node.map.row(y), output_.row(node.begin + y), output_.cols);
+    }
+
+    // Once per chunk, so the output is complete when parallel_for returns
+    if (streaming) {
+      streaming_store_fence();
+    }
+  });
+
+  node.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+}    // namespace interpolate
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <memory>
+#include <stddef.h>
+#include <vector>
+
+#include "interpolate/kernels.hpp"
+#include "interpolate/thread_pool.hpp"
+#include "interpolate/types.hpp"
+
+namespace interpolate
+{
+
+// A NUMA node and the CPUs on it the process may run on.
+struct NumaNode {
+  int node;
+  std::vector<int> cpus;
+};
+
+// Nodes with CPUs the process may run on. Without libnuma, or if the kernel has no NUMA
+// support, a single node 0 with all the CPUs.
+std::vector<NumaNode> numa_nodes();
+
+// Bilinear remap of frames of one size on a multi-socket host, keeping each socket's memory
+// traffic on its own node. The output rows are split between the nodes in proportion to their
+// CPUs, and each node interpolates its rows with a thread pool pinned to its CPUs:
+//
+// - the output image is allocated by the remap, and each node's rows are first touched by its
+//   own threads (and bound to the node with libnuma), so stores stay local
+// - with Options::localise_map each node copies its rows of the map into its own memory once,
+//   when the remap is created, so map reads stay local
+// - with Options::replicate_source each node copies the source image into its own memory every
+//   frame before interpolating. The copy streams the source over the interconnect once instead
+//   of gathering it pixel by pixel, which pays off for large, scattered maps
+//
+// On a single node host this is a remap on one pinned thread pool.
+class NumaRemap
+{
+public:
+  struct Options {
+    bool localise_map = true;
+    bool replicate_source = false;
+    Store store = Store::cached;
+  };
+
+  // Remap source images of `source_rows` x `source_cols` pixels with `map`, which gives the
+  // output size. Unless the map is localised, the caller's map must outlive the remap.
+  NumaRemap(const CoordsMap& map, int source_rows, int source_cols, Isa isa,
+            const Options& options);
+  ~NumaRemap();
+
+  NumaRemap(const NumaRemap&) = delete;
+  NumaRemap& operator=(const NumaRemap&) = delete;
+
+  // The output image written by remap(). Rows are aligned to 64 bytes.
+  const BGRImage& output() const { return output_; }
+
+  // Interpolate output() from `source`, which must be the size the remap was created for, or a
+  // std::runtime_error is thrown. Calls from multiple threads are serialised.
+  void remap(const BGRImage& source);
+
+  int nodes() const { return int(nodes_.size()); }
+  const NumaNode& node(int index) const;
+
+  // Output rows interpolated by a node, and its threads.
+  int node_rows(int index) const;
+  int node_threads(int index) const;
+
+  // Wall time a node has spent on frames, including copying the source, since the remap was
+  // created or reset_node_seconds() was last called. For the throughput of each node.
+  double node_seconds(int index) const;
+  void reset_node_seconds();
+
+private:
+  struct Node;
+
+  void run_node(Node& node, const BGRImage& source);
+
+  int source_rows_;
+  int source_cols_;
+  const Kernels& kernels_;
+  Options options_;
+  void* output_data_ = nullptr;
+  BGRImage output_;
+  std::vector<std::unique_ptr<Node>> nodes_;
+
+  // A thread on each node to drive its pool, so the nodes run in parallel
+  std::unique_ptr<ThreadPool> leads_;
+};
+
+}    // namespace interpolate
@@ -0,0 +1,143 @@
+#include "interpolate/remap.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "interpolate/kernels.hpp"
+#include "interpolate/streaming.hpp"
+
+namespace interpolate
+{
+
+// Runs a row kernel over the rows of the output, with regular stores.
+template <typename Pixel, typename RowKernel>
+static void remap_rows(RowKernel row_kernel, const Image<Pixel>& source, const CoordsMap& map,
+                       const Image<Pixel>& output, ThreadPool& pool) {
+  if (output.rows != map.rows || output.cols != map.cols) {
+    throw std::runtime_error("output image must be the same size as the map");
+  }
+
+  pool.parallel_for(output.rows, 0, [&](int begin, int end) {
+    for (auto y = begin; y < end; y++) {
+      row_kernel(source, map.row(y), output.row(y), output.cols);
+    }
+  });
+}
+
+void remap(const BGRImage& source, const CoordsMap& map, const BGRImage& output, Isa isa,
+           ThreadPool& pool, Store store) {
+  if (output.rows != map.rows || output.cols != map.cols) {
+    throw std::runtime_error("output image must be the same size as the map");
+  }
+
+  const auto& kernels = supported_kernels(isa);
+  const auto streaming = store == Store::streaming;
+  const auto bilinear_row = streaming ? kernels.bilinear_streaming_row : kernels.bilinear_row;
+
+  pool.parallel_for(output.rows, 0, [&](int begin, int end) {
+    for (auto y = begin; y < end; y++) {
+      bilinear_row(source, map.row(y), output.row(y), output.cols);
+    }
+
+    // Once per chunk, so the output is complete when parallel_for returns
+    if (streaming) {
+      streaming_store_fence();
+    }
+  });
+}
+
+void remap(const BGRImage& source, const CoordsMap& map, const BGRImage& output, Store store) {
+  remap(source, map, output, active_isa(), default_thread_pool(), store);
+}
+
+void remap(const BGRImage& source, const CoordsMap& map, const BGRImage& output,
+           TileSize tile_size, Isa isa, ThreadPool& pool) {
+  if (output.rows != map.rows || output.cols != map.cols) {
+    throw std::runtime_error("output image must be the same size as the map");
+  }
+
+  if (tile_size.width <= 0 || tile_size.height <= 0) {
+    throw std::runtime_error("tile size must be positive");
+  }
+
+  const auto bilinear_row = supported_kernels(isa).bilinear_row;
+  const auto bands = (output.rows + tile_size.height - 1) / tile_size.height;
+
+  pool.parallel_for(bands, 0, [&](int begin, int end) {
+    for (auto band = begin; band < end; band++) {
+      auto y_start = band * tile_size.height;
+      auto y_end = std::min(y_start + tile_size.height, output.rows);
+
+      for (auto x = 0; x < output.cols; x += tile_size.width) {
+        auto count = std::min(tile_size.width, output.cols - x);
+
+        for (auto y = y_start; y < y_end; y++) {
+          bilinear_row(source, map.row(y) + x, output.row(y) + x, count);
+        }
+      }
+    }
+  });
+}
+
+void remap(const BGRImage& source, const CoordsMap& map, const BGRImage& output,
+           TileSize tile_size) {
+  remap(source, map, output, tile_size, active_isa(), default_thread_pool());
+}
+
+void remap(const BGRImage& source, const CoordsMap& map, const BGRImage& output,
+           const Border& border, Isa isa, ThreadPool& pool) {
+  if (source.rows < 1 || source.cols < 1) {
+    throw std::runtime_error("source image must not be empty");
+  }
+
+  const auto bilinear_border_row = supported_kernels(isa).bilinear_border_row;
+  const auto row_kernel = [&](const BGRImage& image, const InputCoords* input_coords,
+                              BGRPixel* output_pixels, int count) {
+    bilinear_border_row(image, input_coords, output_pixels, count, border);
+  };
+
+  remap_rows(row_kernel, source, map, output, pool);
+}
+
+void remap(const BGRImage& source, const CoordsMap& map, const BGRImage& output,
+           const Border& border) {
+  remap(source, map, output, border, active_isa(), default_thread_pool());
+}
+
+void remap(const BGRAImage& source, const CoordsMap& map, const BGRAImage& output, Isa isa,
+           ThreadPool& pool) {
+  remap_rows(supported_kernels(isa).bilinear_bgra_row, source, map, output, pool);
+}
+
+void remap(const BGRAImage& source, const CoordsMap& map, const BGRAImage& output) {
+  remap(source, map, output, active_isa(), default_thread_pool());
+}
+
+void remap(const GrayImage& source, const CoordsMap& map, const GrayImage& output, Isa isa,
+           ThreadPool& pool) {
+  remap_rows(supported_kernels(isa).bilinear_gray_row, source, map, output, pool);
+}
+
+void remap(const GrayImage& source, const CoordsMap& map, const GrayImage& output) {
+  remap(source, map, output, active_isa(), default_thread_pool());
+}
+
+void remap(const BGR16Image& source, const CoordsMap& map, const BGR16Image& output, Isa isa,
+           ThreadPool& pool) {
+  remap_rows(supported_kernels(isa).bilinear_bgr16_row, source, map, output, pool);
+}
+
+void remap(const BGR16Image& source, const CoordsMap& map, const BGR16Image& output) {
+  remap(source, map, output, active_isa(), default_thread_pool());
+}
+
+void remap(const BGRFloatImage& source, const CoordsMap& map, const BGRFloatImage& output,
+           Isa isa, ThreadPool& pool) {
+  remap_rows(supported_kernels(isa).bilinear_bgr_float_row, source, map, output, pool);
+}
+
+void remap(const BGRFloatImage& source, const CoordsMap& map, const BGRFloatImage& output) {
+  remap(source, map, output, active_isa(), default_thread_pool());
+}
+
+}    // namespace interpolate
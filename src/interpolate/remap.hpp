@@ -0,0 +1,68 @@
+#pragma once
+
+#include "interpolate/isa.hpp"
+#include "interpolate/thread_pool.hpp"
+#include "interpolate/types.hpp"
+
+namespace interpolate
+{
+
+// Bilinear interpolation of a whole frame from a coordinate map, with the rows spread over the
+// threads of a pool. The entry point for programs that use the kernels directly: images and maps
+// are views of caller owned buffers with explicit steps, so frames in shared memory or any other
+// buffer are interpolated without copying them.
+//
+// Every coordinate of the map must be inside the source image: the pixels to the right of and
+// below each coordinate are read without bounds checks. Maps that may sample outside it need the
+// Border overload below.
+//
+// The output must be the size of the map, and `isa` supported by the CPU (see isa_supported()),
+// or a std::runtime_error is thrown. With Store::streaming the output is written with
+// non-temporal stores (see Kernels::bilinear_streaming_row), and is complete when remap() returns.
+void remap(const BGRImage& source, const CoordsMap& map, const BGRImage& output, Isa isa,
+           ThreadPool& pool, Store store = Store::cached);
+
+// As above with the active instruction set (see active_isa()) and default_thread_pool().
+void remap(const BGRImage& source, const CoordsMap& map, const BGRImage& output,
+           Store store = Store::cached);
+
+// As above, interpolating the output in 2D tiles instead of whole rows. A rotated map makes each
+// output row sample a diagonal band across many source rows, so consecutive rows touch source
+// memory far apart. A tile samples a compact source area that stays in cache while the tile is
+// interpolated, and neighbouring tiles in a band of tile rows share much of it.
+//
+// The bands of tile rows are spread over the threads of the pool, and each band is interpolated
+// left to right, then each tile top to bottom. Throws a std::runtime_error if the tile size isn't
+// positive.
+void remap(const BGRImage& source, const CoordsMap& map, const BGRImage& output,
+           TileSize tile_size, Isa isa, ThreadPool& pool);
+void remap(const BGRImage& source, const CoordsMap& map, const BGRImage& output,
+           TileSize tile_size);
+
+// As above, with coordinates anywhere, inside or outside the source image: the source pixels
+// outside it are sampled through `border` (see Kernels::bilinear_border_row), so the source
+// doesn't need padding first. Throws a std::runtime_error if the source is empty.
+void remap(const BGRImage& source, const CoordsMap& map, const BGRImage& output,
+           const Border& border, Isa isa, ThreadPool& pool);
+void remap(const BGRImage& source, const CoordsMap& map, const BGRImage& output,
+           const Border& border);
+
+// As above for 32bpp images (see Kernels::bilinear_bgra_row), with regular stores.
+void remap(const BGRAImage& source, const CoordsMap& map, const BGRAImage& output, Isa isa,
+           ThreadPool& pool);
+void remap(const BGRAImage& source, const CoordsMap& map, const BGRAImage& output);
+
+// As above for 8 bit single channel images (see Kernels::bilinear_gray_row).
+void remap(const GrayImage& source, const CoordsMap& map, const GrayImage& output, Isa isa,
+           ThreadPool& pool);
+void remap(const GrayImage& source, const CoordsMap& map, const GrayImage& output);
+
+// As above for 16 bit and float channels (see Kernels::bilinear_bgr16_row).
+void remap(const BGR16Image& source, const CoordsMap& map, const BGR16Image& output, Isa isa,
+           ThreadPool& pool);
+void remap(const BGR16Image& source, const CoordsMap& map, const BGR16Image& output);
+void remap(const BGRFloatImage& source, const CoordsMap& map, const BGRFloatImage& output,
+           Isa isa, ThreadPool& pool);
+void remap(const BGRFloatImage& source, const CoordsMap& map, const BGRFloatImage& output);
+
+}    // namespace interpolate
@@ -0,0 +1,69 @@
+#include "interpolate/remap_plan.hpp"
+
+#include <math.h>
+#include <stdexcept>
+
+namespace interpolate
+{
+
+// Same as calculate_weights() in the SIMD kernels: the fractional parts are rounded to 0-256,
+// and the product of the x and y weights is divided by 256.
+static BilinearWeights calculate_weights(float fx, float fy) {
+  const auto x = int(lrintf(fx * 256.0f));
+  const auto y = int(lrintf(fy * 256.0f));
+  const auto x1 = 256 - x;
+  const auto y1 = 256 - y;
+
+  return {{uint16_t((x1 * y1) >> 8), uint16_t((x * y1) >> 8), uint16_t((x1 * y) >> 8),
+           uint16_t((x * y) >> 8)}};
+}
+
+RemapPlan::RemapPlan(const BGRImage& source_image, const InputCoords* coords, int rows, int cols,
+                     int coords_step)
+    : rows_(rows),
+      cols_(cols),
+      source_rows_(source_image.rows),
+      source_cols_(source_image.cols),
+      source_step_(source_image.step) {
+  if (source_image.rows < 2) {
+    throw std::runtime_error("remap plan source image must have at least 2 rows");
+  }
+
+  if ((int64_t) source_image.rows * source_image.step > INT32_MAX) {
+    throw std::runtime_error("remap plan source image too large for 32 bit offsets");
+  }
+
+  offsets_.resize((size_t) rows * cols);
+  weights_.resize((size_t) rows * cols);
+
+  for (auto y = 0; y < rows; y++) {
+    const auto* coords_row = coords + (size_t) y * coords_step;
+    auto* offsets_row = offsets_.data() + (size_t) y * cols;
+    auto* weights_row = weights_.data() + (size_t) y * cols;
+
+    for (auto x = 0; x < cols; x++) {
+      const auto px = int(coords_row[x].x);    // floor x
+      const auto py = int(coords_row[x].y);    // floor y
+
+      auto weights = calculate_weights(coords_row[x].x - px, coords_row[x].y - py);
+
+      if (py < source_image.rows - 1) {
+        offsets_row[x] = py * source_image.step + px * 3;
+      } else {
+        // The last row is its own bottom neighbour, so sample it as the bottom row instead.
+        offsets_row[x] = (py - 1) * source_image.step + px * 3;
+        weights = {{0, 0, uint16_t(weights.w[0] + weights.w[2]),
+                    uint16_t(weights.w[1] + weights.w[3])}};
+      }
+
+      weights_row[x] = weights;
+    }
+  }
+}
+
+bool RemapPlan::compatible(const BGRImage& image) const {
+  return (image.rows == source_rows_) && (image.cols == source_cols_) &&
+         (image.step == source_step_);
+}
+
+}    // namespace interpolate
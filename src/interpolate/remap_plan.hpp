@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+#include "interpolate/types.hpp"
+
+namespace interpolate
+{
+
+// A coordinate map compiled for source images of one size and step. For every output pixel it
+// stores the byte offset of the top left source pixel and pre-packed weights, so executing the
+// plan (see Kernels::bilinear_plan_row) only loads and blends pixels. Building a plan costs more
+// than interpolating one frame, so it pays off when the same map is used for many frames.
+//
+// Pixels sampling the last source row are moved up a row, with all their weight on the bottom
+// pixels, so executing a plan never reads below the last row and needs no bounds checks.
+class RemapPlan
+{
+public:
+  // Build a plan from a map of `rows` x `cols` coordinates, with `coords_step` coordinates per
+  // map row. The coordinates must be inside the source image. Throws if the source image has
+  // fewer than 2 rows or is too large for 32 bit offsets.
+  RemapPlan(const BGRImage& source_image, const InputCoords* coords, int rows, int cols,
+            int coords_step);
+
+  int rows() const { return rows_; }
+  int cols() const { return cols_; }
+
+  // Byte offsets of the top left source pixels from the start of the source image.
+  const int32_t* offsets(int row) const { return offsets_.data() + (size_t) row * cols_; }
+  const BilinearWeights* weights(int row) const { return weights_.data() + (size_t) row * cols_; }
+
+  // Whether the plan can be executed on an image. It must have the same size and step as the
+  // image the plan was built for.
+  bool compatible(const BGRImage& image) const;
+
+private:
+  int rows_;
+  int cols_;
+  int source_rows_;
+  int source_cols_;
+  int source_step_;
+  std::vector<int32_t> offsets_;
+  std::vector<BilinearWeights> weights_;
+};
+
+}    // namespace interpolate
@@ -0,0 +1,126 @@
+#include "interpolate/resize_plan.hpp"
+
+#include <math.h>
+#include <stdexcept>
+
+#include "interpolate/kernels.hpp"
+
+namespace interpolate
+{
+
+// Left or top source pixel of a sample at `coordinate` along a side of `size` pixels, and the
+// 0-256 weight of the pixel after it. The coordinate is clamped to the side, and the last pixel
+// is sampled as the second of the pair before it, so the kernels never read past the side.
+static void sample_position(float coordinate, int size, int& first, int& weight) {
+  coordinate = (coordinate > 0.0f) ? coordinate : 0.0f;
+  coordinate = (coordinate < float(size - 1)) ? coordinate : float(size - 1);
+
+  first = int(coordinate);    // floor
+  weight = int(lrintf((coordinate - float(first)) * 256.0f));
+
+  if (weight == 256) {
+    first++;
+    weight = 0;
+  }
+
+  if (first >= size - 1) {
+    first = size - 2;
+    weight = 256;
+  }
+}
+
+ResizePlan::ResizePlan(int source_rows, int source_cols, int rows, int cols)
+    : ResizePlan(source_rows, source_cols, Rect{0, 0, source_cols, source_rows}, rows, cols) {}
+
+ResizePlan::ResizePlan(int source_rows, int source_cols, const Rect& crop, int rows, int cols)
+    : source_rows_(source_rows), source_cols_(source_cols), crop_(crop) {
+  if (crop.x < 0 || crop.y < 0 || crop.x + crop.width > source_cols ||
+      crop.y + crop.height > source_rows) {
+    throw std::runtime_error("resize crop must be inside the source image");
+  }
+
+  if (crop.width < 2 || crop.height < 2 || rows < 2 || cols < 2) {
+    throw std::runtime_error("resize images must be at least 2x2 pixels");
+  }
+
+  column_offsets_.resize(cols);
+  column_weights_.resize(cols);
+  row_tops_.resize(rows);
+  row_weights_.resize(rows);
+
+  for (auto x = 0; x < cols; x++) {
+    int left, weight;
+    sample_position(source_x(x), crop.width, left, weight);
+
+    column_offsets_[x] = left * int(sizeof(BGRPixel));
+    column_weights_[x] = {{uint16_t(256 - weight), uint16_t(weight)}};
+  }
+
+  for (auto y = 0; y < rows; y++) {
+    sample_position(source_y(y), crop.height, row_tops_[y], row_weights_[y]);
+  }
+}
+
+float ResizePlan::source_x(int x) const {
+  return (float(x) + 0.5f) * (float(crop_.width) / float(cols())) - 0.5f;
+}
+
+float ResizePlan::source_y(int y) const {
+  return (float(y) + 0.5f) * (float(crop_.height) / float(rows())) - 0.5f;
+}
+
+bool ResizePlan::compatible(const BGRImage& image) const {
+  return (image.rows == source_rows_) && (image.cols == source_cols_);
+}
+
+// Row for the blended source pixels of the calling thread, at least `cols` pixels long. Kept
+// between calls.
+static BGRPixel* blended_row_scratch(int cols) {
+  // The kernels read a few bytes past the last pixel
+  const auto size = size_t(cols) * sizeof(BGRPixel) + 16;
+  thread_local auto scratch = std::vector<uint8_t>();
+
+  if (scratch.size() < size) {
+    scratch.resize(size);
+  }
+
+  return (BGRPixel*) scratch.data();
+}
+
+void ResizePlan::resize_rows(const BGRImage& source, const BGRImage& output, int begin, int end,
+                             Isa isa) const {
+  const auto& kernels = supported_kernels(isa);
+
+  auto* blended_row = blended_row_scratch(crop_.width);
+  auto blended_top = -1;
+  auto blended_weight = -1;
+
+  for (auto y = begin; y < end; y++) {
+    const auto top = crop_.y + row_tops_[y];
+    const auto weight = row_weights_[y];
+    const BGRPixel* row;
+
+    if (weight == 0) {
+      row = source.ptr(top, crop_.x);
+    } else if (weight == 256) {
+      row = source.ptr(top + 1, crop_.x);
+    } else {
+      // Only reblended when the pair of source rows or the weight changes. Consecutive output
+      // rows rarely sample the same pair with the same weight, eg an upscale gives each output
+      // row between the same pair its own weight, so most rows are blended.
+      if (top != blended_top || weight != blended_weight) {
+        kernels.blend_row(source.ptr(top, crop_.x), source.ptr(top + 1, crop_.x), weight,
+                          blended_row, crop_.width);
+        blended_top = top;
+        blended_weight = weight;
+      }
+
+      row = blended_row;
+    }
+
+    kernels.resize_row(row, column_offsets_.data(), column_weights_.data(), output.row(y),
+                       output.cols);
+  }
+}
+
+}    // namespace interpolate
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+#include "interpolate/isa.hpp"
+#include "interpolate/types.hpp"
+
+namespace interpolate
+{
+
+// Bilinear resize of a source image, or of a crop of it, without a coordinate map. Every output
+// column shares the same x weights and every output row the same y weights, so the plan only
+// holds one table of source columns and weights for the output columns, and one of source rows
+// and weights for the output rows.
+//
+// Pixel centres are aligned as in cv::resize with INTER_LINEAR: output pixel x samples the crop
+// at (x + 0.5) * crop width / output width - 0.5, clamped to the crop. Each output row is
+// resized in two passes: the two source rows are blended with the row's weight (see
+// Kernels::blend_row), then the output pixels are interpolated from the blended row with the
+// column table (see Kernels::resize_row). Rows that sample a single source row skip the blend,
+// and consecutive output rows that sample the same source rows with the same weight share one.
+class ResizePlan
+{
+public:
+  // Plan a resize of a whole source image of `source_rows` x `source_cols` pixels to `rows` x
+  // `cols`. Throws if either image has a side smaller than 2 pixels.
+  ResizePlan(int source_rows, int source_cols, int rows, int cols);
+
+  // Plan a resize of the `crop` of a source image of `source_rows` x `source_cols` pixels to
+  // `rows` x `cols`. Throws if the crop isn't inside the source image or if either image has a
+  // side smaller than 2 pixels.
+  ResizePlan(int source_rows, int source_cols, const Rect& crop, int rows, int cols);
+
+  int rows() const { return (int) row_tops_.size(); }
+  int cols() const { return (int) column_offsets_.size(); }
+  const Rect& crop() const { return crop_; }
+
+  // Whether the plan can resize an image: it must be the size the plan was built for.
+  bool compatible(const BGRImage& image) const;
+
+  // Resize output rows [begin, end) of `output` from `source`, with the kernels for `isa`. The
+  // source must be compatible() and the output rows() x cols(). Rows can be resized in parallel.
+  // Only a thread's first call, or a call with a wider crop than before, allocates.
+  void resize_rows(const BGRImage& source, const BGRImage& output, int begin, int end,
+                   Isa isa) const;
+
+  // Source coordinate of the centre of output column x or row y in the crop, before clamping.
+  float source_x(int x) const;
+  float source_y(int y) const;
+
+private:
+  int source_rows_;
+  int source_cols_;
+  Rect crop_;
+
+  // Byte offsets of the left source pixels from the start of a crop row, and their weights
+  std::vector<int32_t> column_offsets_;
+  std::vector<ResizeWeights> column_weights_;
+
+  // Source rows of the top source pixels, and the 0-256 weights of the rows below
+  std::vector<int> row_tops_;
+  std::vector<int> row_weights_;
+};
+
+}    // namespace interpolate
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stdint.h>
+#include <xmmintrin.h>
+
+#include "interpolate/types.hpp"
+
+namespace interpolate
+{
+
+// Number of pixels before the first pixel of a row that starts on an `alignment` byte boundary.
+// Pixels are 3 bytes and 3 is invertible modulo a power of 2, so there is always one within the
+// first `alignment` pixels.
+template <int alignment>
+static inline int pixels_to_alignment(const BGRPixel* pixels) {
+  static_assert((alignment & (alignment - 1)) == 0, "alignment must be a power of 2");
+
+  // Multiplicative inverse of 3 modulo alignment
+  constexpr auto inverse = uintptr_t(alignment % 3 == 1 ? (2 * alignment + 1) / 3
+                                                        : (alignment + 1) / 3);
+
+  return int(((0 - (uintptr_t) pixels) * inverse) & (alignment - 1));
+}
+
+// Orders the non-temporal stores of the streaming kernels before any later stores, so another
+// thread that synchronises with this one sees the output. Call once after the last streamed row
+// of each parallel chunk.
+static inline void streaming_store_fence() { _mm_sfence(); }
+
+}    // namespace interpolate
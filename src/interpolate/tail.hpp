@@ -0,0 +1,16 @@
+#pragma once
+
+namespace interpolate
+{
+
+// Copy the last `count` elements of a row, fewer than a full SIMD step of N, into a full step.
+// The rest are padded with the first element, so they are valid inputs that the kernels can
+// process and then discard.
+template <int N, typename T>
+static inline void copy_tail(const T* input, int count, T padded[N]) {
+  for (auto i = 0; i < N; i++) {
+    padded[i] = input[i < count ? i : 0];
+  }
+}
+
+}    // namespace interpolate
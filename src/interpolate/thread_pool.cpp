@@ -0,0 +1,289 @@
+#include "interpolate/thread_pool.hpp"
+
+#include <algorithm>
+#include <emmintrin.h>
+#include <pthread.h>
+#include <sched.h>
+
+namespace interpolate
+{
+
+// A thread's share of the chunks of a job, packed as (begin << 32) | end so the owner and thieves
+// can update it with a single compare and swap. On its own cache line to avoid false sharing.
+struct alignas(64) Share {
+  std::atomic<uint64_t> range;
+};
+
+static inline uint64_t pack_range(uint32_t begin, uint32_t end) {
+  return (uint64_t(begin) << 32) | end;
+}
+
+struct ThreadPool::Job {
+  BodyCall call;
+  const void* body;
+  JobObserver* observer;
+  int count;
+  int grain;
+  bool steal;
+  int shares_count;
+  std::unique_ptr<Share[]> shares;
+  std::atomic<int> remaining_chunks;
+};
+
+std::vector<int> allowed_cpus() {
+  auto cpus = std::vector<int>();
+  cpu_set_t set;
+
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (auto cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+      if (CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+
+  return cpus;
+}
+
+ThreadPool::ThreadPool(const Options& options)
+    : spin_iterations_(options.spin_iterations), job_(new Job()) {
+  auto threads = options.threads;
+
+  if (threads <= 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  job_->shares_count = threads;
+  job_->shares.reset(new Share[threads]);
+
+  auto cpus = options.cpus;
+
+  if (cpus.empty() && options.pin_threads) {
+    cpus = allowed_cpus();
+  }
+
+  // The caller of parallel_for() is thread 0
+  for (auto i = 1; i < threads; i++) {
+    workers_.emplace_back(&ThreadPool::worker_main, this, i);
+
+    if (!cpus.empty()) {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(cpus[i % cpus.size()], &set);
+
+      // Best effort, the pool works without affinity
+      pthread_setaffinity_np(workers_.back().native_handle(), sizeof(set), &set);
+    }
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    auto lock = std::lock_guard<std::mutex>(job_mutex_);
+    stopping_ = true;
+  }
+
+  job_available_.notify_all();
+
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+void ThreadPool::set_job_observer(JobObserver* observer) {
+  auto dispatch_lock = std::lock_guard<std::mutex>(dispatch_mutex_);
+  observer_ = observer;
+}
+
+void ThreadPool::dispatch(int count, int grain, BodyCall call, const void* body, bool steal) {
+  if (count <= 0) {
+    return;
+  }
+
+  auto dispatch_lock = std::lock_guard<std::mutex>(dispatch_mutex_);
+
+  if (grain <= 0) {
+    grain = std::max(1, count / (threads() * 4));
+  }
+
+  const auto chunks = (count + grain - 1) / grain;
+
+  // No worker is in the job between parallel_for() calls, so it can be reset
+  auto& job = *job_;
+  job.call = call;
+  job.body = body;
+  job.observer = observer_;
+  job.count = count;
+  job.grain = grain;
+  job.steal = steal;
+  job.remaining_chunks.store(chunks, std::memory_order_relaxed);
+
+  for (auto i = 0; i < job.shares_count; i++) {
+    auto begin = uint32_t(int64_t(chunks) * i / job.shares_count);
+    auto end = uint32_t(int64_t(chunks) * (i + 1) / job.shares_count);
+    job.shares[i].range.store(pack_range(begin, end), std::memory_order_relaxed);
+  }
+
+  const auto publish = !workers_.empty() && chunks > 1;
+
+  if (publish) {
+    {
+      auto lock = std::lock_guard<std::mutex>(job_mutex_);
+      job_open_ = true;
+      job_generation_.fetch_add(1, std::memory_order_release);
+    }
+
+    job_available_.notify_all();
+  }
+
+  run_job(job, 0);
+
+  // Wait for the chunks other threads took. They are short, so spin before yielding.
+  for (auto i = 0; job.remaining_chunks.load(std::memory_order_acquire) > 0; i++) {
+    if (i < spin_iterations_) {
+      _mm_pause();
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  if (publish) {
+    // Close the job, then wait for the workers in it to find there is nothing left to take
+    {
+      auto lock = std::lock_guard<std::mutex>(job_mutex_);
+      job_open_ = false;
+    }
+
+    for (auto i = 0; job_workers_.load(std::memory_order_acquire) > 0; i++) {
+      if (i < spin_iterations_) {
+        _mm_pause();
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  }
+}
+
+void ThreadPool::run_job(Job& job, int slot) {
+  if (job.observer != nullptr) {
+    job.observer->job_started(slot);
+  }
+
+  take_chunks(job, slot);
+
+  if (job.observer != nullptr) {
+    job.observer->job_finished(slot);
+  }
+}
+
+void ThreadPool::take_chunks(Job& job, int slot) {
+  const auto execute = [&job](uint32_t chunk) {
+    const auto begin = int(chunk) * job.grain;
+    const auto end = std::min(job.count, begin + job.grain);
+
+    job.call(job.body, begin, end);
+
+    job.remaining_chunks.fetch_sub(1, std::memory_order_release);
+  };
+
+  auto& own = job.shares[slot].range;
+
+  while (true) {
+    // Take from the front of our own share
+    auto range = own.load(std::memory_order_acquire);
+    auto begin = uint32_t(range >> 32);
+    auto end = uint32_t(range);
+
+    if (begin < end) {
+      if (own.compare_exchange_weak(range, pack_range(begin + 1, end),
+                                    std::memory_order_acq_rel)) {
+        execute(begin);
+      }
+
+      continue;
+    }
+
+    if (!job.steal) {
+      return;
+    }
+
+    // Steal the back half of another thread's share
+    auto stolen = false;
+
+    for (auto i = 1; i < job.shares_count && !stolen; i++) {
+      auto& victim = job.shares[(slot + i) % job.shares_count].range;
+      auto victim_range = victim.load(std::memory_order_acquire);
+
+      while (true) {
+        auto victim_begin = uint32_t(victim_range >> 32);
+        auto victim_end = uint32_t(victim_range);
+
+        if (victim_begin >= victim_end) {
+          break;
+        }
+
+        auto middle = victim_end - (victim_end - victim_begin + 1) / 2;
+
+        if (victim.compare_exchange_weak(victim_range, pack_range(victim_begin, middle),
+                                         std::memory_order_acq_rel)) {
+          // Keep the rest of the stolen chunks, so other threads can steal them back
+          own.store(pack_range(middle + 1, victim_end), std::memory_order_release);
+          execute(middle);
+          stolen = true;
+          break;
+        }
+      }
+    }
+
+    if (!stolen) {
+      return;
+    }
+  }
+}
+
+void ThreadPool::worker_main(int index) {
+  auto seen_generation = uint64_t(0);
+
+  while (true) {
+    // Spin first, so back to back jobs don't pay for a wake up
+    for (auto i = 0; i < spin_iterations_; i++) {
+      if (job_generation_.load(std::memory_order_acquire) != seen_generation) {
+        break;
+      }
+
+      _mm_pause();
+    }
+
+    {
+      auto lock = std::unique_lock<std::mutex>(job_mutex_);
+      job_available_.wait(lock, [&] {
+        return stopping_ || job_generation_.load(std::memory_order_relaxed) != seen_generation;
+      });
+
+      if (stopping_) {
+        return;
+      }
+
+      seen_generation = job_generation_.load(std::memory_order_relaxed);
+
+      // Too late for a job that has finished
+      if (!job_open_) {
+        continue;
+      }
+
+      job_workers_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // The job may have finished already, in which case there is nothing left to take.
+    run_job(*job_, index);
+
+    job_workers_.fetch_sub(1, std::memory_order_release);
+  }
+}
+
+ThreadPool& default_thread_pool() {
+  static auto pool = ThreadPool();
+  return pool;
+}
+
+}    // namespace interpolate
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+namespace interpolate
+{
+
+// Persistent worker threads for interpolating a frame in parallel, with less dispatch overhead
+// than a generic threading backend.
+//
+// A parallel_for() splits the work into chunks, and gives each thread a contiguous share of
+// them. Threads take chunks from the front of their own share, and when it runs out, steal the
+// back half of another thread's share. The calling thread works too.
+//
+// Idle workers spin for a while waiting for the next parallel_for(), so back to back frames start
+// without a wake up, then park on a condition variable so an idle pool doesn't use any CPU.
+class ThreadPool
+{
+public:
+  struct Options {
+    // Number of threads including the caller of parallel_for(). 0 uses all hardware threads.
+    int threads = 0;
+
+    // Pin worker i to the i-th CPU the process may run on. The calling thread isn't pinned.
+    bool pin_threads = false;
+
+    // Pin worker i to cpus[i % cpus.size()] instead, eg the CPUs of one NUMA node. Worker
+    // indices start at 1, so with as many threads as CPUs cpus[0] is left for the caller.
+    std::vector<int> cpus;
+
+    // How many times an idle worker checks for new work before parking.
+    int spin_iterations = 20000;
+  };
+
+  // Notified on each thread as it starts and finishes its part of a parallel_for(), eg to count
+  // the work of each thread without the time it spends idle. Calls on different threads are
+  // concurrent, and must not throw.
+  class JobObserver
+  {
+  public:
+    virtual ~JobObserver() {}
+    virtual void job_started(int thread) = 0;
+    virtual void job_finished(int thread) = 0;
+  };
+
+  ThreadPool() : ThreadPool(Options()) {}
+  explicit ThreadPool(const Options& options);
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  // Number of threads including the caller of parallel_for().
+  int threads() const { return int(workers_.size()) + 1; }
+
+  // Call body(begin, end) for chunks of [0, count) of `grain` items, and return once they have
+  // all finished. A grain of 0 picks a chunk size giving each thread several chunks to balance
+  // the load. The body must not throw. Calls from multiple threads are serialised.
+  //
+  // The body is called through a pointer to it rather than copied into a std::function, and the
+  // pool reuses the same job for every call, so a parallel_for() doesn't allocate.
+  template <typename Body>
+  void parallel_for(int count, int grain, const Body& body) {
+    const auto call = [](const void* body, int begin, int end) {
+      (*static_cast<const Body*>(body))(begin, end);
+    };
+
+    dispatch(count, grain, call, &body, true);
+  }
+
+  // Call body(thread) once on each thread of the pool, with the caller of for_each_thread() as
+  // thread 0, and return once they have all finished, eg to set up state for each thread. The
+  // body must not throw.
+  template <typename Body>
+  void for_each_thread(const Body& body) {
+    const auto call = [](const void* body, int begin, int) {
+      (*static_cast<const Body*>(body))(begin);
+    };
+
+    dispatch(threads(), 1, call, &body, false);
+  }
+
+  // Notify `observer` of the parallel_for() calls from now on, or stop notifying with nullptr.
+  // The observer must outlive its use.
+  void set_job_observer(JobObserver* observer);
+
+private:
+  struct Job;
+
+  using BodyCall = void (*)(const void* body, int begin, int end);
+
+  void dispatch(int count, int grain, BodyCall call, const void* body, bool steal);
+  void worker_main(int index);
+  static void run_job(Job& job, int slot);
+  static void take_chunks(Job& job, int slot);
+
+  std::vector<std::thread> workers_;
+  int spin_iterations_;
+
+  // Serialises parallel_for() calls
+  std::mutex dispatch_mutex_;
+  JobObserver* observer_ = nullptr;
+
+  // The job of every parallel_for(), with a share of its chunks for each thread
+  std::unique_ptr<Job> job_;
+
+  // Publishes jobs to the workers. Workers only join the job while it's open, and the job isn't
+  // reused until the workers that joined it have left it.
+  std::mutex job_mutex_;
+  std::condition_variable job_available_;
+  std::atomic<uint64_t> job_generation_{0};
+  bool job_open_ = false;
+  std::atomic<int> job_workers_{0};
+  bool stopping_ = false;
+};
+
+// CPUs the process may run on.
+std::vector<int> allowed_cpus();
+
+// Thread pool with a thread per hardware thread, created on first use and shared by everything
+// in the process that doesn't bring its own pool.
+ThreadPool& default_thread_pool();
+
+}    // namespace interpolate
@@ -10,43 +10,215 @@ struct InputCoords {
   float x;
 };
 
-struct BGRPixel {
+// Compact map formats, see compact_maps.hpp.
+
+// Number of fractional bits in a fixed point map, as in OpenCV's CV_16SC2 + CV_16UC1 maps.
+static constexpr int FIXED_POINT_BITS = 5;
+static constexpr int FIXED_POINT_SCALE = 1 << FIXED_POINT_BITS;
+static constexpr int FIXED_POINT_MASK = FIXED_POINT_SCALE - 1;
+
+// Bits of the weights in the exact mode (see Kernels::bilinear_exact_row). Each weight is the
+// product of two fixed point fractions, so it is exact and the four weights always sum to
+// 1 << EXACT_WEIGHT_BITS. OpenCV's INTER_LINEAR tables hold the same weights scaled to 15 bits.
+static constexpr int EXACT_WEIGHT_BITS = 2 * FIXED_POINT_BITS;
+
+// Integer part of a fixed point coordinate. The fractional parts are stored in a separate map of
+// uint16_t, (fy << FIXED_POINT_BITS) | fx, so a map is 6 bytes per pixel instead of 8.
+struct FixedPointCoords {
+  int16_t y;
+  int16_t x;
+};
+
+// Half float offset of the source coordinates from the output pixel position, 4 bytes per pixel.
+// Offsets rather than absolute coordinates are stored because half floats only have 11
+// significant bits, which is too coarse for absolute coordinates in large images.
+//
+// Offsets are only precise while they are small: below 2^k pixels a half float rounds them to
+// 2^(k - 11) pixels. Offsets within +-HALF_FLOAT_OFFSETS_RANGE, eg of lens undistortion or
+// stabilisation maps, are within HALF_FLOAT_OFFSETS_ERROR of a pixel. Maps that move pixels
+// further, eg large rotations or downscales, should use the fixed point or float formats.
+struct HalfFloatOffsets {
+  uint16_t y;
+  uint16_t x;
+};
+
+static constexpr float HALF_FLOAT_OFFSETS_RANGE = 64.0f;
+static constexpr float HALF_FLOAT_OFFSETS_ERROR = 1.0f / 64.0f;
+
+// Weights of the top left, top right, bottom left and bottom right source pixels of a bilinear
+// interpolation, in the range 0-256. Same layout as the weights in the SIMD kernels' registers.
+struct BilinearWeights {
+  uint16_t w[4];
+};
+
+// Weights of the left and right source pixels of an output column of a resize, in the range
+// 0-256 and summing to 256. Same layout as the weights in the SIMD kernels' registers.
+struct ResizeWeights {
+  uint16_t w[2];
+};
+
+// A rectangle of an image, eg the crop of a source image to resize.
+struct Rect {
+  int x;
+  int y;
+  int width;
+  int height;
+};
+
+// Size of the output tiles interpolated in one go by the tiled remap (see remap.hpp). A tile as
+// wide as the image interpolates whole rows.
+struct TileSize {
+  int width;
+  int height;
+};
+
+// How the SIMD kernels fetch source pixels: a scalar address calculation and load for each
+// pixel, or vector address calculation and hardware gathers. Which is faster depends on the CPU.
+enum class Fetch { scalar, gather };
+
+// How the kernels write output pixels: regular stores through the cache, or non-temporal stores
+// of whole cache lines that bypass it (see Kernels::bilinear_streaming_row). Streaming is faster
+// when the output is much larger than the cache and isn't read again soon.
+enum class Store { cached, streaming };
+
+// Maps an output pixel (x, y) to source image coordinates:
+// source x = m[0][0] * x + m[0][1] * y + m[0][2]
+// source y = m[1][0] * x + m[1][1] * y + m[1][2]
+struct AffineTransform {
+  float m[2][3];
+};
+
+// Homography mapping an output pixel (x, y) to source image coordinates:
+// w = m[2][0] * x + m[2][1] * y + m[2][2]
+// source x = (m[0][0] * x + m[0][1] * y + m[0][2]) / w
+// source y = (m[1][0] * x + m[1][1] * y + m[1][2]) / w
+struct PerspectiveTransform {
+  float m[3][3];
+};
+
+// Pixel of three `Channel`s in B G R order, eg uint16_t for 10 or 12 bit HDR frames or float
+// for feature maps.
+template <typename Channel>
+struct BasicBGRPixel {
+  Channel b;
+  Channel g;
+  Channel r;
+};
+
+using BGRPixel = BasicBGRPixel<uint8_t>;
+using BGR16Pixel = BasicBGRPixel<uint16_t>;
+using BGRFloatPixel = BasicBGRPixel<float>;
+
+// How source pixels outside the image are sampled, as OpenCV's border types:
+// constant:  vvvvvv|abcdefgh|vvvvvv, a fixed pixel v
+// replicate: aaaaaa|abcdefgh|hhhhhh
+// reflect:   fedcba|abcdefgh|hgfedcba, repeating for coordinates further out
+enum class BorderType { constant, replicate, reflect };
+
+// A border type, and the pixel outside the image for BorderType::constant.
+struct Border {
+  BorderType type;
+  BGRPixel value;
+};
+
+// Coordinates sampled through a border are limited to +-BORDER_COORDS_LIMIT, so their rows and
+// columns convert to ints exactly. NaN coordinates are sampled at -BORDER_COORDS_LIMIT.
+static constexpr float BORDER_COORDS_LIMIT = float(1 << 22);
+
+// 32bpp pixel, eg from capture or compositing. Alpha (or the unused X byte of BGRX) is
+// interpolated like the colour channels.
+struct BGRAPixel {
   uint8_t b;
   uint8_t g;
   uint8_t r;
+  uint8_t a;
 };
 
-class BGRImage
+// View of an image of `Pixel`s with an explicit step in bytes between rows. Doesn't own the
+// pixels.
+template <typename Pixel>
+class Image
 {
 public:
   int rows;
   int cols;
   int step;
-  BGRPixel* data;    // non-owner
+  Pixel* data;    // non-owner
   uintptr_t data_end;
 
-  BGRImage(){};
-  BGRImage(int rows, int cols, int step, BGRPixel* data)
+  Image(){};
+  Image(int rows, int cols, int step, Pixel* data)
       : rows(rows),
         cols(cols),
         step(step),
         data(data),
         data_end(((uintptr_t) data) + rows * step) {}
 
-  inline const BGRPixel* ptr(int row, int col) const {
-    int offset = (row * step) + (col * 3);
-    return (const BGRPixel*) (((const uint8_t*) data) + offset);
+  inline const Pixel* ptr(int row, int col) const {
+    int offset = (row * step) + (col * int(sizeof(Pixel)));
+    return (const Pixel*) (((const uint8_t*) data) + offset);
   }
 
-  inline const BGRPixel* ptr_below(const BGRPixel* ptr) const {
+  // Start of a row, for images written as the output.
+  inline Pixel* row(int row) const { return (Pixel*) (((uint8_t*) data) + (row * step)); }
+
+  inline const Pixel* ptr_below(const Pixel* ptr) const {
     auto end = ((uintptr_t) ptr) + step;
 
     if (end < data_end) [[likely]] {
-      return (const BGRPixel*) end;
+      return (const Pixel*) end;
     } else {
       return ptr;
     }
   }
 };
 
+using BGRImage = Image<BGRPixel>;
+using BGRAImage = Image<BGRAPixel>;
+using BGR16Image = Image<BGR16Pixel>;
+using BGRFloatImage = Image<BGRFloatPixel>;
+
+// Single channel 8 bit image, eg a luma plane.
+using GrayImage = Image<uint8_t>;
+
+// Pixel of the interleaved chroma plane of an NV12 frame.
+struct UVPixel {
+  uint8_t u;
+  uint8_t v;
+};
+
+using UVImage = Image<UVPixel>;
+
+// BT.601 limited range YUV to BGR coefficients, in the fixed point of OpenCV's YUV to BGR
+// conversions with YUV_SHIFT fractional bits, so the conversions are bit exact with them.
+static constexpr int YUV_SHIFT = 20;
+static constexpr int YUV_CY = 1220542;
+static constexpr int YUV_CUB = 2116026;
+static constexpr int YUV_CUG = -409993;
+static constexpr int YUV_CVG = -852492;
+static constexpr int YUV_CVR = 1673527;
+
+// View of a map of a value per output pixel, eg the sampling coordinates of a frame, with an
+// explicit step in bytes between rows so it can wrap any buffer. Doesn't own the values.
+template <typename T>
+class MapView
+{
+public:
+  int rows;
+  int cols;
+  int step;
+  const T* data;    // non-owner
+
+  MapView(){};
+  MapView(int rows, int cols, int step, const T* data)
+      : rows(rows), cols(cols), step(step), data(data) {}
+
+  inline const T* row(int row) const {
+    return (const T*) (((const uint8_t*) data) + (row * step));
+  }
+};
+
+// Sampling coordinates of every pixel of an output image.
+using CoordsMap = MapView<InputCoords>;
+
 }    // namespace interpolate
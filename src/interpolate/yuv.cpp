@@ -0,0 +1,361 @@
+#include "interpolate/yuv.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+#include "interpolate/kernels.hpp"
+
+namespace interpolate
+{
+
+//
+// Frame checks
+//
+
+// Size of a chroma plane side for a luma plane side.
+static int chroma_size(int luma_size) {
+  return (luma_size + 1) / 2;
+}
+
+template <typename Plane>
+static void check_chroma_plane(const GrayImage& luma, const Plane& chroma) {
+  if (chroma.rows != chroma_size(luma.rows) || chroma.cols != chroma_size(luma.cols)) {
+    throw std::runtime_error("chroma planes must be half the size of the luma plane");
+  }
+}
+
+static void check_frame(const NV12Image& frame) {
+  check_chroma_plane(frame.y, frame.uv);
+}
+
+static void check_frame(const I420Image& frame) {
+  check_chroma_plane(frame.y, frame.u);
+  check_chroma_plane(frame.y, frame.v);
+}
+
+void convert(const NV12Image& source, const BGRImage& output, Isa isa) {
+  check_frame(source);
+
+  if (output.rows != source.y.rows || output.cols != source.y.cols) {
+    throw std::runtime_error("output image must be the same size as the luma plane");
+  }
+
+  const auto& kernels = supported_kernels(isa);
+
+  for (auto y = 0; y < output.rows; y++) {
+    kernels.nv12_to_bgr_row(source.y.ptr(y, 0), source.uv.ptr(y / 2, 0), output.row(y),
+                            output.cols);
+  }
+}
+
+void convert(const NV12Image& source, const BGRImage& output) {
+  convert(source, output, active_isa());
+}
+
+//
+// Coordinates
+//
+
+// Clamp source coordinates to a plane. Comparisons with NaN return the clamp bound.
+static inline InputCoords clamp_coords(int rows, int cols, float x, float y) {
+  x = (x > 0.0f) ? x : 0.0f;
+  y = (y > 0.0f) ? y : 0.0f;
+  x = (x < float(cols - 1)) ? x : float(cols - 1);
+  y = (y < float(rows - 1)) ? y : float(rows - 1);
+
+  return {y, x};
+}
+
+// Luma coordinates of output row y: a row of the map, or generated from the transform into
+// `scratch`.
+static const InputCoords* luma_coords_row(const LumaCoords& coords, const GrayImage& source, int y,
+                                          int cols, InputCoords* scratch) {
+  switch (coords.source) {
+    case LumaCoords::Source::map:
+      return coords.map.row(y);
+
+    case LumaCoords::Source::affine: {
+      const auto& m = coords.affine.m;
+      const auto row_x = m[0][1] * y + m[0][2];
+      const auto row_y = m[1][1] * y + m[1][2];
+
+      for (auto x = 0; x < cols; x++) {
+        scratch[x] = clamp_coords(source.rows, source.cols, m[0][0] * float(x) + row_x,
+                                  m[1][0] * float(x) + row_y);
+      }
+
+      return scratch;
+    }
+
+    case LumaCoords::Source::perspective: {
+      const auto& m = coords.perspective.m;
+      const auto row_x = m[0][1] * y + m[0][2];
+      const auto row_y = m[1][1] * y + m[1][2];
+      const auto row_w = m[2][1] * y + m[2][2];
+
+      for (auto x = 0; x < cols; x++) {
+        const auto w = m[2][0] * float(x) + row_w;
+        scratch[x] = clamp_coords(source.rows, source.cols, (m[0][0] * float(x) + row_x) / w,
+                                  (m[1][0] * float(x) + row_y) / w);
+      }
+
+      return scratch;
+    }
+  }
+
+  return scratch;
+}
+
+// The two luma samples, and their weights, whose weighted sum is the position of chroma sample
+// `i`. A chroma sample is at the centre of the block of 2 luma samples it covers, or at the end of
+// an odd size plane, where it only covers one, extrapolated from the last two.
+struct BlockCentre {
+  int first;
+  int second;
+  float first_weight;
+  float second_weight;
+};
+
+static BlockCentre block_centre(int i, int luma_size) {
+  const auto first = 2 * i;
+
+  if (first + 1 < luma_size) {
+    return {first, first + 1, 0.5f, 0.5f};
+  } else if (first > 0) {
+    return {first - 1, first, -0.5f, 1.5f};
+  } else {
+    return {first, first, 0.5f, 0.5f};
+  }
+}
+
+// Coordinates of `count` chroma output pixels from the luma coordinates of the two luma rows of
+// `rows`, clamped to a source chroma plane of source_rows x source_cols. The luma coordinates at
+// the centre of each chroma pixel are at (luma - 0.5) / 2 in the chroma plane.
+static void chroma_coords_row(const InputCoords* first, const InputCoords* second,
+                              const BlockCentre& rows, int luma_cols, int source_rows,
+                              int source_cols, InputCoords* chroma_coords, int count) {
+  for (auto x = 0; x < count; x++) {
+    const auto cols = block_centre(x, luma_cols);
+
+    // Centres of the two rows, then of the block
+    const auto left_x = rows.first_weight * first[cols.first].x +
+                        rows.second_weight * second[cols.first].x;
+    const auto right_x = rows.first_weight * first[cols.second].x +
+                         rows.second_weight * second[cols.second].x;
+    const auto left_y = rows.first_weight * first[cols.first].y +
+                        rows.second_weight * second[cols.first].y;
+    const auto right_y = rows.first_weight * first[cols.second].y +
+                         rows.second_weight * second[cols.second].y;
+
+    const auto luma_x = cols.first_weight * left_x + cols.second_weight * right_x;
+    const auto luma_y = cols.first_weight * left_y + cols.second_weight * right_y;
+
+    chroma_coords[x] =
+        clamp_coords(source_rows, source_cols, 0.5f * luma_x - 0.25f, 0.5f * luma_y - 0.25f);
+  }
+}
+
+//
+// Warps
+//
+
+// Grow `buffer` to at least `size` elements. Never shrinks, so the capacity is kept.
+template <typename T>
+static void grow(std::vector<T>& buffer, int size) {
+  if (buffer.size() < size_t(size)) {
+    buffer.resize(size);
+  }
+}
+
+// Buffers for the rows of a warp, at least as long as its rows.
+struct RowScratch {
+  std::vector<InputCoords> luma_coords[2];
+  std::vector<InputCoords> chroma_coords;
+
+  // U and V planes of an I420 source
+  std::vector<uint8_t> u;
+  std::vector<uint8_t> v;
+
+  // Warped rows of a BGR output, before conversion
+  std::vector<uint8_t> luma[2];
+  std::vector<UVPixel> chroma;
+
+  void grow_rows(int luma_cols, int chroma_cols) {
+    for (auto i = 0; i < 2; i++) {
+      grow(luma_coords[i], luma_cols);
+      grow(luma[i], luma_cols);
+    }
+
+    grow(chroma_coords, chroma_cols);
+    grow(u, chroma_cols);
+    grow(v, chroma_cols);
+    grow(chroma, chroma_cols);
+  }
+};
+
+// Scratch rows of the calling thread for a warp of `luma_cols` wide frames. Kept between frames,
+// so only a thread's first warp, or a warp of wider frames than before, allocates.
+static RowScratch& row_scratch(int luma_cols, int chroma_cols) {
+  thread_local auto scratch = RowScratch();
+  scratch.grow_rows(luma_cols, chroma_cols);
+
+  return scratch;
+}
+
+// Interpolate a row of chroma output pixels from the chroma planes of the source.
+static void interpolate_chroma_row(const Kernels& kernels, const NV12Image& source,
+                                   const InputCoords* coords, UVPixel* output, int count,
+                                   RowScratch&) {
+  kernels.bilinear_uv_row(source.uv, coords, output, count);
+}
+
+static void interpolate_chroma_row(const Kernels& kernels, const I420Image& source,
+                                   const InputCoords* coords, UVPixel* output, int count,
+                                   RowScratch& scratch) {
+  kernels.bilinear_gray_row(source.u, coords, scratch.u.data(), count);
+  kernels.bilinear_gray_row(source.v, coords, scratch.v.data(), count);
+
+  for (auto x = 0; x < count; x++) {
+    output[x] = {scratch.u[x], scratch.v[x]};
+  }
+}
+
+// Where the warped rows of a chroma row go: the two luma rows and the chroma row of the output
+// frame, or scratch rows that are converted to BGR once they are all written.
+struct OutputRows {
+  uint8_t* luma[2];
+  UVPixel* chroma;
+};
+
+static int output_rows_count(const NV12Image& output) {
+  return output.y.rows;
+}
+
+static int output_cols_count(const NV12Image& output) {
+  return output.y.cols;
+}
+
+static OutputRows output_rows(const NV12Image& output, int chroma_y, RowScratch&) {
+  const auto y = 2 * chroma_y;
+  auto* bottom = (y + 1 < output.y.rows) ? output.y.row(y + 1) : nullptr;
+
+  return {{output.y.row(y), bottom}, output.uv.row(chroma_y)};
+}
+
+static void finish_rows(const Kernels&, const NV12Image&, int, const OutputRows&) {}
+
+static int output_rows_count(const BGRImage& output) {
+  return output.rows;
+}
+
+static int output_cols_count(const BGRImage& output) {
+  return output.cols;
+}
+
+static OutputRows output_rows(const BGRImage&, int, RowScratch& scratch) {
+  return {{scratch.luma[0].data(), scratch.luma[1].data()}, scratch.chroma.data()};
+}
+
+static void finish_rows(const Kernels& kernels, const BGRImage& output, int chroma_y,
+                        const OutputRows& rows) {
+  for (auto i = 0; i < 2; i++) {
+    const auto y = 2 * chroma_y + i;
+
+    if (y < output.rows) {
+      kernels.nv12_to_bgr_row(rows.luma[i], rows.chroma, output.row(y), output.cols);
+    }
+  }
+}
+
+// Warp the planes of `source` a chroma row, and the two luma rows it covers, at a time.
+template <typename Source, typename Output>
+static void remap_yuv(const Source& source, const LumaCoords& coords, const Output& output,
+                      Isa isa, ThreadPool& pool) {
+  check_frame(source);
+
+  const auto rows = output_rows_count(output);
+  const auto cols = output_cols_count(output);
+
+  if (coords.source == LumaCoords::Source::map && (coords.map.rows != rows ||
+                                                   coords.map.cols != cols)) {
+    throw std::runtime_error("output image must be the same size as the map");
+  }
+
+  const auto& kernels = supported_kernels(isa);
+  const auto chroma_rows = chroma_size(rows);
+  const auto chroma_cols = chroma_size(cols);
+  const auto source_chroma_rows = chroma_size(source.y.rows);
+  const auto source_chroma_cols = chroma_size(source.y.cols);
+
+  pool.parallel_for(chroma_rows, 0, [&](int begin, int end) {
+    auto& scratch = row_scratch(cols, chroma_cols);
+
+    for (auto chroma_y = begin; chroma_y < end; chroma_y++) {
+      const auto centre = block_centre(chroma_y, rows);
+      const auto* first =
+          luma_coords_row(coords, source.y, centre.first, cols, scratch.luma_coords[0].data());
+      const auto* second =
+          luma_coords_row(coords, source.y, centre.second, cols, scratch.luma_coords[1].data());
+
+      chroma_coords_row(first, second, centre, cols, source_chroma_rows, source_chroma_cols,
+                        scratch.chroma_coords.data(), chroma_cols);
+
+      // The luma rows are the rows of the block, unless the last row of an odd height frame was
+      // extrapolated from the row above
+      const auto top_y = 2 * chroma_y;
+      const auto rows_out = output_rows(output, chroma_y, scratch);
+
+      kernels.bilinear_gray_row(source.y, (centre.first == top_y) ? first : second,
+                                rows_out.luma[0], cols);
+
+      if (top_y + 1 < rows) {
+        kernels.bilinear_gray_row(source.y, second, rows_out.luma[1], cols);
+      }
+
+      interpolate_chroma_row(kernels, source, scratch.chroma_coords.data(), rows_out.chroma,
+                             chroma_cols, scratch);
+
+      finish_rows(kernels, output, chroma_y, rows_out);
+    }
+  });
+}
+
+void remap(const NV12Image& source, const LumaCoords& coords, const NV12Image& output, Isa isa,
+           ThreadPool& pool) {
+  check_frame(output);
+  remap_yuv(source, coords, output, isa, pool);
+}
+
+void remap(const I420Image& source, const LumaCoords& coords, const NV12Image& output, Isa isa,
+           ThreadPool& pool) {
+  check_frame(output);
+  remap_yuv(source, coords, output, isa, pool);
+}
+
+void remap(const NV12Image& source, const LumaCoords& coords, const BGRImage& output, Isa isa,
+           ThreadPool& pool) {
+  remap_yuv(source, coords, output, isa, pool);
+}
+
+void remap(const I420Image& source, const LumaCoords& coords, const BGRImage& output, Isa isa,
+           ThreadPool& pool) {
+  remap_yuv(source, coords, output, isa, pool);
+}
+
+void remap(const NV12Image& source, const LumaCoords& coords, const NV12Image& output) {
+  remap(source, coords, output, active_isa(), default_thread_pool());
+}
+
+void remap(const I420Image& source, const LumaCoords& coords, const NV12Image& output) {
+  remap(source, coords, output, active_isa(), default_thread_pool());
+}
+
+void remap(const NV12Image& source, const LumaCoords& coords, const BGRImage& output) {
+  remap(source, coords, output, active_isa(), default_thread_pool());
+}
+
+void remap(const I420Image& source, const LumaCoords& coords, const BGRImage& output) {
+  remap(source, coords, output, active_isa(), default_thread_pool());
+}
+
+}    // namespace interpolate
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "interpolate/isa.hpp"
+#include "interpolate/thread_pool.hpp"
+#include "interpolate/types.hpp"
+
+namespace interpolate
+{
+
+// Views of the planes of a 4:2:0 YUV frame, as decoded by hardware video decoders. The chroma
+// planes are half the width and height of the luma plane, rounded up. Chroma samples are sited
+// at the centre of their 2x2 block of luma samples, as written by OpenCV's BGR to YUV
+// conversions.
+
+// Luma plane and interleaved U V plane.
+struct NV12Image {
+  GrayImage y;
+  UVImage uv;
+};
+
+// Luma plane and separate U and V planes.
+struct I420Image {
+  GrayImage y;
+  GrayImage u;
+  GrayImage v;
+};
+
+// Sampling coordinates of the luma plane of a YUV warp: a map the size of the output frame, or
+// a transform of the output pixel positions. Transform coordinates are clamped to the source
+// frame. Chroma coordinates are derived from the luma coordinates of each 2x2 block.
+struct LumaCoords {
+  enum class Source { map, affine, perspective };
+
+  Source source;
+  CoordsMap map;
+  AffineTransform affine;
+  PerspectiveTransform perspective;
+
+  LumaCoords(const CoordsMap& map) : source(Source::map), map(map) {}
+  LumaCoords(const AffineTransform& affine) : source(Source::affine), affine(affine) {}
+  LumaCoords(const PerspectiveTransform& perspective)
+      : source(Source::perspective), perspective(perspective) {}
+};
+
+// Warp a YUV frame plane by plane, without converting it to BGR first: the luma plane at full
+// resolution with Kernels::bilinear_gray_row, and the chroma at half resolution with
+// Kernels::bilinear_uv_row, or bilinear_gray_row on each plane of an I420 source. Output pixels
+// are rounded to the nearest value, so the result doesn't depend on the instruction set, and an
+// I420 source gives the same output as the same frame in NV12.
+//
+// The output must be the size of the map, the chroma planes of each frame half the size of its
+// luma plane, rounded up, and `isa` supported by the CPU (see isa_supported()), or a
+// std::runtime_error is thrown.
+void remap(const NV12Image& source, const LumaCoords& coords, const NV12Image& output, Isa isa,
+           ThreadPool& pool);
+void remap(const I420Image& source, const LumaCoords& coords, const NV12Image& output, Isa isa,
+           ThreadPool& pool);
+
+// As above, converting the warped rows to BGR as they are written, like convert(), so the NV12
+// output frame is never stored.
+void remap(const NV12Image& source, const LumaCoords& coords, const BGRImage& output, Isa isa,
+           ThreadPool& pool);
+void remap(const I420Image& source, const LumaCoords& coords, const BGRImage& output, Isa isa,
+           ThreadPool& pool);
+
+// As above with the active instruction set (see active_isa()) and default_thread_pool().
+void remap(const NV12Image& source, const LumaCoords& coords, const NV12Image& output);
+void remap(const I420Image& source, const LumaCoords& coords, const NV12Image& output);
+void remap(const NV12Image& source, const LumaCoords& coords, const BGRImage& output);
+void remap(const I420Image& source, const LumaCoords& coords, const BGRImage& output);
+
+// Convert an NV12 frame to BGR with Kernels::nv12_to_bgr_row: the BT.601 limited range integer
+// coefficients of OpenCV's COLOR_YUV2BGR_NV12, and its nearest neighbour chroma upsampling, so
+// the results are identical. The output must be the size of the luma plane.
+void convert(const NV12Image& source, const BGRImage& output, Isa isa);
+
+// As above with the active instruction set.
+void convert(const NV12Image& source, const BGRImage& output);
+
+}    // namespace interpolate
@@ -1,92 +1,798 @@
 #include "common.hpp"
 
-#include "benchmark/bilinear_plain_single_thread.hpp"
-#include "benchmark/bilinear_plain_multi_thread.hpp"
-#include "benchmark/bilinear_sse4_single_thread.hpp"
-#include "benchmark/bilinear_sse4_multi_thread.hpp"
-#include "benchmark/bilinear_avx2_single_thread.hpp"
-#include "benchmark/bilinear_avx2_multi_thread.hpp"
-
-#ifdef __AVX512F__
-#include "benchmark/bilinear_avx512_single_thread.hpp"
-#include "benchmark/bilinear_avx512_multi_thread.hpp"
-#endif
-
-BenchmarkInput create_benchmark_input() {
+#include "benchmark/bilinear_single_thread.hpp"
+#include "benchmark/bilinear_multi_thread.hpp"
+#include "benchmark/bilinear_async.hpp"
+#include "benchmark/bilinear_bgra.hpp"
+#include "benchmark/bilinear_gray.hpp"
+#include "benchmark/bilinear_depth.hpp"
+#include "benchmark/bilinear_yuv.hpp"
+#include "benchmark/bilinear_warp.hpp"
+#include "benchmark/bilinear_border.hpp"
+#include "benchmark/bilinear_compact_map.hpp"
+#include "benchmark/bilinear_exact.hpp"
+#include "benchmark/bilinear_matrix.hpp"
+#include "benchmark/bicubic_multi_thread.hpp"
+#include "benchmark/bilinear_mipmap.hpp"
+#include "benchmark/bilinear_numa.hpp"
+#include "benchmark/bilinear_remap_plan.hpp"
+#include "benchmark/bilinear_resize.hpp"
+#include "benchmark/bilinear_tiled.hpp"
+
+#include "interpolate/isa.hpp"
+
+BenchmarkInput create_benchmark_input(cv::Size2i output_size = cv::Size2i(1280, 720)) {
   auto benchmark_input = BenchmarkInput();
 
   auto source_image = cv::imread("../assets/155603.jpg");
   benchmark_input.source_image_mat = source_image;
 
-  benchmark_input.source_image = interpolate::BGRImage(
-      source_image.rows, source_image.cols, source_image.step,
-      reinterpret_cast<interpolate::BGRPixel*>(source_image.ptr<cv::Vec3b>(0, 0)));
+  benchmark_input.source_image = bgr_image(benchmark_input.source_image_mat);
+  cv::cvtColor(source_image, benchmark_input.source_image_bgra_mat, cv::COLOR_BGR2BGRA);
+  benchmark_input.source_image_bgra = bgra_image(benchmark_input.source_image_bgra_mat);
+  cv::cvtColor(source_image, benchmark_input.source_image_gray_mat, cv::COLOR_BGR2GRAY);
+  benchmark_input.source_image_gray = gray_image(benchmark_input.source_image_gray_mat);
+  source_image.convertTo(benchmark_input.source_image_16_mat, CV_16U, 257.0);
+  benchmark_input.source_image_16 = bgr16_image(benchmark_input.source_image_16_mat);
+  source_image.convertTo(benchmark_input.source_image_float_mat, CV_32F, 1.0 / 255.0);
+  benchmark_input.source_image_float = bgr_float_image(benchmark_input.source_image_float_mat);
+  cv::cvtColor(source_image, benchmark_input.source_image_i420_mat, cv::COLOR_BGR2YUV_I420);
+  benchmark_input.source_image_i420 =
+      i420_image(benchmark_input.source_image_i420_mat, source_image.size());
+  benchmark_input.source_image_nv12_mat =
+      nv12_from_i420(benchmark_input.source_image_i420_mat, source_image.size());
+  benchmark_input.source_image_nv12 =
+      nv12_image(benchmark_input.source_image_nv12_mat, source_image.size());
 
-  benchmark_input.output_size = cv::Size2i(1280, 720);
+  benchmark_input.output_size = output_size;
   benchmark_input.coords =
       sampling_coordinates(benchmark_input.output_size, benchmark_input.source_image_mat.size());
+  benchmark_input.outside_coords = outside_sampling_coordinates(
+      benchmark_input.output_size, benchmark_input.source_image_mat.size());
+  benchmark_input.affine_transform =
+      sampling_transform(benchmark_input.output_size, benchmark_input.source_image_mat.size());
+  benchmark_input.perspective_transform = sampling_perspective_transform(
+      benchmark_input.output_size, benchmark_input.source_image_mat.size());
+  convert_compact_maps(benchmark_input);
 
   return benchmark_input;
 }
 
-void compare_mats(const cv::Mat3b& gold_standard, std::string name, const cv::Mat3b& comparison) {
-  if (!mats_equivalent(gold_standard, comparison)) {
+void compare_mats(const cv::Mat3b& gold_standard, std::string name, const cv::Mat3b& comparison,
+                  int tolerance = 3) {
+  if (!mats_equivalent(gold_standard, comparison, tolerance)) {
     std::cout << name << " output image not the same\n";
     std::exit(1);
   }
 }
 
+// Name used for an instruction set in the benchmark output.
+std::string benchmark_name(interpolate::Isa isa) {
+  switch (isa) {
+    case interpolate::Isa::plain:
+      return "No SIMD";
+    case interpolate::Isa::sse4:
+      return "SSE4";
+    case interpolate::Isa::avx2:
+      return "AVX2";
+    case interpolate::Isa::avx512:
+      return "AVX512";
+    case interpolate::Isa::avx512_icl:
+      return "AVX512 VBMI/VNNI";
+    case interpolate::Isa::avx2_gather:
+      return "AVX2 gather";
+    case interpolate::Isa::avx512_gather:
+      return "AVX512 gather";
+  }
+
+  return interpolate::isa_name(isa);
+}
+
 void validate_implementations(BenchmarkInput& benchmark_input) {
-  auto gold_standard = bilinear_plain_single_thread(benchmark_input);
-
-  compare_mats(gold_standard, "plain multi thread", bilinear_plain_multi_thread(benchmark_input));
-  compare_mats(gold_standard, "sse4 single thread", bilinear_sse4_single_thread(benchmark_input));
-  compare_mats(gold_standard, "sse4 multi thread", bilinear_sse4_multi_thread(benchmark_input));
-  compare_mats(gold_standard, "avx2 single thread", bilinear_avx2_single_thread(benchmark_input));
-  compare_mats(gold_standard, "avx2 multi thread", bilinear_avx2_multi_thread(benchmark_input));
-
-#ifdef __AVX512F__
-  compare_mats(gold_standard, "avx512 single thread",
-               bilinear_avx512_single_thread(benchmark_input));
-  compare_mats(gold_standard, "avx512 multi thread", bilinear_avx512_multi_thread(benchmark_input));
-#endif
+  auto gold_standard = bilinear_single_thread(benchmark_input, interpolate::Isa::plain);
+  auto buffer_pool = interpolate::ImageBufferPool();
+
+  // The single channel kernels round as the exact mode, so interpolating the grayscale image as
+  // BGR with it gives the same values in every channel
+  auto gray_input = benchmark_input;
+  gray_input.source_image_mat = bgr_from_gray(benchmark_input.source_image_gray_mat);
+  gray_input.source_image = bgr_image(gray_input.source_image_mat);
+  auto gray_gold_standard = bilinear_exact_multi_thread(gray_input, interpolate::Isa::plain);
+
+  // The plain 16 bit kernel uses the same weights as the plain 8 bit one, so scaled back to 8
+  // bits it only differs by rounding
+  auto deep_gold_standard = bgr_from_deep(
+      bilinear_deep_single_thread<uint16_t>(benchmark_input, interpolate::Isa::plain));
+  compare_mats(gold_standard, "16 bit", deep_gold_standard, 1);
+
+  // The 8 bit kernels truncate each of the 4 weights and the sum, so they are up to 5 below the
+  // float kernel scaled to 8 bits
+  auto float_gold_standard =
+      bgr_from_deep(bilinear_deep_single_thread<float>(benchmark_input, interpolate::Isa::plain));
+  compare_mats(gold_standard, "float", float_gold_standard, 5);
+
+  // The YUV warps round as the exact mode. The library's conversion to BGR matches OpenCV's,
+  // which only converts even sizes.
+  auto nv12_gold_standard = bilinear_nv12_multi_thread(benchmark_input, interpolate::Isa::plain);
+  auto nv12_bgr_gold_standard = bgr_from_nv12(nv12_gold_standard, benchmark_input.output_size);
+
+  if (benchmark_input.output_size.width % 2 == 0 && benchmark_input.output_size.height % 2 == 0) {
+    auto opencv_nv12_bgr = cv::Mat3b();
+    cv::cvtColor(nv12_gold_standard, opencv_nv12_bgr, cv::COLOR_YUV2BGR_NV12);
+    compare_mats(opencv_nv12_bgr, "NV12 to BGR", nv12_bgr_gold_standard, 0);
+  }
+
+  // Only the instruction sets this CPU supports can be checked.
+  for (auto isa : interpolate::ALL_ISAS) {
+    if (!interpolate::isa_supported(isa)) {
+      continue;
+    }
+
+    auto name = std::string(interpolate::isa_name(isa));
+
+    if (isa != interpolate::Isa::plain) {
+      compare_mats(gold_standard, name + " single thread",
+                   bilinear_single_thread(benchmark_input, isa));
+    }
+
+    compare_mats(gold_standard, name + " multi thread",
+                 bilinear_multi_thread(benchmark_input, isa));
+    compare_mats(gold_standard, name + " multi thread cv::parallel_for_",
+                 bilinear_multi_thread(benchmark_input, isa, Executor::opencv));
+
+    // Output into a buffer pool image, which has padded rows
+    auto buffer = buffer_pool.acquire(gold_standard.rows, gold_standard.cols);
+    bilinear_multi_thread(benchmark_input, isa, buffer.image());
+    compare_mats(gold_standard, name + " multi thread buffer pool", mat_view(buffer.image()));
+
+    // Rows of both images start at different offsets from a cache line
+    auto streaming = interpolate::Store::streaming;
+    compare_mats(gold_standard, name + " multi thread streaming stores",
+                 bilinear_multi_thread(benchmark_input, isa, Executor::thread_pool, streaming));
+    bilinear_multi_thread(benchmark_input, isa, buffer.image(), Executor::thread_pool, streaming);
+    compare_mats(gold_standard, name + " multi thread streaming stores buffer pool",
+                 mat_view(buffer.image()));
+
+    // The library's own entry point, from views of the same buffers
+    interpolate::remap(benchmark_input.source_image, coords_map(benchmark_input.coords),
+                       buffer.image(), isa, thread_pool(false));
+    compare_mats(gold_standard, name + " core remap", mat_view(buffer.image()));
+
+    // The 32bpp kernels give the same colour channels as the 24bpp ones
+    auto isa_output = bilinear_multi_thread(benchmark_input, isa);
+    compare_mats(isa_output, name + " BGRA single thread",
+                 bgr_channels(bilinear_bgra_single_thread(benchmark_input, isa)), 0);
+    compare_mats(isa_output, name + " BGRA core remap",
+                 bgr_channels(bilinear_bgra_multi_thread(benchmark_input, isa)), 0);
+
+    // The single channel kernels give the same output on every instruction set
+    compare_mats(gray_gold_standard, name + " gray single thread",
+                 bgr_from_gray(bilinear_gray_single_thread(benchmark_input, isa)), 0);
+    compare_mats(gray_gold_standard, name + " gray core remap",
+                 bgr_from_gray(bilinear_gray_multi_thread(benchmark_input, isa)), 0);
+
+    // Scaled back to 8 bits, the 16 bit kernels differ from the plain one like the 8 bit kernels
+    // do. The float kernels only differ by rounding.
+    compare_mats(deep_gold_standard, name + " 16 bit single thread",
+                 bgr_from_deep(bilinear_deep_single_thread<uint16_t>(benchmark_input, isa)));
+    compare_mats(deep_gold_standard, name + " 16 bit core remap",
+                 bgr_from_deep(bilinear_deep_multi_thread<uint16_t>(benchmark_input, isa)));
+    compare_mats(float_gold_standard, name + " float single thread",
+                 bgr_from_deep(bilinear_deep_single_thread<float>(benchmark_input, isa)), 1);
+    compare_mats(float_gold_standard, name + " float core remap",
+                 bgr_from_deep(bilinear_deep_multi_thread<float>(benchmark_input, isa)), 1);
+
+    // The YUV warps give the same output on every instruction set, from either source layout,
+    // and fusing the conversion to BGR doesn't change it
+    auto i420 = YuvSource::i420;
+    compare_mats(bgr_from_gray(nv12_gold_standard), name + " NV12",
+                 bgr_from_gray(bilinear_nv12_multi_thread(benchmark_input, isa)), 0);
+    compare_mats(bgr_from_gray(nv12_gold_standard), name + " I420 to NV12",
+                 bgr_from_gray(bilinear_nv12_multi_thread(benchmark_input, isa, i420)), 0);
+    compare_mats(nv12_bgr_gold_standard, name + " NV12 to BGR",
+                 bilinear_nv12_to_bgr_multi_thread(benchmark_input, isa), 0);
+    compare_mats(nv12_bgr_gold_standard, name + " I420 to BGR",
+                 bilinear_nv12_to_bgr_multi_thread(benchmark_input, isa, i420), 0);
+  }
+
+  // Once the buffer pool has a buffer, a frame on the thread pool doesn't allocate
+  auto frame_buffer_pool = interpolate::ImageBufferPool();
+  bilinear_buffer_pool_frame(benchmark_input, interpolate::active_isa(), frame_buffer_pool);
+  auto allocations_start = allocations();
+
+  for (auto i = 0; i < 3; i++) {
+    bilinear_buffer_pool_frame(benchmark_input, interpolate::active_isa(), frame_buffer_pool);
+  }
+
+  if (allocations() != allocations_start) {
+    std::cout << "buffer pool frames allocated " << allocations() - allocations_start
+              << " times\n";
+    exit(1);
+  }
+
+  // The NUMA aware remap, with the map in node memory and with the source replicated too
+  auto active_gold_standard = bilinear_multi_thread(benchmark_input, interpolate::active_isa());
+  auto numa_options = interpolate::NumaRemap::Options();
+  compare_mats(active_gold_standard, "NUMA remap",
+               bilinear_numa(benchmark_input, interpolate::active_isa(), numa_options), 0);
+  numa_options.replicate_source = true;
+  compare_mats(active_gold_standard, "NUMA remap replicated source",
+               bilinear_numa(benchmark_input, interpolate::active_isa(), numa_options), 0);
+
+  // The async API, with a map and with transforms
+  auto async_remap = interpolate::AsyncRemap();
+  compare_mats(active_gold_standard, "async remap", bilinear_async(benchmark_input, async_remap),
+               0);
+  compare_mats(bilinear_affine_multi_thread(benchmark_input, interpolate::active_isa()),
+               "async affine warp",
+               bilinear_async(benchmark_input, benchmark_input.affine_transform, async_remap), 0);
+  compare_mats(bilinear_perspective_multi_thread(benchmark_input, interpolate::active_isa()),
+               "async perspective warp",
+               bilinear_async(benchmark_input, benchmark_input.perspective_transform, async_remap),
+               0);
+
+  // The YUV warps with the luma coordinates generated from transforms
+  for (auto coords : {interpolate::LumaCoords(benchmark_input.affine_transform),
+                      interpolate::LumaCoords(benchmark_input.perspective_transform)}) {
+    auto plain = bilinear_nv12_multi_thread(benchmark_input, coords, interpolate::Isa::plain);
+    auto active = bilinear_nv12_multi_thread(benchmark_input, coords, interpolate::active_isa());
+    compare_mats(bgr_from_gray(plain), "NV12 warp", bgr_from_gray(active), 0);
+  }
+
+  // The exact mode must be identical for every instruction set.
+  auto exact_gold_standard = bilinear_exact_multi_thread(benchmark_input, interpolate::Isa::plain);
+
+  for (auto isa : interpolate::ALL_ISAS) {
+    if (isa == interpolate::Isa::plain || !interpolate::isa_supported(isa)) {
+      continue;
+    }
+
+    compare_mats(exact_gold_standard, std::string(interpolate::isa_name(isa)) + " exact",
+                 bilinear_exact_multi_thread(benchmark_input, isa), 0);
+  }
+
+  // Bicubic and Lanczos-3 use the same integer arithmetic for every instruction set
+  for (auto filter : {interpolate::Filter::bicubic, interpolate::Filter::lanczos3}) {
+    auto filter_name = (filter == interpolate::Filter::bicubic) ? " bicubic" : " Lanczos-3";
+    auto filter_gold_standard =
+        filter_multi_thread(benchmark_input, filter, interpolate::Isa::plain);
+
+    for (auto isa : interpolate::ALL_ISAS) {
+      if (isa == interpolate::Isa::plain || !interpolate::isa_supported(isa)) {
+        continue;
+      }
+
+      compare_mats(filter_gold_standard, interpolate::isa_name(isa) + std::string(filter_name),
+                   filter_multi_thread(benchmark_input, filter, isa), 0);
+    }
+  }
+
+  // OpenCV's own rounding has changed between versions, so a difference from cv::remap is
+  // reported rather than treated as a failure.
+  auto opencv_output = opencv_remap(benchmark_input, opencv_map(benchmark_input.coords));
+
+  if (!mats_equivalent(opencv_output, exact_gold_standard, 0)) {
+    std::cout << "exact mode differs from cv::remap with this OpenCV version\n";
+  }
+
+  // The warp modes generate their coordinates instead of reading a map. The affine transform is
+  // checked against the map it replaces, then the plain warps against the plain map kernel
+  // reading the coordinates of their transforms, and the SIMD warps against the plain ones.
+  auto transform_error = sampling_transform_error(benchmark_input);
+
+  // warpAffine() rounds the coordinates of the map to 1/32 of its grid
+  auto input_size = benchmark_input.source_image_mat.size();
+  auto scale = std::max(float(input_size.width) / benchmark_input.output_size.width,
+                        float(input_size.height) / benchmark_input.output_size.height);
+
+  if (transform_error > 0.01f + scale / 32.0f) {
+    std::cout << "affine transform doesn't match the sampling coordinates, error "
+              << transform_error << " pixels\n";
+    exit(1);
+  }
+
+  auto plain = interpolate::Isa::plain;
+  auto affine_gold_standard = bilinear_affine_multi_thread(benchmark_input, plain);
+  auto perspective_gold_standard = bilinear_perspective_multi_thread(benchmark_input, plain);
+
+  compare_mats(bilinear_multi_thread(
+                   transform_map_input(benchmark_input, benchmark_input.affine_transform), plain),
+               "plain affine warp", affine_gold_standard);
+  compare_mats(bilinear_multi_thread(transform_map_input(benchmark_input,
+                                                         benchmark_input.perspective_transform),
+                                     plain),
+               "plain perspective warp", perspective_gold_standard);
+
+  for (auto isa : interpolate::ALL_ISAS) {
+    if (isa == interpolate::Isa::plain || !interpolate::isa_supported(isa)) {
+      continue;
+    }
+
+    auto name = std::string(interpolate::isa_name(isa));
+
+    compare_mats(affine_gold_standard, name + " affine warp",
+                 bilinear_affine_multi_thread(benchmark_input, isa));
+    compare_mats(perspective_gold_standard, name + " perspective warp",
+                 bilinear_perspective_multi_thread(benchmark_input, isa));
+  }
+
+  // With coordinates inside the image, the border modes give the same output as the regular
+  // kernels, through the interior fast path and the edge path near the last row and column.
+  // Sampling outside the image, the plain implementation is checked against padding the source
+  // with cv::copyMakeBorder() then warping it, and the SIMD implementations against the plain one.
+  auto& outside_coords = benchmark_input.outside_coords;
+  auto padded = padded_map(outside_coords, benchmark_input.source_image_mat.size());
+
+  for (auto type : {interpolate::BorderType::constant, interpolate::BorderType::replicate,
+                    interpolate::BorderType::reflect}) {
+    auto border = border_of(type);
+    auto border_gold_standard = bilinear_border_multi_thread(benchmark_input, outside_coords,
+                                                             border, plain);
+
+    compare_mats(border_gold_standard, "cv::copyMakeBorder " + border_name(type),
+                 bilinear_padded_multi_thread(benchmark_input, padded, border, plain));
+
+    for (auto isa : interpolate::ALL_ISAS) {
+      if (!interpolate::isa_supported(isa)) {
+        continue;
+      }
+
+      auto name = std::string(interpolate::isa_name(isa)) + " border " + border_name(type);
+
+      // The sse4 table uses the plain border kernel
+      auto kernel_isa = (isa == interpolate::Isa::sse4) ? plain : isa;
+      compare_mats(bilinear_multi_thread(benchmark_input, kernel_isa), name + " inside",
+                   bilinear_border_multi_thread(benchmark_input, benchmark_input.coords, border,
+                                                isa),
+                   0);
+      compare_mats(border_gold_standard, name,
+                   bilinear_border_multi_thread(benchmark_input, outside_coords, border, isa));
+    }
+  }
+
+  // The fixed point map holds the coordinates the exact mode rounds to, and interpolates them
+  // the same way. The half float offsets are checked on a map of small offsets, where they must
+  // be within HALF_FLOAT_OFFSETS_ERROR of the float map (plus the rounding of adding them to the
+  // output position), and the output must be that of the float map of the coordinates they
+  // decode to. Moving a sample by that error changes each axis's interpolation by up to 255 / 64,
+  // so the output is within 8 of the float map's. The benchmark map's offsets are too large for
+  // these checks, so on it the SIMD implementations are checked against the plain ones.
+  auto fixed_point = MapFormat::fixed_point;
+  auto half_float = MapFormat::half_float;
+  auto fixed_point_gold_standard =
+      bilinear_compact_map_multi_thread(benchmark_input, fixed_point, plain);
+  auto half_float_gold_standard =
+      bilinear_compact_map_multi_thread(benchmark_input, half_float, plain);
+
+  compare_mats(exact_gold_standard, "plain fixed point map", fixed_point_gold_standard, 0);
+
+  auto undistortion_input = benchmark_input;
+  undistortion_input.output_size = benchmark_input.source_image_mat.size();
+  undistortion_input.coords = undistortion_coordinates(undistortion_input.output_size, 48.0f);
+  convert_compact_maps(undistortion_input);
+
+  auto half_float_coords_error = half_float_error(undistortion_input);
+
+  if (half_float_coords_error > interpolate::HALF_FLOAT_OFFSETS_ERROR + 0.001f) {
+    std::cout << "half float offsets differ from the float map by " << half_float_coords_error
+              << " pixels\n";
+    exit(1);
+  }
+
+  auto undistortion_half_float =
+      bilinear_compact_map_multi_thread(undistortion_input, half_float, plain);
+  auto decoded_input = undistortion_input;
+  decoded_input.coords = half_float_coordinates(undistortion_input);
+  compare_mats(bilinear_multi_thread(decoded_input, plain), "plain half float map",
+               undistortion_half_float, 0);
+  compare_mats(bilinear_multi_thread(undistortion_input, plain),
+               "plain half float map against the float map", undistortion_half_float, 8);
+
+  for (auto isa : interpolate::ALL_ISAS) {
+    if (isa == interpolate::Isa::plain || !interpolate::isa_supported(isa)) {
+      continue;
+    }
+
+    auto name = std::string(interpolate::isa_name(isa));
+
+    compare_mats(fixed_point_gold_standard, name + " fixed point map",
+                 bilinear_compact_map_multi_thread(benchmark_input, fixed_point, isa));
+    compare_mats(half_float_gold_standard, name + " half float map",
+                 bilinear_compact_map_multi_thread(benchmark_input, half_float, isa));
+  }
+
+  // Remap plans are built from the float map.
+  auto plan = build_remap_plan(benchmark_input);
+
+  for (auto isa : interpolate::ALL_ISAS) {
+    if (!interpolate::isa_supported(isa)) {
+      continue;
+    }
+
+    auto name = std::string(interpolate::isa_name(isa));
+
+    compare_mats(gold_standard, name + " remap plan",
+                 bilinear_remap_plan_multi_thread(benchmark_input, plan, isa));
+
+    // Tiles that don't divide the output evenly
+    compare_mats(gold_standard, name + " tiled",
+                 bilinear_tiled_multi_thread(benchmark_input, benchmark_input.coords,
+                                             interpolate::TileSize{48, 13}, isa));
+  }
+
+  // Resizes are identical for every instruction set, and within rounding of the generic kernels
+  // with the same coordinates and of cv::resize.
+  for (auto scale : {ResizeScale::down_2x, ResizeScale::down_1_5x, ResizeScale::up_2x}) {
+    auto scale_name = std::string(" resize ") + resize_scale_name(scale);
+    auto resize_plan = build_resize_plan(benchmark_input, scale);
+    auto resize_gold_standard = bilinear_resize_multi_thread(benchmark_input, resize_plan, plain);
+
+    compare_mats(resize_gold_standard, "map" + scale_name,
+                 bilinear_multi_thread(resize_map_input(benchmark_input, resize_plan), plain));
+    compare_mats(resize_gold_standard, "cv::resize" + scale_name,
+                 opencv_resize(benchmark_input, resize_plan), 2);
+
+    for (auto isa : interpolate::ALL_ISAS) {
+      if (isa == interpolate::Isa::plain || !interpolate::isa_supported(isa)) {
+        continue;
+      }
+
+      compare_mats(resize_gold_standard, interpolate::isa_name(isa) + scale_name,
+                   bilinear_resize_multi_thread(benchmark_input, resize_plan, isa), 0);
+    }
+  }
+
+  // Pyramid levels are identical for every instruction set. Mipmapped output is checked against
+  // the plain implementation, with one more for rounding the blend of two levels.
+  auto plain_pyramid = interpolate::ImagePyramid();
+  auto nearest_level = interpolate::MipmapFilter::nearest_level;
+  auto trilinear = interpolate::MipmapFilter::trilinear;
+  auto nearest_level_gold_standard =
+      bilinear_mipmap_multi_thread(benchmark_input, plain_pyramid, nearest_level, plain);
+  auto trilinear_gold_standard =
+      bilinear_mipmap_multi_thread(benchmark_input, plain_pyramid, trilinear, plain);
+
+  if (plain_pyramid.builds() != 1) {
+    std::cout << "image pyramid rebuilt for the same source image\n";
+    std::exit(1);
+  }
+
+  for (auto isa : interpolate::ALL_ISAS) {
+    if (isa == interpolate::Isa::plain || !interpolate::isa_supported(isa)) {
+      continue;
+    }
+
+    auto name = std::string(interpolate::isa_name(isa));
+    auto pyramid = interpolate::ImagePyramid();
+
+    compare_mats(nearest_level_gold_standard, name + " mipmap nearest level",
+                 bilinear_mipmap_multi_thread(benchmark_input, pyramid, nearest_level, isa));
+    compare_mats(trilinear_gold_standard, name + " mipmap trilinear",
+                 bilinear_mipmap_multi_thread(benchmark_input, pyramid, trilinear, isa), 4);
+
+    for (auto level = 1; level < plain_pyramid.levels(); level++) {
+      compare_mats(mat_view(plain_pyramid.level(level)), name + " pyramid level",
+                   mat_view(pyramid.level(level)), 0);
+    }
+  }
 }
 
 void register_benchmarks(BenchmarkInput& benchmark_input) {
   auto benchmarks = std::vector<benchmark::internal::Benchmark*>();
 
+  for (auto isa : interpolate::ALL_ISAS) {
+    if (!interpolate::isa_supported(isa)) {
+      continue;
+    }
+
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - single thread").c_str(), BM_bilinear_single_thread,
+        benchmark_input, isa));
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - multi thread").c_str(), BM_bilinear_multi_thread,
+        benchmark_input, isa));
+  }
+
+  // The cost of the exact mode against the 8 bit weights above
+  for (auto isa : interpolate::ALL_ISAS) {
+    if (!interpolate::isa_supported(isa)) {
+      continue;
+    }
+
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - exact - multi thread").c_str(), BM_bilinear_exact_multi_thread,
+        benchmark_input, isa));
+  }
+
+  // 32bpp against 24bpp ("<ISA> - single thread" and "<ISA> - multi thread")
+  for (auto isa : interpolate::ALL_ISAS) {
+    if (!interpolate::isa_supported(isa)) {
+      continue;
+    }
+
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - BGRA - single thread").c_str(), BM_bilinear_bgra,
+        benchmark_input, isa, false));
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - BGRA - multi thread").c_str(), BM_bilinear_bgra,
+        benchmark_input, isa, true));
+  }
+
+  // 8 bit single channel against 24bpp ("<ISA> - single thread" and "<ISA> - multi thread")
+  for (auto isa : interpolate::ALL_ISAS) {
+    if (!interpolate::isa_supported(isa)) {
+      continue;
+    }
+
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - gray - single thread").c_str(), BM_bilinear_gray,
+        benchmark_input, isa, false));
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - gray - multi thread").c_str(), BM_bilinear_gray,
+        benchmark_input, isa, true));
+  }
+
+  // 16 bit and float channels against 8 bit ("<ISA> - single thread" and "<ISA> - multi thread")
+  for (auto isa : interpolate::ALL_ISAS) {
+    if (!interpolate::isa_supported(isa)) {
+      continue;
+    }
+
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - 16 bit - single thread").c_str(), BM_bilinear_deep<uint16_t>,
+        benchmark_input, isa, false));
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - 16 bit - multi thread").c_str(), BM_bilinear_deep<uint16_t>,
+        benchmark_input, isa, true));
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - float - single thread").c_str(), BM_bilinear_deep<float>,
+        benchmark_input, isa, false));
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - float - multi thread").c_str(), BM_bilinear_deep<float>,
+        benchmark_input, isa, true));
+  }
+
+  // YUV warps against converting the source frame to BGR then warping it
+  for (auto isa : interpolate::ALL_ISAS) {
+    if (!interpolate::isa_supported(isa)) {
+      continue;
+    }
+
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - NV12 - multi thread").c_str(), BM_bilinear_yuv,
+        benchmark_input, isa, YuvWarp::nv12));
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - NV12 to BGR - multi thread").c_str(), BM_bilinear_yuv,
+        benchmark_input, isa, YuvWarp::nv12_to_bgr));
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - cv::cvtColor NV12 then BGR - multi thread").c_str(),
+        BM_bilinear_yuv, benchmark_input, isa, YuvWarp::convert_then_warp));
+  }
+
+  // Border modes: with the map inside the image against "<ISA> - multi thread", and sampling
+  // outside it against padding the source with cv::copyMakeBorder() every frame
+  auto padded = padded_map(benchmark_input.outside_coords, benchmark_input.source_image_mat.size());
+
+  for (auto isa : interpolate::ALL_ISAS) {
+    if (!interpolate::isa_supported(isa)) {
+      continue;
+    }
+
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - border replicate inside - multi thread").c_str(),
+        BM_bilinear_border_multi_thread, benchmark_input, benchmark_input.coords,
+        interpolate::BorderType::replicate, isa));
+
+    for (auto type : {interpolate::BorderType::constant, interpolate::BorderType::replicate,
+                      interpolate::BorderType::reflect}) {
+      benchmarks.push_back(benchmark::RegisterBenchmark(
+          (benchmark_name(isa) + " - border " + border_name(type) + " - multi thread").c_str(),
+          BM_bilinear_border_multi_thread, benchmark_input, benchmark_input.outside_coords, type,
+          isa));
+    }
+
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - cv::copyMakeBorder replicate then multi thread").c_str(),
+        BM_bilinear_padded_multi_thread, benchmark_input, padded,
+        interpolate::BorderType::replicate, isa));
+  }
+
+  benchmarks.push_back(
+      benchmark::RegisterBenchmark("OpenCV - cv::remap", BM_opencv_remap, benchmark_input));
+
+  // Higher order filters against bilinear ("<ISA> - multi thread") and cv::remap with INTER_CUBIC
+  for (auto isa : interpolate::ALL_ISAS) {
+    if (!interpolate::isa_supported(isa)) {
+      continue;
+    }
+
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - bicubic - multi thread").c_str(), BM_filter_multi_thread,
+        benchmark_input, interpolate::Filter::bicubic, isa));
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - Lanczos-3 - multi thread").c_str(), BM_filter_multi_thread,
+        benchmark_input, interpolate::Filter::lanczos3, isa));
+  }
+
+  benchmarks.push_back(benchmark::RegisterBenchmark("OpenCV - cv::remap - INTER_CUBIC",
+                                                    BM_opencv_remap_cubic, benchmark_input));
+
   benchmarks.push_back(benchmark::RegisterBenchmark(
-      "No SIMD - single thread", BM_bilinear_plain_single_thread, benchmark_input));
-  benchmarks.push_back(benchmark::RegisterBenchmark(
-      "No SIMD - multi thread", BM_bilinear_plain_multi_thread, benchmark_input));
+      "Dispatched - multi thread", BM_bilinear_dispatched_multi_thread, benchmark_input,
+      Executor::thread_pool));
 
+  // "Dispatched - multi thread" allocates the output every frame, these three don't
   benchmarks.push_back(benchmark::RegisterBenchmark(
-      "SSE4 - single thread", BM_bilinear_sse4_single_thread, benchmark_input));
+      "Dispatched - multi thread - kernel only", BM_bilinear_dispatched_multi_thread_preallocated,
+      benchmark_input));
   benchmarks.push_back(benchmark::RegisterBenchmark(
-      "SSE4 - multi thread", BM_bilinear_sse4_multi_thread, benchmark_input));
-
+      "Dispatched - multi thread - core remap", BM_core_remap, benchmark_input));
+  benchmarks.push_back(benchmark::RegisterBenchmark(
+      "Dispatched - multi thread - buffer pool", BM_bilinear_dispatched_multi_thread_buffer_pool,
+      benchmark_input));
   benchmarks.push_back(benchmark::RegisterBenchmark(
-      "AVX2 - single thread", BM_bilinear_avx2_single_thread, benchmark_input));
+      "Dispatched - multi thread - pinned thread pool", BM_bilinear_dispatched_multi_thread,
+      benchmark_input, Executor::pinned_thread_pool));
   benchmarks.push_back(benchmark::RegisterBenchmark(
-      "AVX2 - multi thread", BM_bilinear_avx2_multi_thread, benchmark_input));
+      "Dispatched - multi thread - cv::parallel_for_", BM_bilinear_dispatched_multi_thread,
+      benchmark_input, Executor::opencv));
+
+  // A stream of frames through the async API with more and more frames in flight, against the
+  // blocking path. Compare frames_per_second and the latency percentiles.
+  // The submitting thread mostly waits, so these are timed by wall clock rather than its CPU time
+  auto sync_stream =
+      benchmark::RegisterBenchmark("Sync - stream", BM_bilinear_sync_stream, benchmark_input);
+  benchmarks.push_back(sync_stream->UseRealTime());
+
+  for (auto in_flight : {1, 2, 4}) {
+    auto async_stream = benchmark::RegisterBenchmark(
+        ("Async - stream - " + std::to_string(in_flight) + " in flight").c_str(),
+        BM_bilinear_async_stream, benchmark_input, in_flight);
+    benchmarks.push_back(async_stream->UseRealTime());
+  }
 
-#ifdef __AVX512F__
+  // Rows split between NUMA nodes, against "Dispatched - multi thread - core remap"
+  benchmarks.push_back(benchmark::RegisterBenchmark("NUMA - multi thread", BM_bilinear_numa,
+                                                    benchmark_input, false));
   benchmarks.push_back(benchmark::RegisterBenchmark(
-      "AVX512 - single thread", BM_bilinear_avx512_single_thread, benchmark_input));
+      "NUMA - replicated source - multi thread", BM_bilinear_numa, benchmark_input, true));
+
+  // SSE4 has no warp, compact map, remap plan or pyramid specific implementation
+  for (auto isa : interpolate::ALL_ISAS) {
+    if (isa == interpolate::Isa::sse4 || !interpolate::isa_supported(isa)) {
+      continue;
+    }
+
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - affine warp - multi thread").c_str(),
+        BM_bilinear_affine_multi_thread, benchmark_input, isa));
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - perspective warp - multi thread").c_str(),
+        BM_bilinear_perspective_multi_thread, benchmark_input, isa));
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - fixed point map - multi thread").c_str(),
+        BM_bilinear_compact_map_multi_thread, benchmark_input, MapFormat::fixed_point, isa));
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - half float map - multi thread").c_str(),
+        BM_bilinear_compact_map_multi_thread, benchmark_input, MapFormat::half_float, isa));
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - remap plan - multi thread").c_str(),
+        BM_bilinear_remap_plan_multi_thread, benchmark_input, isa));
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - mipmap trilinear - multi thread").c_str(),
+        BM_bilinear_mipmap_multi_thread, benchmark_input, interpolate::MipmapFilter::trilinear,
+        isa, false));
+  }
+
+  benchmarks.push_back(benchmark::RegisterBenchmark("Remap plan - build",
+                                                    BM_bilinear_remap_plan_build, benchmark_input));
+
+  // Resizes with the separable tables, against the generic kernels with a coordinate map of the
+  // same resize and cv::resize
+  for (auto scale : {ResizeScale::down_2x, ResizeScale::down_1_5x, ResizeScale::up_2x}) {
+    auto scale_name = std::string(" - resize ") + resize_scale_name(scale);
+
+    for (auto isa : interpolate::ALL_ISAS) {
+      if (!interpolate::isa_supported(isa)) {
+        continue;
+      }
+
+      benchmarks.push_back(benchmark::RegisterBenchmark(
+          (benchmark_name(isa) + scale_name + " - multi thread").c_str(),
+          BM_bilinear_resize_multi_thread, benchmark_input, scale, isa));
+    }
+
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        ("Dispatched" + scale_name + " - coordinate map - multi thread").c_str(),
+        BM_bilinear_resize_map_multi_thread, benchmark_input, scale, interpolate::active_isa()));
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (std::string("OpenCV - cv::resize ") + resize_scale_name(scale)).c_str(), BM_opencv_resize,
+        benchmark_input, scale));
+  }
+
+  // Mipmapping against plain bilinear ("Dispatched - multi thread - kernel only"), and the cost
+  // of building the pyramid every frame for a source image that changes
+  auto active_isa = interpolate::active_isa();
   benchmarks.push_back(benchmark::RegisterBenchmark(
-      "AVX512 - multi thread", BM_bilinear_avx512_multi_thread, benchmark_input));
-#endif
+      "Dispatched - mipmap nearest level - multi thread", BM_bilinear_mipmap_multi_thread,
+      benchmark_input, interpolate::MipmapFilter::nearest_level, active_isa, false));
+  benchmarks.push_back(benchmark::RegisterBenchmark(
+      "Dispatched - mipmap trilinear - multi thread", BM_bilinear_mipmap_multi_thread,
+      benchmark_input, interpolate::MipmapFilter::trilinear, active_isa, false));
+  benchmarks.push_back(benchmark::RegisterBenchmark(
+      "Dispatched - mipmap trilinear - rebuild pyramid - multi thread",
+      BM_bilinear_mipmap_multi_thread, benchmark_input, interpolate::MipmapFilter::trilinear,
+      active_isa, true));
+
+  // Streaming stores against regular stores, with a 4K output far larger than the cache. The
+  // plain and SSE4 kernels only have regular stores.
+  auto uhd_input = create_benchmark_input(cv::Size2i(3840, 2160));
+
+  for (auto isa : interpolate::ALL_ISAS) {
+    if (isa == interpolate::Isa::plain || isa == interpolate::Isa::sse4 ||
+        !interpolate::isa_supported(isa)) {
+      continue;
+    }
+
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - 4K output - multi thread").c_str(),
+        BM_bilinear_store_multi_thread, uhd_input, isa, interpolate::Store::cached));
+    benchmarks.push_back(benchmark::RegisterBenchmark(
+        (benchmark_name(isa) + " - 4K output - streaming stores - multi thread").c_str(),
+        BM_bilinear_store_multi_thread, uhd_input, isa, interpolate::Store::streaming));
+  }
+
+  // Row by row against tiles, at different rotations and scales
+  auto tiled = benchmark::RegisterBenchmark("Tiled - multi thread", BM_bilinear_tiled_multi_thread,
+                                            benchmark_input);
+  tiled->ArgNames({"tile_w", "tile_h", "angle", "scale_pct"});
+
+  auto tile_sizes = {interpolate::TileSize{0, 1}, interpolate::TileSize{64, 16},
+                     interpolate::TileSize{128, 8}, interpolate::TileSize{32, 32}};
+
+  for (auto scale : {100, 300}) {
+    for (auto angle : {0, 18, 45, 90}) {
+      for (auto tile_size : tile_sizes) {
+        tiled->Args({tile_size.width, tile_size.height, angle, scale});
+      }
+    }
+  }
+
+  benchmarks.push_back(tiled);
 
   for (auto bm : benchmarks) {
     bm->Unit(benchmark::kMillisecond);
     bm->MinTime(2.0);
   }
+  // How the dispatched kernel scales with the source size, output size, rotation, scale and
+  // thread count. Compare points by items_per_second (output pixels) and the bytes_per_second
+  // counters rather than time, which depends on the output size.
+  // Thread counts double from 1 up to the hardware threads, then all of them (0), to show the
+  // scaling
+  auto thread_counts = std::vector<int64_t>{1};
+  for (auto threads = 2; threads < interpolate::default_thread_pool().threads(); threads *= 2) {
+    thread_counts.push_back(threads);
+  }
+  thread_counts.push_back(0);
+
+  benchmark::RegisterBenchmark("Matrix - multi thread", BM_bilinear_matrix, benchmark_input)
+      ->ArgNames({"source_pct", "out_w", "angle", "scale_pct", "threads"})
+      ->ArgsProduct({{50, 100}, {640, 1280, 3840}, {0, 5, 45}, {50, 100, 300}, thread_counts})
+      ->Unit(benchmark::kMicrosecond)
+      ->MinTime(0.5);
 }
 
 int main(int argc, char** argv) {
   auto benchmark_input = create_benchmark_input();
 
   validate_implementations(benchmark_input);
+
+  // Output widths that aren't a multiple of any kernel step, so every row ends in a partial step
+  for (auto output_size : {cv::Size2i(1366, 768), cv::Size2i(1917, 1080), cv::Size2i(7, 5)}) {
+    auto odd_input = create_benchmark_input(output_size);
+    validate_implementations(odd_input);
+  }
+
   register_benchmarks(benchmark_input);
 
   printf("Input image size: %dx%d\n", benchmark_input.source_image.cols,
@@ -94,7 +800,18 @@ int main(int argc, char** argv) {
   printf("Output image size: %dx%d\n", benchmark_input.output_size.width,
          benchmark_input.output_size.height);
   printf("OpenCV: numberOfCPUS=%d getNumThreads=%d\n", cv::getNumberOfCPUs(), cv::getNumThreads());
+  printf("Thread pool: threads=%d\n", thread_pool(false).threads());
+  printf("Instruction set: best=%s active=%s\n", interpolate::isa_name(interpolate::best_isa()),
+         interpolate::isa_name(interpolate::active_isa()));
 
   benchmark::Initialize(&argc, argv);
+
+  // --perf_counters adds hardware performance counters to every benchmark (see PerfCounters)
+  for (auto i = 1; i < argc; i++) {
+    if (std::string(argv[i]) == "--perf_counters") {
+      perf_counters_enabled() = true;
+    }
+  }
+
   benchmark::RunSpecifiedBenchmarks();
 }